@@ -24,6 +24,8 @@ class   CDevImpl;
 class   CAddressImpl;
 class   CompositePathIterator;
 class   IAddress;
+class   CAccessBatch;
+class   CAccessPlan;
 
 typedef shared_ptr<CDevImpl> DevImpl;
 typedef weak_ptr<CDevImpl>   WDevImpl;
@@ -38,12 +40,14 @@ public:
 	uint64_t          off_;
 	CTimeout          timeout_;
 	AsyncIO           aio_;
+	CAccessBatch     *batch_; // addresses which support batching may defer the access
 	CReadArgs()
 	: cacheable_ ( IField::UNKNOWN_CACHEABLE ),
 	  dst_       ( NULL ),
 	  nbytes_    ( 0 ),
 	  off_       ( 0 ),
-	  timeout_   ( TIMEOUT_INDEFINITE )
+	  timeout_   ( TIMEOUT_INDEFINITE ),
+	  batch_     ( NULL )
 	{
 	}
 };
@@ -57,6 +61,8 @@ public:
 	uint8_t           msk1_;
 	uint8_t           mskn_;
 	CTimeout          timeout_;
+	CAccessBatch     *batch_; // addresses which support batching may defer the access
+	bool              pipelined_; // status may be deferred until IAddress::flush()
 	CWriteArgs()
 	: cacheable_ ( IField::UNKNOWN_CACHEABLE ),
 	  src_       ( NULL ),
@@ -64,7 +70,9 @@ public:
 	  nbytes_    ( 0 ),
 	  msk1_      ( 0 ),
 	  mskn_      ( 0 ),
-	  timeout_   ( TIMEOUT_INDEFINITE )
+	  timeout_   ( TIMEOUT_INDEFINITE ),
+	  batch_     ( NULL ),
+	  pipelined_ ( false )
 	{
 	}
 };
@@ -97,6 +105,11 @@ class IAddress : public IChild {
 		virtual uint64_t dispatchRead (CompositePathIterator *node, CReadArgs *args)  const = 0;
 		virtual uint64_t dispatchWrite(CompositePathIterator *node, CWriteArgs *args) const = 0;
 
+		// add this address' contribution to a precompiled access plan
+		// and pass on to the parent; returns false if accesses through
+		// 'node' cannot be precompiled.
+		virtual bool     compilePlan(CompositePathIterator *node, CAccessPlan *plan) const = 0;
+
 		virtual void dump(FILE *f)           const = 0;
 
 		virtual void dump()                  const = 0;
@@ -111,6 +124,10 @@ class IAddress : public IChild {
 
 		virtual unsigned getAlignment()      const = 0;
 
+		// wait for deferred (e.g., pipelined) writes to complete
+		// and report any failure.
+		virtual void flush()                 const = 0;
+
 		virtual ~IAddress() {}
 };
 
@@ -181,6 +198,9 @@ class CAddressImpl : public IAddress {
 
 		virtual unsigned getAlignment() const { return 1; }
 
+		// nothing is deferred by default
+		virtual void     flush()        const {}
+
 		virtual int      incOpen();
 		virtual int      open (CompositePathIterator *);
 		virtual int      decOpen();
@@ -192,6 +212,18 @@ class CAddressImpl : public IAddress {
 		virtual uint64_t dispatchRead (CompositePathIterator *node, CReadArgs *args)  const;
 		virtual uint64_t dispatchWrite(CompositePathIterator *node, CWriteArgs *args) const;
 
+		// Contribute to a CAccessPlan; returns false if the path
+		// cannot be planned, which is the default. Addresses opt in
+		// by overriding this (see terminatePlan()).
+		virtual bool     compilePlan(CompositePathIterator *node, CAccessPlan *plan) const;
+
+		// false if the completion of reads is signalled by the
+		// address itself (rather than read(CompositePathIterator*,...))
+		bool             isSync() const
+		{
+			return isSync_;
+		}
+
 		virtual int  getOpenCount()
 		{
 			return openCount_.load( cpsw::memory_order_acquire );
@@ -221,10 +253,79 @@ class CAddressImpl : public IAddress {
 		}
 
 	protected:
+		// make this address the target of 'plan', i.e., I/O is routed
+		// to read(CReadArgs*)/write(CWriteArgs*). Only for addresses
+		// which do not override read/write(CompositePathIterator*, ...).
+		bool             terminatePlan(CompositePathIterator *node, CAccessPlan *plan) const;
+
 		template <typename T> T getOwnerAs() const
 		{
 			return static_pointer_cast<typename T::element_type, DevImpl::element_type>( this->getOwnerAsDevImpl() );
 		}
 };
 
+typedef shared_ptr<const CAddressImpl> ConstAddressImpl;
+
+/* A path (with its index ranges) flattened into the address
+ * which eventually performs the I/O (the 'target') and the
+ * location of the elements within it (offset of the first one,
+ * stride and count).
+ *
+ * Replaying a plan yields the same target accesses as walking
+ * the path with a CompositePathIterator (read/write through each
+ * address) but without the chain of virtual calls and iterator
+ * copies. Since the addresses on a path never change once the
+ * path has been built, a plan remains valid for as long as
+ * the path it was compiled from.
+ */
+class CAccessPlan {
+private:
+	ConstAddressImpl  target_;
+	uint64_t          off_;
+	uint64_t          stride_;
+	unsigned          nelms_;
+	IField::Cacheable cacheable_;
+
+public:
+	CAccessPlan()
+	: off_      ( 0                          ),
+	  stride_   ( 0                          ),
+	  nelms_    ( 0                          ),
+	  cacheable_( IField::UNKNOWN_CACHEABLE  )
+	{
+	}
+
+	// returns false (and leaves the plan invalid) if any
+	// address on the path cannot be precompiled.
+	bool     compile(const CompositePathIterator &it);
+
+	bool     isValid()   const
+	{
+		return !! target_;
+	}
+
+	void     reset();
+
+	// used by the addresses while compiling
+	bool     hasElements() const
+	{
+		return nelms_ > 0;
+	}
+
+	void     setElements(uint64_t off, uint64_t stride, unsigned nelms, IField::Cacheable cacheable);
+
+	void     addOffset(uint64_t off)
+	{
+		off_ += off;
+	}
+
+	void     setTarget(ConstAddressImpl target)
+	{
+		target_ = target;
+	}
+
+	uint64_t read (CReadArgs  *args) const;
+	uint64_t write(CWriteArgs *args) const;
+};
+
 #endif
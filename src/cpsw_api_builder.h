@@ -58,7 +58,10 @@ struct StrCmp {
 
 typedef enum ByteOrder { UNKNOWN = 0, LE = 12, BE = 21, NATIVE = 22 } ByteOrder;
 
-typedef enum WriteMode { POSTED = 0, SYNCHRONOUS = 1 } WriteMode;
+// PIPELINED: writes are streamed without waiting for their replies;
+//            these are collected asynchronously and any failure is
+//            reported by the next IPath::flush().
+typedef enum WriteMode { POSTED = 0, SYNCHRONOUS = 1, PIPELINED = 2 } WriteMode;
 
 ByteOrder hostByteOrder();
 
@@ -183,11 +186,21 @@ public:
 	virtual uint64_t           getSRPTimeoutUS()                   = 0;
 	virtual void               useSRPDynTimeout(bool)              = 0; // default: YES unless TDEST demuxer in use
 	virtual bool               hasSRPDynTimeout()                  = 0; // dynamically adjusted timeout (based on RTT)
+	virtual void               setSRPDynTimeoutPercentile(double)  = 0; // default: 0 (timeout based on average RTT)
+	virtual double             getSRPDynTimeoutPercentile()        = 0; // timeout based on RTT percentile (plus margin)
+	virtual void               setSRPDynTimeoutMargin(unsigned)    = 0; // default: 100 (percent)
+	virtual unsigned           getSRPDynTimeoutMargin()            = 0;
 	virtual void               setSRPRetryCount(unsigned)          = 0; // default: 10
 	virtual unsigned           getSRPRetryCount()                  = 0;
 
 	virtual void               setSRPDefaultWriteMode(WriteMode)   = 0; // default: POSTED
 	virtual WriteMode          getSRPDefaultWriteMode()            = 0;
+	virtual void               setSRPShadowCacheMaxBytes(unsigned) = 0; // default: 0 (no shadow cache)
+	virtual unsigned           getSRPShadowCacheMaxBytes()         = 0;
+	virtual void               setSRPReadWindow(unsigned)          = 0; // default: 1 (one transaction at a time)
+	virtual unsigned           getSRPReadWindow()                  = 0;
+	virtual void               setSRPWriteWindow(unsigned)         = 0; // default: 8 (PIPELINED mode and batched SYNCHRONOUS writes)
+	virtual unsigned           getSRPWriteWindow()                 = 0;
 
 	virtual bool               hasTcp()                            = 0; // default: NO
     virtual void               setTcpPort(unsigned)                = 0; // default: 8192
@@ -196,6 +209,10 @@ public:
 	virtual unsigned           getTcpOutQueueDepth()               = 0;
 	virtual void               setTcpThreadPriority(int)           = 0;
 	virtual int                getTcpThreadPriority()              = 0;
+	// Size of the process-wide pool of I/O engine (epoll) threads
+	// to service the socket; 0 uses a dedicated RX thread.
+	virtual void               setTcpIoEngineThreads(unsigned)     = 0; // default: 0
+	virtual unsigned           getTcpIoEngineThreads()             = 0;
 
 	virtual bool               hasUdp()                            = 0; // default: YES
 	virtual void               setUdpPort(unsigned)                = 0; // default: 8192
@@ -208,6 +225,16 @@ public:
 	virtual int                getUdpPollSecs()                    = 0;
 	virtual void               setUdpThreadPriority(int)           = 0;
 	virtual int                getUdpThreadPriority()              = 0;
+	// Number of datagrams received (recvmmsg) or sent (sendmmsg) per
+	// system call. A TX batch size > 1 sends from a dedicated thread.
+	virtual void               setUdpRxBatchSize(unsigned)         = 0; // default: 1
+	virtual unsigned           getUdpRxBatchSize()                 = 0;
+	virtual void               setUdpTxBatchSize(unsigned)         = 0; // default: 1
+	virtual unsigned           getUdpTxBatchSize()                 = 0;
+	// Size of the process-wide pool of I/O engine (epoll) threads
+	// to service the socket and poller; 0 uses dedicated threads.
+	virtual void               setUdpIoEngineThreads(unsigned)     = 0; // default: 0
+	virtual unsigned           getUdpIoEngineThreads()             = 0;
 
 	virtual void               useRssi(bool)                       = 0; // default: NO
 	virtual bool               hasRssi()                           = 0;
@@ -260,6 +287,18 @@ public:
 	virtual void               setSocksProxy(LibSocksProxyPtr)     = 0;
 	virtual LibSocksProxyPtr   getSocksProxy()                     = 0;
 
+	// Queues which only block when empty/full (rather than synchronizing
+	// every push and pop). Applies to all out/inp queues of the stack.
+	virtual void               useLockFreeQueues(bool)             = 0; // default: NO
+	virtual bool               hasLockFreeQueues()                 = 0;
+
+	// Let the UDP/TCP receivers place incoming data directly into 'size'
+	// bytes of application memory at 'mem', split into slots of 'slotSize'
+	// (which should hold an entire datagram/frame). Regular buffers are
+	// used while all slots are busy. The memory must remain valid until
+	// all stacks built with it are gone; a NULL 'mem' removes the region.
+	virtual void               setRxMemRegion(void *mem, uint64_t size, unsigned slotSize) = 0; // default: none
+
 	virtual void               reset()                             = 0; // reset to defaults
 
 	virtual bool               getAutoStart()                      = 0;
@@ -31,6 +31,7 @@ class IScalVal_WO;
 class IScalVal;
 class IEnum;
 class IStream;
+class IStreamFrame;
 class IDoubleVal_RO;
 class IDoubleVal_WO;
 class IDoubleVal;
@@ -48,6 +49,7 @@ typedef shared_ptr<IScalVal>             ScalVal;
 typedef shared_ptr<IEnum>                Enum;
 typedef shared_ptr<const std::string>    CString;
 typedef shared_ptr<IStream>              Stream;
+typedef shared_ptr<const IStreamFrame>   StreamFrame;
 typedef shared_ptr< std::vector<Child> > Children;
 typedef shared_ptr<IDoubleVal_RO>        DoubleVal_RO;
 typedef shared_ptr<IDoubleVal_WO>        DoubleVal_WO;
@@ -243,6 +245,9 @@ class IPath {
 public:
 	// lookup 'name' under this path and return new 'full' path
 	virtual Path        findByName(const char *name) const = 0;
+	// lookup each of 'names' under this path (as 'findByName' does);
+	// results are returned in the same order.
+	virtual std::vector<Path> findByNames(const std::vector<std::string> &names) const = 0;
 	// strip last element off this path and return child at tail (or NULL if none)
 	virtual Child       up()                               = 0;
 	// test if this path is empty
@@ -322,6 +327,16 @@ public:
 	 */
 	virtual uint64_t    loadConfigFromYamlFile(const char* filename, const char *incdir = 0) const = 0;
 
+	/*!
+	 * Wait until all writes which were issued to the address spaces
+	 * traversed by this path but whose completion status is still
+	 * outstanding (PIPELINED write mode) have completed.
+	 *
+	 * Throws the first error encountered by any of these writes
+	 * since the last flush.
+	 */
+	virtual void        flush()                      const = 0;
+
 	// create a path
 	static  Path        create();             // absolute; starting at root
 	static  Path        create(const char*);  // absolute; starting at root
@@ -412,6 +427,13 @@ public:
 	 */
 	virtual Path       findByName(const char *path) const = 0;
 
+	/*!
+	 * Bulk version of 'findByName'; returns the paths in the order
+	 * of 'paths'. Lookups from the same hub are cached, so prefixes
+	 * shared by many paths are resolved only once.
+	 */
+	virtual std::vector<Path> findByNames(const std::vector<std::string> &paths) const = 0;
+
 	/*!
 	 * Find a child with 'name' in this hub.
 	 */
@@ -772,6 +794,71 @@ public:
 	static ScalVal create(ConstPath path);
 };
 
+class IBatch;
+typedef shared_ptr<IBatch> Batch;
+
+/*!
+ * Collect many (small) accesses to ScalVals and execute them together.
+ *
+ * Accesses to devices which support batching (SRP) are not performed
+ * when they are queued but deferred until 'execute()' is called. At
+ * that point accesses to adjacent (or overlapping) address ranges of
+ * the same device are merged into as few block transactions as
+ * possible and all reads are in flight simultaneously. A write is
+ * only merged with the write queued right before it; reads are
+ * only merged if the entries are (at least) WT_CACHEABLE.
+ * Accesses to devices which do not support batching are executed
+ * when they are queued.
+ *
+ * All writes are executed (in the order they were queued) before
+ * the reads. Writes to SYNCHRONOUS devices are sent without waiting
+ * for each reply (as if the device was PIPELINED); 'execute()' collects
+ * their status before it proceeds to the reads. POSTED devices
+ * are not affected.
+ *
+ * NOTE: a batch object must not be used by multiple threads
+ *       concurrently.
+ */
+class IBatch {
+public:
+	/*!
+	 * Queue a read of 'val' into 'buf'. The buffer must remain valid
+	 * until 'execute()' returns; it is only guaranteed to hold the
+	 * result after 'execute()' returned successfully.
+	 * See IScalVal_RO::getVal() for the semantics of 'nelms' and 'range'.
+	 *
+	 * RETURNS: number of elements queued.
+	 */
+	virtual unsigned getVal(ScalVal_RO val, uint64_t *buf, unsigned nelms = 1, IndexRange *range = 0) = 0;
+
+	/*!
+	 * Queue a write of the values in 'buf' (the values are copied) or
+	 * of a single value 'v' to all elements of 'val'.
+	 *
+	 * RETURNS: number of elements queued.
+	 */
+	virtual unsigned setVal(ScalVal val, uint64_t *buf, unsigned nelms, IndexRange *range = 0) = 0;
+	virtual unsigned setVal(ScalVal val, uint64_t  v,                   IndexRange *range = 0) = 0;
+
+	/*!
+	 * Execute all queued accesses and wait for them to complete.
+	 * The batch is empty (and can be reused) when this method
+	 * returns.
+	 *
+	 * Throws the first error encountered.
+	 */
+	virtual void     execute()                           = 0;
+
+	/*!
+	 * Number of accesses which are currently deferred.
+	 */
+	virtual unsigned getNumDeferred()              const = 0;
+
+	virtual ~IBatch() {}
+
+	static Batch create();
+};
+
 // Analogous to ScalVal there could be interfaces to double, enums, strings...
 
 
@@ -791,6 +878,44 @@ public:
 class CTimeout;
 #include <cpsw_api_timeout.h>
 
+/*!
+ * Read-only view of a frame received on a stream.
+ *
+ * The frame data are not copied but remain in the buffers they
+ * were received into; these buffers are held (and not recycled)
+ * for as long as a reference to the frame exists.
+ *
+ * The payload is scattered across 'getNumSegments()' contiguous
+ * segments which may be accessed directly.
+ */
+class IStreamFrame {
+public:
+	struct Segment {
+		const uint8_t *data;
+		uint64_t       size;
+	};
+
+	/*!
+	 * Total number of octets in the frame.
+	 */
+	virtual uint64_t       getSize()              const = 0;
+
+	/*!
+	 * Scatter-list of 'getNumSegments()' payload segments.
+	 */
+	virtual unsigned       getNumSegments()       const = 0;
+	virtual const Segment *getSegments()          const = 0;
+
+	/*!
+	 * Copy at most 'size' octets starting at offset 'off' into 'buf'.
+	 *
+	 * RETURNS: number of octets copied.
+	 */
+	virtual uint64_t       extract(uint8_t *buf, uint64_t off, uint64_t size) const = 0;
+
+	virtual ~IStreamFrame() {}
+};
+
 /*!
  * Interface for endpoints with support streaming of raw data.",
  */
@@ -810,6 +935,15 @@ public:
 	 */
 	virtual int64_t read(uint8_t *buf, uint64_t size,  const CTimeout timeoutUs = TIMEOUT_INDEFINITE, uint64_t off = 0) = 0;
 
+	/*!
+	 * Read the next frame from a streaming interface without copying it.
+	 *
+	 * The 'timeoutUs' argument has the same semantics as for 'read'.
+	 *
+	 * RETURNS: a read-only view of the frame or NULL if the timeout expired.
+	 */
+	virtual StreamFrame readChain(const CTimeout timeoutUs = TIMEOUT_INDEFINITE) = 0;
+
 	/*!
 	 * Write raw bytes to a streaming interface and return the number of bytes written.
 	 */
@@ -895,6 +1029,50 @@ public:
 	static DoubleVal create(ConstPath path);
 };
 
+/*!
+ * Run-time metrics of all protocol modules and SRP endpoints
+ * which are currently running.
+ *
+ * Every 'source' (a protocol module or SRP endpoint) provides
+ * a set of named counters, gauges and histograms. Sources of
+ * the same kind are distinguished by their 'instance' number.
+ */
+class IMetrics {
+public:
+	typedef enum { COUNTER, GAUGE, HISTOGRAM } Kind;
+
+	struct Sample {
+		std::string           source;
+		unsigned              instance;
+		std::string           name;
+		Kind                  kind;
+		// COUNTER/GAUGE: the value; HISTOGRAM: number of recorded values
+		uint64_t              value;
+		// HISTOGRAM only: sum of all recorded values
+		uint64_t              sum;
+		// HISTOGRAM only: 'bucketCounts[i]' values were recorded which
+		// are less than 'bucketLimits[i]' (and not less than the limit
+		// of the preceding bucket).
+		std::vector<uint64_t> bucketLimits;
+		std::vector<uint64_t> bucketCounts;
+	};
+
+	typedef std::vector<Sample> Snapshot;
+
+	/*!
+	 * Take a snapshot of all current metrics (appended to 'snapshot').
+	 */
+	static void snapshot(Snapshot *snapshot);
+
+	/*!
+	 * Dump a snapshot in JSON or in Prometheus text exposition format.
+	 * Prometheus counters carry a '_total' suffix and the source's
+	 * instance is exported as label 'cpsw_instance'.
+	 */
+	static void dumpJSON(FILE *f);
+	static void dumpPrometheus(FILE *f);
+};
+
 /*!
  * Obtain the GIT version string of the library
  */
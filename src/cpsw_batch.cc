@@ -0,0 +1,304 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_batch.h>
+#include <cpsw_sval.h>
+
+#include <string.h>
+#include <algorithm>
+
+using cpsw::dynamic_pointer_cast;
+
+// Completion of a merged read; scatters the data into
+// the destinations of the individual reads.
+class CAccessBatch::CMergedRead : public IAsyncIO {
+private:
+	uint64_t             off_;
+	std::vector<uint8_t> buf_;
+	std::vector<CRead>   parts_;
+
+public:
+	CMergedRead(std::vector<CRead>::const_iterator from, std::vector<CRead>::const_iterator to, uint64_t off, unsigned nbytes)
+	: off_  ( off       ),
+	  buf_  ( nbytes    ),
+	  parts_( from, to  )
+	{
+	}
+
+	uint8_t *getBuf()
+	{
+		return &buf_[0];
+	}
+
+	virtual void callback(CPSWError *err)
+	{
+	std::vector<CRead>::iterator it;
+		for ( it = parts_.begin(); it != parts_.end(); ++it ) {
+			if ( ! err ) {
+				memcpy( it->dst_, &buf_[ it->off_ - off_ ], it->nbytes_ );
+			}
+			it->aio_->callback( err );
+		}
+	}
+};
+
+CAccessBatch::CAccessBatch()
+{
+}
+
+CAccessBatch::~CAccessBatch()
+{
+	clear();
+}
+
+shared_ptr<IIntEntryAdapt>
+CAccessBatch::getAdapter(shared_ptr<IScalVal_Base> val)
+{
+shared_ptr<IIntEntryAdapt> rval = dynamic_pointer_cast<IIntEntryAdapt>( val );
+
+	if ( ! rval ) {
+		throw InterfaceNotImplementedError("IBatch: unsupported ScalVal implementation");
+	}
+	adapters_.push_back( rval );
+	return rval;
+}
+
+unsigned
+CAccessBatch::getVal(ScalVal_RO val, uint64_t *buf, unsigned nelms, IndexRange *range)
+{
+shared_ptr<IIntEntryAdapt> a = getAdapter( val );
+
+	if ( ! readsDone_ ) {
+		waiter_    = IAsyncIOCompletionWaiter::create();
+		readsDone_ = IAsyncIOParallelCompletion::create( waiter_ );
+	}
+
+	return a->getVal( this, readsDone_, reinterpret_cast<uint8_t*>( buf ), nelms, sizeof(*buf), range );
+}
+
+unsigned
+CAccessBatch::setVal(ScalVal val, uint64_t *buf, unsigned nelms, IndexRange *range)
+{
+shared_ptr<IIntEntryAdapt> a = getAdapter( val );
+
+	return a->setVal( this, reinterpret_cast<uint8_t*>( buf ), nelms, sizeof(*buf), range );
+}
+
+unsigned
+CAccessBatch::setVal(ScalVal val, uint64_t v, IndexRange *range)
+{
+shared_ptr<IIntEntryAdapt> a     = getAdapter( val );
+unsigned                   nelms = a->nelmsFromIdx( range );
+std::vector<uint64_t>      buf( nelms, v );
+
+	return a->setVal( this, reinterpret_cast<uint8_t*>( &buf[0] ), nelms, sizeof(buf[0]), range );
+}
+
+void
+CAccessBatch::deferRead(const CAddressImpl *addr, const CReadArgs *args)
+{
+CRead r;
+
+	r.addr_      = addr;
+	r.cacheable_ = args->cacheable_;
+	r.off_       = args->off_;
+	r.nbytes_    = args->nbytes_;
+	r.dst_       = args->dst_;
+	r.aio_       = args->aio_;
+
+	reads_.push_back( r );
+}
+
+void
+CAccessBatch::deferWrite(const CAddressImpl *addr, const CWriteArgs *args)
+{
+	// append to the previous write if it is adjacent; merging
+	// with any earlier write would change the order of writes.
+	if ( ! writes_.empty() ) {
+	CWrite &w = writes_.back();
+		if (    w.addr_                 == addr
+		     && w.off_ + w.data_.size() == args->off_
+		     && 0                       == w.mskn_
+		     && 0                       == args->msk1_
+		     && w.cacheable_            == args->cacheable_ ) {
+			w.data_.insert( w.data_.end(), args->src_, args->src_ + args->nbytes_ );
+			w.mskn_ = args->mskn_;
+			w.last_ = adapters_.size() - 1;
+			return;
+		}
+	}
+
+	writes_.push_back( CWrite() );
+
+	CWrite &w = writes_.back();
+
+	w.addr_      = addr;
+	w.cacheable_ = args->cacheable_;
+	w.off_       = args->off_;
+	w.msk1_      = args->msk1_;
+	w.mskn_      = args->mskn_;
+	w.data_.assign( args->src_, args->src_ + args->nbytes_ );
+	// the adapter routing this write was registered last
+	w.first_     = adapters_.size() - 1;
+	w.last_      = w.first_;
+
+	writeTargets_.insert( addr );
+}
+
+std::string
+CAccessBatch::getPaths(const CWrite &w) const
+{
+std::string rval = adapters_[ w.first_ ]->getPath()->toString();
+
+	if ( w.last_ != w.first_ ) {
+		rval += " .. " + adapters_[ w.last_ ]->getPath()->toString();
+	}
+	return rval;
+}
+
+bool
+CAccessBatch::lowerOff(const CRead &a, const CRead &b)
+{
+	if ( a.addr_ != b.addr_ )
+		return a.addr_ < b.addr_;
+	return a.off_ < b.off_;
+}
+
+bool
+CAccessBatch::mergeable(const CRead &a, const CRead &b, uint64_t end)
+{
+	return    a.addr_      == b.addr_
+	       && b.off_       <= end
+	       && a.cacheable_ >= IField::WT_CACHEABLE
+	       && b.cacheable_ >= IField::WT_CACHEABLE;
+}
+
+void
+CAccessBatch::executeWrites()
+{
+std::vector<CWrite>::iterator it;
+Targets::iterator             tgt;
+
+	for ( it = writes_.begin(); it != writes_.end(); ++it ) {
+	CWriteArgs args;
+
+		args.cacheable_ = it->cacheable_;
+		args.src_       = &it->data_[0];
+		args.off_       = it->off_;
+		args.nbytes_    = it->data_.size();
+		args.msk1_      = it->msk1_;
+		args.mskn_      = it->mskn_;
+
+		// SYNCHRONOUS targets only need the status by the time
+		// 'execute()' returns; let them stream the writes and collect
+		// the replies with the 'flush()' below. POSTED targets still
+		// post (see CSRPAddressImpl::writeBlk_unlocked()).
+		args.pipelined_ = true;
+
+		try {
+			it->addr_->write( &args );
+		} catch ( CPSWError &e ) {
+			e.prepend( getPaths( *it ) + ": " );
+			throw;
+		}
+	}
+
+	// collect the status of pipelined writes before reading back
+	for ( tgt = writeTargets_.begin(); tgt != writeTargets_.end(); ++tgt ) {
+		(*tgt)->flush();
+	}
+}
+
+void
+CAccessBatch::executeReads()
+{
+unsigned i, j, n;
+uint64_t end;
+
+	std::stable_sort( reads_.begin(), reads_.end(), lowerOff );
+
+	n = reads_.size();
+
+	for ( i = 0; i < n; i = j ) {
+	CReadArgs args;
+
+		end = reads_[i].off_ + reads_[i].nbytes_;
+
+		// merge adjacent and overlapping ranges of cacheable entries
+		for ( j = i + 1; j < n && mergeable( reads_[i], reads_[j], end ); j++ ) {
+			if ( reads_[j].off_ + reads_[j].nbytes_ > end ) {
+				end = reads_[j].off_ + reads_[j].nbytes_;
+			}
+		}
+
+		// the cache was already consulted when the read was deferred
+		args.cacheable_ = IField::NOT_CACHEABLE;
+		args.off_       = reads_[i].off_;
+		args.nbytes_    = end - reads_[i].off_;
+
+		if ( j == i + 1 ) {
+			args.dst_ = reads_[i].dst_;
+			args.aio_ = reads_[i].aio_;
+		} else {
+			shared_ptr<CMergedRead> m = cpsw::make_shared<CMergedRead>( reads_.begin() + i, reads_.begin() + j, args.off_, args.nbytes_ );
+			args.dst_ = m->getBuf();
+			args.aio_ = m;
+		}
+
+		try {
+			reads_[i].addr_->read( &args );
+		} catch ( CPSWError &e ) {
+			args.aio_->callback( &e );
+		}
+	}
+
+	// the last transfer to complete executes the waiter's callback
+	reads_.clear();
+	readsDone_.reset();
+
+	if ( waiter_ ) {
+		waiter_->wait();
+	}
+}
+
+void
+CAccessBatch::execute()
+{
+	try {
+		executeWrites();
+		executeReads();
+	} catch ( CPSWError & ) {
+		clear();
+		throw;
+	}
+	clear();
+}
+
+void
+CAccessBatch::clear()
+{
+	reads_.clear();
+	writes_.clear();
+	writeTargets_.clear();
+	readsDone_.reset();
+	waiter_.reset();
+	adapters_.clear();
+}
+
+unsigned
+CAccessBatch::getNumDeferred() const
+{
+	return reads_.size() + writes_.size();
+}
+
+Batch
+IBatch::create()
+{
+	return cpsw::make_shared<CAccessBatch>();
+}
@@ -0,0 +1,110 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_BATCH_H
+#define CPSW_BATCH_H
+
+#include <cpsw_api_user.h>
+#include <cpsw_address.h>
+#include <cpsw_async_io.h>
+
+#include <vector>
+#include <string>
+#include <set>
+
+class IIntEntryAdapt;
+
+/* Implementation of IBatch.
+ *
+ * ScalVal accesses queued on a batch are routed down to the
+ * address as usual but with CReadArgs/CWriteArgs::batch_ set.
+ * Addresses which support batching (CSRPAddressImpl) do not
+ * perform the transfer but hand it back to the batch by means
+ * of 'deferRead()'/'deferWrite()'. 'execute()' then merges
+ * adjacent ranges and issues the merged transfers through the
+ * address' ordinary (non-iterator) read/write methods.
+ *
+ * A write is only merged with the write queued immediately
+ * before it (preserving the order of all writes); reads are
+ * only merged if both entries are cacheable (reading a FIFO
+ * or clear-on-read register once instead of N times would
+ * change the semantics).
+ */
+class CAccessBatch : public IBatch {
+private:
+	class CRead {
+	public:
+		const CAddressImpl *addr_;
+		IField::Cacheable   cacheable_;
+		uint64_t            off_;
+		unsigned            nbytes_;
+		uint8_t            *dst_;
+		AsyncIO             aio_;
+	};
+
+	class CWrite {
+	public:
+		const CAddressImpl  *addr_;
+		IField::Cacheable    cacheable_;
+		uint64_t             off_;
+		uint8_t              msk1_;
+		uint8_t              mskn_;
+		std::vector<uint8_t> data_;
+		// range of 'adapters_' merged into this write (for error messages)
+		unsigned             first_;
+		unsigned             last_;
+	};
+
+	class CMergedRead;
+
+	typedef std::set<const CAddressImpl*> Targets;
+
+	// keep the paths (and thus the addresses) alive
+	std::vector< shared_ptr<IIntEntryAdapt> > adapters_;
+	std::vector<CRead>                        reads_;
+	std::vector<CWrite>                       writes_;
+	Targets                                   writeTargets_;
+	AsyncIOCompletionWaiter                   waiter_;
+	AsyncIOParallelCompletion                 readsDone_;
+
+	CAccessBatch(const CAccessBatch&);
+	CAccessBatch &operator=(const CAccessBatch&);
+
+	shared_ptr<IIntEntryAdapt> getAdapter(shared_ptr<IScalVal_Base> val);
+
+	// paths of the ScalVals merged into 'w'
+	std::string getPaths(const CWrite &w) const;
+
+	void executeWrites();
+	void executeReads();
+	void clear();
+
+	static bool lowerOff(const CRead &a, const CRead &b);
+	// whether 'b' may be merged with a read starting at 'a' and ending at 'end'
+	static bool mergeable(const CRead &a, const CRead &b, uint64_t end);
+
+public:
+	CAccessBatch();
+
+	virtual unsigned getVal(ScalVal_RO val, uint64_t *buf, unsigned nelms = 1, IndexRange *range = 0);
+	virtual unsigned setVal(ScalVal val, uint64_t *buf, unsigned nelms, IndexRange *range = 0);
+	virtual unsigned setVal(ScalVal val, uint64_t  v,                   IndexRange *range = 0);
+
+	virtual void     execute();
+
+	virtual unsigned getNumDeferred() const;
+
+	// called by addresses which support batching
+	virtual void     deferRead (const CAddressImpl *addr, const CReadArgs  *args);
+	virtual void     deferWrite(const CAddressImpl *addr, const CWriteArgs *args);
+
+	virtual ~CAccessBatch();
+};
+
+#endif
@@ -412,6 +412,11 @@ public:
 		return s()->read( buf, size, timeoutUs, off );
 	}
 
+	virtual StreamFrame readChain(const CTimeout timeoutUs)
+	{
+		return s()->readChain( timeoutUs );
+	}
+
 	virtual int64_t write(uint8_t *buf, uint64_t size, const CTimeout timeoutUs)
 	{
 		return s()->write( buf, size, timeoutUs );
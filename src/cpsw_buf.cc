@@ -14,14 +14,18 @@
 #include <cpsw_compat.h>
 #include <cpsw_freelist.h>
 #include <cpsw_buf.h>
+#include <cpsw_mutex.h>
 
 #include <stdio.h>
+#include <vector>
 
 
 class CBufImpl;
 class CBufChainImpl;
+class CBufPoolImpl;
 typedef shared_ptr<CBufImpl>      BufImpl;
 typedef shared_ptr<CBufChainImpl> BufChainImpl;
+typedef shared_ptr<CBufPoolImpl>  BufPoolImpl;
 
 using cpsw::weak_ptr;
 using cpsw::static_pointer_cast;
@@ -91,13 +95,45 @@ public:
 
 CFreeList<CBufChainImpl> CBufChainImpl::freeList;
 
+class CBufPoolImpl : public IBufPool {
+private:
+	weak_ptr<CBufPoolImpl>  self_;
+	uint8_t                *mem_;
+	size_t                  slotSize_;
+	unsigned                nSlots_;
+	std::vector<uint8_t*>   free_;
+	CMtx                    mtx_;
+
+	CBufPoolImpl(uint8_t *mem, size_t size, size_t slotSize);
+
+public:
+	virtual Buf      getBuf();
+
+	virtual size_t   getSlotSize()            { return slotSize_; }
+	virtual unsigned getNumSlots()            { return nSlots_;   }
+	virtual unsigned getNumFree();
+
+	virtual bool     contains(const void *p)
+	{
+		return p >= mem_ && p < mem_ + (size_t)nSlots_ * slotSize_;
+	}
+
+	virtual void     putSlot(uint8_t *slot);
+
+	static BufPoolImpl create(uint8_t *mem, size_t size, size_t slotSize);
+};
+
 
 class CBufImpl : public IBuf, public CFreeListNode<CBufImpl> {
 private:
 	weak_ptr<CBufChainImpl> chain_;
 	BufImpl                 next_; 
 	weak_ptr<CBufImpl>      prev_;
-	unsigned short          beg_,  end_, capa_;
+	size_t                  beg_,  end_, capa_;
+	// buffers wrapping a slot of an application's memory
+	// region (IBufPool) keep the pool alive.
+	BufPoolImpl             pool_;
+	uint8_t                *ext_;
 	// no alignment of the data area is guaranteed - but this is not necessary
 	// as we always treat it what it is: a raw array of bytes.
 	// Any conversion to or from more structured types (including cardinals)
@@ -107,8 +143,13 @@ protected:
 	virtual void     addToChain(BufImpl p, bool);
 	virtual void     delFromChain();
 
+	uint8_t         *getData()     { return ext_ ? ext_ : data_;              }
+
 public:
-	CBufImpl(CFreeListNodeKey<CBufImpl> k, unsigned short capa);
+	CBufImpl(CFreeListNodeKey<CBufImpl> k, size_t capa);
+
+	// make this (empty) buffer use a pool slot instead of 'data_'
+	virtual void     attach(BufPoolImpl pool, uint8_t *slot, size_t capa);
 
 	virtual void     addToChain(BufChainImpl c);
 
@@ -117,7 +158,7 @@ public:
 	virtual size_t   getSize()     { return end_ - beg_;                      }
 	virtual size_t   getAvail()    { return getCapacity() - end_;             }
 	virtual size_t   getHeadroom() { return beg_;                             }
-	virtual uint8_t *getPayload()  { return data_ + beg_;                     }
+	virtual uint8_t *getPayload()  { return getData() + beg_;                 }
 
 	virtual void     setSize(size_t);
 	virtual void     setPayload(uint8_t*);
@@ -149,7 +190,9 @@ public:
 	// then the 'prev' pointer of the following node expires which 
 	// yields the correct result: a subsequent getPrev() on the 
 	// second/following node will return NULL.
-	//virtual ~CBufImpl() { }
+	//
+	// Slots borrowed from an application's region go back to the pool, though.
+	virtual ~CBufImpl();
 
 	static const size_t HEADROOM = 32; // enough for rssi + packetizer
 	static const size_t TAILROOM = 16; // enough for packetizer
@@ -159,19 +202,38 @@ public:
 
 static CFreeListExtra<CBufImpl, 2048 - sizeof(CBufImpl)> freeListBig;
 
+// buffer headers only; payload lives in an IBufPool's region
+static CFreeListExtra<CBufImpl, 0>                        freeListExt;
+
 // free lists ordered in decreasing order of node size
 static IFreeListExtra<CBufImpl> *freeListPool[] = {
 	&freeListBig
 };
 
-CBufImpl::CBufImpl(CFreeListNodeKey<CBufImpl> k, unsigned short capa)
+CBufImpl::CBufImpl(CFreeListNodeKey<CBufImpl> k, size_t capa)
 : CFreeListNode<CBufImpl>( k ),
   beg_(HEADROOM),
   end_(HEADROOM),
-  capa_(capa)
+  capa_(capa),
+  ext_(0)
 {
 }
 
+void CBufImpl::attach(BufPoolImpl pool, uint8_t *slot, size_t capa)
+{
+	pool_ = pool;
+	ext_  = slot;
+	capa_ = capa;
+	// received data need no headroom
+	beg_  = end_ = 0;
+}
+
+CBufImpl::~CBufImpl()
+{
+	if ( pool_ )
+		pool_->putSlot( ext_ );
+}
+
 void CBufImpl::setSize(size_t s)
 {
 unsigned     old_size = getSize();
@@ -194,10 +256,10 @@ BufChainImpl c;
 
 	if ( !p ) {
 		beg_ = 0;
-	} else if ( p < data_ || p > data_ + getCapacity() ) {
+	} else if ( p < getData() || p > getData() + getCapacity() ) {
 		throw InvalidArgError("requested payload pointer out of range");
 	} else  {
-		beg_ = p - data_;
+		beg_ = p - getData();
 		if ( end_ < beg_ )
 			end_ = beg_;
 	}
@@ -227,7 +289,7 @@ void CBufImpl::reinit()
 {
 unsigned     old_size = getSize();
 BufChainImpl c;
-	beg_ = end_ = HEADROOM;
+	beg_ = end_ = ( ext_ ? 0 : HEADROOM );
 	if ( (c=getChainImpl()) ) {
 		c->addSize( getSize() - old_size );
 	}
@@ -429,6 +491,69 @@ unsigned rval, i;
 	return rval;
 }
 
+CBufPoolImpl::CBufPoolImpl(uint8_t *mem, size_t size, size_t slotSize)
+: mem_     ( mem                 ),
+  slotSize_( slotSize            ),
+  nSlots_  ( size / slotSize     ),
+  mtx_     ( "CBufPoolImpl"      )
+{
+unsigned i;
+	free_.reserve( nSlots_ );
+	// hand out in ascending order
+	for ( i = nSlots_; i > 0; i-- ) {
+		free_.push_back( mem_ + (size_t)(i - 1) * slotSize_ );
+	}
+}
+
+BufPoolImpl CBufPoolImpl::create(uint8_t *mem, size_t size, size_t slotSize)
+{
+	if ( ! mem || 0 == slotSize || size < slotSize )
+		throw InvalidArgError("IBufPool: memory region smaller than a single slot");
+	if ( slotSize <= CBufImpl::TAILROOM )
+		throw InvalidArgError("IBufPool: slot size too small");
+BufPoolImpl rval( new CBufPoolImpl( mem, size, slotSize ) );
+	rval->self_ = rval;
+	return rval;
+}
+
+BufPool IBufPool::create(void *mem, size_t size, size_t slotSize)
+{
+	return CBufPoolImpl::create( static_cast<uint8_t*>(mem), size, slotSize );
+}
+
+unsigned CBufPoolImpl::getNumFree()
+{
+CMtx::lg guard( &mtx_ );
+	return free_.size();
+}
+
+void CBufPoolImpl::putSlot(uint8_t *slot)
+{
+CMtx::lg guard( &mtx_ );
+	free_.push_back( slot );
+}
+
+Buf CBufPoolImpl::getBuf()
+{
+uint8_t *slot;
+	{
+	CMtx::lg guard( &mtx_ );
+		if ( free_.empty() )
+			return NULLBUF;
+		slot = free_.back();
+		free_.pop_back();
+	}
+BufImpl rval;
+	try {
+		rval = freeListExt.get();
+	} catch ( ... ) {
+		putSlot( slot );
+		throw;
+	}
+	rval->attach( BufPoolImpl( self_ ), slot, slotSize_ );
+	return rval;
+}
+
 CBufChainImpl::CBufChainImpl( CFreeListNodeKey<CBufChainImpl> k )
 : CFreeListNode<CBufChainImpl>( k ),
   len_(0),
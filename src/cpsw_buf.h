@@ -19,10 +19,12 @@
 class IBuf;
 class IBufChain;
 class IBufQueue;
+class IBufPool;
 
 typedef shared_ptr<IBuf> Buf;
 typedef shared_ptr<IBufChain> BufChain;
 typedef shared_ptr<IBufQueue> BufQueue;
+typedef shared_ptr<IBufPool> BufPool;
 
 // NOTE: Buffer chains are NOT THREAD SAFE. It is the user's responsibility
 //       to properly synchronize.
@@ -117,6 +119,30 @@ public:
 	static unsigned  numBufsInUse();
 };
 
+// A pool of buffers carved out of a memory region which is
+// owned by the application. Data received into such buffers
+// stays where it landed; the buffers are not accounted for
+// by IBuf::numBufsXXX().
+// The pool is kept alive by the buffers it handed out; the
+// memory region must remain valid until all of them are gone.
+class IBufPool {
+public:
+	// NULL if all slots are in use
+	virtual Buf      getBuf()                 = 0;
+
+	virtual size_t   getSlotSize()            = 0;
+	virtual unsigned getNumSlots()            = 0;
+	virtual unsigned getNumFree()             = 0;
+
+	// does 'p' point into this pool's memory region?
+	virtual bool     contains(const void *p)  = 0;
+
+	virtual         ~IBufPool() {}
+
+	// split 'size' bytes at 'mem' into slots of 'slotSize'
+	static BufPool   create(void *mem, size_t size, size_t slotSize);
+};
+
 
 class IBufChain {
 public:
@@ -164,6 +190,30 @@ public:
 	virtual bool     push(BufChain b, const CTimeout *abs_timeout)      = 0;
 	virtual bool     tryPush(BufChain b)                                = 0;
 
+	// Batched operations: block (subject to 'abs_timeout') until at
+	// least one element can be transferred, then transfer as many
+	// as possible (up to 'n') without blocking. Return the number
+	// of elements transferred.
+	virtual unsigned pushN(BufChain *b, unsigned n, const CTimeout *abs_timeout)
+	{
+	unsigned k = 0;
+		if ( n > 0 && push( b[0], abs_timeout ) ) {
+			for ( k = 1; k < n && tryPush( b[k] ); k++ )
+				;
+		}
+		return k;
+	}
+
+	virtual unsigned popN(BufChain *b, unsigned n, const CTimeout *abs_timeout)
+	{
+	unsigned k = 0;
+		if ( n > 0 && (b[0] = pop( abs_timeout )) ) {
+			for ( k = 1; k < n && (b[k] = tryPop()); k++ )
+				;
+		}
+		return k;
+	}
+
 	virtual CTimeout getAbsTimeoutPop(const CTimeout *rel_timeout)      = 0;
 	virtual CTimeout getAbsTimeoutPush(const CTimeout *rel_timeout)     = 0;
 
@@ -180,6 +230,11 @@ public:
 
 
 	static BufQueue create(unsigned size);
+
+	// Queue which only resorts to blocking on a mutex/condvar
+	// when it is empty (pop) or full (push). Event sources
+	// are only notified when the queue leaves that state.
+	static BufQueue create(unsigned size, bool lockFree);
 };
 
 #endif
@@ -12,6 +12,7 @@
 #include <cpsw_buf.h>
 #include <cpsw_event.h>
 #include <cpsw_mutex.h>
+#include <cpsw_condvar.h>
 
 #include <errno.h>
 
@@ -34,6 +35,23 @@ public:
 	virtual bool getSlot( bool wait, const CTimeout *abs_timeout )  = 0;
 	virtual void putSlot()                                          = 0;
 
+	// get up to 'n' slots; only the first one is waited for
+	virtual unsigned getSlots( unsigned n, bool wait, const CTimeout *abs_timeout )
+	{
+	unsigned k = 0;
+		if ( n > 0 && getSlot( wait, abs_timeout ) ) {
+			for ( k = 1; k < n && getSlot( false, NULL ); k++ )
+				;
+		}
+		return k;
+	}
+
+	virtual void putSlots( unsigned n )
+	{
+		while ( n-- > 0 )
+			putSlot();
+	}
+
 	virtual unsigned getAvailSlots()                                = 0;
 
 	virtual void getAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout) = 0;
@@ -41,6 +59,8 @@ public:
 	virtual IEventSource *getEventSource()                          = 0;
 
 	static void clockRealtimeGetAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout);
+
+	virtual ~IBufSync() {}
 };
 
 class CEventBufSync : public IBufSync, public IIntEventSource, public IEventHandler {
@@ -165,13 +185,154 @@ void CEventBufSync::putSlot()
 	notify();
 }
 
+// Slot counter which never blocks nor notifies as long as
+// slots are available. Threads only wait on the condition
+// variable (and are only woken) when the counter is zero.
+// Event sources handed out are notified when the counter
+// leaves zero.
+class CWaitBufSync : public IBufSync, public IIntEventSource {
+private:
+	atomic<int>  slots_;
+	atomic<int>  waiters_;
+	atomic<bool> watched_;
+	CMtx         mtx_;
+	CCond        cnd_;
+
+	unsigned tryGetSlots(unsigned n);
+
+public:
+	CWaitBufSync(unsigned initialSlots)
+	: slots_  ( initialSlots  ),
+	  waiters_( 0             ),
+	  watched_( false         ),
+	  mtx_    ( "CWaitBufSync" )
+	{
+	}
+
+	virtual bool getSlot( bool wait, const CTimeout *abs_timeout )
+	{
+		return getSlots( 1, wait, abs_timeout ) > 0;
+	}
+
+	virtual void putSlot()
+	{
+		putSlots( 1 );
+	}
+
+	virtual unsigned getSlots( unsigned n, bool wait, const CTimeout *abs_timeout );
+	virtual void     putSlots( unsigned n );
+
+	virtual void getAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout)
+	{
+		clockRealtimeGetAbsTimeout( abs_timeout, rel_timeout );
+	}
+
+	virtual unsigned getAvailSlots()
+	{
+	int v = slots_.load( memory_order_acquire );
+		return v <= 0 ? 0 : (unsigned)v;
+	}
+
+	virtual IEventSource *getEventSource()
+	{
+		watched_.store( true );
+		return this;
+	}
+
+	// IIntEventSource must implement 'checkForEvent()'
+	virtual bool checkForEvent()
+	{
+	unsigned avail = getAvailSlots();
+		if ( avail > 0 ) {
+			setEventVal( avail );
+			return true;
+		}
+		return false;
+	}
+};
+
+unsigned CWaitBufSync::tryGetSlots(unsigned n)
+{
+int v = slots_.load( memory_order_acquire );
+int k;
+	while ( v > 0 ) {
+		k = v < (int)n ? v : (int)n;
+		if ( slots_.compare_exchange_weak( v, v - k ) )
+			return k;
+	}
+	return 0;
+}
+
+unsigned CWaitBufSync::getSlots(unsigned n, bool wait, const CTimeout *abs_timeout)
+{
+unsigned k;
+int      st;
+
+	if ( 0 == n )
+		return 0;
+
+	if ( (k = tryGetSlots( n )) || ! wait )
+		return k;
+
+	if ( abs_timeout ) {
+		if ( abs_timeout->isNone() ) {
+			return 0;
+		} else if ( abs_timeout->isIndefinite() ) {
+			abs_timeout = NULL;
+		}
+	}
+
+	CMtx::lg guard( &mtx_ );
+
+	// 'putSlots()' increments the counter before looking at 'waiters_';
+	// we register before checking the counter (again) -- either we
+	// see the new slot or they see us.
+	waiters_.fetch_add( 1 );
+
+	while ( ! (k = tryGetSlots( n )) ) {
+		if ( abs_timeout ) {
+			st = pthread_cond_timedwait( cnd_.getp(), mtx_.getp(), &abs_timeout->tv_ );
+		} else {
+			st = pthread_cond_wait( cnd_.getp(), mtx_.getp() );
+		}
+		if ( st ) {
+			waiters_.fetch_sub( 1 );
+			if ( ETIMEDOUT == st )
+				return 0;
+			throw InternalError("CWaitBufSync -- pthread_cond_wait failed", st);
+		}
+	}
+
+	waiters_.fetch_sub( 1 );
+
+	return k;
+}
+
+void CWaitBufSync::putSlots(unsigned n)
+{
+int prev;
+
+	if ( 0 == n )
+		return;
+
+	prev = slots_.fetch_add( n );
+
+	if ( waiters_.load() > 0 ) {
+		CMtx::lg guard( &mtx_ );
+		pthread_cond_broadcast( cnd_.getp() );
+	}
+
+	// an event-set consumer re-polls before it blocks; it
+	// only needs a wakeup when the counter leaves zero.
+	if ( 0 == prev && watched_.load( memory_order_acquire ) ) {
+		notify();
+	}
+}
 
 class CBufQueue : public IBufQueue, protected CBufQueueBase {
 private:
 	unsigned      n_;
 	bool          isUp_;
-	CEventBufSync rd_sync_impl_;
-	CEventBufSync wr_sync_impl_;
 
 	IBufSync     *rd_sync_;
 	IBufSync     *wr_sync_;
@@ -186,7 +347,7 @@ protected:
 	bool     push(BufChain b, bool wait, const CTimeout *abs_timeout);
 
 public:
-	CBufQueue(size_type n);
+	CBufQueue(size_type n, bool lockFree);
 
 	virtual BufChain pop(const CTimeout *abs_timeout)
 	{
@@ -219,6 +380,9 @@ public:
 		return push(b, false, 0);
 	}
 
+	virtual unsigned pushN(BufChain *b, unsigned n, const CTimeout *abs_timeout);
+	virtual unsigned popN(BufChain *b, unsigned n, const CTimeout *abs_timeout);
+
 	virtual CTimeout getAbsTimeoutPop(const CTimeout *rel_timeout)
 	{
 	CTimeout rval;
@@ -252,21 +416,24 @@ public:
 
 
 
-CBufQueue::CBufQueue(size_type n)
+CBufQueue::CBufQueue(size_type n, bool lockFree)
 : CBufQueueBase(n),
   n_(n),
   isUp_(true),
-  rd_sync_impl_(0),
-  wr_sync_impl_(n),
-  rd_sync_( &rd_sync_impl_ ),
-  wr_sync_( &wr_sync_impl_ ),
+  rd_sync_( lockFree ? static_cast<IBufSync*>( new CWaitBufSync(0) ) : static_cast<IBufSync*>( new CEventBufSync(0) ) ),
+  wr_sync_( lockFree ? static_cast<IBufSync*>( new CWaitBufSync(n) ) : static_cast<IBufSync*>( new CEventBufSync(n) ) ),
   mtx_( "CBufQueue" )
 {
 }
 
 BufQueue IBufQueue::create(unsigned n)
 {
-	return cpsw::make_shared<CBufQueue>(n);
+	return cpsw::make_shared<CBufQueue>(n, false);
+}
+
+BufQueue IBufQueue::create(unsigned n, bool lockFree)
+{
+	return cpsw::make_shared<CBufQueue>(n, lockFree);
 }
 
 CBufQueue::~CBufQueue()
@@ -275,6 +442,8 @@ CBufQueue::~CBufQueue()
 	// we must extract the shared_ptr ownership from all
 	// stored elements here.
 	shutdown();
+	delete rd_sync_;
+	delete wr_sync_;
 }
 
 void CBufQueue::shutdown()
@@ -362,6 +531,49 @@ BufChain CBufQueue::pop(bool wait, const CTimeout *abs_timeout)
 	return BufChain( reinterpret_cast<BufChain::element_type *>(0) );
 }
 
+unsigned CBufQueue::pushN(BufChain *b, unsigned n, const CTimeout *abs_timeout)
+{
+unsigned k, i;
+
+	// reserve as many slots as we can get at once
+	k = wr_sync_->getSlots( n, true, abs_timeout );
+
+	for ( i = 0; i < k; i++ ) {
+		IBufChain::take_ownership( b[i] );
+		if ( ! bounded_push( b[i].get() ) ) {
+			b[i]->yield_ownership();
+			// release what we got but didn't use
+			rd_sync_->putSlots( i );
+			wr_sync_->putSlots( k - i );
+			throw InternalError("Queue inconsistency???");
+		}
+	}
+
+	// make them available to readers in one go
+	rd_sync_->putSlots( k );
+
+	return k;
+}
+
+unsigned CBufQueue::popN(BufChain *b, unsigned n, const CTimeout *abs_timeout)
+{
+unsigned k, i;
+
+	k = rd_sync_->getSlots( n, true, abs_timeout );
+
+	for ( i = 0; i < k; i++ ) {
+		IBufChain *raw_ptr;
+		if ( !CBufQueueBase::pop( raw_ptr ) ) {
+			throw InternalError("FATAL ERROR -- unable to pop even though we decremented the semaphore?");
+		}
+		b[i] = raw_ptr->yield_ownership();
+	}
+
+	wr_sync_->putSlots( k );
+
+	return k;
+}
+
 void IBufSync::clockRealtimeGetAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout)
 {
 
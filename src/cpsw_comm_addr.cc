@@ -104,6 +104,12 @@ BufChain bch;
 	return bch->extract( args->dst_, args->off_, args->nbytes_ );
 }
 
+BufChain
+CCommAddressImpl::readChain(const CTimeout *timeout) const
+{
+	return door_->pop( timeout, IProtoPort::REL_TIMEOUT );
+}
+
 uint64_t
 CCommAddressImpl::write(CWriteArgs *args) const
 {
@@ -55,6 +55,9 @@ public:
 	virtual uint64_t read (CReadArgs *args)  const;
 	virtual uint64_t write(CWriteArgs *args) const;
 
+	// pop the next frame off the stack without copying
+	virtual BufChain readChain(const CTimeout *timeout) const;
+
 	virtual void dump(FILE *f) const;
 
 	virtual ~CCommAddressImpl();
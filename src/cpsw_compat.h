@@ -7,11 +7,13 @@
 
 #ifdef CPSW_USES_BOOST
 #include <boost/unordered_set.hpp>
+#include <boost/unordered_map.hpp>
 #include <boost/atomic.hpp>
 
 namespace cpsw {
   using boost::shared_ptr;
   using boost::unordered_set;
+  using boost::unordered_map;
   using boost::atomic;
   using boost::memory_order_relaxed;
   using boost::memory_order_acq_rel;
@@ -23,11 +25,13 @@ namespace cpsw {
 #ifdef CPSW_USES_STD
 
 #include <unordered_set>
+#include <unordered_map>
 #include <atomic>
 
 namespace cpsw {
   using std::shared_ptr;
   using std::unordered_set;
+  using std::unordered_map;
   using std::atomic;
   using std::memory_order_relaxed;
   using std::memory_order_acq_rel;
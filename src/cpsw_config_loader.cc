@@ -0,0 +1,168 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_config_loader.h>
+#include <cpsw_sval.h>
+#include <cpsw_debug.h>
+
+#include <stdio.h>
+#include <algorithm>
+
+#define CONFIG_DEBUG 0
+
+#ifdef CONFIG_DEBUG
+int cpsw_config_debug = CONFIG_DEBUG;
+#endif
+
+static double
+msSince(const struct timespec *then)
+{
+struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return  (double)(now.tv_sec  - then->tv_sec )*1.0E3
+	      + (double)(now.tv_nsec - then->tv_nsec)/1.0E6;
+}
+
+CConfigLoader::CConfigLoader()
+: prio_    ( 0     ),
+  havePrio_( false ),
+  phase_   ( 0     ),
+  nVals_   ( 0     )
+{
+}
+
+void
+CConfigLoader::setPrio(int prio)
+{
+	if ( havePrio_ && prio == prio_ )
+		return;
+
+	barrier();
+
+	prio_     = prio;
+	havePrio_ = true;
+}
+
+void
+CConfigLoader::barrier()
+{
+unsigned nXfers;
+
+	if ( 0 == nVals_ )
+		return;
+
+	nXfers = batch_.getNumDeferred();
+
+	try {
+		batch_.execute();
+	} catch ( CPSWError &e ) {
+		char buf[100];
+		snprintf( buf, sizeof(buf), "loadConfigFromYaml (phase %u): ", phase_ );
+		e.prepend( buf );
+		throw;
+	}
+
+#ifdef CONFIG_DEBUG
+	if ( cpsw_config_debug > 0 ) {
+		fprintf( CPSW::fDbg(), "loadConfigFromYaml -- phase %3u: %6u values, %6u transfers, %10.3f ms\n",
+		         phase_,
+		         nVals_,
+		         nXfers,
+		         msSince( &phaseStart_ ) );
+	}
+#endif
+
+	phase_++;
+	nVals_ = 0;
+}
+
+void
+CConfigLoader::queued(unsigned nelms)
+{
+	if ( 0 == nVals_ ) {
+		clock_gettime( CLOCK_MONOTONIC, &phaseStart_ );
+	}
+	nVals_ += nelms;
+}
+
+unsigned
+CConfigLoader::setVal(ScalVal val, uint64_t v)
+{
+unsigned rval = batch_.setVal( val, v );
+	queued( rval );
+	return rval;
+}
+
+unsigned
+CConfigLoader::setVal(ScalVal val, uint64_t *buf, unsigned nelms)
+{
+unsigned rval = batch_.setVal( val, buf, nelms );
+	queued( rval );
+	return rval;
+}
+
+CConfigDumper::CConfigDumper()
+: prefetching_( true ),
+  nVals_      ( 0    )
+{
+}
+
+void
+CConfigDumper::prefetch(const CIntEntryImpl *entry, ScalVal_RO val, unsigned nelms)
+{
+	pending_.push_back( CPending( entry, val, nelms ) );
+
+	if ( batch_.getVal( val, &pending_.back().buf_[0], nelms ) != nelms ) {
+		throw ConfigurationError("CConfigDumper::prefetch -- unexpected number of elements");
+	}
+
+	nVals_ += nelms;
+}
+
+void
+CConfigDumper::execute()
+{
+struct timespec then;
+unsigned        nXfers;
+
+	nXfers = batch_.getNumDeferred();
+
+	clock_gettime( CLOCK_MONOTONIC, &then );
+
+	try {
+		batch_.execute();
+	} catch ( CPSWError &e ) {
+		e.prepend( "dumpConfigToYaml: " );
+		throw;
+	}
+
+#ifdef CONFIG_DEBUG
+	if ( cpsw_config_debug > 0 ) {
+		fprintf( CPSW::fDbg(), "dumpConfigToYaml -- %6u values, %6u transfers, %10.3f ms\n",
+		         nVals_,
+		         nXfers,
+		         msSince( &then ) );
+	}
+#endif
+
+	prefetching_ = false;
+}
+
+void
+CConfigDumper::getVals(const CIntEntryImpl *entry, uint64_t *buf, unsigned nelms)
+{
+	// both passes must visit the same entries in the same order
+	if ( pending_.empty() || pending_.front().entry_ != entry || pending_.front().buf_.size() != nelms ) {
+		throw InternalError("CConfigDumper::getVals -- prefetched data out of sync");
+	}
+
+	std::copy( pending_.front().buf_.begin(), pending_.front().buf_.end(), buf );
+
+	pending_.pop_front();
+}
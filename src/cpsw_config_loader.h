@@ -0,0 +1,120 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_CONFIG_LOADER_H
+#define CPSW_CONFIG_LOADER_H
+
+#include <cpsw_api_user.h>
+#include <cpsw_batch.h>
+
+#include <yaml-cpp/yaml.h>
+
+#include <time.h>
+#include <list>
+
+class CIntEntryImpl;
+
+/* Loading a configuration proceeds in 'phases'. The integer
+ * settings of a phase are queued on a batch (merged per device,
+ * pipelined unless the device's write mode is POSTED, i.e., the
+ * writes to all devices of a phase are in flight together and
+ * their status is collected by the barrier). A phase ends
+ * ('barrier') when
+ *  - the 'configPrio' of the siblings being loaded changes,
+ *  - an entry which does not batch its settings (commands,
+ *    doubles, ...) is about to be loaded,
+ *  - the load is finished.
+ *
+ * The loader is attached to the path which is handed down
+ * the hierarchy by 'loadConfigFromYaml()'.
+ */
+class CConfigLoader {
+private:
+	CAccessBatch    batch_;
+	int             prio_;
+	bool            havePrio_;
+	unsigned        phase_;
+	unsigned        nVals_;
+	struct timespec phaseStart_;
+
+	CConfigLoader(const CConfigLoader&);
+	CConfigLoader &operator=(const CConfigLoader&);
+
+	void     queued(unsigned nelms);
+
+public:
+	CConfigLoader();
+
+	// a sibling with config. priority 'prio' is about to be loaded
+	void     setPrio(int prio);
+
+	// execute everything deferred so far
+	void     barrier();
+
+	unsigned setVal(ScalVal val, uint64_t  v);
+	unsigned setVal(ScalVal val, uint64_t *buf, unsigned nelms);
+
+	unsigned getPhase() const
+	{
+		return phase_;
+	}
+};
+
+/* Dumping a configuration takes two passes over the hierarchy.
+ * During the first ('prefetch') pass integer entries merely queue
+ * reads of their values on a batch; 'execute()' then issues the
+ * (coalesced) reads to all devices in parallel. The second pass
+ * builds the YAML tree as usual but entries consume the prefetched
+ * data (in the same order) rather than reading from the hardware.
+ * Entries which don't prefetch are skipped during the first pass.
+ */
+class CConfigDumper {
+private:
+	class CPending {
+	public:
+		ScalVal_RO            val_; // keeps the entry alive
+		const CIntEntryImpl  *entry_;
+		std::vector<uint64_t> buf_;
+
+		CPending(const CIntEntryImpl *entry, ScalVal_RO val, unsigned nelms)
+		: val_  ( val   ),
+		  entry_( entry ),
+		  buf_  ( nelms )
+		{
+		}
+	};
+
+	CAccessBatch        batch_;
+	std::list<CPending> pending_;
+	bool                prefetching_;
+	unsigned            nVals_;
+
+	CConfigDumper(const CConfigDumper&);
+	CConfigDumper &operator=(const CConfigDumper&);
+
+public:
+	CConfigDumper();
+
+	bool     isPrefetching() const
+	{
+		return prefetching_;
+	}
+
+	// first pass: queue a read of 'nelms' values from 'val'
+	void     prefetch(const CIntEntryImpl *entry, ScalVal_RO val, unsigned nelms);
+
+	// read everything queued and switch to the second pass
+	void     execute();
+
+	// second pass: the next 'nelms' values prefetched for 'entry'
+	// are copied to 'buf'.
+	void     getVals(const CIntEntryImpl *entry, uint64_t *buf, unsigned nelms);
+};
+
+#endif
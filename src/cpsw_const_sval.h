@@ -63,6 +63,8 @@ public:
 
 	virtual unsigned getVal(uint8_t  *, unsigned, unsigned, SlicedPathIterator *it);
 	virtual unsigned getVal(AsyncIO aio, uint8_t  *, unsigned, unsigned, SlicedPathIterator *it);
+	// nothing to defer
+	virtual unsigned getVal(CAccessBatch *batch, AsyncIO aio, uint8_t  *, unsigned, unsigned, IndexRange *r);
 };
 
 class CConstDblEntryAdapt : public virtual CDoubleVal_ROAdapt {
@@ -9,39 +9,279 @@
 
 #include <cpsw_crc32_le.h>
 
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC32_HAVE_CLMUL
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CRC32_HAVE_ARMV8
+#include <arm_acle.h>
+#endif
+
 struct CpswCrc32Tbl {
 public:
 	const static unsigned LDTSZ = 8;
+	const static unsigned NTBLS = 8;
 
-	uint32_t t[(1<<LDTSZ)];
+	// t[0] is the classic byte-wise table; t[k] advances
+	// the CRC by k additional zero octets (slicing-by-8)
+	uint32_t t[NTBLS][(1<<LDTSZ)];
 
 	CpswCrc32Tbl()
 	{
 	unsigned i,j;
-		for ( i = 0; i < sizeof(t)/sizeof(t[0]); i++ ) {
+		for ( i = 0; i < sizeof(t[0])/sizeof(t[0][0]); i++ ) {
 			uint32_t crc = i;
 			for ( j = 0; j < LDTSZ; j++ ) {
 				crc = (crc >> 1) ^ ( (crc & 1 ) ? CCpswCrc32LE::POLY : 0 );
 			}
-			t[i] = crc;
+			t[0][i] = crc;
+		}
+		for ( i = 0; i < sizeof(t[0])/sizeof(t[0][0]); i++ ) {
+			for ( j = 1; j < NTBLS; j++ ) {
+				t[j][i] = ( t[j-1][i] >> 8 ) ^ t[0][ (uint8_t)t[j-1][i] ];
+			}
 		}
 	}
 };
 
-uint32_t *
-CCpswCrc32LE::tbl()
+static const CpswCrc32Tbl &
+tbl()
 {
 static CpswCrc32Tbl t_;
-	return t_.t;
+	return t_;
 }
 
 uint32_t
-CCpswCrc32LE::operator()(uint32_t crc, uint8_t *buf, unsigned long l)
+CCpswCrc32LE::bytewise(uint32_t crc, const uint8_t *buf, unsigned long l)
 {
-uint8_t idx;
+const uint32_t *t = tbl().t[0];
+uint8_t         idx;
 	while ( l-- ) {
 		idx = ((uint8_t)crc) ^ *buf++;
-		crc = ( crc >> 8 ) ^ tbl()[idx];
+		crc = ( crc >> 8 ) ^ t[idx];
+	}
+	return crc;
+}
+
+uint32_t
+CCpswCrc32LE::slice8(uint32_t crc, const uint8_t *buf, unsigned long l)
+{
+const CpswCrc32Tbl &t = tbl();
+uint32_t            lo;
+
+	while ( l >= 8 ) {
+		// assembled octet-wise so that this works on any endianness;
+		// compilers reduce this to a single load where possible.
+		lo   = crc ^ (   (uint32_t)buf[0]        | ((uint32_t)buf[1] <<  8)
+		              | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24) );
+		crc  = t.t[7][ (uint8_t) lo        ] ^ t.t[6][ (uint8_t)(lo >>  8) ]
+		     ^ t.t[5][ (uint8_t)(lo >> 16) ] ^ t.t[4][           lo >> 24  ]
+		     ^ t.t[3][ buf[4] ]              ^ t.t[2][ buf[5] ]
+		     ^ t.t[1][ buf[6] ]              ^ t.t[0][ buf[7] ];
+		buf += 8;
+		l   -= 8;
+	}
+	return bytewise( crc, buf, l );
+}
+
+#ifdef CRC32_HAVE_CLMUL
+/* Folding with carry-less multiplication as described in
+ * "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ * Instruction" (Gopal et al., Intel, 2009). The constants are
+ * those of the bit-reflected IEEE polynomial.
+ *
+ * Processes multiples of 16 octets (at least 64); the
+ * remainder is handled by slicing-by-8.
+ */
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t
+clmul(uint32_t crc, const uint8_t *buf, unsigned long l)
+{
+static const uint64_t k1k2[2] __attribute__((aligned(16))) = { 0x0154442bd4ULL, 0x01c6e41596ULL };
+static const uint64_t k3k4[2] __attribute__((aligned(16))) = { 0x01751997d0ULL, 0x00ccaa009eULL };
+static const uint64_t k5k0[2] __attribute__((aligned(16))) = { 0x0163cd6124ULL, 0x0000000000ULL };
+static const uint64_t poly[2] __attribute__((aligned(16))) = { 0x01db710641ULL, 0x01f7011641ULL };
+
+__m128i       x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+unsigned long n;
+
+	if ( l < 64 ) {
+		return CCpswCrc32LE::slice8( crc, buf, l );
 	}
+
+	n  = l & ~(unsigned long)15;
+	l -= n;
+
+	x1 = _mm_loadu_si128( (const __m128i*)(buf + 0x00) );
+	x2 = _mm_loadu_si128( (const __m128i*)(buf + 0x10) );
+	x3 = _mm_loadu_si128( (const __m128i*)(buf + 0x20) );
+	x4 = _mm_loadu_si128( (const __m128i*)(buf + 0x30) );
+
+	x1 = _mm_xor_si128( x1, _mm_cvtsi32_si128( crc ) );
+
+	x0 = _mm_load_si128( (const __m128i*)k1k2 );
+
+	buf += 64;
+	n   -= 64;
+
+	// fold four 128-bit lanes in parallel
+	while ( n >= 64 ) {
+		x5 = _mm_clmulepi64_si128( x1, x0, 0x00 );
+		x6 = _mm_clmulepi64_si128( x2, x0, 0x00 );
+		x7 = _mm_clmulepi64_si128( x3, x0, 0x00 );
+		x8 = _mm_clmulepi64_si128( x4, x0, 0x00 );
+
+		x1 = _mm_clmulepi64_si128( x1, x0, 0x11 );
+		x2 = _mm_clmulepi64_si128( x2, x0, 0x11 );
+		x3 = _mm_clmulepi64_si128( x3, x0, 0x11 );
+		x4 = _mm_clmulepi64_si128( x4, x0, 0x11 );
+
+		y5 = _mm_loadu_si128( (const __m128i*)(buf + 0x00) );
+		y6 = _mm_loadu_si128( (const __m128i*)(buf + 0x10) );
+		y7 = _mm_loadu_si128( (const __m128i*)(buf + 0x20) );
+		y8 = _mm_loadu_si128( (const __m128i*)(buf + 0x30) );
+
+		x1 = _mm_xor_si128( _mm_xor_si128( x1, x5 ), y5 );
+		x2 = _mm_xor_si128( _mm_xor_si128( x2, x6 ), y6 );
+		x3 = _mm_xor_si128( _mm_xor_si128( x3, x7 ), y7 );
+		x4 = _mm_xor_si128( _mm_xor_si128( x4, x8 ), y8 );
+
+		buf += 64;
+		n   -= 64;
+	}
+
+	// fold the lanes into a single one
+	x0 = _mm_load_si128( (const __m128i*)k3k4 );
+
+	x5 = _mm_clmulepi64_si128( x1, x0, 0x00 );
+	x1 = _mm_clmulepi64_si128( x1, x0, 0x11 );
+	x1 = _mm_xor_si128( _mm_xor_si128( x1, x2 ), x5 );
+
+	x5 = _mm_clmulepi64_si128( x1, x0, 0x00 );
+	x1 = _mm_clmulepi64_si128( x1, x0, 0x11 );
+	x1 = _mm_xor_si128( _mm_xor_si128( x1, x3 ), x5 );
+
+	x5 = _mm_clmulepi64_si128( x1, x0, 0x00 );
+	x1 = _mm_clmulepi64_si128( x1, x0, 0x11 );
+	x1 = _mm_xor_si128( _mm_xor_si128( x1, x4 ), x5 );
+
+	// remaining 16-octet blocks
+	while ( n >= 16 ) {
+		x2 = _mm_loadu_si128( (const __m128i*)buf );
+
+		x5 = _mm_clmulepi64_si128( x1, x0, 0x00 );
+		x1 = _mm_clmulepi64_si128( x1, x0, 0x11 );
+		x1 = _mm_xor_si128( _mm_xor_si128( x1, x2 ), x5 );
+
+		buf += 16;
+		n   -= 16;
+	}
+
+	// 128 -> 64 bits
+	x2 = _mm_clmulepi64_si128( x1, x0, 0x10 );
+	x3 = _mm_setr_epi32( ~0, 0, ~0, 0 );
+	x1 = _mm_srli_si128( x1, 8 );
+	x1 = _mm_xor_si128( x1, x2 );
+
+	x0 = _mm_loadl_epi64( (const __m128i*)k5k0 );
+
+	x2 = _mm_srli_si128( x1, 4 );
+	x1 = _mm_and_si128( x1, x3 );
+	x1 = _mm_clmulepi64_si128( x1, x0, 0x00 );
+	x1 = _mm_xor_si128( x1, x2 );
+
+	// Barrett reduction to 32 bits
+	x0 = _mm_load_si128( (const __m128i*)poly );
+
+	x2 = _mm_and_si128( x1, x3 );
+	x2 = _mm_clmulepi64_si128( x2, x0, 0x10 );
+	x2 = _mm_and_si128( x2, x3 );
+	x2 = _mm_clmulepi64_si128( x2, x0, 0x00 );
+	x1 = _mm_xor_si128( x1, x2 );
+
+	crc = _mm_extract_epi32( x1, 1 );
+
+	return CCpswCrc32LE::slice8( crc, buf, l );
+}
+#endif
+
+#ifdef CRC32_HAVE_ARMV8
+static uint32_t
+armv8(uint32_t crc, const uint8_t *buf, unsigned long l)
+{
+uint64_t v;
+	while ( l >= 8 ) {
+		memcpy( &v, buf, sizeof(v) );
+		crc  = __crc32d( crc, v );
+		buf += 8;
+		l   -= 8;
+	}
+	while ( l-- ) {
+		crc = __crc32b( crc, *buf++ );
+	}
+	return crc;
+}
+#endif
+
+CCpswCrc32LE::Impl
+CCpswCrc32LE::getAccel()
+{
+#if defined(CRC32_HAVE_CLMUL)
+	__builtin_cpu_init();
+	if ( __builtin_cpu_supports( "pclmul" ) && __builtin_cpu_supports( "sse4.1" ) ) {
+		return clmul;
+	}
+#elif defined(CRC32_HAVE_ARMV8)
+	return armv8;
+#endif
+	return 0;
+}
+
+CCpswCrc32LE::Impl
+CCpswCrc32LE::getImpl()
+{
+static const Impl impl_ = getAccel() ? getAccel() : slice8;
+	return impl_;
+}
+
+const char *
+CCpswCrc32LE::getImplName()
+{
+#if defined(CRC32_HAVE_CLMUL)
+	if ( getImpl() == clmul )
+		return "pclmul";
+#elif defined(CRC32_HAVE_ARMV8)
+	if ( getImpl() == armv8 )
+		return "armv8-crc32";
+#endif
+	return "slicing-by-8";
+}
+
+uint32_t
+CCpswCrc32LE::operator()(uint32_t crc, Buf b, unsigned long off, unsigned long len)
+{
+Impl          impl = getImpl();
+unsigned long l;
+
+	while ( b && off >= b->getSize() ) {
+		off -= b->getSize();
+		b    = b->getNext();
+	}
+
+	while ( b && len > 0 ) {
+		l = b->getSize() - off;
+		if ( l > len ) {
+			l = len;
+		}
+		crc  = impl( crc, b->getPayload() + off, l );
+		len -= l;
+		off  = 0;
+		b    = b->getNext();
+	}
+
 	return crc;
 }
@@ -11,15 +11,45 @@
 #define CPSW_CRC32_LE_H
 
 #include <stdint.h>
+#include <cpsw_buf.h>
 
+/* CRC32 (little-endian/reflected, IEEE polynomial).
+ *
+ * The CRC register is neither pre- nor post-inverted, i.e.,
+ * updates may be chained and the caller is responsible for
+ * seeding (usually with ~0) and the final inversion.
+ *
+ * The implementation is selected at run-time: a carry-less
+ * multiplication (PCLMULQDQ) algorithm on x86-64 CPUs which
+ * support it, the ARMv8 CRC32 instructions on aarch64 (if
+ * enabled by the compiler flags) and 'slicing-by-8' otherwise.
+ */
 struct CCpswCrc32LE {
 public:
 	static const uint32_t POLY = 0xedb88320;
-private:
-	static uint32_t *tbl();
-public:
 
-	uint32_t operator()(uint32_t crc_in, uint8_t *buf, unsigned long len);
+	typedef uint32_t (*Impl)(uint32_t crc_in, const uint8_t *buf, unsigned long len);
+
+	// portable implementations
+	static uint32_t bytewise(uint32_t crc_in, const uint8_t *buf, unsigned long len);
+	static uint32_t slice8(uint32_t crc_in, const uint8_t *buf, unsigned long len);
+
+	// hardware-assisted implementation; NULL if not supported
+	static Impl        getAccel();
+
+	// implementation used by the operators
+	static Impl        getImpl();
+	static const char *getImplName();
+
+	uint32_t operator()(uint32_t crc_in, uint8_t *buf, unsigned long len)
+	{
+		return getImpl()( crc_in, buf, len );
+	}
+
+	// update with 'len' octets of a chain of buffers, starting
+	// 'off' octets into buffer 'b'. Returns the updated CRC;
+	// stops early if the chain is shorter.
+	uint32_t operator()(uint32_t crc_in, Buf b, unsigned long off, unsigned long len);
 };
 
 #endif
@@ -23,6 +23,7 @@ static struct Component components[] = {
 	{ "socks",               &libSocksDebug     },
 	{ "thread",              &cpsw_thread_debug },
 	{ "yaml",                &cpsw_yaml_debug   },
+	{ "config",              &cpsw_config_debug },
 	{                    0 ,                  0 }
 };
 
@@ -10,6 +10,7 @@ extern     int cpsw_rssi_debug   __attribute__((weak));
 extern     int cpsw_psbldr_debug __attribute__((weak));
 extern     int cpsw_thread_debug __attribute__((weak));
 extern     int cpsw_yaml_debug   __attribute__((weak));
+extern     int cpsw_config_debug __attribute__((weak));
 extern "C" int libSocksDebug     __attribute__((weak));
 
 #endif
@@ -13,6 +13,7 @@
 #include <cpsw_entry_adapt.h>
 #include <cpsw_stream_adapt.h>
 #include <cpsw_hub.h>
+#include <cpsw_config_loader.h>
 #include <ctype.h>
 
 #include <cpsw_obj_cnt.h>
@@ -206,7 +207,12 @@ void CEntryImpl::setConfigPrio(int configPrio)
 uint64_t CEntryImpl::processYamlConfig(Path p, YAML::Node &n, bool doDump) const
 {
 	if ( doDump ) {
-		uint64_t rval;
+		uint64_t       rval;
+		CConfigDumper *dmp = IPathImpl::toPathImpl( p )->getConfigDumper();
+		if ( dmp && dmp->isPrefetching() && ! batchesConfigDump() ) {
+			n = YAML::Node( YAML::NodeType::Undefined );
+			return 0;
+		}
 		rval = dumpMyConfigToYaml( p, n );
 		if ( n ) {
 			// attach a tag.
@@ -214,6 +220,10 @@ uint64_t CEntryImpl::processYamlConfig(Path p, YAML::Node &n, bool doDump) const
 		}
 		return rval;
 	} else {
+		CConfigLoader *ldr = IPathImpl::toPathImpl( p )->getConfigLoader();
+		if ( ldr && ! batchesConfigLoad() ) {
+			ldr->barrier();
+		}
 		return loadMyConfigFromYaml(p, n);
 	}
 }
@@ -120,6 +120,22 @@ class CEntryImpl: public virtual IField, public CShObj, public CYamlSupportBase
 
 		virtual uint64_t processYamlConfig(Path, YAML::Node &, bool) const;
 
+		// Does 'loadMyConfigFromYaml()' queue its writes on the
+		// path's CConfigLoader? If not then all writes deferred
+		// so far are executed before it is called.
+		virtual bool     batchesConfigLoad() const
+		{
+			return false;
+		}
+
+		// Does 'dumpMyConfigToYaml()' take part in the prefetch
+		// pass of the path's CConfigDumper? If not then it is
+		// only called during the second pass.
+		virtual bool     batchesConfigDump() const
+		{
+			return false;
+		}
+
 		// Every subclass MUST implement the 'getClassName()' virtual
 		// method. Just copy-paste this one:
 		static  const char *_getClassName()       { return "Field";         }
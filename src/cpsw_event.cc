@@ -12,9 +12,16 @@
 #include <cpsw_mutex.h>
 #include <cpsw_condvar.h>
 #include <vector>
+#include <map>
+#include <deque>
 
 #include <pthread.h>
 #include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 
 using std::vector;
@@ -43,6 +50,10 @@ public:
 	{
 	unsigned i;
 
+		if ( src->getFd() >= 0 ) {
+			throw InvalidArgError("File descriptor sources require a pollable event set");
+		}
+
 	// Source hold the last reference to 'this' event set.
 	// Make sure the rug is not pulled out...
 	EventSet holdOn = getSelfAs<EventSetImpl>();
@@ -211,6 +222,11 @@ public:
 			throw CondSignalFailed();
 	}
 
+	virtual int getFd()
+	{
+		return -1;
+	}
+
 	virtual void getAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout)
 	{
 		if ( clock_gettime( CLOCK_REALTIME, & abs_timeout->tv_ ) )
@@ -240,11 +256,428 @@ public:
 	static EventSetImpl create();
 };
 
+class CFdEventSet : public IEventSet, public CShObj {
+protected:
+	typedef shared_ptr<CFdEventSet>                   EventSetImpl;
+
+	struct Member {
+		IEventHandler *h_;
+		bool           queued_;
+		Member(IEventHandler *h) : h_(h), queued_(false) {}
+	};
+
+	typedef std::map<IEventSource*, Member>           Members;
+	typedef std::pair<IEventSource*, IEventHandler*>  Binding;
+
+private:
+	Members                    srcs_;
+	std::deque<IEventSource*>  ready_;  // notified; to be polled
+	std::vector<IEventSource*> parked_; // ready_ while handler was disabled
+	int                        epfd_;
+	int                        evfd_;   // notifications
+	CMtx                       mutx_;
+
+	CFdEventSet(const CFdEventSet &orig);
+	CFdEventSet operator=(const CFdEventSet &orig);
+
+	// NOTE: caller must hold mutx_
+	void enqueue(IEventSource *src);
+	void arm(IEventSource *src, int op);
+	bool popReady(Binding *);
+
+	// wait for epoll; returns 'false' if nothing happened
+	bool harvest(int timeoutMs);
+
+	bool tryRemoveSrc(IEventHandler *);
+	void removeSrc(Members::iterator it);
+
+public:
+	static const int EVENTS_MAX = 16;
+
+	CFdEventSet(Key &k);
+
+	virtual void add(IEventSource *src, IEventHandler *h);
+	virtual void del(IEventSource *src);
+	virtual void del(IEventHandler *h);
+
+	virtual bool processEvent(bool wait, const CTimeout *abs_timeout);
+
+	virtual void notify();
+	virtual void notify(IEventSource *src);
+
+	virtual int getFd()
+	{
+		return epfd_;
+	}
+
+	virtual void getAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout)
+	{
+		getAbsTime( abs_timeout );
+		if ( rel_timeout )
+			*abs_timeout += *rel_timeout;
+	}
+
+	virtual CTimeout getAbsTimeout(const CTimeout *rel_timeout)
+	{
+	CTimeout rval;
+		getAbsTimeout( &rval, rel_timeout );
+		return rval;
+	}
+
+	virtual void getAbsTime(CTimeout *abs_time)
+	{
+		if ( clock_gettime( CLOCK_REALTIME, & abs_time->tv_ ) )
+			throw InternalError("clock_gettime failed");
+	}
+
+	virtual ~CFdEventSet() throw();
+
+	static EventSetImpl create();
+};
+
+CFdEventSet::CFdEventSet(Key &k)
+: CShObj( k       ),
+  epfd_ ( -1      ),
+  evfd_ ( -1      ),
+  mutx_ ( "FDEVS" )
+{
+struct epoll_event ev;
+
+	if ( (epfd_ = epoll_create1( EPOLL_CLOEXEC )) < 0 ) {
+		throw InternalError("CFdEventSet: epoll_create1 failed", errno);
+	}
+	if ( (evfd_ = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK )) < 0 ) {
+		close( epfd_ );
+		throw InternalError("CFdEventSet: eventfd failed", errno);
+	}
+	ev.events   = EPOLLIN;
+	ev.data.ptr = NULL;
+	if ( epoll_ctl( epfd_, EPOLL_CTL_ADD, evfd_, &ev ) ) {
+		close( evfd_ );
+		close( epfd_ );
+		throw InternalError("CFdEventSet: unable to add eventfd", errno);
+	}
+}
+
+CFdEventSet::~CFdEventSet() throw()
+{
+	close( evfd_ );
+	close( epfd_ );
+	// see ~CEventSet()
+	if ( srcs_.size() > 0 ) {
+		throw InternalError("Event set not empty during destruction!");
+	}
+}
+
+CFdEventSet::EventSetImpl CFdEventSet::create()
+{
+	return CShObj::create<EventSetImpl>();
+}
+
+// descriptors are 'one-shot'; they are re-armed once
+// the source has been handled (or found not ready).
+void CFdEventSet::arm(IEventSource *src, int op)
+{
+struct epoll_event ev;
+CFdEventSource    *fdSrc = static_cast<CFdEventSource*>( src );
+
+	ev.events   = fdSrc->getEvents() | EPOLLONESHOT;
+	ev.data.ptr = src;
+	if ( epoll_ctl( epfd_, op, fdSrc->getFd(), &ev ) ) {
+		throw InternalError("CFdEventSet: unable to (re-)arm descriptor", errno);
+	}
+}
+
+void CFdEventSet::enqueue(IEventSource *src)
+{
+Members::iterator it = srcs_.find( src );
+uint64_t          one = 1;
+
+	if ( it == srcs_.end() || it->second.queued_ )
+		return;
+
+	it->second.queued_ = true;
+	ready_.push_back( src );
+	if ( 1 == ready_.size() ) {
+		// wake up a waiter (if any); the eventfd stays
+		// readable until it is drained.
+		if ( write( evfd_, &one, sizeof(one) ) < 0 && EAGAIN != errno ) {
+			throw InternalError("CFdEventSet: unable to write eventfd", errno);
+		}
+	}
+}
+
+void CFdEventSet::add(IEventSource *src, IEventHandler *h)
+{
+// Source hold the last reference to 'this' event set.
+// Make sure the rug is not pulled out...
+EventSet holdOn = getSelfAs<EventSetImpl>();
+
+// always lock source before the event set
+CMtx::lg guard( &src->mtx_ );
+
+	// remove current association -- may call 'del'
+	// and recursively lock the source
+	src->clrEventSet();
+
+	{CMtx::lg guard( &mutx_ );
+	std::pair<Members::iterator, bool> res = srcs_.insert( Members::value_type( src, Member( h ) ) );
+
+		if ( ! res.second ) {
+			// replace existing
+			res.first->second.h_ = h;
+		} else if ( src->getFd() >= 0 ) {
+			arm( src, EPOLL_CTL_ADD );
+		}
+		src->setEventSet( getSelfAs<EventSetImpl>() );
+		// the source might already be 'ready'
+		enqueue( src );
+	}
+}
+
+// NOTE: caller must hold mutx_ and the source's mtx_
+void CFdEventSet::removeSrc(Members::iterator it)
+{
+IEventSource *src = it->first;
+unsigned      i;
+
+	if ( src->getFd() >= 0 ) {
+		// the descriptor might already be closed
+		epoll_ctl( epfd_, EPOLL_CTL_DEL, src->getFd(), NULL );
+	}
+	srcs_.erase( it );
+	// entries on 'ready_' are skipped once they are not found
+	for ( i=0; i<parked_.size(); i++ ) {
+		if ( parked_[i] == src ) {
+			parked_[i] = parked_.back();
+			parked_.pop_back();
+			break;
+		}
+	}
+	src->clrEventSet( getSelfAs<EventSetImpl>() );
+}
+
+void CFdEventSet::del(IEventSource *src)
+{
+// Source hold the last reference to 'this' event set.
+// Make sure the rug is not pulled out...
+EventSet holdOn = getSelfAs<EventSetImpl>();
+
+// always lock source before the event set
+CMtx::lg guard( &src->mtx_ );
+
+	{CMtx::lg guard( &mutx_ );
+	Members::iterator it = srcs_.find( src );
+		if ( it != srcs_.end() ) {
+			removeSrc( it );
+		}
+	}
+}
+
+// see CEventSet::tryRemoveSrc()
+bool CFdEventSet::tryRemoveSrc(IEventHandler *h)
+{
+Members::iterator it;
+
+// Source hold the last reference to 'this' event set.
+// Make sure the rug is not pulled out...
+EventSet holdOn = getSelfAs<EventSetImpl>();
+
+CMtx::lg guard( &mutx_ );
+
+	for ( it = srcs_.begin(); it != srcs_.end(); ++it ) {
+		if ( it->second.h_ == h ) {
+			try {
+				CMtx::lg guard( &it->first->mtx_, false /* dont' block */);
+
+				removeSrc( it );
+
+				return true;
+
+			} catch ( CMtx::MutexBusy ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+void CFdEventSet::del(IEventHandler *h)
+{
+unsigned attempt = 0;
+
+// Source hold the last reference to 'this' event set.
+// Make sure the rug is not pulled out...
+EventSet holdOn = getSelfAs<EventSetImpl>();
+
+	while ( ! tryRemoveSrc( h ) ) {
+		if ( ++attempt > 10 ) {
+			throw InternalError("Unable to remove event handler -- starved");
+		}
+		struct timespec t;
+		t.tv_sec  = 0;
+		t.tv_nsec = 10000000;
+		nanosleep( &t, NULL );
+	}
+}
+
+void CFdEventSet::notify(IEventSource *src)
+{
+CMtx::lg guard( &mutx_ );
+	enqueue( src );
+}
+
+void CFdEventSet::notify()
+{
+uint64_t one = 1;
+	// we don't know who; look at everybody
+	CMtx::lg guard( &mutx_ );
+	for ( Members::iterator it = srcs_.begin(); it != srcs_.end(); ++it ) {
+		enqueue( it->first );
+	}
+	if ( write( evfd_, &one, sizeof(one) ) < 0 && EAGAIN != errno ) {
+		throw InternalError("CFdEventSet: unable to write eventfd", errno);
+	}
+}
+
+// NOTE: caller must hold mutx_
+bool CFdEventSet::popReady(Binding *b)
+{
+Members::iterator it;
+IEventSource     *src;
+unsigned          i;
+
+	// sources whose handler has been re-enabled
+	for ( i=0; i<parked_.size(); ) {
+		if ( (it = srcs_.find( parked_[i] )) != srcs_.end() && it->second.h_->isEnabled() ) {
+			ready_.push_back( parked_[i] );
+			it->second.queued_ = true;
+			parked_[i] = parked_.back();
+			parked_.pop_back();
+		} else {
+			i++;
+		}
+	}
+
+	while ( ! ready_.empty() ) {
+		src = ready_.front();
+		ready_.pop_front();
+		if ( (it = srcs_.find( src )) == srcs_.end() ) {
+			continue; // removed meanwhile
+		}
+		it->second.queued_ = false;
+		if ( ! it->second.h_->isEnabled() ) {
+			parked_.push_back( src );
+			continue;
+		}
+		if ( src->poll() ) {
+			b->first  = src;
+			b->second = it->second.h_;
+			return true;
+		}
+		if ( src->getFd() >= 0 ) {
+			arm( src, EPOLL_CTL_MOD );
+		}
+	}
+	return false;
+}
+
+bool CFdEventSet::harvest(int timeoutMs)
+{
+struct epoll_event evs[EVENTS_MAX];
+int                n, i;
+uint64_t           val;
+
+	if ( (n = epoll_wait( epfd_, evs, EVENTS_MAX, timeoutMs )) < 0 ) {
+		if ( EINTR == errno )
+			return true;
+		throw InternalError("CFdEventSet: epoll_wait failed", errno);
+	}
+
+	if ( n > 0 ) {
+	CMtx::lg guard( &mutx_ );
+		for ( i=0; i<n; i++ ) {
+			if ( ! evs[i].data.ptr ) {
+				if ( read( evfd_, &val, sizeof(val) ) < 0 && EAGAIN != errno ) {
+					throw InternalError("CFdEventSet: unable to read eventfd", errno);
+				}
+			} else {
+				enqueue( static_cast<IEventSource*>( evs[i].data.ptr ) );
+			}
+		}
+	}
+	return n > 0;
+}
+
+bool CFdEventSet::processEvent(bool wait, const CTimeout *abs_timeout)
+{
+Binding  b;
+bool     got;
+CTimeout now;
+int64_t  ms;
+
+	if ( wait && abs_timeout ) {
+		if ( abs_timeout->isNone() ) {
+			wait = false;
+		} else if ( abs_timeout->isIndefinite() ) {
+			abs_timeout = NULL;
+		}
+	}
+
+	while ( 1 ) {
+		{
+		CMtx::lg guard( &mutx_ );
+			got = popReady( &b );
+		}
+
+		if ( got ) {
+			b.first->handle( b.second );
+
+			// the handler might not have consumed everything
+			// and sources are not required to notify again
+			CMtx::lg guard( &mutx_ );
+			if ( srcs_.find( b.first ) != srcs_.end() ) {
+				if ( b.first->poll() ) {
+					enqueue( b.first );
+				} else if ( b.first->getFd() >= 0 ) {
+					arm( b.first, EPOLL_CTL_MOD );
+				}
+			}
+			return true;
+		}
+
+		if ( ! wait ) {
+			ms = 0;
+		} else if ( ! abs_timeout ) {
+			ms = -1;
+		} else {
+			getAbsTime( &now );
+			if ( ! (now < *abs_timeout) ) {
+				ms = 0;
+			} else {
+				now = *abs_timeout - now;
+				// round up; we must not return early
+				ms  = (int64_t)now.tv_.tv_sec * 1000 + (now.tv_.tv_nsec + 999999) / 1000000;
+			}
+		}
+
+		if ( ! harvest( (int)ms ) && 0 == ms ) {
+			return false;
+		}
+	}
+}
+
 EventSet IEventSet::create()
 {
 	return CEventSet::create();
 }
 
+EventSet IEventSet::createPollable()
+{
+	return CFdEventSet::create();
+}
+
 CEventSet::EventSetImpl CEventSet::create()
 {
 	return CShObj::create<EventSetImpl>();
@@ -287,7 +720,7 @@ void IEventSource::notify()
 CMtx::lg guard( &mtx_ );
 
 	if ( eventSet_ )
-		eventSet_->notify();
+		eventSet_->notify( this );
 }
 
 bool CIntEventSource::checkForEvent()
@@ -360,6 +793,30 @@ CIntEventSource::CIntEventSource()
 {
 }
 
+CFdEventSource::CFdEventSource(int fd, short events)
+: fd_     ( fd     ),
+  events_ ( events ),
+  revents_( 0      )
+{
+	if ( fd < 0 ) {
+		throw InvalidArgError("CFdEventSource: invalid file descriptor");
+	}
+}
+
+bool CFdEventSource::checkForEvent()
+{
+struct pollfd p;
+
+	p.fd      = fd_;
+	p.events  = events_;
+	p.revents = 0;
+	if ( ::poll( &p, 1, 0 ) > 0 && p.revents ) {
+		revents_ = p.revents;
+		return true;
+	}
+	return false;
+}
+
 void CIntEventSource::sendEvent(int val)
 {
 	if ( val ) {
@@ -61,6 +61,7 @@ using cpsw::memory_order_release;
 // Look for a '####' pattern to find other locations
 // that need to be modified.
 class IIntEventSource;
+class CFdEventSource;
 
 class IEventSet;
 typedef shared_ptr<IEventSet> EventSet;
@@ -100,6 +101,11 @@ public:
 	{
 		throw InternalError("No event handler implemented for this source");
 	}
+
+	virtual void handle(CFdEventSource *es)
+	{
+		throw InternalError("No event handler implemented for this source");
+	}
 };
 
 // useful if the event itself is all you need
@@ -108,6 +114,10 @@ public:
 	virtual void handle(IIntEventSource *es)
 	{
 	}
+
+	virtual void handle(CFdEventSource *es)
+	{
+	}
 };
 
 // general-purpose handler for 'int' events
@@ -138,6 +148,7 @@ private:
 	void clrEventSet();
 
 	friend class CEventSet;
+	friend class CFdEventSet;
 
 protected:
 	// Every subclass must add
@@ -190,6 +201,13 @@ public:
 	// notify the eventSet bound to this source
 	virtual void notify();
 
+	// sources which are backed by a file descriptor
+	// (rather than being notified) return it here
+	virtual int  getFd()
+	{
+		return -1;
+	}
+
 	virtual ~IEventSource();
 };
 
@@ -236,6 +254,45 @@ public:
 	virtual void sendEvent(int val);
 };
 
+// A file descriptor of the application (socket, pipe, ...) as
+// an event source; the event is the descriptor becoming ready
+// for any of 'events' (POLLIN, POLLOUT, ...). The condition is
+// level-triggered: the handler must consume the data (or the
+// event is dispatched again).
+// Only supported by 'pollable' event sets (IEventSet::createPollable).
+class CFdEventSource : public IEventSource {
+private:
+	int   fd_;
+	short events_;
+	short revents_;
+
+protected:
+	virtual void dispatch(IEventHandler *h) { h->handle( this ); }
+
+	virtual bool checkForEvent();
+
+public:
+	CFdEventSource(int fd, short events);
+
+	virtual int   getFd()
+	{
+		return fd_;
+	}
+
+	virtual short getEvents()
+	{
+		return events_;
+	}
+
+	// what was ready when the event was detected
+	virtual short getREvents()
+	{
+		if ( ! isPending() )
+			throw InternalError("No event pending");
+		return revents_;
+	}
+};
+
 // Don't use shared_ptr for referencing EventSources or Handlers.
 
 // The Entity using the EventSet (processEvent) usually also implements
@@ -281,6 +338,20 @@ public:
 	// to be called by
 	virtual void notify()                                             = 0;
 
+	// notification on behalf of a particular source; lets
+	// an implementation look at the ready sources only.
+	virtual void notify(IEventSource *src)
+	{
+		notify();
+	}
+
+	// a descriptor which becomes readable when an event may be
+	// pending so that the set can be waited for together with
+	// other descriptors (poll/select/epoll). 'processEvent(false,...)'
+	// should then be called until it returns 'false'.
+	// Returns -1 if the set is not pollable.
+	virtual int  getFd()                                              = 0;
+
 	virtual ~IEventSet() {}
 
 	virtual void     getAbsTimeout(CTimeout *abs_timeout, const CTimeout *rel_timeout) = 0;
@@ -288,6 +359,13 @@ public:
 	virtual void     getAbsTime(CTimeout *abs_time)                                    = 0;
 
 	static EventSet create();
+
+	// A set based on epoll/eventfd: dispatching only looks at the
+	// sources which were notified (rather than polling all members),
+	// file descriptors (CFdEventSource) may be added and the set
+	// itself can be waited for with poll/select/epoll ('getFd()').
+	// Relative to 'create()' each notification costs a system call.
+	static EventSet createPollable();
 };
 
 #endif
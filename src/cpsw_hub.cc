@@ -10,7 +10,9 @@
 #include <cpsw_api_builder.h>
 #include <cpsw_hub.h>
 #include <cpsw_path.h>
+#include <cpsw_config_loader.h>
 #include <cpsw_fs_addr.h>
+#include <cpsw_async_io.h>
 
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -286,6 +288,120 @@ uint64_t CAddressImpl::write(CWriteArgs *args) const
 	throw ConfigurationError("Configuration Error: -- unable to route I/O for write");
 }
 
+bool CAddressImpl::compilePlan(CompositePathIterator *node, CAccessPlan *plan) const
+{
+	// we don't know what a subclass does in read/write(CompositePathIterator*,...)
+	return false;
+}
+
+bool CAddressImpl::terminatePlan(CompositePathIterator *node, CAccessPlan *plan) const
+{
+	// read(CompositePathIterator*,...) iterates over our own
+	// elements; only plan the trivial case.
+	if ( ! plan->hasElements() || 0 != (*node)->idxf_ || 0 != (*node)->idxt_ ) {
+		return false;
+	}
+	// 'this' is the address the iterator points to
+	plan->setTarget( static_pointer_cast<const CAddressImpl>( (*node)->c_p_ ) );
+	return true;
+}
+
+void CAccessPlan::reset()
+{
+	target_.reset();
+	off_       = 0;
+	stride_    = 0;
+	nelms_     = 0;
+	cacheable_ = IField::UNKNOWN_CACHEABLE;
+}
+
+bool CAccessPlan::compile(const CompositePathIterator &start)
+{
+CompositePathIterator it( start );
+
+	reset();
+	if ( it.atEnd() || ! it->c_p_->compilePlan( &it, this ) ) {
+		reset();
+		return false;
+	}
+	return true;
+}
+
+void CAccessPlan::setElements(uint64_t off, uint64_t stride, unsigned nelms, IField::Cacheable cacheable)
+{
+	off_       = off;
+	stride_    = stride;
+	nelms_     = nelms;
+	cacheable_ = cacheable;
+}
+
+// Must match what CMMIOAddressImpl::read() and
+// CAddressImpl::read(CompositePathIterator*, ...) do.
+uint64_t CAccessPlan::read(CReadArgs *args) const
+{
+CReadArgs nargs     = *args;
+unsigned  n         = nelms_;
+uintptr_t dstStride = args->nbytes_;
+uint64_t  rval      = 0;
+
+	if ( nargs.nbytes_ == stride_ && cacheable_ >= IField::WT_CACHEABLE ) {
+		// contiguous; read all in one chunk
+		nargs.nbytes_ *= n;
+		n              = 1;
+	}
+
+	nargs.off_ += off_;
+
+	if ( n > 1 && nargs.aio_ ) {
+		nargs.aio_ = IAsyncIOParallelCompletion::create( nargs.aio_ );
+	}
+
+	while ( n-- > 0 ) {
+		rval += target_->read( &nargs );
+
+		if ( target_->isSync() && nargs.aio_ ) {
+			nargs.aio_->callback( 0 );
+		}
+
+		nargs.off_ += stride_;
+		nargs.dst_ += dstStride;
+	}
+
+	return rval;
+}
+
+// Must match what CMMIOAddressImpl::write() and
+// CAddressImpl::write(CompositePathIterator*, ...) do.
+uint64_t CAccessPlan::write(CWriteArgs *args) const
+{
+CWriteArgs nargs     = *args;
+unsigned   n         = nelms_;
+uintptr_t  srcStride = args->nbytes_;
+uint64_t   rval      = 0;
+
+	if (    nargs.nbytes_ == stride_
+	     && cacheable_ >= IField::WB_CACHEABLE
+	     && nargs.msk1_ == 0
+	     && nargs.mskn_ == 0
+	   ) {
+		// contiguous and no bits to merge; write all in one chunk
+		nargs.nbytes_ *= n;
+		n              = 1;
+	}
+
+	nargs.off_ += off_;
+
+	while ( n-- > 0 ) {
+		target_->checkWriteAlignmentReqs( &nargs );
+		rval += target_->write( &nargs );
+
+		nargs.off_ += stride_;
+		nargs.src_ += srcStride;
+	}
+
+	return rval;
+}
+
 Hub CAddressImpl::getOwner() const
 {
 	return owner_.get();
@@ -508,11 +624,16 @@ Dev IDev::create(const char *name, uint64_t size)
 
 Path CDevImpl::findByName(const char *s) const
 {
-	Hub  h( getSelfAsConst<DevImpl>() );
-	Path p = IPath::create( h );
+	Path p = IPathImpl::create( getSelfAsConst<DevImpl>() );
 	return p->findByName( s );
 }
 
+std::vector<Path> CDevImpl::findByNames(const std::vector<std::string> &names) const
+{
+	Path p = IPathImpl::create( getSelfAsConst<DevImpl>() );
+	return p->findByNames( names );
+}
+
 void CDevImpl::accept(IVisitor    *v, RecursionOrder order, int recursionDepth)
 {
 MyChildren::iterator it;
@@ -615,6 +736,10 @@ uint64_t    rval = 0;
 		// We did get a template hierarchy. OK; we'll save stuff in the order
 		// specified by the template sequence.
 		YAML::Node::iterator it;
+		CConfigLoader       *ldr = IPathImpl::toPathImpl( p )->getConfigLoader();
+		CConfigDumper       *dmp = IPathImpl::toPathImpl( p )->getConfigDumper();
+		// warn only once, i.e., not during the prefetch pass of a dump
+		bool                 wrn = ! dmp || ! dmp->isPrefetching();
 		for ( it = n.begin(); it != n.end(); ++it ) {
 
 			YAML::Node child(*it);
@@ -631,11 +756,13 @@ uint64_t    rval = 0;
 				// a descendant of ours and a value which is to be interpreted
 				// by the descendant.
 				if ( ! child.IsMap() ) {
-					fprintf( CPSW::fErr(), "WARNING CDevImpl::processYamlConfig(%s) -- unexpected YAML node @line %d, col %d (Map expected) -- IGNORING\n", job, mrk.line, mrk.column );
+					if ( wrn )
+						fprintf( CPSW::fErr(), "WARNING CDevImpl::processYamlConfig(%s) -- unexpected YAML node @line %d, col %d (Map expected) -- IGNORING\n", job, mrk.line, mrk.column );
 					continue;
 				}
 				if ( child.size() != 1 ) {
-					fprintf( CPSW::fErr(), "WARNING CDevImpl::processYamlConfig(%s) -- unexpected YAML node @line %d, col %d (Map with more than 1 element) -- IGNORING\n", job, mrk.line, mrk.column );
+					if ( wrn )
+						fprintf( CPSW::fErr(), "WARNING CDevImpl::processYamlConfig(%s) -- unexpected YAML node @line %d, col %d (Map with more than 1 element) -- IGNORING\n", job, mrk.line, mrk.column );
 					continue;
 				}
 
@@ -649,6 +776,17 @@ uint64_t    rval = 0;
 					// try to find the entity referred to by the yaml node in our hierarchy
 					Path descendant( findByName( key.c_str() ) );
 
+					if ( ldr ) {
+						// siblings of equal priority may be loaded concurrently;
+						// a descendant further down can't be ordered w.r.t. our
+						// children -- treat it as a separate phase.
+						if ( 1 == descendant->size() ) {
+							ldr->setPrio( IPathImpl::toPathImpl( descendant )->tailAsPathEntry().c_p_->getEntryImpl()->getConfigPrio() );
+						} else {
+							ldr->barrier();
+						}
+					}
+
 					p->append( descendant );
 
 					if ( doDump )
@@ -656,6 +794,10 @@ uint64_t    rval = 0;
 					else
 						rval += p->loadConfigFromYaml( item->second );
 
+					if ( ldr && 1 != descendant->size() ) {
+						ldr->barrier();
+					}
+
 					int i = descendant->size();
 
 					// strip descendant from path again
@@ -664,7 +806,8 @@ uint64_t    rval = 0;
 
 				} catch ( NotFoundError &e ) {
 					// descendant not found; not a big deal but spit out a warning
-					fprintf( CPSW::fErr(), "WARNING CDevImpl::processYamlConfig(%s) -- unexpected YAML node @line %d, col %d (key %s not found) -- IGNORING\n", job, mrk.line, mrk.column, key.c_str() );
+					if ( wrn )
+						fprintf( CPSW::fErr(), "WARNING CDevImpl::processYamlConfig(%s) -- unexpected YAML node @line %d, col %d (key %s not found) -- IGNORING\n", job, mrk.line, mrk.column, key.c_str() );
 					child.remove( key );
 				}
 			}
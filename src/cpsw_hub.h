@@ -13,6 +13,7 @@
 #include <cpsw_api_builder.h>
 #include <cpsw_address.h>
 #include <cpsw_entry.h>
+#include <cpsw_path.h>
 
 #include <map>
 #include <list>
@@ -41,6 +42,7 @@ class CDevImpl : public CEntryImpl, public virtual IDev {
 	private:
 		mutable  MyChildren children_;       // only by 'add' and 'startUp' methods
 		mutable  PrioList   configPrioList_; // order for dumping configuration fields
+		mutable  CPathIndex pathIndex_;      // paths found from here; not copied by clone
 
 	protected:
 		virtual void add(AddressImpl a, Field child);
@@ -89,6 +91,13 @@ class CDevImpl : public CEntryImpl, public virtual IDev {
 
 		virtual Path findByName(const char *s) const;
 
+		virtual std::vector<Path> findByNames(const std::vector<std::string> &names) const;
+
+		virtual CPathIndex *getPathIndex() const
+		{
+			return &pathIndex_;
+		}
+
 		virtual Child getChild(const char *name) const
 		{
 			return getAddress( name );
@@ -0,0 +1,169 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_io_engine.h>
+#include <cpsw_worker_pool.h>
+#include <cpsw_error.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+CIoEngine::CIoEngine(int prio)
+: CRunnable( "I/O Engine", prio ),
+  epfd_    ( -1                 ),
+  ctlfd_   ( -1                 ),
+  mtx_     ( "IoEngine"         ),
+  assigned_( 0                  )
+{
+struct epoll_event ev;
+
+	if ( (epfd_ = epoll_create1( EPOLL_CLOEXEC )) < 0 ) {
+		throw InternalError("CIoEngine: epoll_create1 failed", errno);
+	}
+	if ( (ctlfd_ = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK )) < 0 ) {
+		close( epfd_ );
+		throw InternalError("CIoEngine: eventfd failed", errno);
+	}
+	ev.events   = EPOLLIN;
+	ev.data.ptr = NULL;
+	if ( epoll_ctl( epfd_, EPOLL_CTL_ADD, ctlfd_, &ev ) ) {
+		close( ctlfd_ );
+		close( epfd_  );
+		throw InternalError("CIoEngine: unable to add control descriptor", errno);
+	}
+}
+
+CIoEngine::~CIoEngine()
+{
+	threadStop();
+	close( ctlfd_ );
+	close( epfd_  );
+}
+
+void
+CIoEngine::add(int fd, IIoHandler *handler)
+{
+struct epoll_event ev;
+
+	ev.events   = EPOLLIN;
+	ev.data.ptr = handler;
+	if ( epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, &ev ) ) {
+		throw InternalError("CIoEngine: unable to add descriptor", errno);
+	}
+	assigned_.fetch_add( 1, cpsw::memory_order_relaxed );
+}
+
+void
+CIoEngine::enable(int fd, IIoHandler *handler)
+{
+struct epoll_event ev;
+
+	ev.events   = EPOLLIN;
+	ev.data.ptr = handler;
+	// EEXIST: already enabled
+	if ( epoll_ctl( epfd_, EPOLL_CTL_ADD, fd, &ev ) && EEXIST != errno ) {
+		throw InternalError("CIoEngine: unable to re-enable descriptor", errno);
+	}
+}
+
+void
+CIoEngine::disable(int fd)
+{
+	// ENOENT: already disabled
+	if ( epoll_ctl( epfd_, EPOLL_CTL_DEL, fd, NULL ) && ENOENT != errno ) {
+		throw InternalError("CIoEngine: unable to remove descriptor", errno);
+	}
+}
+
+void
+CIoEngine::remove(int fd)
+{
+	disable( fd );
+	// the engine may already have retrieved an event for 'fd'
+	sync();
+	assigned_.fetch_sub( 1, cpsw::memory_order_relaxed );
+}
+
+void
+CIoEngine::sync()
+{
+CIntEventSource  done;
+CIntEventHandler eh;
+uint64_t         one = 1;
+
+	if ( pthread_equal( pthread_self(), getTid() ) ) {
+		throw InternalError("I/O engine cannot remove descriptors from its own thread");
+	}
+	{
+	CMtx::lg guard( &mtx_ );
+		barrier_.push_back( &done );
+	}
+	if ( sizeof(one) != write( ctlfd_, &one, sizeof(one) ) ) {
+		throw InternalError("CIoEngine: unable to wake engine", errno);
+	}
+	eh.receiveEvent( &done, true, NULL );
+}
+
+void *
+CIoEngine::threadBody()
+{
+struct epoll_event                      evs[EVENTS_MAX];
+int                                     n, i;
+bool                                    ctl;
+uint64_t                                val;
+std::vector<CIntEventSource*>           waiters;
+std::vector<CIntEventSource*>::iterator it;
+
+	while ( 1 ) {
+		if ( (n = epoll_wait( epfd_, evs, EVENTS_MAX, -1 )) < 0 ) {
+			if ( EINTR == errno )
+				continue;
+			throw InternalError("CIoEngine: epoll_wait failed", errno);
+		}
+
+		ctl = false;
+		for ( i = 0; i < n; i++ ) {
+			if ( ! evs[i].data.ptr ) {
+				ctl = true;
+			} else {
+				static_cast<IIoHandler*>( evs[i].data.ptr )->handleInput();
+			}
+		}
+
+		// release waiters only after the entire batch has been dispatched
+		if ( ctl ) {
+			if ( read( ctlfd_, &val, sizeof(val) ) < 0 && EAGAIN != errno ) {
+				throw InternalError("CIoEngine: unable to read control descriptor", errno);
+			}
+			{
+			CMtx::lg guard( &mtx_ );
+				waiters.swap( barrier_ );
+			}
+			for ( it = waiters.begin(); it != waiters.end(); ++it ) {
+				(*it)->sendEvent( 1 );
+			}
+			waiters.clear();
+		}
+	}
+
+	return NULL;
+}
+
+IoEngine
+CIoEngine::get(unsigned poolSize, int prio)
+{
+// never destroyed: modules may be shut down from static destructors
+static CWorkerPool<CIoEngine> *pool = new CWorkerPool<CIoEngine>( "IoEnginePool" );
+
+	return pool->get( poolSize, prio );
+}
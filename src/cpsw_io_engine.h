@@ -0,0 +1,99 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_IO_ENGINE_H
+#define CPSW_IO_ENGINE_H
+
+#include <cpsw_thread.h>
+#include <cpsw_mutex.h>
+#include <cpsw_event.h>
+#include <cpsw_compat.h>
+
+#include <vector>
+
+using cpsw::atomic;
+
+class CIoEngine;
+typedef shared_ptr<CIoEngine> IoEngine;
+
+// Objects whose file descriptor is serviced by an I/O engine.
+class IIoHandler {
+public:
+	// Called from the engine thread while the descriptor is
+	// readable (level-triggered). Must not block for long:
+	// all other descriptors of the engine wait meanwhile.
+	virtual void handleInput() = 0;
+
+	virtual ~IIoHandler() {}
+};
+
+/* An I/O engine is a thread which waits (epoll) for any of
+ * the descriptors registered with it to become readable and
+ * then runs the respective handler.
+ *
+ * Engines form a process-wide pool which is shared by all
+ * protocol modules; a descriptor is assigned to the least
+ * busy engine. The pool grows up to the size requested by
+ * the modules and an engine thread terminates once its last
+ * descriptor is removed.
+ */
+class CIoEngine : public CRunnable {
+private:
+	int                               epfd_;
+	int                               ctlfd_;    // eventfd; wakes the engine
+	CMtx                              mtx_;      // protects barrier_
+	std::vector<CIntEventSource*>     barrier_;
+	atomic<unsigned>                  assigned_;
+
+	CIoEngine(const CIoEngine &);
+	CIoEngine & operator=(const CIoEngine &);
+
+	// returns after the engine has finished dispatching
+	// all events it possibly retrieved before the call
+	void sync();
+
+protected:
+	virtual void *threadBody();
+
+public:
+	static const unsigned EVENTS_MAX = 64;
+
+	CIoEngine(int prio);
+
+	// # of descriptors assigned to this engine
+	unsigned getLoad()
+	{
+		return assigned_.load( cpsw::memory_order_relaxed );
+	}
+
+	void add(int fd, IIoHandler *handler);
+
+	// once 'remove' returns the handler is guaranteed not to
+	// be executing nor to be executed again. Must not be called
+	// from a handler.
+	void remove(int fd);
+
+	// stop watching 'fd' without waiting; may be used by a
+	// handler to silence its own descriptor (e.g., on error).
+	// 'remove' must still be called eventually.
+	void disable(int fd);
+
+	// resume watching a descriptor which was silenced by 'disable'
+	// (no-op if it is being watched). May be called from any thread
+	// (including a handler) as long as 'remove' is not executing.
+	void enable(int fd, IIoHandler *handler);
+
+	// obtain the least busy engine running at priority 'prio' from
+	// a pool of (up to) 'poolSize' (one pool per priority)
+	static IoEngine get(unsigned poolSize, int prio);
+
+	virtual ~CIoEngine();
+};
+
+#endif
@@ -15,6 +15,7 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <typeinfo>
 
 #include <cpsw_yaml.h>
 #include <cpsw_aligned_mmio.h>
@@ -275,6 +276,15 @@ fprintf(CPSW::fDbg(), "\n");
 }
 
 
+bool
+CMemAddressImpl::compilePlan(CompositePathIterator *node, CAccessPlan *plan) const
+{
+	if ( typeid( *this ) != typeid( CMemAddressImpl ) ) {
+		return false;
+	}
+	return terminatePlan( node, plan );
+}
+
 void
 CMemAddressImpl::dumpYamlPart(YAML::Node &node) const
 {
@@ -52,6 +52,8 @@ class CMemAddressImpl : public CAddressImpl {
 
 		virtual uint64_t read(CReadArgs *args)   const;
 		virtual uint64_t write(CWriteArgs *args) const;
+
+		virtual bool     compilePlan(CompositePathIterator *node, CAccessPlan *plan) const;
 };
 
 class CMemDevImpl : public CDevImpl, public virtual IMemDev {
@@ -0,0 +1,298 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_metrics.h>
+#include <cpsw_mutex.h>
+
+#include <stdio.h>
+#include <ctype.h>
+#include <inttypes.h>
+#include <map>
+#include <algorithm>
+
+CMetricHistogram::CMetricHistogram()
+{
+	reset();
+}
+
+void
+CMetricHistogram::reset()
+{
+unsigned i;
+	for ( i = 0; i < NBUCKETS; i++ ) {
+		buckets_[i].store( 0, cpsw::memory_order_relaxed );
+	}
+	count_.store( 0, cpsw::memory_order_relaxed );
+	sum_.store( 0, cpsw::memory_order_relaxed );
+}
+
+namespace {
+
+struct Source {
+	IMetricsSource *src_;
+	std::string     name_;
+	unsigned        instance_;
+};
+
+class CRegistry {
+public:
+	CMtx                            mtx_;
+	std::vector<Source>             sources_;
+	std::map<std::string, unsigned> instances_;
+
+	CRegistry()
+	: mtx_( "metrics" )
+	{
+	}
+};
+
+// never destroyed: sources may unregister from static destructors
+CRegistry &
+theRegistry()
+{
+static CRegistry *r = new CRegistry();
+	return *r;
+}
+
+// Append samples of the current source to a snapshot
+class CSnapshotSink : public IMetricsSink {
+private:
+	IMetrics::Snapshot *snap_;
+	const Source       *src_;
+
+	IMetrics::Sample &
+	add(const char *name, IMetrics::Kind kind, uint64_t value)
+	{
+		snap_->push_back( IMetrics::Sample() );
+		IMetrics::Sample &s( snap_->back() );
+		s.source   = src_->name_;
+		s.instance = src_->instance_;
+		s.name     = name;
+		s.kind     = kind;
+		s.value    = value;
+		s.sum      = 0;
+		return s;
+	}
+
+public:
+	CSnapshotSink(IMetrics::Snapshot *snap)
+	: snap_( snap ),
+	  src_ ( 0    )
+	{
+	}
+
+	void setSource(const Source *src)
+	{
+		src_ = src;
+	}
+
+	virtual void counter(const char *name, uint64_t value)
+	{
+		add( name, IMetrics::COUNTER, value );
+	}
+
+	virtual void gauge(const char *name, uint64_t value)
+	{
+		add( name, IMetrics::GAUGE, value );
+	}
+
+	virtual void histogram(const char *name, const CMetricHistogram &h)
+	{
+	IMetrics::Sample &s( add( name, IMetrics::HISTOGRAM, h.getCount() ) );
+	unsigned          i;
+		s.sum = h.getSum();
+		s.bucketLimits.resize( CMetricHistogram::NBUCKETS );
+		s.bucketCounts.resize( CMetricHistogram::NBUCKETS );
+		for ( i = 0; i < CMetricHistogram::NBUCKETS; i++ ) {
+			s.bucketLimits[i] = CMetricHistogram::getBucketLimit( i );
+			s.bucketCounts[i] = h.getBucket( i );
+		}
+	}
+};
+
+// Prometheus metric names are restricted to [a-zA-Z0-9_:];
+// by convention the names of counters end in '_total'.
+std::string
+promName(const IMetrics::Sample &s)
+{
+std::string            rval( "cpsw_" + s.source + "_" + s.name );
+std::string::iterator  it;
+	for ( it = rval.begin(); it != rval.end(); ++it ) {
+		*it = isalnum( *it ) ? tolower( *it ) : '_';
+	}
+	if ( IMetrics::COUNTER == s.kind ) {
+		rval += "_total";
+	}
+	return rval;
+}
+
+bool
+promOrder(const IMetrics::Sample *a, const IMetrics::Sample *b)
+{
+	return promName( *a ) < promName( *b );
+}
+
+const char *
+kindName(IMetrics::Kind kind)
+{
+	switch ( kind ) {
+		case IMetrics::COUNTER:   return "counter";
+		case IMetrics::GAUGE:     return "gauge";
+		case IMetrics::HISTOGRAM: return "histogram";
+	}
+	return "untyped";
+}
+
+void
+jsonString(FILE *f, const std::string &str)
+{
+std::string::const_iterator it;
+	fputc( '"', f );
+	for ( it = str.begin(); it != str.end(); ++it ) {
+		if ( '"' == *it || '\\' == *it )
+			fputc( '\\', f );
+		fputc( *it, f );
+	}
+	fputc( '"', f );
+}
+
+}
+
+void
+CMetricsRegistry::add(IMetricsSource *src, const char *sourceName)
+{
+CRegistry &r( theRegistry() );
+CMtx::lg   guard( &r.mtx_ );
+std::vector<Source>::iterator it;
+Source     s;
+
+	for ( it = r.sources_.begin(); it != r.sources_.end(); ++it ) {
+		if ( it->src_ == src )
+			return;
+	}
+	s.src_      = src;
+	s.name_     = sourceName;
+	s.instance_ = r.instances_[ s.name_ ]++;
+	r.sources_.push_back( s );
+}
+
+void
+CMetricsRegistry::remove(IMetricsSource *src)
+{
+CRegistry &r( theRegistry() );
+CMtx::lg   guard( &r.mtx_ );
+std::vector<Source>::iterator it;
+
+	for ( it = r.sources_.begin(); it != r.sources_.end(); ++it ) {
+		if ( it->src_ == src ) {
+			r.sources_.erase( it );
+			return;
+		}
+	}
+}
+
+void
+CMetricsRegistry::snapshot(IMetrics::Snapshot *snap)
+{
+CRegistry    &r( theRegistry() );
+CMtx::lg      guard( &r.mtx_ );
+CSnapshotSink sink( snap );
+std::vector<Source>::const_iterator it;
+
+	for ( it = r.sources_.begin(); it != r.sources_.end(); ++it ) {
+		sink.setSource( &(*it) );
+		it->src_->collectMetrics( &sink );
+	}
+}
+
+void
+IMetrics::snapshot(Snapshot *snap)
+{
+	CMetricsRegistry::snapshot( snap );
+}
+
+void
+IMetrics::dumpJSON(FILE *f)
+{
+Snapshot                 snap;
+Snapshot::const_iterator it;
+unsigned                 i;
+
+	snapshot( &snap );
+
+	fprintf(f, "{\"metrics\":[");
+	for ( it = snap.begin(); it != snap.end(); ++it ) {
+		fprintf(f, "%s\n {\"source\":", it == snap.begin() ? "" : ",");
+		jsonString( f, it->source );
+		fprintf(f, ",\"instance\":%u,\"name\":", it->instance);
+		jsonString( f, it->name );
+		fprintf(f, ",\"type\":\"%s\"", kindName( it->kind ));
+		if ( HISTOGRAM == it->kind ) {
+			fprintf(f, ",\"count\":%" PRIu64 ",\"sum\":%" PRIu64 ",\"buckets\":[", it->value, it->sum);
+			for ( i = 0; i < it->bucketCounts.size(); i++ ) {
+				if ( i == it->bucketCounts.size() - 1 ) {
+					fprintf(f, "%s{\"lt\":\"+Inf\",\"count\":%" PRIu64 "}", i ? "," : "", it->bucketCounts[i]);
+				} else {
+					fprintf(f, "%s{\"lt\":%" PRIu64 ",\"count\":%" PRIu64 "}", i ? "," : "", it->bucketLimits[i], it->bucketCounts[i]);
+				}
+			}
+			fprintf(f, "]}");
+		} else {
+			fprintf(f, ",\"value\":%" PRIu64 "}", it->value);
+		}
+	}
+	fprintf(f, "\n]}\n");
+}
+
+void
+IMetrics::dumpPrometheus(FILE *f)
+{
+Snapshot                       snap;
+std::vector<const Sample *>    sorted;
+std::string                    nam, lnam;
+unsigned                       i, k;
+uint64_t                       cum;
+
+	snapshot( &snap );
+
+	// 'instance' is attached by the Prometheus server (scrape
+	// target) and would clobber ours; hence 'cpsw_instance'.
+
+	// all samples of a metric family must be grouped together
+	for ( i = 0; i < snap.size(); i++ ) {
+		sorted.push_back( &snap[i] );
+	}
+	std::stable_sort( sorted.begin(), sorted.end(), promOrder );
+
+	for ( i = 0; i < sorted.size(); i++ ) {
+		const Sample *s = sorted[i];
+		nam = promName( *s );
+		if ( nam != lnam ) {
+			fprintf(f, "# TYPE %s %s\n", nam.c_str(), kindName( s->kind ));
+			lnam = nam;
+		}
+		if ( HISTOGRAM == s->kind ) {
+			// Prometheus buckets are cumulative and inclusive ('le');
+			// since our values are integers 'v < lim' is 'v <= lim - 1'
+			cum = 0;
+			for ( k = 0; k < s->bucketCounts.size(); k++ ) {
+				cum += s->bucketCounts[k];
+				if ( k == s->bucketCounts.size() - 1 ) {
+					fprintf(f, "%s_bucket{cpsw_instance=\"%u\",le=\"+Inf\"} %" PRIu64 "\n", nam.c_str(), s->instance, cum);
+				} else {
+					fprintf(f, "%s_bucket{cpsw_instance=\"%u\",le=\"%" PRIu64 "\"} %" PRIu64 "\n", nam.c_str(), s->instance, s->bucketLimits[k] - 1, cum);
+				}
+			}
+			fprintf(f, "%s_sum{cpsw_instance=\"%u\"} %" PRIu64 "\n",   nam.c_str(), s->instance, s->sum);
+			fprintf(f, "%s_count{cpsw_instance=\"%u\"} %" PRIu64 "\n", nam.c_str(), s->instance, s->value);
+		} else {
+			fprintf(f, "%s{cpsw_instance=\"%u\"} %" PRIu64 "\n", nam.c_str(), s->instance, s->value);
+		}
+	}
+}
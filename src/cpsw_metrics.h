@@ -0,0 +1,92 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_METRICS_H
+#define CPSW_METRICS_H
+
+#include <cpsw_api_user.h>
+#include <cpsw_compat.h>
+
+/* Metrics support (implementation of IMetrics).
+ *
+ * Counters live where they are updated (usually as relaxed
+ * atomics in the module itself); nothing is done on the fast
+ * path except incrementing them. Modules which want to expose
+ * their counters implement IMetricsSource and register with
+ * CMetricsRegistry while they are running. A snapshot visits
+ * all registered sources under the registry lock and has each
+ * of them report its values to a IMetricsSink.
+ */
+
+// Histogram with power-of-two buckets; recording is lock-free.
+class CMetricHistogram {
+public:
+	static const unsigned NBUCKETS = 32;
+
+private:
+	cpsw::atomic<uint64_t> buckets_[NBUCKETS];
+	cpsw::atomic<uint64_t> count_;
+	cpsw::atomic<uint64_t> sum_;
+
+	CMetricHistogram(const CMetricHistogram &);
+	CMetricHistogram & operator=(const CMetricHistogram &);
+
+public:
+	CMetricHistogram();
+
+	void record(uint64_t v)
+	{
+	unsigned b = v ? 64 - __builtin_clzll( v ) : 0;
+		if ( b >= NBUCKETS )
+			b = NBUCKETS - 1;
+		buckets_[b].fetch_add( 1, cpsw::memory_order_relaxed );
+		sum_.fetch_add( v, cpsw::memory_order_relaxed );
+		count_.fetch_add( 1, cpsw::memory_order_relaxed );
+	}
+
+	uint64_t getCount()           const { return count_.load( cpsw::memory_order_relaxed );      }
+	uint64_t getSum()             const { return sum_.load( cpsw::memory_order_relaxed );        }
+	uint64_t getBucket(unsigned i) const { return buckets_[i].load( cpsw::memory_order_relaxed ); }
+
+	// values recorded in bucket 'i' are less than this limit
+	static uint64_t getBucketLimit(unsigned i)
+	{
+		return i < NBUCKETS - 1 ? ((uint64_t)1) << i : (uint64_t)-1;
+	}
+
+	void reset();
+};
+
+class IMetricsSink {
+public:
+	virtual void counter  (const char *name, uint64_t value)            = 0;
+	virtual void gauge    (const char *name, uint64_t value)            = 0;
+	virtual void histogram(const char *name, const CMetricHistogram &h) = 0;
+
+	virtual ~IMetricsSink() {}
+};
+
+class IMetricsSource {
+public:
+	// called with the registry locked; must not block
+	virtual void collectMetrics(IMetricsSink *sink) = 0;
+
+	virtual ~IMetricsSource() {}
+};
+
+class CMetricsRegistry {
+public:
+	// adding a source which is already registered is a no-op
+	static void add(IMetricsSource *src, const char *sourceName);
+	static void remove(IMetricsSource *src);
+
+	static void snapshot(IMetrics::Snapshot *snapshot);
+};
+
+#endif
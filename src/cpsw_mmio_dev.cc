@@ -10,6 +10,7 @@
 #include <cpsw_mmio_dev.h>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <typeinfo>
 
 #include <cpsw_yaml.h>
 #include <cpsw_async_io.h>
@@ -150,6 +151,33 @@ CWriteArgs nargs = *args;
 	return rval;
 }
 
+bool CMMIOAddressImpl::compilePlan(CompositePathIterator *node, CAccessPlan *plan) const
+{
+int f = (*node)->idxf_;
+int t = (*node)->idxt_;
+
+	// a subclass may route I/O differently
+	if ( typeid( *this ) != typeid( CMMIOAddressImpl ) ) {
+		return false;
+	}
+
+	if ( ! plan->hasElements() ) {
+		// the leaf defines the elements
+		plan->setElements( this->offset_ + f * getStride(), getStride(), t - f + 1, getEntryImpl()->getCacheable() );
+	} else if ( f == t ) {
+		plan->addOffset( this->offset_ + f * getStride() );
+	} else {
+		// multi-dimensional arrays are not planned
+		return false;
+	}
+
+	++(*node);
+	if ( node->atEnd() ) {
+		return false;
+	}
+	return (*node)->c_p_->compilePlan( node, plan );
+}
+
 void CMMIOAddressImpl::attach(EntryImpl child)
 {
 	if ( IMMIODev::STRIDE_AUTO == stride_ ) {
@@ -49,6 +49,7 @@ class CMMIOAddressImpl : public CAddressImpl {
 		virtual void dump(FILE *f) const;
 		virtual uint64_t  read(CompositePathIterator *node, CReadArgs  *args) const;
 		virtual uint64_t write(CompositePathIterator *node, CWriteArgs *args) const;
+		virtual bool     compilePlan(CompositePathIterator *node, CAccessPlan *plan) const;
 		virtual void attach(EntryImpl child);
 		virtual void dumpYamlPart(YAML::Node &) const;
 };
@@ -10,6 +10,7 @@
 #include <cpsw_path.h>
 #include <cpsw_hub.h>
 #include <cpsw_obj_cnt.h>
+#include <cpsw_config_loader.h>
 #include <string>
 
 #include <stdio.h>
@@ -42,12 +43,15 @@ Dev IDev::getRootDev()
 
 class CPathImpl : public PathEntryContainer, public IPathImpl {
 private:
-	ConstDevImpl originDev_;
+	ConstDevImpl   originDev_;
+	// only set while loading/dumping a configuration; not copied
+	CConfigLoader *loader_;
+	CConfigDumper *dumper_;
 
 public:
 	CPathImpl();
 	CPathImpl(Hub);
-	CPathImpl(DevImpl);
+	CPathImpl(ConstDevImpl);
 
 	CPathImpl(const CPathImpl&);
 
@@ -67,6 +71,14 @@ public:
 	CPathImpl::const_iterator begin() const;
 
 	virtual Path     findByName(const char *name) const;
+	virtual std::vector<Path> findByNames(const std::vector<std::string> &names) const;
+
+	// append the entries 'name' resolves to; if 'idx' is non-NULL then
+	// 'name' must point into 'full' and the prefixes of 'full' which
+	// end at a separator (i.e., hubs) are recorded there.
+	virtual void     resolve(const char *name, CPathIndex *idx, const char *full);
+	// resolve 'name' relative to the (empty) path using the origin's index
+	virtual void     resolveIndexed(const char *name);
 	virtual Path     clone()                      const;
 	virtual PathImpl cloneAsPathImpl()            const;
 
@@ -145,6 +157,7 @@ public:
 	virtual void        explore(IPathVisitor *) const;
 
 	virtual uint64_t    processYamlConfig(YAML::Node &, bool) const;
+	uint64_t            dispatchYamlConfig(PathImpl, YAML::Node &, bool) const;
 
 	virtual uint64_t    dumpConfigToYaml(YAML::Node &node)    const
 	{
@@ -162,6 +175,18 @@ public:
 		return loadConfigFromYaml( conf );
 	}
 
+	virtual void        flush()                               const;
+
+	virtual CConfigLoader *getConfigLoader()                  const
+	{
+		return loader_;
+	}
+
+	virtual CConfigDumper *getConfigDumper()                  const
+	{
+		return dumper_;
+	}
+
 	virtual ~CPathImpl();
 
 protected:
@@ -213,7 +238,7 @@ IPathImpl * IPathImpl::toPathImpl(Path p)
 }
 
 CPathImpl::CPathImpl()
-: PathEntryContainer(), originDev_(theRootDev)
+: PathEntryContainer(), originDev_(theRootDev), loader_(0), dumper_(0)
 {
 	// maintain an empty marker element so that the back iterator
 	// can easily detect the end of the list
@@ -228,13 +253,17 @@ CPathImpl::~CPathImpl()
 
 CPathImpl::CPathImpl(const CPathImpl &in)
 : PathEntryContainer(in),
-  originDev_(in.originDev_)
+  originDev_(in.originDev_),
+  loader_(0),
+  dumper_(0)
 {
 	++ocnt();
 }
 
 CPathImpl::CPathImpl(Hub h)
-: PathEntryContainer()
+: PathEntryContainer(),
+  loader_(0),
+  dumper_(0)
 {
 ConstDevImpl c = dynamic_pointer_cast<ConstDevImpl::element_type, Hub::element_type>(h);
 
@@ -248,9 +277,11 @@ ConstDevImpl c = dynamic_pointer_cast<ConstDevImpl::element_type, Hub::element_t
 	++ocnt();
 }
 
-CPathImpl::CPathImpl(DevImpl c)
+CPathImpl::CPathImpl(ConstDevImpl c)
 : PathEntryContainer(),
-  originDev_(c ? c : theRootDev)
+  originDev_(c ? c : theRootDev),
+  loader_(0),
+  dumper_(0)
 {
 	// maintain an empty marker element so that the back iterator
 	// can easily detect the end of the list
@@ -442,6 +473,11 @@ Path IPath::create(Hub h)
 	return Path( cpsw::make_shared<CPathImpl>( h ) );
 }
 
+Path IPathImpl::create(ConstDevImpl origin)
+{
+	return Path( cpsw::make_shared<CPathImpl>( origin ) );
+}
+
 
 // scan a decimal number;
 // ASSUMPTIONS: from < to on entry
@@ -458,12 +494,105 @@ char         *endp;
 	return (int)rval;
 }
 
+CPathIndex::CPathIndex(unsigned capacity)
+: mtx_     ( false, "CPathIndex" ),
+  capacity_( capacity            )
+{
+}
+
+bool
+CPathIndex::lookup(const std::string &key, PathEntryContainer *path)
+{
+CMtxLazy::lg  guard( mtx_ );
+Map::iterator it = map_.find( key );
+
+	if ( it == map_.end() ) {
+		return false;
+	}
+	lru_.splice( lru_.begin(), lru_, it->second.lru_ );
+	*path = it->second.path_;
+	return true;
+}
+
+void
+CPathIndex::insert(const std::string &key, const PathEntryContainer &path)
+{
+CMtxLazy::lg                   guard( mtx_ );
+std::pair<Map::iterator, bool> ins = map_.insert( Map::value_type( key, Entry() ) );
+Map::iterator                  victim;
+
+	if ( ! ins.second ) {
+		// another thread resolved the same name
+		return;
+	}
+	ins.first->second.path_ = path;
+	lru_.push_front( &ins.first->first );
+	ins.first->second.lru_  = lru_.begin();
+
+	if ( map_.size() > capacity_ ) {
+		victim = map_.find( *lru_.back() );
+		lru_.pop_back();
+		map_.erase( victim );
+	}
+}
+
+unsigned
+CPathIndex::size()
+{
+CMtxLazy::lg guard( mtx_ );
+	return map_.size();
+}
+
 Path CPathImpl::findByName(const char *s) const
 {
+PathImpl rval = cpsw::make_shared<CPathImpl>( *this );
+
+	if ( empty() ) {
+		rval->resolveIndexed( s );
+	} else {
+		rval->resolve( s, 0, 0 );
+	}
+	return rval;
+}
+
+std::vector<Path> CPathImpl::findByNames(const std::vector<std::string> &names) const
+{
+std::vector<Path> rval;
+unsigned          i;
+
+	rval.reserve( names.size() );
+	for ( i = 0; i < names.size(); i++ ) {
+		rval.push_back( findByName( names[i].c_str() ) );
+	}
+	return rval;
+}
+
+void CPathImpl::resolveIndexed(const char *s)
+{
+CPathIndex             *idx = originDev_->getPathIndex();
+std::string             key( s );
+std::string::size_type  pos;
+
+	// avoid repeated reallocation while resolving
+	reserve( 16 );
+
+	// resume from the longest prefix already known
+	for ( pos = key.rfind( '/' ); std::string::npos != pos && pos > 0; pos = key.rfind( '/', pos - 1 ) ) {
+		key.resize( pos );
+		if ( idx->lookup( key, this ) ) {
+			resolve( s + pos, idx, s );
+			return;
+		}
+	}
+
+	resolve( s, idx, s );
+}
+
+void CPathImpl::resolve(const char *s, CPathIndex *idx, const char *full)
+{
 Address      found;
 ConstDevImpl h;
-Path         rval = cpsw::make_shared<CPathImpl>( *this );
-CPathImpl    *p   = _toPathImpl( rval );
+CPathImpl    *p   = this;
 const char  *sl;
 
 shared_ptr<const EntryImpl::element_type> tailp;
@@ -499,7 +628,7 @@ CPSW::sDbg() <<"starting at: "<<found->getName() << "\n";
 
 		if ( ! *s ) {
 			// end of string reached; (this handles trailing slashes)
-			return rval;
+			return;
 		}
 
 		sl = strchr(s,'/');
@@ -573,11 +702,13 @@ CPSW::sDbg() <<"starting at: "<<found->getName() << "\n";
 
 			p->push_back( PathEntry(found, idxf, idxt, p->getNelms()) );
 
+			if ( idx && sl ) {
+				idx->insert( std::string( full, sl - full ), *p );
+			}
+
 		}
 
 	} while ( (s = sl) != NULL );
-
-	return rval;
 }
 
 ConstDevImpl CPathImpl::parentAsDevImpl() const
@@ -753,13 +884,72 @@ CPathImpl::explore_r(struct explorer_ctxt *ctxt)
 uint64_t
 CPathImpl::processYamlConfig(YAML::Node &template_node, bool doDump) const
 {
+PathImpl      p = cloneAsPathImpl();
+CConfigLoader ldr;
+CConfigDumper dmp;
+uint64_t      rval;
+
+	// hand the loader/dumper down the hierarchy; a top-level
+	// load executes the last phase, a top-level dump runs the
+	// prefetch pass first.
+	p->loader_ = doDump ? 0 : ( loader_ ? loader_ : &ldr );
+	p->dumper_ = doDump ? ( dumper_ ? dumper_ : &dmp ) : 0;
+
+	if ( p->dumper_ == &dmp ) {
+		// prefetch pass; work on a copy as the template is modified
+		YAML::Node scratch;
+		if ( template_node && ! template_node.IsNull() ) {
+			scratch = YAML::Clone( template_node );
+		}
+		dispatchYamlConfig( p, scratch, doDump );
+		dmp.execute();
+	}
+
+	rval = dispatchYamlConfig( p, template_node, doDump );
+
+	if ( p->loader_ == &ldr ) {
+		ldr.barrier();
+	}
+
+	return rval;
+}
+
+uint64_t
+CPathImpl::dispatchYamlConfig(PathImpl p, YAML::Node &template_node, bool doDump) const
+{
+uint64_t rval;
+
 	if ( empty() ) {
 		if ( ! originDev_ ) {
 			throw InvalidPathError("dumpConfigToYaml() called on an empty Path");
 		}
-		return originDev_->processYamlConfig( clone(), template_node, doDump );
+		rval = originDev_->processYamlConfig( p, template_node, doDump );
 	} else {
-		return back().c_p_->getEntryImpl()->processYamlConfig( clone(), template_node, doDump );
+		rval = back().c_p_->getEntryImpl()->processYamlConfig( p, template_node, doDump );
+	}
+
+	return rval;
+}
+
+void
+CPathImpl::flush() const
+{
+CPathImpl::const_iterator it;
+CPSWErrorHdl              err;
+
+	// flush all address spaces along the path; report the first error
+	for ( it = begin(); it != end(); ++it ) {
+		try {
+			it->c_p_->flush();
+		} catch ( CPSWError &e ) {
+			if ( ! err ) {
+				err = e.clone();
+			}
+		}
+	}
+
+	if ( err ) {
+		err->throwMe();
 	}
 }
 
@@ -12,7 +12,10 @@
 
 #include <list>
 #include <vector>
+#include <string>
 #include <cpsw_api_user.h>
+#include <cpsw_compat.h>
+#include <cpsw_mutex.h>
 
 #include <cstdarg>
 
@@ -22,6 +25,9 @@ typedef shared_ptr<IAddress> Address;
 class CDevImpl;
 typedef shared_ptr<const CDevImpl> ConstDevImpl;
 
+class CConfigLoader;
+class CConfigDumper;
+
 struct PathEntry {
 	Address  c_p_;
 	shared_ptr<void> address_pvt_; // address may attach context to be used by read/write
@@ -80,15 +86,66 @@ class CompositePathIterator : public PathEntryContainer::const_reverse_iterator
 		void dump(FILE *f) const;
 };
 
+/* Cache of (hub) paths resolved by 'findByName' relative to the
+ * device owning the index; maps the prefixes of the names looked
+ * up (up to a '/' separator) to the resolved path entries so that
+ * only the trailing component(s) of a name have to be resolved.
+ *
+ * Addresses are never removed from a hierarchy, hence a resolved
+ * path never becomes stale; least-recently used entries are evicted
+ * once the capacity is exceeded. The entries do not hold a reference
+ * to the origin (the owner of the index) thus there is no cycle.
+ */
+class CPathIndex {
+public:
+	static const unsigned DFLT_CAPACITY = 4096;
+
+private:
+	typedef std::list<const std::string *>   Lru;
+
+	struct Entry {
+		PathEntryContainer path_;
+		Lru::iterator      lru_;
+	};
+
+	typedef cpsw::unordered_map<std::string, Entry> Map;
+
+	CMtxLazy  mtx_;
+	Map       map_;
+	Lru       lru_;       // most recently used first
+	unsigned  capacity_;
+
+	CPathIndex(const CPathIndex &);
+	CPathIndex & operator=(const CPathIndex &);
+
+public:
+	CPathIndex(unsigned capacity = DFLT_CAPACITY);
+
+	// copy the entries of the path cached under 'key' into 'path';
+	// returns false if there is no such entry.
+	bool     lookup(const std::string &key, PathEntryContainer *path);
+
+	void     insert(const std::string &key, const PathEntryContainer &path);
+
+	unsigned size();
+};
+
 class IPathImpl : public IPath {
 public:
 	virtual void         append(Address, int f, int t) = 0;
 	virtual PathEntry    tailAsPathEntry() const = 0;
 	virtual ConstDevImpl originAsDevImpl() const = 0;
 	virtual ConstDevImpl parentAsDevImpl() const = 0;
+	// non-NULL while loading a configuration
+	virtual CConfigLoader *getConfigLoader() const = 0;
+	// non-NULL while dumping a configuration
+	virtual CConfigDumper *getConfigDumper() const = 0;
 
 	static  IPathImpl   *toPathImpl(Path p);
 
+	// like IPath::create(Hub) but without the (expensive) cross-cast
+	static  Path         create(ConstDevImpl origin);
+
 };
 
 class SlicedPathIterator : public CompositePathIterator {
@@ -231,18 +231,92 @@ IPortImpl::getUpstreamPort()
 	return upstrm ? upstrm->close() : ProtoPort();
 }
 
-CPortImpl::CPortImpl(unsigned n)
-: outputQueue_( n > 0 ? IBufQueue::create( n ) : BufQueue() ),
-  depth_(n)
+CPortImpl::CPortImpl(unsigned n, bool lockFree)
+: outputQueue_( n > 0 ? IBufQueue::create( n, lockFree ) : BufQueue() ),
+  depth_(n),
+  lockFree_(lockFree),
+  qFill_(0),
+  qHwm_(0),
+  qFullDrops_(0),
+  spaceWanted_(false)
 {
 }
 
+void
+CPortImpl::notePush(bool ok)
+{
+int fill, hwm;
+	if ( ! ok ) {
+		qFullDrops_.fetch_add( 1, cpsw::memory_order_relaxed );
+		return;
+	}
+	fill = qFill_.fetch_add( 1, cpsw::memory_order_relaxed ) + 1;
+	hwm  = qHwm_.load( cpsw::memory_order_relaxed );
+	while ( fill > hwm && ! qHwm_.compare_exchange_weak( hwm, fill, cpsw::memory_order_relaxed ) )
+		/* retry */;
+}
+
+BufChain
+CPortImpl::notePop(BufChain bc)
+{
+	if ( bc ) {
+		qFill_.fetch_sub( 1, cpsw::memory_order_relaxed );
+		if ( spaceWanted_.load() && spaceWanted_.exchange( false ) ) {
+			outputSpaceAvailable();
+		}
+	}
+	return bc;
+}
+
+void
+CPortImpl::requestOutputSpace()
+{
+	spaceWanted_.store( true );
+}
+
+bool
+CPortImpl::cancelOutputSpaceRequest()
+{
+	return spaceWanted_.exchange( false );
+}
+
+void
+CPortImpl::collectQueueMetrics(IMetricsSink *sink, const char *prefix)
+{
+char nam[100];
+int  fill;
+
+	if ( ! outputQueue_ )
+		return;
+
+	if ( ! prefix )
+		prefix = "";
+
+	// push/pop accounting is not atomic with the queue
+	// operation itself; the fill level may transiently be off
+	fill = qFill_.load( cpsw::memory_order_relaxed );
+	snprintf(nam, sizeof(nam), "%squeue_fill", prefix);
+	sink->gauge( nam, fill < 0 ? 0 : fill );
+	snprintf(nam, sizeof(nam), "%squeue_hwm", prefix);
+	sink->gauge( nam, qHwm_.load( cpsw::memory_order_relaxed ) );
+	snprintf(nam, sizeof(nam), "%squeue_depth", prefix);
+	sink->gauge( nam, depth_ );
+	snprintf(nam, sizeof(nam), "%squeue_full_drops", prefix);
+	sink->counter( nam, qFullDrops_.load( cpsw::memory_order_relaxed ) );
+}
+
 unsigned
 CPortImpl::getQueueDepth() const
 {
 	return depth_;
 }
 
+bool
+CPortImpl::hasLockFreeQueue() const
+{
+	return lockFree_;
+}
+
 IEventSource *
 CPortImpl::getReadEventSource()
 {
@@ -284,16 +358,16 @@ CPortImpl::pop(const CTimeout *timeout, bool abs_timeout)
 		return bc;
 	} else {
 		if ( ! timeout || timeout->isIndefinite() )
-			return outputQueue_->pop( 0 );
+			return notePop( outputQueue_->pop( 0 ) );
 		else if ( timeout->isNone() )
-			return outputQueue_->tryPop();
+			return notePop( outputQueue_->tryPop() );
 
 		if ( ! abs_timeout ) {
 			// arg is rel-timeout
 			CTimeout abst( getAbsTimeoutPop( timeout ) );
-			return outputQueue_->pop( &abst );
+			return notePop( outputQueue_->pop( &abst ) );
 		} else {
-			return outputQueue_->pop( timeout );
+			return notePop( outputQueue_->pop( timeout ) );
 		}
 	}
 }
@@ -315,6 +389,8 @@ CPortImpl::pushDownstream(BufChain bc, const CTimeout *rel_timeout)
 			rval = outputQueue_->push( bc, &abst );
 		}
 
+		notePush( rval );
+
 		if ( rval ) {
 			// just went offline - drain
 			while ( ! isOpen() && tryPop() )
@@ -350,7 +426,7 @@ CPortImpl::tryPop()
 				;
 		return bc;
 	} else {
-		return outputQueue_->tryPop();
+		return notePop( outputQueue_->tryPop() );
 	}
 }
 
@@ -399,6 +475,7 @@ CProtoModBase::modStartupOnce()
 {
 	if ( 0 == started_++ ) {
 		modStartup();
+		CMetricsRegistry::add( this, getName() );
 	}
 }
 
@@ -410,10 +487,16 @@ CProtoModBase::modShutdownOnce()
 		throw InternalError("Protocol Module startup count <= 0");
 	}
 	if ( 0 == --started_ ) {
+		CMetricsRegistry::remove( this );
 		modShutdown();
 	}
 }
 
+CProtoModBase::~CProtoModBase()
+{
+	CMetricsRegistry::remove( this );
+}
+
 void
 CProtoModImpl::modStartup()
 {
@@ -468,9 +551,9 @@ CProtoMod::getSelfAsProtoPort()
 	return getSelfAs< shared_ptr<CProtoMod> >();
 }
 
-CProtoMod::CProtoMod(Key &k, unsigned n)
+CProtoMod::CProtoMod(Key &k, unsigned n, bool lockFree)
 : CShObj(k),
-  CPortImpl(n)
+  CPortImpl(n, lockFree)
 {
 }
 
@@ -481,6 +564,12 @@ CProtoMod::pushDown(BufChain bc, const CTimeout *rel_timeout)
 	return pushDownstream( bc, rel_timeout );
 }
 
+void
+CProtoMod::collectMetrics(IMetricsSink *sink)
+{
+	collectQueueMetrics( sink );
+}
+
 ProtoMod
 CProtoMod::getProtoMod()
 {
@@ -18,6 +18,7 @@
 #include <cpsw_buf.h>
 #include <cpsw_shared_obj.h>
 #include <cpsw_event.h>
+#include <cpsw_metrics.h>
 
 using cpsw::weak_ptr;
 
@@ -291,7 +292,7 @@ public:
 };
 
 
-class IProtoMod {
+class IProtoMod : public IMetricsSource {
 public:
 	// to be called by the upstream module's addAtPort() method
 	// (which is protocol specific)
@@ -345,9 +346,32 @@ private:
 	weak_ptr< ProtoMod::element_type > downstream_;
 	BufQueue                           outputQueue_;
 	unsigned                           depth_;
+	bool                               lockFree_;
+	// output queue statistics
+	cpsw::atomic<int>                  qFill_;
+	cpsw::atomic<int>                  qHwm_;
+	cpsw::atomic<uint64_t>             qFullDrops_;
+	cpsw::atomic<bool>                 spaceWanted_;
+
+	void             notePush(bool ok);
+	BufChain         notePop(BufChain bc);
 
 protected:
 
+	// A producer which must not block on a full output queue may
+	// ask to be notified: the next consumer which pops an element
+	// executes 'outputSpaceAvailable()' (once per request).
+	// The producer should retry after requesting since the queue
+	// may have been drained meanwhile; 'cancelOutputSpaceRequest()'
+	// returns 'true' if the request was still pending (i.e., no
+	// notification has been or will be executed).
+	void             requestOutputSpace();
+	bool             cancelOutputSpaceRequest();
+
+	virtual void     outputSpaceAvailable()
+	{
+	}
+
 	CPortImpl(const CPortImpl &orig)
 	{
 		// would have to set downstream_ to
@@ -376,10 +400,16 @@ protected:
 
 public:
 
-	CPortImpl(unsigned n);
+	CPortImpl(unsigned n, bool lockFree = false);
 
 	virtual unsigned getQueueDepth() const;
 
+	virtual bool     hasLockFreeQueue() const;
+
+	// report fill level, high-water mark and overflows of the
+	// output queue; names are prefixed with 'prefix' (if non-NULL)
+	virtual void     collectQueueMetrics(IMetricsSink *sink, const char *prefix = 0);
+
 	virtual IEventSource *getReadEventSource();
 
 	virtual void      addAtPort(ProtoMod downstream);
@@ -423,6 +453,13 @@ public:
 	virtual void modStartupOnce();
 	virtual void modShutdownOnce();
 
+	// modules are registered as a metrics source while they are running;
+	// by default there is nothing to report.
+	virtual void collectMetrics(IMetricsSink *sink)
+	{
+	}
+
+	virtual ~CProtoModBase();
 };
 
 class CProtoModImpl : public CProtoModBase {
@@ -456,7 +493,7 @@ protected:
 	virtual ProtoPort getSelfAsProtoPort();
 
 public:
-	CProtoMod(Key &k, unsigned n);
+	CProtoMod(Key &k, unsigned n, bool lockFree = false);
 
 	virtual bool pushDown(BufChain bc, const CTimeout *rel_timeout);
 
@@ -464,6 +501,8 @@ public:
 
 	virtual ProtoMod getProtoMod();
 
+	virtual void collectMetrics(IMetricsSink *sink);
+
 	virtual ~CProtoMod()
 	{
 	}
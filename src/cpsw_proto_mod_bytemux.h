@@ -95,6 +95,19 @@ public:
 		}
 	}
 
+	virtual void collectMetrics(IMetricsSink *sink)
+	{
+	unsigned slot;
+	char     prefix[30];
+		for ( slot = 0; slot < sizeof(downstream_)/sizeof(downstream_[0]); slot++ ) {
+			PORT p = downstream_[slot].lock();
+			if ( p ) {
+				snprintf( prefix, sizeof(prefix), "port%u_", (unsigned)p->getDest() );
+				p->collectQueueMetrics( sink, prefix );
+			}
+		}
+	}
+
 	// derived class usually implements a 'newPort' method
 	// taking 'dest' and additional args 'args':
 	//     PORT newPort(dest, args...)
@@ -189,9 +202,9 @@ protected:
 	}
 
 public:
-	CByteMuxPort(Key &k, OwnerType owner, int dest, unsigned queueDepth)
+	CByteMuxPort(Key &k, OwnerType owner, int dest, unsigned queueDepth, bool lockFreeQueue = false)
 	: CShObj(k),
-	  CPortImpl(queueDepth),
+	  CPortImpl(queueDepth, lockFreeQueue),
 	  dest_(dest),
 	  owner_(owner)
 	{
@@ -43,10 +43,15 @@ void CFrame::updateChain()
 {
 unsigned idx = oldestFrag_ & (fragWin_.size() - 1);
 	while ( fragWin_[idx] ) {
-		Buf b;
-		while ( (b = fragWin_[idx]->getHead()) ) {
-			b->unlink();
-			prod_->addAtTail( b );
+		if ( ! prod_ ) {
+			// adopt the first fragment's chain
+			prod_ = fragWin_[idx];
+		} else {
+			Buf b;
+			while ( (b = fragWin_[idx]->getHead()) ) {
+				b->unlink();
+				prod_->addAtTail( b );
+			}
 		}
 		nFrags_++;
 		fragWin_[idx].reset();
@@ -57,8 +62,8 @@ unsigned idx = oldestFrag_ & (fragWin_.size() - 1);
 }
 
 
-CProtoModDepack::CProtoModDepack(Key &k, unsigned oqueueDepth, unsigned ldFrameWinSize, unsigned ldFragWinSize, CTimeout timeout, int threadPrio)
-	: CProtoMod(k, oqueueDepth),
+CProtoModDepack::CProtoModDepack(Key &k, unsigned oqueueDepth, unsigned ldFrameWinSize, unsigned ldFragWinSize, CTimeout timeout, int threadPrio, bool lockFreeQueue)
+	: CProtoMod(k, oqueueDepth, lockFreeQueue),
 	  CRunnable("'Depacketizer' protocol module", threadPrio),
 	  badHeaderDrops_(0),
 	  oldFrameDrops_(0),
@@ -310,10 +315,13 @@ Buf bh = bc->getHead();
 	if ( CFrame::NO_FRAME == frame->frameID_ ) {
 		// first frag of a frame -- may accept
 
-		// Looks good
-		frame->prod_             = IBufChain::create();
+		// Looks good; the output chain is created lazily
+		// by adopting the first fragment (see updateChain)
 		frame->frameID_          = hdr.getFrameNo();
 
+		if ( clock_gettime( CLOCK_MONOTONIC, &frame->firstSeen_.tv_ ) )
+			throw InternalError("clock_gettime failed", errno);
+
 #ifdef DEPACK_DEBUG
 		fprintf(CPSW::fDbg(), "First frag (%d) of frame # %d\n", hdr.getFragNo(), frame->frameID_);
 #endif
@@ -398,6 +406,8 @@ bool CProtoModDepack::releaseOldestFrame(bool onlyComplete)
 
 	BufChain completeFrame = frame->prod_;
 	bool     isComplete    = frame->isComplete(); // frame invalid after release
+	bool     isEmpty       = CFrame::NO_FRAME == frame->frameID_;
+	CTimeout firstSeen     = frame->firstSeen_;
 #ifdef DEPACK_DEBUG
 	bool     wasRunning    = frame->running_;
 #endif
@@ -420,12 +430,18 @@ bool CProtoModDepack::releaseOldestFrame(bool onlyComplete)
 #endif
 			fragsAccepted_  += l;
 			framesAccepted_ += 1;
+
+			CTimeout now;
+			if ( clock_gettime( CLOCK_MONOTONIC, &now.tv_ ) )
+				throw InternalError("clock_gettime failed", errno);
+			now -= firstSeen;
+			latencyHisto_.record( now.getUs() );
 		}
 	} else {
-		if ( completeFrame )
-			incompleteDrops_++;
-		else
+		if ( isEmpty )
 			emptyDrops_++;
+		else
+			incompleteDrops_++;
 	}
 
 	oldestFrame_ = CAxisFrameHeader::moduloFrameSz( oldestFrame_ + 1 );
@@ -560,14 +576,9 @@ void CProtoModDepack::releaseFrames(bool onlyComplete)
 
 void CProtoModDepack::startTimeout(CFrame *frame)
 {
-struct timespec now;
-
 	if ( frame->running_ )
 		return;
 
-	if ( clock_gettime( CLOCK_REALTIME, &now ) ) 
-		throw InternalError("clock_gettime failed");
-
 	frame->timeout_ = upstream_->getAbsTimeoutPop( &timeout_ );
 
 	frame->running_ = true;
@@ -635,6 +646,28 @@ bool rval = false;
 }
 
 
+void CProtoModDepack::collectMetrics(IMetricsSink *sink)
+{
+	CProtoMod::collectMetrics( sink );
+	sink->counter( "frags_accepted",       fragsAccepted_      );
+	sink->counter( "frames_accepted",      framesAccepted_     );
+	sink->counter( "bad_header_drops",     badHeaderDrops_     );
+	sink->counter( "old_frame_drops",      oldFrameDrops_      );
+	sink->counter( "new_frame_drops",      newFrameDrops_      );
+	sink->counter( "old_frag_drops",       oldFragDrops_       );
+	sink->counter( "new_frag_drops",       newFragDrops_       );
+	sink->counter( "duplicate_frag_drops", duplicateFragDrops_ );
+	sink->counter( "duplicate_last_seen",  duplicateLastSeen_  );
+	sink->counter( "no_last_seen",         noLastSeen_         );
+	sink->counter( "oqueue_full_drops",    oqueueFullDrops_    );
+	sink->counter( "evicted_frames",       evictedFrames_      );
+	sink->counter( "incomplete_drops",     incompleteDrops_    );
+	sink->counter( "empty_drops",          emptyDrops_         );
+	sink->counter( "timed_out_frames",     timedOutFrames_     );
+	sink->counter( "past_last_drops",      pastLastDrops_      );
+	sink->histogram( "reassembly_us",      latencyHisto_       );
+}
+
 void CProtoModDepack::dumpInfo(FILE *f)
 {
 	if ( ! f ) {
@@ -659,4 +692,7 @@ void CProtoModDepack::dumpInfo(FILE *f)
 	fprintf(f,"  Empty fragments dropped         : %8d\n", emptyDrops_);
 	fprintf(f,"  Incomplete Frames with Timeout  : %8d\n", timedOutFrames_);
 	fprintf(f,"  Frames past EOF dropped         : %8d\n", pastLastDrops_);
+	if ( latencyHisto_.getCount() ) {
+		fprintf(f,"  Avg. reassembly latency (us)    : %8llu\n", (unsigned long long)(latencyHisto_.getSum()/latencyHisto_.getCount()));
+	}
 }
@@ -16,6 +16,7 @@
 #include <cpsw_proto_mod.h>
 #include <cpsw_thread.h>
 #include <cpsw_proto_depack.h>
+#include <cpsw_metrics.h>
 
 #include <pthread.h>
 
@@ -32,12 +33,13 @@ public:
 	static const FrameID NO_FRAME = (FrameID)(1<<24); // so that abs(frame-NO_FRAME) never is inside any window
 	static const FragID  NO_FRAG  = (FragID)-2; // so that NO_FRAG + 1 is not a valid ID
 protected:
-	BufChain         prod_;
+	BufChain         prod_;       // chain of the first fragment; later ones are linked to it
 	FragID           nFrags_;
 	FrameID          frameID_;
 	FragID           oldestFrag_;
 	FragID           lastFrag_;
 	CTimeout         timeout_;
+	CTimeout         firstSeen_;  // arrival of the first fragment (CLOCK_MONOTONIC)
 	vector<BufChain> fragWin_;
 	bool             isComplete_;
 	bool             running_;
@@ -83,6 +85,8 @@ private:
 	unsigned timedOutFrames_;
 	unsigned pastLastDrops_;
 
+	CMetricHistogram latencyHisto_; // first fragment -> frame delivered, in us
+
 	unsigned cachedMTU_;
 
 	static const unsigned SAFE_MTU = 1024; // assume this just always fits
@@ -127,11 +131,12 @@ protected:
 	CProtoModDepack( CProtoModDepack &orig, Key &k );
 
 public:
-	CProtoModDepack(Key &k, unsigned oqueueDepth, unsigned ldFrameWinSize, unsigned ldFragWinSize, CTimeout timeout, int threadPrio);
+	CProtoModDepack(Key &k, unsigned oqueueDepth, unsigned ldFrameWinSize, unsigned ldFragWinSize, CTimeout timeout, int threadPrio, bool lockFreeQueue = false);
 
 	virtual ~CProtoModDepack();
 
 	virtual void dumpInfo(FILE *f);
+	virtual void collectMetrics(IMetricsSink *sink);
 
 	virtual unsigned getMTU();
 
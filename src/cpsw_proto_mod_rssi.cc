@@ -91,6 +91,12 @@ const CRssiConfigParams *config = getConfigParams();
 	if( deflts.rexTimeoutUS_     != config->rexTimeoutUS_     ) {
 		writeNode(parms, YAML_KEY_retransmissionTimeoutUS, config->rexTimeoutUS_ );
 	}
+	if( deflts.rexTimeoutMinUS_  != config->rexTimeoutMinUS_  ) {
+		writeNode(parms, YAML_KEY_minRetransmissionTimeoutUS, config->rexTimeoutMinUS_ );
+	}
+	if( deflts.rexTimeoutMaxUS_  != config->rexTimeoutMaxUS_  ) {
+		writeNode(parms, YAML_KEY_maxRetransmissionTimeoutUS, config->rexTimeoutMaxUS_ );
+	}
 	if( deflts.cumAckTimeoutUS_  != config->cumAckTimeoutUS_  ) {
 		writeNode(parms, YAML_KEY_cumulativeAckTimeoutUS, config->cumAckTimeoutUS_  );
 	}
@@ -106,6 +112,12 @@ const CRssiConfigParams *config = getConfigParams();
 	if( deflts.forcedSegsMax_    != config->forcedSegsMax_    ) {
 		writeNode(parms, YAML_KEY_maxSegmentSize, config->forcedSegsMax_ );
 	}
+	if( deflts.reactorThreads_   != config->reactorThreads_   ) {
+		writeNode(parms, YAML_KEY_reactorThreads, config->reactorThreads_ );
+	}
+	if( deflts.selectiveAck_     != config->selectiveAck_     ) {
+		writeNode(parms, YAML_KEY_selectiveAck, config->selectiveAck_ );
+	}
 
 	writeNode(node, YAML_KEY_RSSI, parms );
 }
@@ -189,6 +201,12 @@ CProtoModRssi::dumpInfo(FILE *f)
 	CRssi::dumpStats( f );
 }
 
+void
+CProtoModRssi::collectMetrics(IMetricsSink *sink)
+{
+	CRssi::collectStats( sink );
+}
+
 const char *
 CProtoModRssi::getName() const
 {
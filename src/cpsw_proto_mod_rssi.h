@@ -74,6 +74,7 @@ public:
 	virtual bool          pushDown(BufChain, const CTimeout *rel_timeout);
 
 	virtual void          dumpInfo(FILE *);
+	virtual void          collectMetrics(IMetricsSink *);
 
 	virtual ~CProtoModRssi();
 
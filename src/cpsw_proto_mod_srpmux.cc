@@ -55,9 +55,9 @@ INetIODev::ProtocolVersion CSRPPort::getProtoVersion()
 	return cpsw::static_pointer_cast<ProtoModSRPMux::element_type>( getProtoMod() )->getProtoVersion();
 }
 
-SRPPort CProtoModSRPMux::newPort(int dest, unsigned queueDepth)
+SRPPort CProtoModSRPMux::newPort(int dest, unsigned queueDepth, bool lockFreeQueue)
 {
-	return CShObj::create<SRPPort>( getSelfAs<ProtoModSRPMux>(), dest, queueDepth );
+	return CShObj::create<SRPPort>( getSelfAs<ProtoModSRPMux>(), dest, queueDepth, lockFreeQueue );
 }
 
 int CProtoModSRPMux::extractDest(BufChain bc)
@@ -29,7 +29,7 @@ protected:
 	{
 	}
 
-	SRPPort newPort(int dest, unsigned queueDepth);
+	SRPPort newPort(int dest, unsigned queueDepth, bool lockFreeQueue);
 
 public:
 
@@ -39,9 +39,9 @@ public:
 	{
 	}
 
-	SRPPort createPort(int dest, unsigned queueDepth)
+	SRPPort createPort(int dest, unsigned queueDepth, bool lockFreeQueue = false)
 	{
-		return addPort(dest, newPort(dest, queueDepth));
+		return addPort(dest, newPort(dest, queueDepth, lockFreeQueue));
 	}
 
 	// range of bits in TID that the downstream user may occupy
@@ -92,8 +92,8 @@ protected:
 	virtual int iMatch(ProtoPortMatchParams *cmp);
 
 public:
-	CSRPPort(Key &k, ProtoModSRPMux owner, int dest, unsigned queueDepth)
-	: CByteMuxPort<CProtoModSRPMux>(k, owner, dest, queueDepth),
+	CSRPPort(Key &k, ProtoModSRPMux owner, int dest, unsigned queueDepth, bool lockFreeQueue)
+	: CByteMuxPort<CProtoModSRPMux>(k, owner, dest, queueDepth, lockFreeQueue),
 	  queueDepth_(queueDepth)
 	{
 	}
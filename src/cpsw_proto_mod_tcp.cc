@@ -17,7 +17,9 @@
 #include <cpsw_stdio.h>
 
 #include <errno.h>
+#include <string.h>
 #include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/uio.h>
 
 #include <stdio.h>
@@ -28,8 +30,6 @@
 //#define TCP_DEBUG
 //#define TCP_DEBUG_STRM
 
-#define NBUFS_MAX 8
-
 static void xfer(
 	const char   *nm,
 	ssize_t     (*op)(int, const struct iovec*, int),
@@ -56,115 +56,193 @@ ssize_t xfr;
 	}
 }
 
-void * CProtoModTcp::CRxHandlerThread::threadBody()
+// buffers are allocated as needed; a frame lands in a single
+// one if the application provided large enough slots.
+void CProtoModTcp::CRxHandlerThread::setupIovs(uint32_t len)
 {
-	ssize_t          got,siz,cap;
-	std::vector<Buf> bufs;
-	unsigned         idx, i;
-
-	struct iovec     iov[NBUFS_MAX];
-	unsigned         niovs;
-
-	uint32_t         len;
-
-	for ( niovs = 0, cap = 0; niovs<NBUFS_MAX && cap < (ssize_t)IBuf::CAPA_ETH_JUM; niovs++ ) {
-		bufs.push_back( IBuf::getBuf( IBuf::CAPA_ETH_BIG ) );
-		iov[niovs].iov_base = bufs[niovs]->getPayload();
-		cap += (iov[niovs].iov_len  = bufs[niovs]->getAvail());
+	ssize_t siz = len;
+
+	niovs_  = 0;
+	iovIdx_ = 0;
+	while ( siz > 0 ) {
+		if ( niovs_ == NBUFS_MAX )
+			throw InternalError("Too many TCP fragments");
+		if ( ! bufs_[niovs_] ) {
+			bufs_[niovs_] = owner_->getRxBuf();
+		}
+		iov_[niovs_].iov_base = bufs_[niovs_]->getPayload();
+		iov_[niovs_].iov_len  = bufs_[niovs_]->getAvail();
+		if ( (size_t)siz >= iov_[niovs_].iov_len ) {
+			siz -= iov_[niovs_].iov_len;
+		} else {
+			iov_[niovs_].iov_len = siz;
+			siz = 0;
+		}
+		// reading modifies the iovecs
+		lens_[niovs_] = iov_[niovs_].iov_len;
+		niovs_++;
 	}
+}
 
-	while ( 1 ) {
-		uint8_t      *p;
-
-#ifdef TCP_DEBUG
-		fprintf(CPSW::fDbg(), "TCP -- waiting for data\n");
-#endif
-
-		siz = sizeof(len);
-		p   = reinterpret_cast<uint8_t*>( &len );
-		while ( siz > 0 ) {
-			if ( (got = ::read(sd_, p, siz)) <= 0 )
-				throw InternalError("TCP reading length: ", errno);
-			p   += got;
-			siz -= got;
+bool CProtoModTcp::CRxHandlerThread::readFrame(bool wait)
+{
+	ssize_t          got;
+	int              flags = wait ? 0 : MSG_DONTWAIT;
+	unsigned         i;
+	uint32_t         len;
+	struct msghdr    msg;
+
+	while ( hdrGot_ < sizeof(hdr_) ) {
+		got = ::recv( sd_, reinterpret_cast<uint8_t*>( &hdr_ ) + hdrGot_, sizeof(hdr_) - hdrGot_, flags );
+		if ( got <= 0 ) {
+			if ( got < 0 && ! wait && ( EAGAIN == errno || EWOULDBLOCK == errno ) )
+				return false;
+			throw InternalError("TCP reading length: ", errno);
 		}
-
-		len = ntohl(len);
-
+		if ( (hdrGot_ += got) == sizeof(hdr_) ) {
 #ifdef TCP_DEBUG
-		fprintf(CPSW::fDbg(), "TCP RX -- got length: %" PRId32 "\n", len);
+			fprintf(CPSW::fDbg(), "TCP RX -- got length: %" PRId32 "\n", ntohl(hdr_));
 #endif
+			setupIovs( ntohl(hdr_) );
+		}
+	}
 
-		siz = len;
-		idx = 0;
-		while ( siz > 0 ) {
-			if ( idx == niovs )
-				throw InternalError("Too many TCP fragments");
-			if ( (size_t)siz >= iov[idx].iov_len ) {
-				siz -= iov[idx].iov_len;
-			} else {
-				iov[idx].iov_len = siz;
-				siz = 0;
-			}
-			idx++;
+	while ( iovIdx_ < niovs_ ) {
+		memset( &msg, 0, sizeof(msg) );
+		msg.msg_iov    = &iov_[iovIdx_];
+		msg.msg_iovlen = niovs_ - iovIdx_;
+		got = ::recvmsg( sd_, &msg, flags );
+		if ( got <= 0 ) {
+			if ( got < 0 && ! wait && ( EAGAIN == errno || EWOULDBLOCK == errno ) )
+				return false;
+			throw InternalError( "TCP: readv() error: ", errno );
+		}
+		while ( iovIdx_ < niovs_ && (size_t)got >= iov_[iovIdx_].iov_len ) {
+			got -= iov_[iovIdx_].iov_len;
+			iovIdx_++;
+		}
+		if ( got > 0 ) {
+			iov_[iovIdx_].iov_len -= got;
+			iov_[iovIdx_].iov_base = reinterpret_cast<void*>( reinterpret_cast<uintptr_t>( iov_[iovIdx_].iov_base ) + got );
 		}
-			
-		xfer("readv()", ::readv, sd_, iov, idx, len);
+	}
+
+	len     = ntohl(hdr_);
+	hdrGot_ = 0;
 
-		nDgrams_.fetch_add(1,   cpsw::memory_order_relaxed);
-		nOctets_.fetch_add(len, cpsw::memory_order_relaxed);
+	nDgrams_.fetch_add(1,   cpsw::memory_order_relaxed);
+	nOctets_.fetch_add(len, cpsw::memory_order_relaxed);
 
-		BufChain bufch = IBufChain::create();
+	BufChain bufch = IBufChain::create();
 
-		for ( i=0; i<idx; i++ ) {
-			bufs[i]->setSize( iov[i].iov_len );
+	for ( i=0; i<niovs_; i++ ) {
+		bufs_[i]->setSize( lens_[i] );
 #ifdef TCP_DEBUG
-			if ( i == 1 ) {
-				uint8_t  *p = bufs[i]->getPayload();
+		if ( i == 1 ) {
+			uint8_t  *p = bufs_[i]->getPayload();
 #ifdef TCP_DEBUG_STRM
-				unsigned fram = (p[1]<<4) | (p[0]>>4);
-				unsigned frag = (p[4]<<16) | (p[3] << 8) | p[2];
-				fprintf(CPSW::fDbg(), "TCP: fram %d[%d]\n", fram, frag);
+			unsigned fram = (p[1]<<4) | (p[0]>>4);
+			unsigned frag = (p[4]<<16) | (p[3] << 8) | p[2];
+			fprintf(CPSW::fDbg(), "TCP: fram %d[%d]\n", fram, frag);
 #else
-				int      i;
-				fprintf(CPSW::fDbg(), "TCP got %d data: ",(int)len);
-				for ( i=0; i< (len < 20 ? len : 20); i++ )
-					fprintf(CPSW::fDbg(), "%02x ", p[i]);
-				fprintf(CPSW::fDbg(), "\n");
+			int      i;
+			fprintf(CPSW::fDbg(), "TCP got %d data: ",(int)len);
+			for ( i=0; i< (len < 20 ? len : 20); i++ )
+				fprintf(CPSW::fDbg(), "%02x ", p[i]);
+			fprintf(CPSW::fDbg(), "\n");
 #endif
-			}
+		}
 #endif
 
-			bufch->addAtTail( bufs[i] );
+		bufch->addAtTail( bufs_[i] );
 
-			// get new buffers
-			bufs[i] = IBuf::getBuf( IBuf::CAPA_ETH_BIG );
-			iov[i].iov_base = bufs[i]->getPayload();
-			iov[i].iov_len  = bufs[i]->getAvail();
-		}
+		// get new buffers next time around
+		bufs_[i].reset();
+	}
+	niovs_ = 0;
+
+	if ( ! wait ) {
+		// must not block the (shared) I/O engine thread
+		pending_ = bufch;
+		return forwardPending();
+	}
 
+	// dedicated thread; TCP flow control throttles the peer
+	owner_->pushDown( bufch, &TIMEOUT_INDEFINITE );
+
+	return true;
+}
+
+bool CProtoModTcp::CRxHandlerThread::forwardPending()
+{
+bool stalled = false;
+
+	while ( ! owner_->pushDown( pending_, &TIMEOUT_NONE ) ) {
+		if ( stalled ) {
+			// reading is resumed by the consumer
 #ifdef TCP_DEBUG
-		bool st=
+			fprintf(CPSW::fDbg(), "TCP -- queue full; RX stalled\n");
 #endif
+			return false;
+		}
+		nRxStalls_.fetch_add( 1, cpsw::memory_order_relaxed );
+		// TCP flow control throttles the peer meanwhile
+		owner_->stallRx();
+		stalled = true;
+		// retry; the consumer may have made room before the request was posted
+	}
 
-			owner_->pushDown( bufch, &TIMEOUT_INDEFINITE );
+	pending_.reset();
+
+	if ( stalled && owner_->cancelOutputSpaceRequest() ) {
+		// nobody else is going to resume reading
+		owner_->outputSpaceAvailable();
+	}
 
+	return true;
+}
+
+void * CProtoModTcp::CRxHandlerThread::threadBody()
+{
+	while ( 1 ) {
 #ifdef TCP_DEBUG
-			if ( st )
-				fprintf(CPSW::fDbg(), " (pushdown SUCC)\n");
-			else
-				fprintf(CPSW::fDbg(), " (pushdown DROP)\n");
+		fprintf(CPSW::fDbg(), "TCP -- waiting for data\n");
 #endif
-
+		readFrame( true );
 	}
 	return NULL;
 }
 
+// the engine comes back if there is more
+#define ENGINE_RX_FRAMES 16
+
+void CProtoModTcp::CRxHandlerThread::handleInput()
+{
+	unsigned i;
+
+	try {
+		if ( pending_ && ! forwardPending() )
+			return;
+		for ( i = 0; i < ENGINE_RX_FRAMES && readFrame( false ); i++ )
+			;
+	} catch ( CPSWError &e ) {
+		// the connection is dead; don't let it spin the engine
+		fprintf(CPSW::fErr(), "%s -- disabling TCP RX\n", e.getInfo().c_str());
+		owner_->ioEngine_->disable( sd_ );
+	}
+}
+
 CProtoModTcp::CRxHandlerThread::CRxHandlerThread(const char *name, int threadPriority, int sd, CProtoModTcp *owner)
 : CRunnable(name, threadPriority),
   sd_(sd),
   nOctets_(0),
   nDgrams_(0),
+  nRxStalls_(0),
+  hdr_(0),
+  hdrGot_(0),
+  bufs_(NBUFS_MAX),
+  niovs_(0),
+  iovIdx_(0),
   owner_(owner)
 {
 }
@@ -174,6 +252,12 @@ CProtoModTcp::CRxHandlerThread::CRxHandlerThread(CRxHandlerThread &orig, int sd,
   sd_(sd),
   nOctets_(0),
   nDgrams_(0),
+  nRxStalls_(0),
+  hdr_(0),
+  hdrGot_(0),
+  bufs_(NBUFS_MAX),
+  niovs_(0),
+  iovIdx_(0),
   owner_(owner)
 {
 }
@@ -191,12 +275,48 @@ void CProtoModTcp::createThread(int threadPriority)
 
 void CProtoModTcp::modStartup()
 {
-	if ( rxHandler_ )
+	if ( ! rxHandler_ )
+		return;
+	if ( ioEngineThreads_ ) {
+		if ( ! ioEngine_ ) {
+			ioEngine_ = CIoEngine::get( ioEngineThreads_, rxHandler_->getPrio() );
+			{
+			CMtx::lg guard( &rxMtx_ );
+				rxEnabled_ = true;
+			}
+			ioEngine_->add( rxHandler_->getSd(), rxHandler_ );
+		}
+	} else {
 		rxHandler_->threadStart();
+	}
+}
+
+void CProtoModTcp::stallRx()
+{
+	ioEngine_->disable( rxHandler_->getSd() );
+	requestOutputSpace();
+}
+
+// executed by the consumer which made room (or by the RX handler)
+void CProtoModTcp::outputSpaceAvailable()
+{
+CMtx::lg guard( &rxMtx_ );
+	if ( rxEnabled_ ) {
+		ioEngine_->enable( rxHandler_->getSd(), rxHandler_ );
+	}
 }
 
 void CProtoModTcp::modShutdown()
 {
+	if ( ioEngine_ ) {
+		{
+		// nobody must re-enable the descriptor once it has been removed
+		CMtx::lg guard( &rxMtx_ );
+			rxEnabled_ = false;
+		}
+		ioEngine_->remove( rxHandler_->getSd() );
+		ioEngine_.reset();
+	}
 	if ( rxHandler_ )
 		rxHandler_->threadStop();
 }
@@ -207,14 +327,19 @@ CProtoModTcp::CProtoModTcp(
 	unsigned                  depth,
 	int                       threadPriority,
 	const LibSocksProxy      *proxy,
-	const struct sockaddr_in *via
+	const struct sockaddr_in *via,
+	bool                      lockFreeQueue,
+	unsigned                  ioEngineThreads
 )
-:CProtoMod(k, depth),
+:CProtoMod(k, depth, lockFreeQueue),
  dest_     (*dest               ),
  via_      ( via ? *via : *dest ),
  sd_       (SOCK_STREAM, proxy  ),
  nTxOctets_(0                   ),
  nTxDgrams_(0                   ),
+ ioEngineThreads_(ioEngineThreads),
+ rxMtx_    ("TCP RX"            ),
+ rxEnabled_(false               ),
  rxHandler_(NULL                )
 {
 	sd_.init( &via_, 0, false );
@@ -231,7 +356,13 @@ int prio = rxHandler_->getPrio();
 	if ( prio != IProtoStackBuilder::DFLT_THREAD_PRIORITY ) {
 		writeNode(tcpParms, YAML_KEY_threadPriority, prio);
 	}
+	if ( ioEngineThreads_ > 0 ) {
+		writeNode(tcpParms, YAML_KEY_ioEngineThreads, ioEngineThreads_);
+	}
 	writeNode(node, YAML_KEY_TCP, tcpParms);
+	if ( hasLockFreeQueue() ) {
+		writeNode(node, YAML_KEY_lockFreeQueues, true);
+	}
 }
 
 CProtoModTcp::CProtoModTcp(CProtoModTcp &orig, Key &k)
@@ -240,12 +371,31 @@ CProtoModTcp::CProtoModTcp(CProtoModTcp &orig, Key &k)
  via_ (orig.via_ ),
  sd_  (orig.sd_  ),
  nTxOctets_(0),
- nTxDgrams_(0)
+ nTxDgrams_(0),
+ rxPool_(orig.rxPool_),
+ ioEngineThreads_(orig.ioEngineThreads_),
+ rxMtx_("TCP RX"),
+ rxEnabled_(false),
+ rxHandler_(NULL)
 {
 	sd_.init( &via_, 0, false );
 	createThread( orig.rxHandler_->getPrio() );
 }
 
+void CProtoModTcp::setRxBufPool(BufPool pool)
+{
+	rxPool_ = pool;
+}
+
+Buf CProtoModTcp::getRxBuf()
+{
+Buf rval;
+	if ( ! rxPool_ || ! (rval = rxPool_->getBuf()) ) {
+		rval = IBuf::getBuf( IBuf::CAPA_ETH_BIG );
+	}
+	return rval;
+}
+
 uint64_t CProtoModTcp::getNumRxOctets()
 {
 	return rxHandler_ ? rxHandler_->getNumOctets() : 0;
@@ -256,6 +406,11 @@ uint64_t CProtoModTcp::getNumRxDgrams()
 	return rxHandler_ ? rxHandler_->getNumDgrams() : 0;
 }
 
+uint64_t CProtoModTcp::getNumRxStalls()
+{
+	return rxHandler_ ? rxHandler_->getNumRxStalls() : 0;
+}
+
 CProtoModTcp::~CProtoModTcp()
 {
 	if ( rxHandler_ )
@@ -271,10 +426,22 @@ void CProtoModTcp::dumpInfo(FILE *f)
 	fprintf(f,"CProtoModTcp:\n");
 	fprintf(f,"  Peer port : %15u\n",    getDestPort());
 	fprintf(f,"  ThreadPrio: %15d\n",    rxHandler_->getPrio());
+	fprintf(f,"  IO Engine : %15u\n",    ioEngineThreads_);
 	fprintf(f,"  #TX Octets: %15" PRIu64 "\n", getNumTxOctets());
 	fprintf(f,"  #TX DGRAMs: %15" PRIu64 "\n", getNumTxDgrams());
 	fprintf(f,"  #RX Octets: %15" PRIu64 "\n", getNumRxOctets());
 	fprintf(f,"  #RX DGRAMs: %15" PRIu64 "\n", getNumRxDgrams());
+	fprintf(f,"  #RX stalls: %15" PRIu64 "\n", getNumRxStalls());
+}
+
+void CProtoModTcp::collectMetrics(IMetricsSink *sink)
+{
+	CProtoMod::collectMetrics( sink );
+	sink->counter( "tx_octets", getNumTxOctets() );
+	sink->counter( "tx_dgrams", getNumTxDgrams() );
+	sink->counter( "rx_octets", getNumRxOctets() );
+	sink->counter( "rx_dgrams", getNumRxDgrams() );
+	sink->counter( "rx_stalls", getNumRxStalls() );
 }
 
 bool CProtoModTcp::doPush(BufChain bc, bool wait, const CTimeout *timeout, bool abs_timeout)
@@ -15,10 +15,14 @@
 #include <cpsw_thread.h>
 #include <cpsw_sock.h>
 #include <cpsw_mutex.h>
+#include <cpsw_io_engine.h>
 #include <cpsw_compat.h>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
+#include <sys/uio.h>
+
+#include <vector>
 
 using cpsw::atomic;
 
@@ -31,11 +35,34 @@ typedef shared_ptr<CProtoModTcp> ProtoModTcp;
 class CProtoModTcp : public CProtoMod {
 protected:
 
-	class CRxHandlerThread : public CRunnable {
+	class CRxHandlerThread : public CRunnable, public IIoHandler {
+		public:
+			static const unsigned NBUFS_MAX = 8;
+
 		private:
 			int              sd_;
 			atomic<uint64_t> nOctets_;
 			atomic<uint64_t> nDgrams_;
+			atomic<uint64_t> nRxStalls_; // I/O engine stopped reading (queue full)
+
+			// frame being received
+			uint32_t         hdr_;
+			size_t           hdrGot_;
+			std::vector<Buf> bufs_;
+			struct iovec     iov_[NBUFS_MAX];
+			size_t           lens_[NBUFS_MAX];
+			unsigned         niovs_;
+			unsigned         iovIdx_;
+			// complete frame the (full) upstream queue refused (I/O engine)
+			BufChain         pending_;
+
+			void setupIovs(uint32_t len);
+
+			// pass 'pending_' on without blocking; if the upstream queue
+			// is full then stop reading until the consumer makes room and
+			// return 'false'.
+			bool forwardPending();
+
 		public:
 			// cannot use smart pointer here because CProtoModUdp's
 			// constructor creates the threads (and a smart ptr is
@@ -48,12 +75,26 @@ protected:
 
 			virtual void* threadBody();
 
+			// continue receiving the current frame; returns 'true'
+			// once it has been passed on and 'false' if no more data
+			// are available (only if ! 'wait'). Unless 'wait' is set
+			// 'false' is also returned if the upstream queue is full;
+			// the frame is then kept and passed on once the consumer
+			// has made room.
+			virtual bool  readFrame(bool wait);
+
 		public:
+			// read what is available without blocking (I/O engine)
+			virtual void handleInput();
+
+			virtual int getSd() const { return sd_; }
+
 			CRxHandlerThread(const char *name, int threadPriority, int sd, CProtoModTcp *owner);
 			CRxHandlerThread(CRxHandlerThread &orig, int sd, CProtoModTcp *owner);
 
 			virtual uint64_t getNumOctets() { return nOctets_.load( cpsw::memory_order_relaxed ); }
 			virtual uint64_t getNumDgrams() { return nDgrams_.load( cpsw::memory_order_relaxed ); }
+			virtual uint64_t getNumRxStalls() { return nRxStalls_.load( cpsw::memory_order_relaxed ); }
 
 			virtual ~CRxHandlerThread() { threadStop(); }
 	};
@@ -65,12 +106,24 @@ private:
 	atomic<uint64_t>   nTxOctets_;
 	atomic<uint64_t>   nTxDgrams_;
 	CMtx               txMtx_;
+	BufPool            rxPool_;
+	unsigned           ioEngineThreads_;
+	IoEngine           ioEngine_;
+	CMtx               rxMtx_;    // serializes re-enabling RX with shutdown
+	bool               rxEnabled_;
 
 protected:
 	CRxHandlerThread  *rxHandler_;
 
+	// from the application's pool if there is one (and it is not exhausted)
+	virtual Buf getRxBuf();
+
 	void createThread(int threadPriority);
 
+	// I/O engine: stop reading while the output queue is full
+	virtual void stallRx();
+	virtual void outputSpaceAvailable();
+
 	virtual bool doPush(BufChain bc, bool wait, const CTimeout *timeout, bool abs_timeout);
 
 	virtual bool push(BufChain bc, const CTimeout *timeout, bool abs_timeout)
@@ -92,7 +145,9 @@ public:
 		unsigned                  depth,
 		int                       threadPriority,
 		const LibSocksProxy      *proxy,
-		const struct sockaddr_in *via
+		const struct sockaddr_in *via,
+		bool                      lockFreeQueue = false,
+		unsigned                  ioEngineThreads = 0 // > 0: use the shared I/O engine
 	);
 
 	CProtoModTcp(CProtoModTcp &orig, Key &k);
@@ -107,7 +162,13 @@ public:
 		return ntohs( dest_.sin_port );
 	}
 
+	virtual unsigned getIoEngineThreads() const
+	{
+		return ioEngineThreads_;
+	}
+
 	virtual void dumpInfo(FILE *f);
+	virtual void collectMetrics(IMetricsSink *sink);
 
 	virtual CProtoModTcp *clone(Key &k)
 	{
@@ -116,10 +177,14 @@ public:
 
 	virtual unsigned getMTU();
 
+	// receive into application memory; must be set before the module is started
+	virtual void    setRxBufPool(BufPool pool);
+
 	virtual uint64_t getNumTxOctets() { return nTxOctets_.load( cpsw::memory_order_relaxed ); }
 	virtual uint64_t getNumTxDgrams() { return nTxDgrams_.load( cpsw::memory_order_relaxed ); }
 	virtual uint64_t getNumRxOctets();
 	virtual uint64_t getNumRxDgrams();
+	virtual uint64_t getNumRxStalls();
 	virtual void modStartup();
 	virtual void modShutdown();
 
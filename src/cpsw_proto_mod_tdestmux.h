@@ -24,9 +24,9 @@ protected:
 	{
 	}
 
-	TDestPort newPort(int dest, bool stripHeader, unsigned qDepth)
+	TDestPort newPort(int dest, bool stripHeader, unsigned qDepth, bool lockFreeQueue)
 	{
-		return CShObj::create<TDestPort>( getSelfAs<ProtoModTDestMux>(), dest, stripHeader, qDepth );
+		return CShObj::create<TDestPort>( getSelfAs<ProtoModTDestMux>(), dest, stripHeader, qDepth, lockFreeQueue );
 	}
 
 public:
@@ -36,9 +36,9 @@ public:
 	{
 	}
 
-	TDestPort createPort(int dest, bool stripHeader, unsigned qDepth)
+	TDestPort createPort(int dest, bool stripHeader, unsigned qDepth, bool lockFreeQueue = false)
 	{
-		return addPort( dest, newPort(dest, stripHeader, qDepth) );
+		return addPort( dest, newPort(dest, stripHeader, qDepth, lockFreeQueue) );
 	}
 
 	virtual int extractDest(BufChain);
@@ -73,8 +73,8 @@ protected:
 
 
 public:
-	CTDestPort(Key &k, ProtoModTDestMux owner, int dest, bool stripHeader, unsigned qDepth)
-	: CByteMuxPort<CProtoModTDestMux>(k, owner, dest, qDepth),
+	CTDestPort(Key &k, ProtoModTDestMux owner, int dest, bool stripHeader, unsigned qDepth, bool lockFreeQueue)
+	: CByteMuxPort<CProtoModTDestMux>(k, owner, dest, qDepth, lockFreeQueue),
 	  stripHeader_(stripHeader)
 	{
 	}
@@ -178,47 +178,26 @@ unsigned added;
 	CDepack2Header::CrcMode crcMode = hdr.getCrcMode();
 
 	if ( CDepack2Header::NONE != crcMode ) {
-		uint8_t       *crcb;
-		unsigned long  crcl, crcltot;
+		unsigned long  off, crcltot;
 
-		crcb    = h->getPayload();
 		// how many bytes need to be CRCed
 		crcltot = bc->getSize();
-		// how many bytes are in the data buffer
-		crcl    = h->getSize();
 
 		if ( crcMode == CDepack2Header::DATA ) {
 			// skip header
-			crcb    += hdr.getSize();
-            crcl    -= hdr.getSize();
+			off      = hdr.getSize();
 			crcltot -= hdr.getSize() + hdr.getTailSize();
 		} else {
+			off      = 0;
 			// don't include crc itself -- HACK ; we should handle that in CDepack2Header
 			crcltot -= sizeof( w.crc_ );
 		}
 
-		if ( crcl > crcltot ) {
-			crcl = crcltot;
-		}
-
 #ifdef TDESTMUX2_DEBUG
 		fprintf(CPSW::fDbg(), "TDestMux2 sendFrag: crc over %ld octets\n", crcltot);
 #endif
 
-		w.crc_   = crc32( w.crc_, crcb, crcl );
-		crcltot -= crcl;
-
-		while ( crcltot > 0 ) {
-			h        = h->getNext();
-			crcl     = h->getSize();
-
-			if ( crcl > crcltot ) {
-				crcl = crcltot;
-			}
-			crcb     = h->getPayload();
-			w.crc_   = crc32( w.crc_, crcb, crcl );
-			crcltot -= crcl;
-		}
+		w.crc_ = crc32( w.crc_, h, off, crcltot );
 
 	} else {
 		w.crc_ = 0;
@@ -87,10 +87,10 @@ protected:
 	{
 	}
 
-	TDestPort2 newPort(int dest, bool stripHeader, unsigned oQDepth, unsigned iQDepth)
+	TDestPort2 newPort(int dest, bool stripHeader, unsigned oQDepth, unsigned iQDepth, bool lockFreeQueues)
 	{
 		// don't add to event set during creation but from 'add' -- this facilitates cloning
-		return CShObj::create<TDestPort2>( getSelfAs<ProtoModTDestMux2>(), dest, stripHeader, oQDepth, iQDepth );
+		return CShObj::create<TDestPort2>( getSelfAs<ProtoModTDestMux2>(), dest, stripHeader, oQDepth, iQDepth, lockFreeQueues );
 	}
 
 public:
@@ -118,9 +118,9 @@ public:
 	{
 	}
 
-	TDestPort2 createPort(int dest, bool stripHeader, unsigned oQDepth, unsigned iQDepth)
+	TDestPort2 createPort(int dest, bool stripHeader, unsigned oQDepth, unsigned iQDepth, bool lockFreeQueues = false)
 	{
-		return addPort( dest, newPort(dest, stripHeader, oQDepth, iQDepth) );
+		return addPort( dest, newPort(dest, stripHeader, oQDepth, iQDepth, lockFreeQueues) );
 	}
 
 	virtual TDestPort2 addPort(int dest, TDestPort2 port);
@@ -175,11 +175,11 @@ protected:
 	virtual int iMatch(ProtoPortMatchParams *cmp);
 
 public:
-	CTDestPort2(Key &k, ProtoModTDestMux2 owner, int dest, bool stripHeader, unsigned oQDepth, unsigned iQDepth)
-	: CByteMuxPort<CProtoModTDestMux2>(k, owner, dest, oQDepth),
-	  stripHeader_  ( stripHeader                  ),
-	  inpQueueDepth_( iQDepth                      ),
-	  inputQueue_   ( IBufQueue::create( iQDepth ) ),
+	CTDestPort2(Key &k, ProtoModTDestMux2 owner, int dest, bool stripHeader, unsigned oQDepth, unsigned iQDepth, bool lockFreeQueues)
+	: CByteMuxPort<CProtoModTDestMux2>(k, owner, dest, oQDepth, lockFreeQueues),
+	  stripHeader_  ( stripHeader                                  ),
+	  inpQueueDepth_( iQDepth                                      ),
+	  inputQueue_   ( IBufQueue::create( iQDepth, lockFreeQueues ) ),
 	  slot_         ( -1                           ),
 	  badHeadersCnt_( 0                            ),
 	  nonSeqFragCnt_( 0                            ),
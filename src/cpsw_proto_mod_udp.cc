@@ -17,8 +17,12 @@
 #include <cpsw_stdio.h>
 
 #include <errno.h>
+#include <string.h>
 #include <sys/select.h>
+#include <sys/socket.h>
 #include <sys/uio.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
 
 #include <stdio.h>
 
@@ -47,32 +51,110 @@ CUdpHandlerThread::CUdpHandlerThread(CUdpHandlerThread &orig, struct sockaddr_in
 
 #define NBUFS_MAX 8
 
-void * CProtoModUdp::CUdpRxHandlerThread::threadBody()
+// never ask the kernel for more than this many messages at once
+#define BATCH_MAX 1024
+
+// (re-)populate the iovecs of message 'msg' with enough
+// buffers to hold a jumbo frame
+void CProtoModUdp::CUdpRxHandlerThread::fillIovs(Buf *bufs, struct iovec *iov, struct mmsghdr *msg)
 {
-	ssize_t          got,siz,cap;
-	std::vector<Buf> bufs;
-	unsigned         idx;
+	size_t   cap;
+	unsigned idx;
+
+	for ( idx = 0, cap = 0; idx < NBUFS_MAX && cap < IBuf::CAPA_ETH_JUM; idx++ ) {
+		if ( ! bufs[idx] ) {
+			bufs[idx] = owner_->getRxBuf();
+		}
+		iov[idx].iov_base = bufs[idx]->getPayload();
+		cap += (iov[idx].iov_len  = bufs[idx]->getAvail());
+	}
+	msg->msg_hdr.msg_iov    = iov;
+	msg->msg_hdr.msg_iovlen = idx;
+}
+
+void CProtoModUdp::CUdpRxHandlerThread::initBufs()
+{
+	unsigned msg;
 
-	struct iovec     iov[NBUFS_MAX];
-	int              niovs;
+	// buffers are only allocated as needed (the application
+	// might provide slots big enough for an entire frame).
+	bufs_.resize( batch_ * NBUFS_MAX );
+	iov_.resize ( batch_ * NBUFS_MAX );
+	msgs_.resize( batch_ );
 
-	for ( niovs = 0, cap = 0; niovs<NBUFS_MAX && cap < (ssize_t)IBuf::CAPA_ETH_JUM; niovs++ ) {
-		bufs.push_back( IBuf::getBuf( IBuf::CAPA_ETH_BIG ) );
-		iov[niovs].iov_base = bufs[niovs]->getPayload();
-		cap += (iov[niovs].iov_len  = bufs[niovs]->getAvail());
+	for ( msg = 0; msg < batch_; msg++ ) {
+		memset( &msgs_[msg], 0, sizeof(msgs_[msg]) );
+		fillIovs( &bufs_[msg * NBUFS_MAX], &iov_[msg * NBUFS_MAX], &msgs_[msg] );
 	}
+}
 
-	while ( 1 ) {
+void * CProtoModUdp::CUdpRxHandlerThread::threadBody()
+{
+	initBufs();
 
+	while ( 1 ) {
 #ifdef UDP_DEBUG
 		fprintf(CPSW::fDbg(), "UDP -- waiting for data\n");
 #endif
-		got = ::readv( sd_.getSd(), iov, niovs );
+		receive( true );
+	}
+	return NULL;
+}
+
+// the engine comes back if there is more
+#define ENGINE_RX_ROUNDS 4
+
+void CProtoModUdp::CUdpRxHandlerThread::handleInput()
+{
+	unsigned i;
+
+	for ( i = 0; i < ENGINE_RX_ROUNDS; i++ ) {
+		if ( receive( false ) < batch_ )
+			break;
+	}
+}
+
+unsigned CProtoModUdp::CUdpRxHandlerThread::receive(bool wait)
+{
+	ssize_t          got,siz,cap;
+	unsigned         idx, msg, nmsgs;
+	int              nrcv;
+
+	if ( batch_ > 1 ) {
+		// block for the first message only; pick up
+		// whatever else is already there.
+		nrcv = ::recvmmsg( sd_.getSd(), &msgs_[0], batch_, wait ? MSG_WAITFORONE : MSG_DONTWAIT, NULL );
+		if ( nrcv < 0 ) {
+			if ( ! wait && ( EAGAIN == errno || EWOULDBLOCK == errno ) )
+				return 0;
+			perror("rx thread (recvmmsg)");
+			if ( wait )
+				sleep(10);
+			return 0;
+		}
+		nmsgs = nrcv;
+	} else {
+		if ( wait ) {
+			got = ::readv( sd_.getSd(), &iov_[0], msgs_[0].msg_hdr.msg_iovlen );
+		} else {
+			got = ::recvmsg( sd_.getSd(), &msgs_[0].msg_hdr, MSG_DONTWAIT );
+		}
 		if ( got < 0 ) {
+			if ( ! wait && ( EAGAIN == errno || EWOULDBLOCK == errno ) )
+				return 0;
 			perror("rx thread");
-			sleep(10);
-			continue;
+			if ( wait )
+				sleep(10);
+			return 0;
 		}
+		msgs_[0].msg_len = got;
+		nmsgs            = 1;
+	}
+
+	for ( msg = 0; msg < nmsgs; msg++ ) {
+
+		got = msgs_[msg].msg_len;
+
 		nDgrams_.fetch_add(1,   cpsw::memory_order_relaxed);
 		nOctets_.fetch_add(got, cpsw::memory_order_relaxed);
 
@@ -85,16 +167,16 @@ void * CProtoModUdp::CUdpRxHandlerThread::threadBody()
 			BufChain bufch = IBufChain::create();
 
 			siz = got;
-			idx = 0;
+			idx = msg * NBUFS_MAX;
 			while ( siz > 0 ) {
-				if ( siz < (cap = bufs[idx]->getAvail()) ) {
+				if ( siz < (cap = bufs_[idx]->getAvail()) ) {
 					cap = siz;
 				}
-				bufs[idx]->setSize( cap );
+				bufs_[idx]->setSize( cap );
 #ifdef UDP_DEBUG
-				if ( idx == 0 ) {
+				if ( idx == msg * NBUFS_MAX ) {
 					int      i;
-					uint8_t  *p = bufs[idx]->getPayload();
+					uint8_t  *p = bufs_[idx]->getPayload();
 #ifdef UDP_DEBUG_STRM
 					fram = (p[1]<<4) | (p[0]>>4);
 					frag = (p[4]<<16) | (p[3] << 8) | p[2];
@@ -106,16 +188,16 @@ void * CProtoModUdp::CUdpRxHandlerThread::threadBody()
 				}
 #endif
 
-				bufch->addAtTail( bufs[idx] );
+				bufch->addAtTail( bufs_[idx] );
 
-				// get new buffers
-				bufs[idx] = IBuf::getBuf( IBuf::CAPA_ETH_BIG );
-				iov[idx].iov_base = bufs[idx]->getPayload();
-				iov[idx].iov_len  = bufs[idx]->getAvail();
+				bufs_[idx].reset();
 				idx++;
 				siz -= cap;
 			}
 
+			// get new buffers
+			fillIovs( &bufs_[msg * NBUFS_MAX], &iov_[msg * NBUFS_MAX], &msgs_[msg] );
+
 		bool st=
 			// do NOT wait indefinitely
 			// could be that the queue is full with
@@ -135,7 +217,7 @@ void * CProtoModUdp::CUdpRxHandlerThread::threadBody()
 				fprintf(CPSW::fDbg(), " (pushdown DROP)\n");
 #endif
 
-			if ( st ) {
+			if ( ! st ) {
 				nRxDrop_.fetch_add(1,   cpsw::memory_order_relaxed);
 			}
 		}
@@ -145,7 +227,7 @@ void * CProtoModUdp::CUdpRxHandlerThread::threadBody()
 		}
 #endif
 	}
-	return NULL;
+	return nmsgs;
 }
 
 CProtoModUdp::CUdpRxHandlerThread::CUdpRxHandlerThread(
@@ -153,12 +235,14 @@ CProtoModUdp::CUdpRxHandlerThread::CUdpRxHandlerThread(
 	int                 threadPriority,
 	struct sockaddr_in *dest,
 	struct sockaddr_in *me,
-	CProtoModUdp       *owner
+	CProtoModUdp       *owner,
+	unsigned            batch
 )
 : CUdpHandlerThread(name, threadPriority, dest, me),
   nOctets_(0),
   nDgrams_(0),
   nRxDrop_(0),
+  batch_(batch),
   owner_(owner)
 {
 }
@@ -168,35 +252,124 @@ CProtoModUdp::CUdpRxHandlerThread::CUdpRxHandlerThread(CUdpRxHandlerThread &orig
   nOctets_(0),
   nDgrams_(0),
   nRxDrop_(0),
+  batch_(orig.batch_),
   owner_(owner)
 {
 }
 
-void * CUdpPeerPollerThread::threadBody()
+void * CProtoModUdp::CUdpTxHandlerThread::threadBody()
+{
+	std::vector<BufChain> bcs( owner_->txBatch_ );
+	unsigned              n, i;
+
+	while ( 1 ) {
+		n = owner_->txQueue_->popN( &bcs[0], bcs.size(), NULL );
+		owner_->sendBatch( &bcs[0], n );
+		for ( i = 0; i < n; i++ ) {
+			bcs[i].reset();
+		}
+	}
+	return NULL;
+}
+
+CProtoModUdp::CUdpTxHandlerThread::CUdpTxHandlerThread(
+	const char         *name,
+	int                 threadPriority,
+	CProtoModUdp       *owner
+)
+: CRunnable(name, threadPriority),
+  owner_(owner)
+{
+}
+
+void CUdpPeerPollerThread::sendPoll()
 {
 	uint8_t buf[4];
 	memset( buf, 0, sizeof(buf) );
+	if ( ::write( sd_.getSd(), buf, 0 ) < 0 ) {
+		perror("poller thread (write)");
+	}
+}
+
+void * CUdpPeerPollerThread::threadBody()
+{
 	while ( 1 ) {
-		if ( ::write( sd_.getSd(), buf, 0 ) < 0 ) {
-			perror("poller thread (write)");
-			continue;
-		}
+		sendPoll();
 		if ( sleep( pollSecs_ ) )
 			continue; // interrupted by signal
 	}
 	return NULL;
 }
 
+int CUdpPeerPollerThread::startTimer()
+{
+struct itimerspec its;
+
+	if ( tfd_ < 0 ) {
+		if ( (tfd_ = timerfd_create( CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC )) < 0 ) {
+			throw InternalError("CUdpPeerPollerThread: timerfd_create failed", errno);
+		}
+	}
+	// first poll right away
+	its.it_value.tv_sec     = 0;
+	its.it_value.tv_nsec    = 1;
+	its.it_interval.tv_sec  = pollSecs_;
+	its.it_interval.tv_nsec = 0;
+	if ( timerfd_settime( tfd_, 0, &its, NULL ) ) {
+		throw InternalError("CUdpPeerPollerThread: timerfd_settime failed", errno);
+	}
+	return tfd_;
+}
+
+void CUdpPeerPollerThread::stopTimer()
+{
+	if ( tfd_ >= 0 ) {
+		close( tfd_ );
+		tfd_ = -1;
+	}
+}
+
+void CUdpPeerPollerThread::handleInput()
+{
+uint64_t expirations;
+
+	if ( ::read( tfd_, &expirations, sizeof(expirations) ) > 0 ) {
+		sendPoll();
+	}
+}
+
 CUdpPeerPollerThread::CUdpPeerPollerThread(const char *name, struct sockaddr_in *dest, struct sockaddr_in *me, unsigned pollSecs)
 : CUdpHandlerThread(name, IProtoStackBuilder::NORT_THREAD_PRIORITY, dest, me),
-  pollSecs_(pollSecs)
+  pollSecs_(pollSecs),
+  tfd_(-1)
 {
 }
 
 CUdpPeerPollerThread::CUdpPeerPollerThread(CUdpPeerPollerThread &orig, struct sockaddr_in *dest, struct sockaddr_in *me)
 : CUdpHandlerThread(orig, dest, me),
-  pollSecs_(orig.pollSecs_)
+  pollSecs_(orig.pollSecs_),
+  tfd_(-1)
+{
+}
+
+CUdpPeerPollerThread::~CUdpPeerPollerThread()
+{
+	threadStop();
+	stopTimer();
+}
+
+void CProtoModUdp::setRxBufPool(BufPool pool)
+{
+	rxPool_ = pool;
+}
+
+Buf CProtoModUdp::getRxBuf()
 {
+Buf rval;
+	if ( ! rxPool_ || ! (rval = rxPool_->getBuf()) ) {
+		rval = IBuf::getBuf( IBuf::CAPA_ETH_BIG );
+	}
+	return rval;
 }
 
 void CProtoModUdp::createThreads(unsigned nRxThreads, int pollSeconds)
@@ -217,7 +390,11 @@ void CProtoModUdp::createThreads(unsigned nRxThreads, int pollSeconds)
 	rxHandlers_.clear();
 
 	for ( i=0; i<nRxThreads; i++ ) {
-		rxHandlers_.push_back( new CUdpRxHandlerThread("UDP RX Handler (UDP protocol module)", threadPriority_, &dest_, &me, this ) );
+		rxHandlers_.push_back( new CUdpRxHandlerThread("UDP RX Handler (UDP protocol module)", threadPriority_, &dest_, &me, this, rxBatch_ ) );
+	}
+
+	if ( txBatch_ > 1 ) {
+		txHandler_ = new CUdpTxHandlerThread("UDP TX Handler (UDP protocol module)", threadPriority_, this );
 	}
 
 	// maybe setting the threadPriority failed?
@@ -229,22 +406,50 @@ void CProtoModUdp::createThreads(unsigned nRxThreads, int pollSeconds)
 void CProtoModUdp::modStartup()
 {
 unsigned i;
-	if ( poller_ )
-		poller_->threadStart();
-	for ( i=0; i<rxHandlers_.size(); i++ ) {
-		rxHandlers_[i]->threadStart();
+	if ( ioEngineThreads_ ) {
+		if ( ! ioEngine_ ) {
+			ioEngine_ = CIoEngine::get( ioEngineThreads_, threadPriority_ );
+			if ( poller_ )
+				ioEngine_->add( poller_->startTimer(), poller_ );
+			for ( i=0; i<rxHandlers_.size(); i++ ) {
+				rxHandlers_[i]->initBufs();
+				ioEngine_->add( rxHandlers_[i]->getSd(), rxHandlers_[i] );
+			}
+		}
+	} else {
+		if ( poller_ )
+			poller_->threadStart();
+		for ( i=0; i<rxHandlers_.size(); i++ ) {
+			rxHandlers_[i]->threadStart();
+		}
 	}
+	if ( txHandler_ )
+		txHandler_->threadStart();
 }
 
 void CProtoModUdp::modShutdown()
 {
 unsigned i;
+	if ( ioEngine_ ) {
+		if ( poller_ ) {
+			ioEngine_->remove( poller_->getTimerFd() );
+			poller_->stopTimer();
+		}
+		for ( i=0; i<rxHandlers_.size(); i++ ) {
+			ioEngine_->remove( rxHandlers_[i]->getSd() );
+		}
+		ioEngine_.reset();
+	}
+
 	if ( poller_ )
 		poller_->threadStop();
 
 	for ( i=0; i<rxHandlers_.size(); i++ ) {
 		rxHandlers_[i]->threadStop();
 	}
+
+	if ( txHandler_ )
+		txHandler_->threadStop();
 }
 
 CProtoModUdp::CProtoModUdp(
@@ -253,17 +458,30 @@ CProtoModUdp::CProtoModUdp(
 	unsigned            depth,
 	int                 threadPriority,
 	unsigned            nRxThreads,
-	int                 pollSecs
+	int                 pollSecs,
+	bool                lockFreeQueue,
+	unsigned            rxBatch,
+	unsigned            txBatch,
+	unsigned            ioEngineThreads
 )
-:CProtoMod(k, depth),
+:CProtoMod(k, depth, lockFreeQueue),
  dest_(*dest),
  nTxOctets_(0),
  nTxDgrams_(0),
+ nTxDrops_(0),
  threadPriority_(threadPriority),
- poller_( NULL )
+ rxBatch_( rxBatch < 1 ? 1 : (rxBatch > BATCH_MAX ? BATCH_MAX : rxBatch) ),
+ txBatch_( txBatch < 1 ? 1 : (txBatch > BATCH_MAX ? BATCH_MAX : txBatch) ),
+ txQueue_( txBatch_ > 1 ? IBufQueue::create( 4 * txBatch_, lockFreeQueue ) : BufQueue() ),
+ txMsgs_( txBatch_ ),
+ txIov_( txBatch_ * NBUFS_MAX ),
+ ioEngineThreads_( ioEngineThreads ),
+ poller_( NULL ),
+ txHandler_( NULL )
 {
 	tx_.init( dest, 0, true );
-	createThreads( nRxThreads, pollSecs );
+	// a single socket is enough when served by the engine
+	createThreads( ioEngineThreads_ ? 1 : nRxThreads, pollSecs );
 }
 
 void
@@ -277,7 +495,19 @@ CProtoModUdp::dumpYaml(YAML::Node &node) const
 	if ( threadPriority_ != IProtoStackBuilder::DFLT_THREAD_PRIORITY ) {
 		writeNode(udpParms, YAML_KEY_threadPriority,  threadPriority_);
 	}
+	if ( rxBatch_ > 1 ) {
+		writeNode(udpParms, YAML_KEY_rxBatchSize,     rxBatch_);
+	}
+	if ( txBatch_ > 1 ) {
+		writeNode(udpParms, YAML_KEY_txBatchSize,     txBatch_);
+	}
+	if ( ioEngineThreads_ > 0 ) {
+		writeNode(udpParms, YAML_KEY_ioEngineThreads, ioEngineThreads_);
+	}
 	writeNode(node, YAML_KEY_UDP, udpParms);
+	if ( hasLockFreeQueue() ) {
+		writeNode(node, YAML_KEY_lockFreeQueues, true);
+	}
 }
 
 CProtoModUdp::CProtoModUdp(CProtoModUdp &orig, Key &k)
@@ -286,8 +516,17 @@ CProtoModUdp::CProtoModUdp(CProtoModUdp &orig, Key &k)
  tx_(orig.tx_),
  nTxOctets_(0),
  nTxDgrams_(0),
+ nTxDrops_(0),
  threadPriority_(orig.threadPriority_),
- poller_(orig.poller_)
+ rxBatch_(orig.rxBatch_),
+ txBatch_(orig.txBatch_),
+ txQueue_( txBatch_ > 1 ? IBufQueue::create( 4 * txBatch_, orig.hasLockFreeQueue() ) : BufQueue() ),
+ txMsgs_( txBatch_ ),
+ txIov_( txBatch_ * NBUFS_MAX ),
+ rxPool_(orig.rxPool_),
+ ioEngineThreads_(orig.ioEngineThreads_),
+ poller_(orig.poller_),
+ txHandler_( NULL )
 {
 	tx_.init( &dest_, 0, true );
 	createThreads( orig.rxHandlers_.size(), -1 );
@@ -331,6 +570,8 @@ unsigned i;
 		delete rxHandlers_[i];
 	if ( poller_ )
 		delete poller_;
+	if ( txHandler_ )
+		delete txHandler_;
 }
 
 void CProtoModUdp::dumpInfo(FILE *f)
@@ -343,13 +584,28 @@ void CProtoModUdp::dumpInfo(FILE *f)
 	fprintf(f,"  RX Threads: %15lu\n",   (unsigned long)rxHandlers_.size());
 	fprintf(f,"  ThreadPrio: %15d\n",    threadPriority_);
 	fprintf(f,"  Has Poller:               %c\n", poller_ ? 'Y' : 'N');
+	fprintf(f,"  RX Batch  : %15u\n",    rxBatch_);
+	fprintf(f,"  TX Batch  : %15u\n",    txBatch_);
+	fprintf(f,"  IO Engine : %15u\n",    ioEngineThreads_);
 	fprintf(f,"  #TX Octets: %15" PRIu64 "\n", getNumTxOctets());
 	fprintf(f,"  #TX DGRAMs: %15" PRIu64 "\n", getNumTxDgrams());
+	fprintf(f,"  #TX droppd: %15" PRIu64 "\n", getNumTxDrops() );
 	fprintf(f,"  #RX Octets: %15" PRIu64 "\n", getNumRxOctets());
 	fprintf(f,"  #RX DGRAMs: %15" PRIu64 "\n", getNumRxDgrams());
 	fprintf(f,"  #RX droppd: %15" PRIu64 "\n", getNumRxDrops() );
 }
 
+void CProtoModUdp::collectMetrics(IMetricsSink *sink)
+{
+	CProtoMod::collectMetrics( sink );
+	sink->counter( "tx_octets", getNumTxOctets() );
+	sink->counter( "tx_dgrams", getNumTxDgrams() );
+	sink->counter( "tx_drops",  getNumTxDrops()  );
+	sink->counter( "rx_octets", getNumRxOctets() );
+	sink->counter( "rx_dgrams", getNumRxDgrams() );
+	sink->counter( "rx_drops",  getNumRxDrops()  );
+}
+
 bool CProtoModUdp::doPush(BufChain bc, bool wait, const CTimeout *timeout, bool abs_timeout)
 {
 fd_set         fds;
@@ -368,6 +624,21 @@ unsigned       nios;
 	nTxDgrams_.fetch_add( 1, cpsw::memory_order_relaxed );
 	nTxOctets_.fetch_add( bc->getSize(), cpsw::memory_order_relaxed );
 
+	if ( txQueue_ ) {
+		// batched mode; the TX thread sends
+		if ( ! wait ) {
+			return txQueue_->tryPush( bc );
+		}
+		if ( !timeout || timeout->isIndefinite() ) {
+			return txQueue_->push( bc, NULL );
+		}
+		if ( abs_timeout ) {
+			return txQueue_->push( bc, timeout );
+		}
+		CTimeout abst( txQueue_->getAbsTimeoutPush( timeout ) );
+		return txQueue_->push( bc, &abst );
+	}
+
 	for (nios=0, b=bc->getHead(); nios<bc->getLen(); nios++, b=b->getNext()) {
 		iov[nios].iov_base = b->getPayload();
 		iov[nios].iov_len  = b->getSize();
@@ -414,6 +685,56 @@ abort();
 	return true;
 }
 
+unsigned CProtoModUdp::sendBatch(BufChain *bcs, unsigned n)
+{
+unsigned                    i, nios, sent, dropped;
+int                         st;
+Buf                         b;
+
+	if ( n > txMsgs_.size() ) {
+		throw InternalError("UDP sendBatch: batch exceeds TX batch size");
+	}
+
+	for ( i = 0, nios = 0; i < n; i++ ) {
+		nios += bcs[i]->getLen();
+	}
+	if ( nios > txIov_.size() ) {
+		txIov_.resize( nios );
+	}
+
+	for ( i = 0, nios = 0; i < n; i++ ) {
+		memset( &txMsgs_[i], 0, sizeof(txMsgs_[i]) );
+		txMsgs_[i].msg_hdr.msg_iov    = &txIov_[nios];
+		txMsgs_[i].msg_hdr.msg_iovlen = bcs[i]->getLen();
+		for ( b = bcs[i]->getHead(); b; b = b->getNext(), nios++ ) {
+			txIov_[nios].iov_base = b->getPayload();
+			txIov_[nios].iov_len  = b->getSize();
+		}
+	}
+
+	for ( sent = 0, dropped = 0; sent < n; sent += st ) {
+		st = ::sendmmsg( tx_.getSd(), &txMsgs_[sent], n - sent, 0 );
+		if ( st < 0 ) {
+			if ( EINTR == errno )
+				st = 0;
+			else {
+				// the error refers to the first unsent message (e.g.,
+				// ECONNREFUSED on a connected socket); skip it but
+				// send the rest.
+				perror("::sendmmsg() - dropping message due to error");
+				nTxDrops_.fetch_add( 1, cpsw::memory_order_relaxed );
+				dropped++;
+				st = 1;
+			}
+		}
+	}
+
+#ifdef UDP_DEBUG
+	fprintf(CPSW::fDbg(), "UDP sendBatch -- sent %u of %u messages\n", n - dropped, n);
+#endif
+	return n - dropped;
+}
+
 int CProtoModUdp::iMatch(ProtoPortMatchParams *cmp)
 {
 	cmp->udpDestPort_.handledBy_ = getProtoMod();
@@ -14,6 +14,7 @@
 #include <cpsw_proto_mod.h>
 #include <cpsw_thread.h>
 #include <cpsw_sock.h>
+#include <cpsw_io_engine.h>
 #include <cpsw_compat.h>
 
 #include <arpa/inet.h>
@@ -36,20 +37,28 @@ public:
 		sd_.getMyAddr( addr_p );
 	}
 
+	virtual int getSd() const
+	{
+		return sd_.getSd();
+	}
+
 	CUdpHandlerThread(const char *name, int threadPriority, struct sockaddr_in *dest, struct sockaddr_in *me_p = NULL);
 	CUdpHandlerThread(CUdpHandlerThread &orig, struct sockaddr_in *dest, struct sockaddr_in *me_p);
 
 	virtual ~CUdpHandlerThread() {}
 };
 
-class CUdpPeerPollerThread : public CUdpHandlerThread {
+class CUdpPeerPollerThread : public CUdpHandlerThread, public IIoHandler {
 private:
 	unsigned pollSecs_;
+	int      tfd_;
 
 protected:
 
 	virtual void* threadBody();
 
+	virtual void  sendPoll();
+
 public:
 	CUdpPeerPollerThread(const char *name, struct sockaddr_in *dest, struct sockaddr_in *me = NULL, unsigned pollSecs = 60);
 	CUdpPeerPollerThread(CUdpPeerPollerThread &orig, struct sockaddr_in *dest, struct sockaddr_in *me);
@@ -59,17 +68,30 @@ public:
 		return pollSecs_;
 	}
 
-	virtual ~CUdpPeerPollerThread() { threadStop(); }
+	// when driven by an I/O engine rather than by a thread: create
+	// a timer descriptor which becomes readable every 'pollSecs'
+	virtual int   startTimer();
+	virtual void  stopTimer();
+	virtual int   getTimerFd() const { return tfd_; }
+	virtual void  handleInput();
+
+	virtual ~CUdpPeerPollerThread();
 };
 
 class CProtoModUdp : public CProtoMod {
 protected:
 
-	class CUdpRxHandlerThread : public CUdpHandlerThread {
+	class CUdpRxHandlerThread : public CUdpHandlerThread, public IIoHandler {
 		private:
 			atomic<uint64_t> nOctets_;
 			atomic<uint64_t> nDgrams_;
 			atomic<uint64_t> nRxDrop_;
+			unsigned         batch_;
+
+			// 'batch_' sets of NBUFS_MAX buffers/iovecs
+			std::vector<Buf>            bufs_;
+			std::vector<struct iovec>   iov_;
+			std::vector<struct mmsghdr> msgs_;
 		public:
 			// cannot use smart pointer here because CProtoModUdp's
 			// constructor creates the threads (and a smart ptr is
@@ -82,10 +104,25 @@ protected:
 
 			virtual void* threadBody();
 
+			void fillIovs(Buf *bufs, struct iovec *iov, struct mmsghdr *msg);
+
+			// one system call's worth of datagrams; returns the
+			// number of datagrams received
+			unsigned receive(bool wait);
+
 		public:
-			CUdpRxHandlerThread(const char *name, int threadPriority, struct sockaddr_in *dest, struct sockaddr_in *me, CProtoModUdp *owner);
+			CUdpRxHandlerThread(const char *name, int threadPriority, struct sockaddr_in *dest, struct sockaddr_in *me, CProtoModUdp *owner, unsigned batch = 1);
 			CUdpRxHandlerThread(CUdpRxHandlerThread &orig, struct sockaddr_in *dest, struct sockaddr_in *me, CProtoModUdp *owner);
 
+			virtual unsigned getBatch() const { return batch_; }
+
+			// (re-)populate the receive buffers; the buffer pool
+			// is only known once the module is started
+			virtual void initBufs();
+
+			// read what is available without blocking (I/O engine)
+			virtual void handleInput();
+
 			virtual uint64_t getNumOctets() { return nOctets_.load( cpsw::memory_order_relaxed ); }
 			virtual uint64_t getNumDgrams() { return nDgrams_.load( cpsw::memory_order_relaxed ); }
 			virtual uint64_t getNumRxDrop() { return nRxDrop_.load( cpsw::memory_order_relaxed ); }
@@ -93,18 +130,52 @@ protected:
 			virtual ~CUdpRxHandlerThread() { threadStop(); }
 	};
 
+	// drains the TX queue and hands batches of
+	// messages to the kernel with a single 'sendmmsg'
+	class CUdpTxHandlerThread : public CRunnable {
+		private:
+			CProtoModUdp   *owner_;
+
+		protected:
+
+			virtual void* threadBody();
+
+		public:
+			CUdpTxHandlerThread(const char *name, int threadPriority, CProtoModUdp *owner);
+
+			virtual ~CUdpTxHandlerThread() { threadStop(); }
+	};
+
 private:
 	struct sockaddr_in dest_;
 	CSockSd            tx_;
 	atomic<uint64_t>   nTxOctets_;
 	atomic<uint64_t>   nTxDgrams_;
+	atomic<uint64_t>   nTxDrops_;
 	int                threadPriority_;
+	unsigned           rxBatch_;
+	unsigned           txBatch_;
+	BufQueue           txQueue_;
+	// 'sendBatch' scratch (TX thread only); 'txIov_' grows if
+	// a batch carries more than NBUFS_MAX buffers per message
+	std::vector<struct mmsghdr> txMsgs_;
+	std::vector<struct iovec>   txIov_;
+	BufPool            rxPool_;
+	unsigned           ioEngineThreads_;
+	IoEngine           ioEngine_;
 protected:
 	std::vector< CUdpRxHandlerThread * > rxHandlers_;
 	CUdpPeerPollerThread                 *poller_;
+	CUdpTxHandlerThread                  *txHandler_;
 
 	void createThreads(unsigned nRxThreads, int pollSeconds);
 
+	// send up to 'n' chains; returns the number of chains sent
+	virtual unsigned sendBatch(BufChain *bcs, unsigned n);
+
+	// from the application's pool if there is one (and it is not exhausted)
+	virtual Buf getRxBuf();
+
 	virtual bool doPush(BufChain bc, bool wait, const CTimeout *timeout, bool abs_timeout);
 
 	virtual bool push(BufChain bc, const CTimeout *timeout, bool abs_timeout)
@@ -121,7 +192,13 @@ protected:
 
 public:
 	// negative or zero 'pollSecs' avoids creating a poller thread
-	CProtoModUdp(Key &k, struct sockaddr_in *dest, unsigned depth, int threadPriority, unsigned nRxThreads = 1, int pollSecs = 4);
+	// 'rxBatch'/'txBatch' > 1 use recvmmsg/sendmmsg to transfer
+	// up to that many datagrams per system call; TX then goes
+	// through a queue (of depth 'txBatch' * 4) and a dedicated thread.
+	// 'ioEngineThreads' > 0 services the socket (and poller) from the
+	// shared pool of I/O engine threads instead of dedicated threads
+	// ('nRxThreads' is then ignored).
+	CProtoModUdp(Key &k, struct sockaddr_in *dest, unsigned depth, int threadPriority, unsigned nRxThreads = 1, int pollSecs = 4, bool lockFreeQueue = false, unsigned rxBatch = 1, unsigned txBatch = 1, unsigned ioEngineThreads = 0);
 
 	CProtoModUdp(CProtoModUdp &orig, Key &k);
 
@@ -135,7 +212,26 @@ public:
 		return ntohs( dest_.sin_port );
 	}
 
+	virtual unsigned getRxBatchSize() const
+	{
+		return rxBatch_;
+	}
+
+	virtual unsigned getTxBatchSize() const
+	{
+		return txBatch_;
+	}
+
+	virtual unsigned getIoEngineThreads() const
+	{
+		return ioEngineThreads_;
+	}
+
 	virtual void dumpInfo(FILE *f);
+	virtual void collectMetrics(IMetricsSink *sink);
+
+	// receive into application memory; must be set before the module is started
+	virtual void setRxBufPool(BufPool pool);
 
 	virtual CProtoModUdp *clone(Key &k)
 	{
@@ -144,6 +240,7 @@ public:
 
 	virtual uint64_t getNumTxOctets() { return nTxOctets_.load( cpsw::memory_order_relaxed ); }
 	virtual uint64_t getNumTxDgrams() { return nTxDgrams_.load( cpsw::memory_order_relaxed ); }
+	virtual uint64_t getNumTxDrops()  { return nTxDrops_.load ( cpsw::memory_order_relaxed ); }
 	virtual uint64_t getNumRxOctets();
 	virtual uint64_t getNumRxDgrams();
 	virtual uint64_t getNumRxDrops();
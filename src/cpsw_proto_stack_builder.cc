@@ -38,20 +38,29 @@ int cpsw_psbldr_debug = PSBLDR_DEBUG;
 class CProtoStackBuilder : public IProtoStackBuilder {
 	public:
 		typedef enum TransportProto { NONE = 0,  UDP  = 1,  TCP = 2 } TransportProto;
-		typedef enum SRPWriteMode   { UNSP = -1, POST = 0, SYNC = 1 } SRPWriteMode;
+		typedef enum SRPWriteMode   { UNSP = -1, POST = 0, SYNC = 1, PIPE = 2 } SRPWriteMode;
 	private:
 		INetIODev::ProtocolVersion protocolVersion_;
 		uint64_t                   SRPTimeoutUS_;
 		int                        SRPDynTimeout_;
+		double                     SRPDynTimeoutPercentile_;
+		unsigned                   SRPDynTimeoutMargin_;
 		unsigned                   SRPRetryCount_;
 		SRPWriteMode               SRPDefaultWriteMode_;
+		unsigned                   SRPShadowCacheMaxBytes_;
+		unsigned                   SRPReadWindow_;
+		unsigned                   SRPWriteWindow_;
 		TransportProto             Xprt_;
 		unsigned                   XprtPort_;
 		unsigned                   XprtOutQueueDepth_;
         int                        UdpThreadPriority_;
 		unsigned                   UdpNumRxThreads_;
 		int                        UdpPollSecs_;
+		unsigned                   UdpRxBatchSize_;
+		unsigned                   UdpTxBatchSize_;
+		unsigned                   UdpIoEngineThreads_;
         int                        TcpThreadPriority_;
+		unsigned                   TcpIoEngineThreads_;
 		bool                       hasRssi_;
         int                        RssiThreadPriority_;
 		int                        hasDepack_;
@@ -74,6 +83,8 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 		struct LibSocksProxy       socksProxy_;
 		in_addr_t                  rssiBridgeIPAddr_;
 		CRssiConfigParams          rssiConfig_;
+		bool                       lockFreeQueues_;
+		BufPool                    rxBufPool_;
 		bool                       autoStart_;
 	public:
 		virtual void reset()
@@ -81,15 +92,24 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			protocolVersion_        = SRP_UDP_V2;
 			SRPTimeoutUS_           = 0;
 			SRPDynTimeout_          = -1;
+			SRPDynTimeoutPercentile_= 0.;
+			SRPDynTimeoutMargin_    = 100;
 			SRPRetryCount_          = -1;
 			SRPDefaultWriteMode_    = UNSP;
+			SRPShadowCacheMaxBytes_ = 0;
+			SRPReadWindow_          = 1;
+			SRPWriteWindow_         = 8;
 			Xprt_                   = UDP;
 			XprtPort_               = 8192;
 			XprtOutQueueDepth_      = 0;
 			UdpThreadPriority_      = IProtoStackBuilder::DFLT_THREAD_PRIORITY;
 			UdpNumRxThreads_        = 0;
 			UdpPollSecs_            = -1;
+			UdpRxBatchSize_         = 1;
+			UdpTxBatchSize_         = 1;
+			UdpIoEngineThreads_     = 0;
 			TcpThreadPriority_      = IProtoStackBuilder::DFLT_THREAD_PRIORITY;
+			TcpIoEngineThreads_     = 0;
 			hasRssi_                = false;
 			hasDepack_              = -1;
 			depackProto_            = DEPACKETIZER_V0;
@@ -112,6 +132,8 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			rssiBridgeIPAddr_       = INADDR_NONE;
 			socksProxy_.version     = SOCKS_VERSION_NONE;
 			rssiConfig_             = CRssiConfigParams();
+			lockFreeQueues_         = false;
+			rxBufPool_.reset();
 			autoStart_              = true; // legacy behaviour
 		}
 
@@ -193,6 +215,9 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 				case SYNCHRONOUS:
 					SRPDefaultWriteMode_ = SYNC;
 				break;
+				case PIPELINED:
+					SRPDefaultWriteMode_ = PIPE;
+				break;
 				default:
 					SRPDefaultWriteMode_ = POST;
 				break;
@@ -204,7 +229,42 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			// If this was never set (UNSP) -> default to POSTED
 			if ( UNSP == SRPDefaultWriteMode_ )
 				return hasRssi() ? POSTED : SYNCHRONOUS;
-			return SRPDefaultWriteMode_ == SYNC ? SYNCHRONOUS : POSTED;
+			switch ( SRPDefaultWriteMode_ ) {
+				case SYNC: return SYNCHRONOUS;
+				case PIPE: return PIPELINED;
+				default:   break;
+			}
+			return POSTED;
+		}
+
+		virtual void            setSRPShadowCacheMaxBytes(unsigned v)
+		{
+			SRPShadowCacheMaxBytes_ = v;
+		}
+
+		virtual unsigned        getSRPShadowCacheMaxBytes()
+		{
+			return SRPShadowCacheMaxBytes_;
+		}
+
+		virtual void            setSRPReadWindow(unsigned v)
+		{
+			SRPReadWindow_ = v;
+		}
+
+		virtual unsigned        getSRPReadWindow()
+		{
+			return SRPReadWindow_;
+		}
+
+		virtual void            setSRPWriteWindow(unsigned v)
+		{
+			SRPWriteWindow_ = v;
+		}
+
+		virtual unsigned        getSRPWriteWindow()
+		{
+			return SRPWriteWindow_;
 		}
 
 		virtual void            setSRPRetryCount(unsigned v)
@@ -243,6 +303,28 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			return SRPDynTimeout_ ? true : false;
 		}
 
+		virtual void            setSRPDynTimeoutPercentile(double v)
+		{
+			if ( v < 0. || v > 100. )
+				throw InvalidArgError("SRP dynamic timeout percentile must be in 0..100");
+			SRPDynTimeoutPercentile_ = v;
+		}
+
+		virtual double          getSRPDynTimeoutPercentile()
+		{
+			return SRPDynTimeoutPercentile_;
+		}
+
+		virtual void            setSRPDynTimeoutMargin(unsigned v)
+		{
+			SRPDynTimeoutMargin_ = v;
+		}
+
+		virtual unsigned        getSRPDynTimeoutMargin()
+		{
+			return SRPDynTimeoutMargin_;
+		}
+
 		virtual void setXprtPort(unsigned v)
 		{
 			if ( v > 65535 || v == 0 )
@@ -282,6 +364,18 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			return TcpThreadPriority_;
 		}
 
+		virtual void            setTcpIoEngineThreads(unsigned v)
+		{
+			if ( v > 100 )
+				throw InvalidArgError("Too many I/O engine threads");
+			TcpIoEngineThreads_ = v;
+		}
+
+		virtual unsigned        getTcpIoEngineThreads()
+		{
+			return TcpIoEngineThreads_;
+		}
+
 		virtual void            setUdpThreadPriority(int prio)
 		{
 			UdpThreadPriority_ = prio;
@@ -357,6 +451,42 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			return UdpPollSecs_;
 		}
 
+		virtual void            setUdpRxBatchSize(unsigned v)
+		{
+			if ( v > 1024 )
+				throw InvalidArgError("UDP RX batch size too big");
+			UdpRxBatchSize_ = v < 1 ? 1 : v;
+		}
+
+		virtual unsigned        getUdpRxBatchSize()
+		{
+			return UdpRxBatchSize_;
+		}
+
+		virtual void            setUdpTxBatchSize(unsigned v)
+		{
+			if ( v > 1024 )
+				throw InvalidArgError("UDP TX batch size too big");
+			UdpTxBatchSize_ = v < 1 ? 1 : v;
+		}
+
+		virtual unsigned        getUdpTxBatchSize()
+		{
+			return UdpTxBatchSize_;
+		}
+
+		virtual void            setUdpIoEngineThreads(unsigned v)
+		{
+			if ( v > 100 )
+				throw InvalidArgError("Too many I/O engine threads");
+			UdpIoEngineThreads_ = v;
+		}
+
+		virtual unsigned        getUdpIoEngineThreads()
+		{
+			return UdpIoEngineThreads_;
+		}
+
 		virtual void            useRssi(bool v)
 		{
 			hasRssi_ = v;
@@ -608,6 +738,32 @@ class CProtoStackBuilder : public IProtoStackBuilder {
 			return &rssiConfig_;
 		}
 
+		virtual void useLockFreeQueues(bool v)
+		{
+			lockFreeQueues_              = v;
+			rssiConfig_.lockFreeQueues_  = v;
+		}
+
+		virtual bool hasLockFreeQueues()
+		{
+			return lockFreeQueues_;
+		}
+
+		virtual void setRxMemRegion(void *mem, uint64_t size, unsigned slotSize)
+		{
+			if ( mem ) {
+				rxBufPool_ = IBufPool::create( mem, size, slotSize );
+			} else {
+				rxBufPool_.reset();
+			}
+		}
+
+		// not part of the public interface (IBufPool is internal)
+		virtual BufPool getRxBufPool()
+		{
+			return rxBufPool_;
+		}
+
 		virtual bool getAutoStart()
 		{
 			return autoStart_;
@@ -639,10 +795,14 @@ uint64_t                   u64;
 bool                       b;
 SRPProtoVersion            proto_vers;
 int                        i;
+double                     d;
 WriteMode                  writeMode;
 
 	reset();
 
+	if ( readNode(node, YAML_KEY_lockFreeQueues, &b) )
+		useLockFreeQueues( b );
+
 	{
 		YamlState nn( &node, YAML_KEY_SRP );
 		if ( !!nn && nn.IsMap() )
@@ -659,8 +819,18 @@ WriteMode                  writeMode;
 				setSRPTimeoutUS( u64 );
 			if ( readNode(nn, YAML_KEY_dynTimeout, &b) )
 				useSRPDynTimeout( b );
+			if ( readNode(nn, YAML_KEY_dynTimeoutPercentile, &d) )
+				setSRPDynTimeoutPercentile( d );
+			if ( readNode(nn, YAML_KEY_dynTimeoutMargin, &u) )
+				setSRPDynTimeoutMargin( u );
 			if ( readNode(nn, YAML_KEY_retryCount, &u) )
 				setSRPRetryCount( u );
+			if ( readNode(nn, YAML_KEY_shadowCacheMaxBytes, &u) )
+				setSRPShadowCacheMaxBytes( u );
+			if ( readNode(nn, YAML_KEY_readWindow, &u) )
+				setSRPReadWindow( u );
+			if ( readNode(nn, YAML_KEY_writeWindow, &u) )
+				setSRPWriteWindow( u );
 			if ( readNode(nn, YAML_KEY_defaultWriteMode, &writeMode) )
 			{
 				if ( hasSRPMux_ < 0 || UNSP == SRPDefaultWriteMode_ ) {
@@ -681,6 +851,8 @@ WriteMode                  writeMode;
 					setTcpOutQueueDepth( u );
 				if ( readNode(nn, YAML_KEY_threadPriority, &i) )
 					setTcpThreadPriority( i );
+				if ( readNode(nn, YAML_KEY_ioEngineThreads, &u) )
+					setTcpIoEngineThreads( u );
 			}
 		}
 	}
@@ -702,6 +874,12 @@ WriteMode                  writeMode;
 					setUdpPollSecs( i );
 				if ( readNode(nn, YAML_KEY_threadPriority, &i) )
 					setUdpThreadPriority( i );
+				if ( readNode(nn, YAML_KEY_rxBatchSize, &u) )
+					setUdpRxBatchSize( u );
+				if ( readNode(nn, YAML_KEY_txBatchSize, &u) )
+					setUdpTxBatchSize( u );
+				if ( readNode(nn, YAML_KEY_ioEngineThreads, &u) )
+					setUdpIoEngineThreads( u );
 			}
 		}
 	}
@@ -733,6 +911,12 @@ WriteMode                  writeMode;
 			if ( readNode(nn, YAML_KEY_retransmissionTimeoutUS, &u) ) {
 				rssiConfig_.rexTimeoutUS_      = u;
 			}
+			if ( readNode(nn, YAML_KEY_minRetransmissionTimeoutUS, &u) ) {
+				rssiConfig_.rexTimeoutMinUS_   = u;
+			}
+			if ( readNode(nn, YAML_KEY_maxRetransmissionTimeoutUS, &u) ) {
+				rssiConfig_.rexTimeoutMaxUS_   = u;
+			}
 			if ( readNode(nn, YAML_KEY_cumulativeAckTimeoutUS,  &u) ) {
 				rssiConfig_.cumAckTimeoutUS_   = u;
 			}
@@ -748,6 +932,12 @@ WriteMode                  writeMode;
 			if ( readNode(nn, YAML_KEY_maxSegmentSize,          &u) ) {
 				rssiConfig_.forcedSegsMax_     = u;
 			}
+			if ( readNode(nn, YAML_KEY_reactorThreads,          &u) ) {
+				rssiConfig_.reactorThreads_    = u;
+			}
+			if ( readNode(nn, YAML_KEY_selectiveAck,            &b) ) {
+				rssiConfig_.selectiveAck_      = b;
+			}
 		}
 	}
 	{
@@ -1021,12 +1211,18 @@ bool                           hasSRP = IProtoStackBuilder::SRP_UDP_NONE != bldr
 
 		if ( bldr->hasUdp() ) {
 			// Note: transport module MUST have a queue if RSSI is used
-			rval = CShObj::create< ProtoModUdp >( &dst,
+			ProtoModUdp udpMod = CShObj::create< ProtoModUdp >( &dst,
 			                                       bldr->getUdpOutQueueDepth(),
 			                                       bldr->getUdpThreadPriority(),
 			                                       bldr->getUdpNumRxThreads(),
-			                                       bldr->getUdpPollSecs()
+			                                       bldr->getUdpPollSecs(),
+			                                       bldr->hasLockFreeQueues(),
+			                                       bldr->getUdpRxBatchSize(),
+			                                       bldr->getUdpTxBatchSize(),
+			                                       bldr->getUdpIoEngineThreads()
 			);
+			udpMod->setRxBufPool( bldr->getRxBufPool() );
+			rval = udpMod;
 		} else {
 			struct sockaddr_in via = dst;
 
@@ -1062,12 +1258,16 @@ bool                           hasSRP = IProtoStackBuilder::SRP_UDP_NONE != bldr
 				via.sin_port = htons( map[0].actPort );
 			}
 
-			rval = CShObj::create< ProtoModTcp >( &dst,
+			ProtoModTcp tcpMod = CShObj::create< ProtoModTcp >( &dst,
 			                                      bldr->getTcpOutQueueDepth(),
 			                                      bldr->getTcpThreadPriority(),
 			                                      bldr->getSocksProxy(),
-			                                      &via
+			                                      &via,
+			                                      bldr->hasLockFreeQueues(),
+			                                      bldr->getTcpIoEngineThreads()
 			);
+			tcpMod->setRxBufPool( bldr->getRxBufPool() );
+			rval = tcpMod;
 		}
 
 		if ( bldr->hasRssiAndUdp() ) {
@@ -1095,7 +1295,8 @@ bool                           hasSRP = IProtoStackBuilder::SRP_UDP_NONE != bldr
 			                                bldr->getDepackLdFrameWinSize(),
 			                                bldr->getDepackLdFragWinSize(),
 			                                CTimeout(),
-			                                bldr->getDepackThreadPriority());
+			                                bldr->getDepackThreadPriority(),
+			                                bldr->hasLockFreeQueues());
 			rval->addAtPort( depackMod );
 			rval = depackMod;
 		}
@@ -1161,7 +1362,8 @@ bool                           hasSRP = IProtoStackBuilder::SRP_UDP_NONE != bldr
 			                       bldr->getTDestMuxTDEST(),
 			                       bldr->getTDestMuxStripHeader(),
 			                       bldr->getTDestMuxOutQueueDepth(),
-			                       bldr->getTDestMuxInpQueueDepth()
+			                       bldr->getTDestMuxInpQueueDepth(),
+			                       bldr->hasLockFreeQueues()
 			                     );
 		} else {
 #ifdef PSBLDR_DEBUG
@@ -1172,7 +1374,8 @@ bool                           hasSRP = IProtoStackBuilder::SRP_UDP_NONE != bldr
 			rval = v0->createPort(
 			                       bldr->getTDestMuxTDEST(),
 			                       bldr->getTDestMuxStripHeader(),
-			                       bldr->getTDestMuxOutQueueDepth()
+			                       bldr->getTDestMuxOutQueueDepth(),
+			                       bldr->hasLockFreeQueues()
 			                     );
 		}
 	}
@@ -1190,7 +1393,7 @@ bool                           hasSRP = IProtoStackBuilder::SRP_UDP_NONE != bldr
 		// reserve enough queue depth - must potentially hold replies to synchronous retries
 		// until the synchronous reader comes along for the next time!
 		unsigned retryCount = bldr->getSRPRetryCount() & 0xffff; // undocumented hack to test byte-resolution access
-		rval = srpMuxMod->createPort( bldr->getSRPMuxVirtualChannel(), 2 * (retryCount + 1) );
+		rval = srpMuxMod->createPort( bldr->getSRPMuxVirtualChannel(), 2 * (retryCount + 1), bldr->hasLockFreeQueues() );
 #ifdef PSBLDR_DEBUG
 		if ( cpsw_psbldr_debug > 0 ) {
 			fprintf(CPSW::fDbg(), "  creating SRP mux port\n");
@@ -11,6 +11,7 @@
 #include <inttypes.h>
 
 #include <cpsw_rssi.h>
+#include <cpsw_rssi_reactor.h>
 #include <cpsw_stdio.h>
 
 #include <vector>
@@ -28,6 +29,7 @@ void CRssi::attach(IEventSource *upstreamReadEventSource)
 		fprintf(CPSW::fDbg(),"%s: attach\n", ""); 
 	}
 #endif
+	upstreamSrc_ = upstreamReadEventSource;
 	eventSet_->add( upstreamReadEventSource, recvEH() );
 #ifdef RSSI_DEBUG
 	if ( cpsw_rssi_debug > 3 ) {
@@ -37,12 +39,14 @@ void CRssi::attach(IEventSource *upstreamReadEventSource)
 }
 
 static BufQueue
-mkQ(unsigned desiredDepth, unsigned ldMaxUnackedSegs)
+mkQ(unsigned desiredDepth, unsigned ldMaxUnackedSegs, bool lockFree)
 {
 	if ( 0 == desiredDepth ) {
 		desiredDepth = (1<<ldMaxUnackedSegs) + 4;
 	}
-	return IBufQueue::create( desiredDepth );
+	// the test server (libTstAux) supplies its own IBufQueue::create(unsigned)
+	// which must keep being used when no lock-free queue is requested.
+	return lockFree ? IBufQueue::create( desiredDepth, true ) : IBufQueue::create( desiredDepth );
 }
 	
 CRssi::CRssi(
@@ -55,17 +59,20 @@ CRssi::CRssi(
   IRexTimer      ( &timers_ ),
   IAckTimer      ( &timers_ ),
   INulTimer      ( &timers_ ),
-
+  IReopenTimer   ( &timers_ ),
 
   defaults_      ( defaults ? defaults->assertValid() : CRssiConfigParams() ),
   isServer_      ( isServer ),
 
   name_          ( isServer ? "S" : "C"              ),
   mtuQuerier_    ( mtuQuerier                        ),
+  upstreamSrc_   ( 0                                 ),
   outQ_          ( mkQ(defaults_.outQueueDepth_,
-                       defaults_.ldMaxUnackedSegs_)  ),
+                       defaults_.ldMaxUnackedSegs_,
+                       defaults_.lockFreeQueues_)    ),
   inpQ_          ( mkQ(defaults_.inpQueueDepth_,
-                       defaults_.ldMaxUnackedSegs_)  ),
+                       defaults_.ldMaxUnackedSegs_,
+                       defaults_.lockFreeQueues_)    ),
   state_         ( &stateCLOSED                      ),
   timerUnits_    ( UNIT_US                           ),
   timerUnitExp_  ( UNIT_US_EXP                       ),
@@ -84,13 +91,32 @@ CRssi::CRssi(
 	eventSet_->add( outQ_->getWriteEventSource(), usrOEH() );
 }
 
-void CRssi::processAckNumber(uint8_t flags, SeqNo ackNo)
+void CRssi::processAckNumber(RssiHeader &hdr, bool hasPayload)
 {
-int acked;
-	if ( (flags & RssiHeader::FLG_ACK) ) {
-		if ( (acked = unAckedSegs_.ack( ackNo )) > 0 ) {
-			numRex_ = 0;
+int      acked;
+unsigned i;
+SeqNo    oldest;
+CTimeout now;
+	rexAcked_ = false;
+	if ( (hdr.getFlags() & RssiHeader::FLG_ACK) ) {
+		oldest = unAckedSegs_.getOldest();
+		if ( (acked = unAckedSegs_.ack( hdr.getAckNo() )) > 0 ) {
+			numRex_    = 0;
+			numDupAck_ = 0;
 			stats_.numSegsAckedByPeer_ += acked;
+			if ( rttTiming_ && (SeqNo)(rttSeqNo_ - oldest) < acked ) {
+				rttTiming_ = false;
+				eventSet_->getAbsTime( &now );
+				if ( rttStart_ < now ) {
+					sampleRtt( (now - rttStart_).getUs() );
+				}
+			}
+		}
+		if ( (hdr.getFlags() & RssiHeader::FLG_EAC) ) {
+			stats_.eacksRcvd_++;
+			for ( i = 0; i < hdr.getEackNum(); i++ ) {
+				unAckedSegs_.eack( hdr.getEack( i ) );
+			}
 		}
 		if ( unAckedSegs_.getSize() == 0 ) {
 #ifdef RSSI_DEBUG
@@ -99,17 +125,128 @@ int acked;
 			}
 #endif
 			rexTimer()->cancel();
-			numRex_ = 0;
+			numRex_    = 0;
+			numDupAck_ = 0;
 		} else {
 #ifdef RSSI_DEBUG
 			if ( cpsw_rssi_debug > 3 ) {
 				fprintf(CPSW::fDbg(),"%s: outstanding ACKS %d (oldest %d)\n", getName(), unAckedSegs_.getSize(), unAckedSegs_.getOldest());
 			}
 #endif
+			// The peer ACKs out-of-sequence segments immediately; thus
+			// repeated pure ACKs which do not advance mean that it is
+			// missing (at least) our oldest segment.
+			if ( 0 == acked && ! hasPayload && hdr.isPureAck() && ! (hdr.getFlags() & RssiHeader::FLG_BSY) ) {
+				stats_.dupAcks_++;
+				if ( ++numDupAck_ == FAST_REX_DUP_ACKS ) {
+					retransmit( true );
+					// retransmitted segments carry our ACK
+					rexAcked_ = true;
+				}
+			}
 		}
 	}
 }
 
+// Resend unacknowledged segments except for those the peer reported
+// (EACK) to hold already. A fast retransmission only fills the holes
+// up to the newest EACKed segment or -- lacking EACK information --
+// resends just the oldest one.
+void CRssi::retransmit(bool fast)
+{
+RingBuf::iterator it   = unAckedSegs_.begin();
+unsigned          span = fast ? unAckedSegs_.getEackedSpan() : unAckedSegs_.getSize();
+unsigned          i;
+BufChain          bc;
+
+	if ( 0 == span )
+		span = 1;
+
+	// an ACK for a retransmitted segment yields no valid RTT sample (Karn)
+	rttTiming_ = false;
+
+	for ( i = 0; i < span && (bc = *it); i++, ++it ) {
+		if ( it.isEacked() ) {
+			stats_.eackedNotRex_++;
+			continue;
+		}
+		if ( fast )
+			stats_.fastRexSegments_++;
+		else
+			stats_.rexSegments_++;
+#ifdef RSSI_DEBUG
+		if ( cpsw_rssi_debug > 2 ) {
+			fprintf(CPSW::fDbg(),"%s: %sretransmitting (state %s)\n", getName(), fast ? "fast " : "", state_->getName());
+		}
+#endif
+		sendBuf( bc, true );
+	}
+
+	if ( i > 0 )
+		armRexAndNulTimer();
+}
+
+void CRssi::resetRttEstimator()
+{
+// RTT samples include the time the peer holds back a cumulative
+// ACK; hence the estimate covers that and the floor can be small.
+uint64_t lo = defaults_.rexTimeoutMinUS_ ? defaults_.rexTimeoutMinUS_ : units_;
+uint64_t hi = defaults_.rexTimeoutMaxUS_ ? defaults_.rexTimeoutMaxUS_ : rexTO_.getUs();
+
+	if ( lo > hi )
+		lo = hi;
+
+	rexTOMin_  = CTimeout( lo );
+	rexTOMax_  = CTimeout( hi );
+
+	// start out with the negotiated value
+	if ( rexTO_ < rexTOMin_ )
+		rexTO_ = rexTOMin_;
+	if ( rexTOMax_ < rexTO_ )
+		rexTO_ = rexTOMax_;
+
+	srttUS_    = 0;
+	rttVarUS_  = 0;
+	rttTiming_ = false;
+}
+
+void CRssi::sampleRtt(uint64_t us)
+{
+uint64_t dev, rto;
+
+	if ( 0 == srttUS_ ) {
+		srttUS_   = us ? us : 1;
+		rttVarUS_ = us/2;
+	} else {
+		dev       = srttUS_ > us ? srttUS_ - us : us - srttUS_;
+		rttVarUS_ = rttVarUS_ - (rttVarUS_ >> 2) + (dev >> 2);
+		srttUS_   = srttUS_   - (srttUS_   >> 3) + (us  >> 3);
+	}
+
+	// at least one timer unit of margin
+	rto = srttUS_ + ( 4*rttVarUS_ > units_ ? 4*rttVarUS_ : units_ );
+
+	if ( rto < rexTOMin_.getUs() )
+		rto = rexTOMin_.getUs();
+	if ( rto > rexTOMax_.getUs() )
+		rto = rexTOMax_.getUs();
+
+	rexTO_ = CTimeout( rto );
+
+	stats_.rttSamples_++;
+}
+
+void CRssi::backoffRexTimeout()
+{
+uint64_t rto = 2*rexTO_.getUs();
+
+	if ( rto > rexTOMax_.getUs() )
+		rto = rexTOMax_.getUs();
+
+	rexTO_     = CTimeout( rto );
+	rttTiming_ = false;
+}
+
 void CRssi::handleRxEvent(IIntEventSource *src)
 {
 #ifdef RSSI_DEBUG
@@ -149,6 +286,7 @@ void CRssi::resetNegotiableParams()
 	setNulTimeout( defaults_.nulTimeoutUS_ );
 	rexMX_   = defaults_.rexMax_;
 	cakMX_   = defaults_.cumAckMax_;
+	resetRttEstimator();
 }
 
 void CRssi::close()
@@ -160,6 +298,7 @@ void CRssi::close()
 	ackTimer()->cancel();
 	nulTimer()->cancel();
 	rexTimer()->cancel();
+	reopenTimer()->cancel();
 
 	// initial default values
 	resetNegotiableParams();
@@ -169,8 +308,11 @@ void CRssi::close()
 
 	numRex_         = 0;
 	numCak_         = 0;
+	numDupAck_      = 0;
 
 	peerBSY_        = false;
+	peerEAK_        = false;
+	rexAcked_       = false;
 
 	// we don't know the peer's setting yet (it's in the SYN packet)
 	// -> don't verify their checksum but always add ours
@@ -233,6 +375,18 @@ void CRssi::sendBuf(BufChain bc, bool retrans)
 	}
 }
 
+// The peer may hold back its ACK for up to 'cakTO_' until it has
+// more than 'cakMX_' segments to acknowledge. Retransmitting earlier
+// would be spurious -- and since such a segment yields no RTT sample
+// the estimator would never learn about the delay.
+CTimeout CRssi::getArmedRexTimeout()
+{
+	if ( rexTO_ < cakTO_ && unAckedSegs_.getSize() <= (unsigned)cakMX_ ) {
+		return cakTO_;
+	}
+	return rexTO_;
+}
+
 void CRssi::armRexAndNulTimer()
 {
 	CTimeout now;
@@ -241,7 +395,7 @@ void CRssi::armRexAndNulTimer()
 		eventSet_->getAbsTime( &now );
 
 		if ( ! peerBSY_ ) {
-			rexTimer()->arm_abs( now + rexTO_ );
+			rexTimer()->arm_abs( now + getArmedRexTimeout() );
 #ifdef RSSI_DEBUG
 			if ( cpsw_rssi_debug > 2 ) {
 				fprintf(CPSW::fDbg(),"%s: REX timer armed (state %s)\n", getName(), state_->getName());
@@ -262,6 +416,12 @@ void CRssi::armRexAndNulTimer()
 
 void CRssi::sendBufAndKeepForRetransmission(BufChain b)
 {
+	// time one segment per round trip
+	if ( ! rttTiming_ ) {
+		rttTiming_ = true;
+		rttSeqNo_  = RssiHeader( b->getHead()->getPayload() ).getSeqNo();
+		eventSet_->getAbsTime( &rttStart_ );
+	}
 	sendBuf( b, false );
 	unAckedSegs_.push( b );
 	armRexAndNulTimer();
@@ -285,10 +445,19 @@ void CRssi::sendACK()
 BufChain   bc = IBufChain::create();
 Buf        b  = bc->createAtHead( IBuf::CAPA_ETH_HDR );
 RssiHeader hdr( b->getPayload(), b->getAvail(), false, RssiHeader::SET );
+uint8_t    eacks[256];
+unsigned   n;
 
 	hdr.setFlags( RssiHeader::FLG_ACK );
 	hdr.setSeqNo( lastSeqSent_ + 1 );
 
+	// tell the peer what we hold beyond the gap so it resends only the holes
+	if ( peerEAK_ && (n = unOrderedSegs_.getOutOfOrder( eacks, sizeof(eacks) - 1 )) > 0 ) {
+		hdr.setFlags( RssiHeader::FLG_ACK | RssiHeader::FLG_EAC );
+		hdr.setEackList( eacks, n );
+		stats_.eacksSent_++;
+	}
+
 	b->setSize( hdr.getHSize() );
 
 	// ACK is never retransmitted
@@ -373,6 +542,9 @@ int           maxSegSize;
 	synHdr.setSeqNo( ( lastSeqSent_ = (SeqNo)(time(NULL) ^ (isServer_ ? -1 : 0) ) ) );
 
 	flags = RssiSynHeader::XFL_ONE;
+	// the bit is reserved by the spec; only set it if asked to
+	if ( defaults_.selectiveAck_ )
+		flags |= RssiSynHeader::XFL_EAK;
 	if ( addChecksum_ )
 		flags |= RssiSynHeader::XFL_CHK;
 
@@ -445,6 +617,7 @@ int           maxSegSize;
 void CRssi::processRetransmissionTimeout()
 {
 	stats_.rexTimeouts_++;
+	backoffRexTimeout();
 #ifdef RSSI_DEBUG
 	if ( cpsw_rssi_debug > 2 ) {
 		fprintf(CPSW::fDbg(),"%s: RexTimer expired\n", getName());
@@ -453,6 +626,16 @@ void CRssi::processRetransmissionTimeout()
 	state_->processRetransmissionTimeout( this );
 }
 
+void CRssi::processReopenTimeout()
+{
+#ifdef RSSI_DEBUG
+	if ( cpsw_rssi_debug > 2 ) {
+		fprintf(CPSW::fDbg(),"%s: ReopenTimer expired\n", getName());
+	}
+#endif
+	state_->processReopenTimeout( this );
+}
+
 void CRssi::processAckTimeout()
 {
 	stats_.ackTimeouts_++;
@@ -484,6 +667,42 @@ void * CRssi::threadBody()
 	return NULL;
 }
 
+// Move our event sources to the set 'evSet' (which the
+// serving reactor waits on) or back to our private one.
+void CRssi::reactorBind(EventSet evSet)
+{
+	if ( ! evSet )
+		evSet = eventSet_;
+	evSet->add( inpQ_->getReadEventSource() , usrIEH() );
+	evSet->add( outQ_->getWriteEventSource(), usrOEH() );
+	if ( upstreamSrc_ )
+		evSet->add( upstreamSrc_, recvEH() );
+}
+
+// Run state transitions which don't wait and process expired
+// timers; this is what 'advance' does in our private thread.
+void CRssi::reactorAdvance(const CTimeout &now)
+{
+RssiTimer *timer;
+
+	while ( ! state_->waitsForEvent() ) {
+		state_->advance( this );
+	}
+	while ( (timer = timers_.getFirstToExpire()) && ! (now < *timer->getTimeout()) ) {
+		timer->cancel();
+		timer->process();
+		while ( ! state_->waitsForEvent() ) {
+			state_->advance( this );
+		}
+	}
+}
+
+const CTimeout *CRssi::reactorGetTimeout()
+{
+RssiTimer *timer = timers_.getFirstToExpire();
+	return timer ? timer->getTimeout() : 0;
+}
+
 void CRssi::changeState(STATE *newState)
 {
 int newConnState = newState->getConnectionState( this );
@@ -570,6 +789,44 @@ void CRssi::dumpStats(FILE *f)
 	fprintf(f ,"  # segments delivered to usr: %12u\n", stats_.numSegsGivenToUser_);
 	fprintf(f ,"  # RX segs with BSY asserted: %12u\n", stats_.busyFlagsCountedRx_);
 	fprintf(f ,"  # TX segs with BSY asserted: %12u\n", stats_.busyFlagsCountedTx_);
+	fprintf(f ,"  # duplicate ACKs received  : %12u\n", stats_.dupAcks_           );
+	fprintf(f ,"  # fast retransmitted segs  : %12u\n", stats_.fastRexSegments_   );
+	fprintf(f ,"  # EACKs sent               : %12u\n", stats_.eacksSent_         );
+	fprintf(f ,"  # EACKs received           : %12u\n", stats_.eacksRcvd_         );
+	fprintf(f ,"  # EACKed segs not resent   : %12u\n", stats_.eackedNotRex_      );
+	fprintf(f ,"  # RTT samples              : %12u\n", stats_.rttSamples_        );
+	fprintf(f ,"  smoothed RTT               : %12" PRIu64 "us\n", srttUS_        );
+	fprintf(f ,"  RTT mean deviation         : %12" PRIu64 "us\n", rttVarUS_      );
+	fprintf(f ,"  retransmission timeout     : %12" PRIu64 "us (%" PRIu64 "..%" PRIu64 "us)\n",
+	                                        rexTO_.getUs(), rexTOMin_.getUs(), rexTOMax_.getUs());
+}
+
+void CRssi::collectStats(IMetricsSink *sink)
+{
+	sink->counter( "outgoing_dropped",    stats_.outgoingDropped_    );
+	sink->counter( "rex_segments",        stats_.rexSegments_        );
+	sink->counter( "rex_timeouts",        stats_.rexTimeouts_        );
+	sink->counter( "busy_deassert_rex",   stats_.busyDeassertRex_    );
+	sink->counter( "ack_timeouts",        stats_.ackTimeouts_        );
+	sink->counter( "nul_timeouts",        stats_.nulTimeouts_        );
+	sink->counter( "bad_checksum",        stats_.badChecksum_        );
+	sink->counter( "bad_syn_dropped",     stats_.badSynDropped_      );
+	sink->counter( "bad_hdr_dropped",     stats_.badHdrDropped_      );
+	sink->counter( "rejected_segs",       stats_.rejectedSegs_       );
+	sink->counter( "skipped_nuls",        stats_.skippedNULs_        );
+	sink->counter( "segs_acked_by_peer",  stats_.numSegsAckedByPeer_ );
+	sink->counter( "segs_given_to_user",  stats_.numSegsGivenToUser_ );
+	sink->counter( "busy_flags_rx",       stats_.busyFlagsCountedRx_ );
+	sink->counter( "busy_flags_tx",       stats_.busyFlagsCountedTx_ );
+	sink->counter( "dup_acks",            stats_.dupAcks_            );
+	sink->counter( "fast_rex_segments",   stats_.fastRexSegments_    );
+	sink->counter( "eacks_sent",          stats_.eacksSent_          );
+	sink->counter( "eacks_received",      stats_.eacksRcvd_          );
+	sink->counter( "eacked_not_rex",      stats_.eackedNotRex_       );
+	sink->counter( "rtt_samples",         stats_.rttSamples_         );
+	sink->gauge  ( "srtt_us",             srttUS_                    );
+	sink->gauge  ( "rttvar_us",           rttVarUS_                  );
+	sink->gauge  ( "rex_timeout_us",      rexTO_.getUs()             );
 }
 
 void CRssi::RingBuf::dump()
@@ -590,11 +847,28 @@ BufChain bc;
 	}
 }
 
+void CRssi::threadStart()
+{
+	if ( 0 == defaults_.reactorThreads_ ) {
+		CRunnable::threadStart();
+	} else if ( ! reactor_ ) {
+		reactor_ = CRssiReactor::get( defaults_.reactorThreads_, getPrio() );
+		reactor_->add( this );
+	}
+}
+
 bool CRssi::threadStop()
 {
 bool rval;
 
-	rval = CRunnable::threadStop();
+	if ( reactor_ ) {
+		// once this returns the reactor no longer touches us
+		reactor_->remove( this );
+		reactor_.reset();
+		rval = true;
+	} else {
+		rval = CRunnable::threadStop();
+	}
 	state_->shutdown( this );
 	close();
 	state_ = &stateCLOSED;
@@ -653,6 +927,9 @@ unsigned i, u;
 
 	peerSgsMX_      = synHdr.getSgsMX();
 
+	// only send EACKs if enabled and the peer announced that it understands them
+	peerEAK_        = defaults_.selectiveAck_ && !! (synHdr.getXflgs() & RssiSynHeader::XFL_EAK);
+
 #ifdef RSSI_DEBUG
 	if ( cpsw_rssi_debug > 0 ) {
 		fprintf(CPSW::fDbg(), "RSSI Peer SGS Max: %d\n", synHdr.getSgsMX());
@@ -685,6 +962,8 @@ unsigned i, u;
 
 	}
 
+	resetRttEstimator();
+
 #ifdef RSSI_DEBUG
 	if ( cpsw_rssi_debug > 0 ) {
 		fprintf(CPSW::fDbg(), "RSSI Negotiated parms      : %s\n", acceptNegotiated ? "proposed by peer" : "enforced by us" );
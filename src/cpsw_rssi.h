@@ -16,6 +16,7 @@
 #include <cpsw_error.h>
 #include <cpsw_thread.h>
 #include <cpsw_compat.h>
+#include <cpsw_metrics.h>
 
 #include <stdint.h>
 
@@ -73,6 +74,15 @@ public:
 
 };
 
+class IReopenTimer : public RssiTimer {
+protected:
+	virtual void processReopenTimeout() = 0;
+public:
+	IReopenTimer(RssiTimerList *l) : RssiTimer("REOPEN", l) {}
+	virtual void process() { processReopenTimeout(); }
+
+};
+
 // posts events when the state changes
 class CConnectionStateChangedEventSource : public CIntEventSource {
 public:
@@ -134,6 +144,9 @@ struct CRssiConfigParams {
 	static const uint64_t      REX_TIMEOUT_US_DFLT =  100*(uint64_t)UNIT_US_DFLT; // ms
 	static const uint64_t      CAK_TIMEOUT_US_DFLT =   50*(uint64_t)UNIT_US_DFLT; // ms; < rex timeout
 	static const uint64_t      NUL_TIMEOUT_US_DFLT = 3000*(uint64_t)UNIT_US_DFLT; // ms
+	static const uint64_t  REX_TIMEOUT_MIN_US_DFLT = 2*(uint64_t)UNIT_US_DFLT; // ms; 0: one timer unit
+	static const uint64_t  REX_TIMEOUT_MAX_US_DFLT =    0; // negotiated retransmission timeout
+	static const unsigned     REACTOR_THREADS_DFLT =    0; // private thread per connection
 	static const uint8_t              REX_MAX_DFLT =   15;
 	static const uint8_t              CAK_MAX_DFLT =    5;
 	static const unsigned             SGS_MAX_DFLT =    0;
@@ -148,6 +161,11 @@ struct CRssiConfigParams {
 	uint8_t      rexMax_;
 	uint8_t      cumAckMax_;
 	unsigned     forcedSegsMax_;
+	bool         lockFreeQueues_;
+	uint64_t     rexTimeoutMinUS_;
+	uint64_t     rexTimeoutMaxUS_;
+	unsigned     reactorThreads_;
+	bool         selectiveAck_;  // announce EACK support (CPSW extension)
 
 	CRssiConfigParams(
 		uint8_t      ldMaxUnackedSegs = LD_MAX_UNACKED_SEGS_DFLT,
@@ -158,7 +176,12 @@ struct CRssiConfigParams {
 		uint64_t     nulTimeoutUS     = NUL_TIMEOUT_US_DFLT,
 		uint8_t      rexMax           = REX_MAX_DFLT,
 		uint8_t      cumAckMax        = CAK_MAX_DFLT,
-		unsigned     forcedSegsMax    = SGS_MAX_DFLT
+		unsigned     forcedSegsMax    = SGS_MAX_DFLT,
+		bool         lockFreeQueues   = false,
+		uint64_t     rexTimeoutMinUS  = REX_TIMEOUT_MIN_US_DFLT,
+		uint64_t     rexTimeoutMaxUS  = REX_TIMEOUT_MAX_US_DFLT,
+		unsigned     reactorThreads   = REACTOR_THREADS_DFLT,
+		bool         selectiveAck     = false
 	)
 	:
 		ldMaxUnackedSegs_( ldMaxUnackedSegs ),
@@ -169,13 +192,21 @@ struct CRssiConfigParams {
 		nulTimeoutUS_    ( nulTimeoutUS     ),
 		rexMax_          ( rexMax           ),
 		cumAckMax_       ( cumAckMax        ),
-		forcedSegsMax_   ( forcedSegsMax    )
+		forcedSegsMax_   ( forcedSegsMax    ),
+		lockFreeQueues_  ( lockFreeQueues   ),
+		rexTimeoutMinUS_ ( rexTimeoutMinUS  ),
+		rexTimeoutMaxUS_ ( rexTimeoutMaxUS  ),
+		reactorThreads_  ( reactorThreads   ),
+		selectiveAck_    ( selectiveAck     )
 	{}
 
 	const CRssiConfigParams & assertValid() const;
 };
 
 
+class CRssiReactor;
+typedef shared_ptr<CRssiReactor> RssiReactor;
+
 class CRssi : public CRunnable,
               public IRxEventHandler,
               public IUsrInputEventHandler,
@@ -183,6 +214,7 @@ class CRssi : public CRunnable,
               public IRexTimer,
               public IAckTimer,
               public INulTimer,
+              public IReopenTimer,
               public CConnectionStateChangedEventSource,
               public CConnectionOpenEventSource,
               public CConnectionNotOpenEventSource,
@@ -209,12 +241,21 @@ public:
 
 	static const uint16_t MAX_SEGMENT_SIZE    = 1500 - 20 - 8 - 8; // - IP - UDP - RSSI
 
+	// # of duplicate ACKs which trigger a fast retransmission
+	static const unsigned FAST_REX_DUP_ACKS   = 3;
+
 private:
 	CRssiConfigParams defaults_;
 	bool              isServer_;
 	const char       *name_;
 	EventSet          eventSet_;
 	IMTUQuerier      *mtuQuerier_;
+	IEventSource     *upstreamSrc_;
+	// if set then the state machine is driven by a (shared)
+	// reactor thread instead of our own thread
+	RssiReactor       reactor_;
+
+	friend class CRssiReactor;
 
 protected:
 	BufQueue    outQ_;
@@ -235,6 +276,7 @@ public:
 	const char *getName()  { return name_;     }
 
 	virtual void dumpStats(FILE *);
+	virtual void collectStats(IMetricsSink *);
 
 protected:
 
@@ -310,13 +352,16 @@ protected:
 	class RingBuf : public BufBase {
 	private:
 		BufIdx wp_;
+		// segments the peer reported (EACK) to hold already
+		std::vector<bool> eacked_;
 
 		friend class iterator;
 
 	public:
 		RingBuf(unsigned ldsz)
 		: BufBase(ldsz),
-		  wp_(rp_)
+		  wp_(rp_),
+		  eacked_(capa_)
 		{}
 
 		void dump();
@@ -349,6 +394,11 @@ protected:
 					return BufChain();
 				return rb_->buf_.at( (idx_ & rb_->msk_) );
 			}
+
+			bool isEacked()
+			{
+				return idx_ != rb_->wp_ && rb_->eacked_[ idx_ & rb_->msk_ ];
+			}
 		};
 
 		iterator begin()
@@ -372,12 +422,42 @@ protected:
 				return -1;
 			}
 
-			for ( i=0; i<cumAck; i++ )
+			for ( i=0; i<cumAck; i++ ) {
+				eacked_[ rp_ & msk_ ] = false;
 				pop();
+			}
 
 			return cumAck;
 		}
 
+		// mark a segment as received out of sequence by the peer
+		void eack(SeqNo seqNo)
+		{
+		SeqNo off = seqNo - oldest_;
+			if ( off < getSize() )
+				eacked_[ (rp_ + off) & msk_ ] = true;
+		}
+
+		// number of segments up to and including the newest
+		// one the peer reported by EACK (0 if none)
+		unsigned getEackedSpan()
+		{
+		unsigned i;
+			for ( i = getSize(); i > 0; i-- ) {
+				if ( eacked_[ (rp_ + i - 1) & msk_ ] )
+					break;
+			}
+			return i;
+		}
+
+		void purge()
+		{
+			while ( getSize() > 0 ) {
+				eacked_[ rp_ & msk_ ] = false;
+				pop();
+			}
+		}
+
 		void push(BufChain b)
 		{
 		unsigned widx = wp_ & msk_;
@@ -401,6 +481,9 @@ protected:
 				tmp[i] = pop();
 			for ( capa_=1; capa_ < new_capa; capa_<<=1 )
 				;
+			// EACK information is lost; this only happens while
+			// the connection is being established.
+			eacked_.assign( capa_, false );
 			buf_.resize(capa_);
 			rp_  = wp_ = 0;
 			msk_ = capa_ - 1;
@@ -448,6 +531,24 @@ protected:
 			return (getOldest() - 1) & 0xff;
 		}
 
+		// collect the sequence numbers of segments which are held
+		// but cannot be delivered yet because of a gap
+		unsigned getOutOfOrder(uint8_t *seqs, unsigned max)
+		{
+		unsigned off, n;
+			for ( off = 1, n = 0; off < lim_ && n < max; off++ ) {
+				if ( buf_[ (rp_ + off) & msk_ ] )
+					seqs[n++] = (SeqNo)(oldest_ + off);
+			}
+			return n;
+		}
+
+		bool hasOutOfOrder()
+		{
+		uint8_t dummy;
+			return getOutOfOrder( &dummy, 1 ) > 0;
+		}
+
 		void purge()
 		{
 		unsigned i;
@@ -473,12 +574,17 @@ protected:
 		virtual void processRetransmissionTimeout(CRssi *context);
 		virtual void processAckTimeout(CRssi *context);
 		virtual void processNulTimeout(CRssi *context);
+		virtual void processReopenTimeout(CRssi *context);
 
 		virtual  int getConnectionState(CRssi *context);
 
 		virtual void shutdown(CRssi *context);
 
 		virtual void advance(CRssi *context) = 0;
+
+		// whether 'advance' blocks for an event or timer; a
+		// reactor runs states which don't right away.
+		virtual bool waitsForEvent() { return false; }
 	};
 
 	class CLOSED : public STATE {
@@ -501,9 +607,20 @@ protected:
 		        void advance(CRssi *context, bool checkTimer);
 		virtual void advance(CRssi *context);
 		virtual void shutdown(CRssi *context);
+		virtual bool waitsForEvent() { return true; }
 	};
 	friend class NOTCLOSED;
 
+	// client waiting before it tries to reconnect
+	class CLNT_REOPEN_DELAY : public NOTCLOSED {
+	public:
+		CLNT_REOPEN_DELAY():NOTCLOSED("CLNT_REOPEN_DELAY") {}
+		virtual void handleRxEvent(CRssi *context, IIntEventSource *src);
+		virtual void processReopenTimeout(CRssi *context);
+		virtual void shutdown(CRssi *context);
+	};
+	friend class CLNT_REOPEN_DELAY;
+
 	class WAIT_SYN : public NOTCLOSED {
 	public:
 		WAIT_SYN(const char *name):NOTCLOSED(name) {}
@@ -541,6 +658,7 @@ protected:
 		PREP_OPEN():NOTCLOSED("PREP_OPEN") {}
 
 		virtual void advance(CRssi *context);
+		virtual bool waitsForEvent() { return false; }
 	};
 	friend class PREP_OPEN;
 
@@ -568,6 +686,7 @@ protected:
 	friend class OPEN_OUTWIN_FULL;
 
 	CLOSED            stateCLOSED;
+	CLNT_REOPEN_DELAY stateCLNT_REOPEN_DELAY;
 	LISTEN            stateLISTEN;
 	CLNT_WAIT_SYN_ACK stateCLNT_WAIT_SYN_ACK;
 	SERV_WAIT_SYN_ACK stateSERV_WAIT_SYN_ACK;
@@ -593,6 +712,14 @@ private:
 protected:
 
 	CTimeout rexTO_, cakTO_, nulTO_;
+	// the retransmission timeout adapts to the measured RTT
+	// (Jacobson/Karels; RFC 6298) within these bounds
+	CTimeout rexTOMin_, rexTOMax_;
+	uint64_t srttUS_;   // smoothed RTT; 0 if not sampled yet
+	uint64_t rttVarUS_; // mean deviation
+	CTimeout rttStart_;
+	SeqNo    rttSeqNo_; // segment being timed
+	bool     rttTiming_;
 	unsigned rexMX_;
 	int      cakMX_;
 	uint32_t conID_;
@@ -600,6 +727,9 @@ protected:
 	unsigned numRex_;
 	int      numCak_; // may temporarily fall below zero
 	bool     peerBSY_;
+	bool     peerEAK_; // both sides enabled EACK
+	bool     rexAcked_; // a fast retransmission carried our ACK
+	unsigned numDupAck_;
 
 	struct timespec closedReopenDelay_;
 
@@ -620,7 +750,13 @@ protected:
 	void sendBufAndKeepForRetransmission(BufChain);
 	void sendBuf(BufChain, bool);
 	void armRexAndNulTimer();
-	void processAckNumber(uint8_t, SeqNo);
+	void processAckNumber(RssiHeader &, bool hasPayload);
+	void retransmit(bool fast);
+
+	void resetRttEstimator();
+	CTimeout getArmedRexTimeout();
+	void sampleRtt(uint64_t us);
+	void backoffRexTimeout();
 
 	void sendSYN(bool do_ack);
 	void sendACK();
@@ -647,6 +783,12 @@ protected:
 		unsigned busyFlagsCountedRx_;
 		unsigned busyFlagsCountedTx_;
 		unsigned busyDeassertRex_;
+		unsigned dupAcks_;
+		unsigned fastRexSegments_;
+		unsigned eacksSent_;
+		unsigned eacksRcvd_;
+		unsigned eackedNotRex_;
+		unsigned rttSamples_;
 	} stats_;
 
 
@@ -663,10 +805,17 @@ protected:
 	virtual void processRetransmissionTimeout();
 	virtual void processAckTimeout();
 	virtual void processNulTimeout();
+	virtual void processReopenTimeout();
+
+	IRexTimer              *rexTimer()    { return (IRexTimer*)    this; }
+	IAckTimer              *ackTimer()    { return (IAckTimer*)    this; }
+	INulTimer              *nulTimer()    { return (INulTimer*)    this; }
+	IReopenTimer           *reopenTimer() { return (IReopenTimer*) this; }
 
-	IRexTimer              *rexTimer() { return (IRexTimer*) this; }
-	IAckTimer              *ackTimer() { return (IAckTimer*) this; }
-	INulTimer              *nulTimer() { return (INulTimer*) this; }
+	// executed by the reactor thread serving this connection
+	void            reactorBind(EventSet);
+	void            reactorAdvance(const CTimeout &now);
+	const CTimeout *reactorGetTimeout();
 
 	virtual const CRssiConfigParams *getConfigParams() const
 	{
@@ -696,6 +845,9 @@ protected:
 
 	virtual void changeState(STATE *newState);
 
+	// start our thread or join a reactor
+	// (CRssiConfigParams::reactorThreads_)
+	virtual void threadStart();
 	virtual bool threadStop();
 
 };
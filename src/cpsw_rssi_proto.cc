@@ -88,7 +88,7 @@ void RssiHeader::dump(FILE *f, int hasPayload)
 char      pld = hasPayload > 0 ? 'P' : hasPayload < 0 ? '?' : '-';
 uint8_t flags = getFlags();
 
-		fprintf(f,"SEQ %d, ACK %d [%c%c%c%c%c%c]",
+		fprintf(f,"SEQ %d, ACK %d [%c%c%c%c%c%c%c]",
 			getSeqNo(),
 			getAckNo(),
 			(flags & RssiHeader::FLG_SYN) ? 'S':'-',
@@ -96,5 +96,6 @@ uint8_t flags = getFlags();
 			(flags & RssiHeader::FLG_BSY) ? 'B':'-',
 			(flags & RssiHeader::FLG_RST) ? 'R':'-',
 			(flags & RssiHeader::FLG_NUL) ? 'N':'-',
+			(flags & RssiHeader::FLG_EAC) ? 'E':'-',
 			pld);
 }
@@ -113,9 +113,36 @@ public:
 		st16be( getHSize() - 2, cs() );
 	}
 
+	// an EACK is a pure ACK which additionally lists
+	// segments received out of sequence
 	bool isPureAck()
 	{
-		return (getFlags() & ~FLG_BSY) == FLG_ACK;
+		return (getFlags() & ~(FLG_BSY | FLG_EAC)) == FLG_ACK;
+	}
+
+	// EACK: the out-of-sequence numbers follow the spare bytes;
+	// the last entry is repeated to pad the header to an even
+	// size (checksum alignment).
+	unsigned getEackNum()
+	{
+		return getHSize() > minHeaderSize() ? getHSize() - minHeaderSize() : 0;
+	}
+
+	uint16_t getEack(unsigned i)             { return buf_[6 + i];                        }
+	void     setEack(unsigned i, uint16_t v) { buf_[6 + i] = static_cast<uint8_t>(v); }
+
+	// set the EACK list and adjust the header size; the
+	// caller must make sure the buffer is large enough
+	void     setEackList(const uint8_t *seqs, unsigned n)
+	{
+	unsigned i;
+		for ( i = 0; i < n; i++ )
+			setEack( i, seqs[i] );
+		if ( (n & 1) ) {
+			setEack( n, seqs[n - 1] );
+			n++;
+		}
+		setHSize( minHeaderSize() + n );
 	}
 
 	// hasPayload: > 0 yes, == 0 no, < 0 unknown
@@ -153,6 +180,7 @@ public:
 class RssiSynHeader : public RssiHeader {
 public:
 
+	const static uint8_t XFL_EAK = (1<<0); // we understand EACK (CPSW extension; reserved by the spec, opt-in)
 	const static uint8_t XFL_CHK = (1<<2);
 	const static uint8_t XFL_ONE = (1<<3);
 
@@ -0,0 +1,121 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_rssi_reactor.h>
+#include <cpsw_worker_pool.h>
+
+#include <pthread.h>
+
+CRssiReactor::CRssiReactor(int prio)
+: CRunnable( "RSSI Reactor", prio         ),
+  eventSet_( IEventSet::createPollable() ),
+  mtx_     ( "RssiReactor"                ),
+  assigned_( 0                            )
+{
+	eventSet_->add( &ctrl_, this );
+}
+
+CRssiReactor::~CRssiReactor()
+{
+	threadStop();
+}
+
+void
+CRssiReactor::post(CRssi *rssi, bool add)
+{
+CIntEventSource  done;
+CIntEventHandler eh;
+
+	if ( pthread_equal( pthread_self(), getTid() ) ) {
+		throw InternalError("RSSI reactor cannot (un)register connections from its own thread");
+	}
+	{
+	CMtx::lg guard( &mtx_ );
+		requests_.push_back( Request( rssi, add, &done ) );
+	}
+	ctrl_.sendEvent( 1 );
+	eh.receiveEvent( &done, true, NULL );
+}
+
+void
+CRssiReactor::add(CRssi *rssi)
+{
+	post( rssi, true );
+}
+
+void
+CRssiReactor::remove(CRssi *rssi)
+{
+	post( rssi, false );
+	assigned_.fetch_sub( 1, cpsw::memory_order_relaxed );
+}
+
+void
+CRssiReactor::handle(IIntEventSource *src)
+{
+std::vector<Request>           reqs;
+std::vector<Request>::iterator it;
+std::vector<CRssi*>::iterator  m;
+
+	{
+	CMtx::lg guard( &mtx_ );
+		reqs.swap( requests_ );
+	}
+
+	for ( it = reqs.begin(); it != reqs.end(); ++it ) {
+		if ( it->add_ ) {
+			it->rssi_->reactorBind( eventSet_ );
+			members_.push_back( it->rssi_ );
+		} else {
+			for ( m = members_.begin(); m != members_.end(); ++m ) {
+				if ( *m == it->rssi_ ) {
+					members_.erase( m );
+					break;
+				}
+			}
+			it->rssi_->reactorBind( EventSet() );
+		}
+		it->done_->sendEvent( 1 );
+	}
+}
+
+void *
+CRssiReactor::threadBody()
+{
+CTimeout                      now, tmo;
+const CTimeout               *t;
+bool                          haveTmo;
+std::vector<CRssi*>::iterator m;
+
+	while ( 1 ) {
+		eventSet_->getAbsTime( &now );
+		haveTmo = false;
+		for ( m = members_.begin(); m != members_.end(); ++m ) {
+			(*m)->reactorAdvance( now );
+			if ( (t = (*m)->reactorGetTimeout()) && ( ! haveTmo || *t < tmo ) ) {
+				tmo     = *t;
+				haveTmo = true;
+			}
+		}
+		eventSet_->processEvent( true, haveTmo ? &tmo : NULL );
+	}
+
+	return NULL;
+}
+
+RssiReactor
+CRssiReactor::get(unsigned poolSize, int prio)
+{
+// never destroyed: connections may be shut down from static destructors
+static CWorkerPool<CRssiReactor> *pool = new CWorkerPool<CRssiReactor>( "RssiReactorPool" );
+
+	// account for the new connection while the pool is locked so
+	// that concurrent callers see the updated load
+	return pool->get( poolSize, prio, &CRssiReactor::claim );
+}
@@ -0,0 +1,95 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_RSSI_REACTOR_H
+#define CPSW_RSSI_REACTOR_H
+
+#include <cpsw_rssi.h>
+#include <cpsw_event.h>
+#include <cpsw_thread.h>
+#include <cpsw_mutex.h>
+#include <cpsw_compat.h>
+
+#include <vector>
+
+/* A reactor is a thread which drives the state machines of
+ * many RSSI connections: the event sources of all of its
+ * members are bound to a single event set and the reactor
+ * waits for whichever member timer expires first.
+ *
+ * Reactors form a process-wide pool; a connection is assigned
+ * to the least busy reactor. The pool grows up to the size
+ * requested by the connections and a reactor thread terminates
+ * once its last member leaves.
+ *
+ * The event set is 'pollable' (epoll based) so that a wakeup
+ * only looks at the members which were actually notified.
+ *
+ * Only the reactor thread ever touches its member list and
+ * the members' state; adding and removing members is handed
+ * to the reactor thread and the caller waits for completion.
+ */
+class CRssiReactor : public CRunnable, public IEventHandler {
+private:
+	struct Request {
+		CRssi           *rssi_;
+		bool             add_;
+		CIntEventSource *done_;
+
+		Request(CRssi *rssi, bool add, CIntEventSource *done)
+		: rssi_( rssi ),
+		  add_ ( add  ),
+		  done_( done )
+		{
+		}
+	};
+
+	EventSet              eventSet_;
+	CIntEventSource       ctrl_;      // posted when requests are pending
+	CMtx                  mtx_;       // protects requests_
+	std::vector<Request>  requests_;
+	std::vector<CRssi*>   members_;
+	atomic<unsigned>      assigned_;
+
+	CRssiReactor(const CRssiReactor &);
+	CRssiReactor & operator=(const CRssiReactor &);
+
+	void post(CRssi *rssi, bool add);
+
+	void claim()
+	{
+		assigned_.fetch_add( 1, cpsw::memory_order_relaxed );
+	}
+
+protected:
+	virtual void *threadBody();
+
+	// process membership requests
+	virtual void handle(IIntEventSource *src);
+
+public:
+	CRssiReactor(int prio);
+
+	// # of connections assigned to this reactor
+	unsigned getLoad()
+	{
+		return assigned_.load( cpsw::memory_order_relaxed );
+	}
+
+	void add(CRssi *rssi);
+	void remove(CRssi *rssi);
+
+	// obtain the least busy reactor running at priority 'prio' from
+	// a pool of (up to) 'poolSize' (one pool per priority)
+	static RssiReactor get(unsigned poolSize, int prio);
+
+	virtual ~CRssiReactor();
+};
+
+#endif
@@ -43,6 +43,11 @@ void CRssi::STATE::processNulTimeout(CRssi *context)
 	throw InternalError("NULTimeout unexpected in this state");
 }
 
+void CRssi::STATE::processReopenTimeout(CRssi *context)
+{
+	throw InternalError("ReopenTimeout unexpected in this state");
+}
+
 void CRssi::STATE::shutdown(CRssi *context)
 {
 }
@@ -51,6 +56,10 @@ void CRssi::LISTEN::shutdown(CRssi *context)
 {
 }
 
+void CRssi::CLNT_REOPEN_DELAY::shutdown(CRssi *context)
+{
+}
+
 void CRssi::NOTCLOSED::shutdown(CRssi *context)
 {
 	context->sendRST();
@@ -82,14 +91,33 @@ void CRssi::CLOSED::advance(CRssi *context)
 		if ( context->closedReopenDelay_.tv_sec ) {
 			fprintf(CPSW::fErr(), "Client unable to establish connection; sleeping for a while (%lu)\n",
 				(unsigned long)context->closedReopenDelay_.tv_sec);
-			::nanosleep( &context->closedReopenDelay_, NULL );
+			// use a timer rather than sleeping; a reactor thread
+			// may be serving other connections, too.
+			CTimeout delay;
+			delay.set( context->closedReopenDelay_ );
+			context->reopenTimer()->arm_rel( delay );
+			context->increaseReopenDelay();
+			context->changeState( &context->stateCLNT_REOPEN_DELAY );
+		} else {
+			context->increaseReopenDelay();
+			context->sendSYN( false );
+			context->changeState( &context->stateCLNT_WAIT_SYN_ACK );
 		}
-		context->increaseReopenDelay();
-		context->sendSYN( false );
-		context->changeState( &context->stateCLNT_WAIT_SYN_ACK );
 	}
 }
 
+void CRssi::CLNT_REOPEN_DELAY::handleRxEvent(CRssi *context, IIntEventSource *src)
+{
+	// drop whatever the peer sends; the connection is reset anyways
+	context->tryPopUpstream();
+}
+
+void CRssi::CLNT_REOPEN_DELAY::processReopenTimeout(CRssi *context)
+{
+	context->sendSYN( false );
+	context->changeState( &context->stateCLNT_WAIT_SYN_ACK );
+}
+
 void CRssi::NOTCLOSED::advance(CRssi *context, bool checkTimer)
 {
 RssiTimer *timer = context->timers_.getFirstToExpire();
@@ -195,7 +223,7 @@ bool     hasPayload;
 		}
 
 		// clean out our outgoing buffer
-		context->processAckNumber( hdr.getFlags(), hdr.getAckNo() );
+		context->processAckNumber( hdr, hasPayload );
 
 		// cache the busy flag (header no longer valid further down);
 		bool peerNowBSY = !! (hdr.getFlags() & RssiHeader::FLG_BSY);
@@ -204,6 +232,13 @@ bool     hasPayload;
 
 			if ( context->unOrderedSegs_.canAccept( hdr.getSeqNo() ) ) {
 
+				// ACK a segment past or into a gap right away; the
+				// duplicate ACK (EACK) lets the peer retransmit without
+				// waiting for its timer and the ACK which closes the
+				// gap reopens the peer's window.
+				bool gap = hdr.getSeqNo() != context->unOrderedSegs_.getOldest()
+				           || context->unOrderedSegs_.hasOutOfOrder();
+
 #ifdef RSSI_DEBUG
 				if (cpsw_rssi_debug > 1 ) {
 					fprintf(CPSW::fDbg(),"RX: %s  storing (oldest %d)", context->getName(), context->unOrderedSegs_.getOldest());
@@ -220,6 +255,9 @@ bool     hasPayload;
 
 				drainReassembleBuffer( context );
 
+				if ( gap )
+					context->forceACK();
+
 			} else {
 				// should not happen if the peer respects our max. unacked window
 				// but still could as a result of retransmissions...
@@ -255,8 +293,10 @@ bool     hasPayload;
 #endif
 
 		// do we have to ACK this one?
-		++context->numCak_;
-		if ( context->numCak_ > context->cakMX_ ) {
+		if ( context->rexAcked_ ) {
+			// a fast retransmission (processAckNumber) just sent our ACK
+			context->rexAcked_ = false;
+		} else if ( ++context->numCak_ > context->cakMX_ ) {
 			BufChain b1 = hasBufToSend(context);
 			if ( b1 )
 				context->sendDAT( b1 );
@@ -444,21 +484,7 @@ void CRssi::NOTCLOSED::processRetransmissionTimeout(CRssi *context)
 		return;
 	}
 
-	CRssi::RingBuf::iterator it = context->unAckedSegs_.begin();
-	BufChain bc;
-
-	if ( (bc = *it) ) {
-		do {
-			context->stats_.rexSegments_++;
-#ifdef RSSI_DEBUG
-			if (cpsw_rssi_debug > 2 ) {
-				fprintf(CPSW::fDbg(),"%s: retransmitting (state %s)\n", getName(), context->getName());
-			}
-#endif
-			context->sendBuf(bc, true);	
-		} while ( (bc = *(++it)) );
-		context->armRexAndNulTimer();
-	}
+	context->retransmit( false );
 }
 
 void CRssi::OPEN::processNulTimeout(CRssi *context)
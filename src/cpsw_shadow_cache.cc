@@ -0,0 +1,242 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string.h>
+
+#include <cpsw_shadow_cache.h>
+
+CShadowCache::CShadowCache(unsigned maxBytes)
+: maxBytes_    ( maxBytes       ),
+  mtx_         ( "SHADOW_CACHE" ),
+  nHits_       ( 0              ),
+  nMisses_     ( 0              ),
+  nUpdates_    ( 0              ),
+  nInvalidates_( 0              ),
+  gen_         ( 0              )
+{
+}
+
+bool
+CShadowCache::read_unlocked(uint64_t off, uint8_t *dst, unsigned nbytes) const
+{
+Extents::const_iterator it = extents_.upper_bound( off );
+
+	if ( it != extents_.begin() ) {
+		--it;
+		if ( off + nbytes <= it->first + it->second.size() ) {
+			memcpy( dst, &it->second[ off - it->first ], nbytes );
+			return true;
+		}
+	}
+	return false;
+}
+
+bool
+CShadowCache::read(uint64_t off, uint8_t *dst, unsigned nbytes) const
+{
+CMtx::lg guard( &mtx_ );
+
+	if ( read_unlocked( off, dst, nbytes ) ) {
+		nHits_++;
+		return true;
+	}
+	nMisses_++;
+	return false;
+}
+
+void
+CShadowCache::invalidate_unlocked(uint64_t off, uint64_t nbytes)
+{
+uint64_t          end = off + nbytes;
+Extents::iterator it  = extents_.upper_bound( off );
+
+	if ( it != extents_.begin() ) {
+		--it;
+		if ( it->first + it->second.size() <= off ) {
+			++it;
+		}
+	}
+
+	while ( it != extents_.end() && it->first < end ) {
+		uint64_t xbeg = it->first;
+		uint64_t xend = xbeg + it->second.size();
+
+		if ( xend > end ) {
+			// preserve the tail
+			Extent &tail = extents_[ end ];
+			tail.assign( it->second.begin() + (end - xbeg), it->second.end() );
+		}
+
+		if ( xbeg < off ) {
+			// preserve the head
+			it->second.resize( off - xbeg );
+			++it;
+		} else {
+			extents_.erase( it++ );
+		}
+	}
+}
+
+void
+CShadowCache::update(uint64_t off, const uint8_t *src, unsigned nbytes, uint8_t msk1, uint8_t mskn)
+{
+CMtx::lg guard( &mtx_ );
+
+	gen_++;
+	update_unlocked( off, src, nbytes, msk1, mskn );
+}
+
+uint64_t
+CShadowCache::getGeneration() const
+{
+CMtx::lg guard( &mtx_ );
+	return gen_;
+}
+
+bool
+CShadowCache::fill(uint64_t off, const uint8_t *src, unsigned nbytes, uint64_t gen)
+{
+CMtx::lg guard( &mtx_ );
+
+	if ( gen != gen_ ) {
+		// a write happened while the read was in flight; the
+		// data we hold may be older than what the cache has.
+		return false;
+	}
+	update_unlocked( off, src, nbytes, 0, 0 );
+	return true;
+}
+
+void
+CShadowCache::update_unlocked(uint64_t off, const uint8_t *src, unsigned nbytes, uint8_t msk1, uint8_t mskn)
+{
+	if ( 0 == nbytes )
+		return;
+
+Extent   buf( src, src + nbytes );
+uint64_t beg = off;
+uint64_t end = off + nbytes;
+uint8_t  orig;
+
+	if ( 1 == nbytes ) {
+		msk1 |= mskn;
+		mskn  = 0;
+	}
+
+	// bits covered by the masks are not written; merge
+	// with what we have or drop the byte if we don't know it
+	if ( msk1 ) {
+		if ( read_unlocked( off, &orig, 1 ) ) {
+			buf[0] = (orig & msk1) | (buf[0] & ~msk1);
+		} else {
+			beg++;
+		}
+	}
+
+	if ( mskn ) {
+		if ( read_unlocked( end - 1, &orig, 1 ) ) {
+			buf[nbytes - 1] = (orig & mskn) | (buf[nbytes - 1] & ~mskn);
+		} else {
+			end--;
+		}
+	}
+
+	invalidate_unlocked( off, nbytes );
+
+	nUpdates_++;
+
+	if ( end <= beg )
+		return;
+
+Extent            x( buf.begin() + (beg - off), buf.begin() + (end - off) );
+Extents::iterator it = extents_.lower_bound( beg );
+
+	// coalesce with an adjacent successor
+	if ( it != extents_.end() && it->first == end ) {
+		x.insert( x.end(), it->second.begin(), it->second.end() );
+		extents_.erase( it++ );
+	}
+
+	// coalesce with an adjacent predecessor
+	if ( it != extents_.begin() ) {
+		Extents::iterator prv = it;
+		--prv;
+		if ( prv->first + prv->second.size() == beg ) {
+			prv->second.insert( prv->second.end(), x.begin(), x.end() );
+			return;
+		}
+	}
+
+	extents_[ beg ].swap( x );
+}
+
+void
+CShadowCache::invalidate(uint64_t off, uint64_t nbytes)
+{
+CMtx::lg guard( &mtx_ );
+	gen_++;
+	invalidate_unlocked( off, nbytes );
+	nInvalidates_++;
+}
+
+void
+CShadowCache::clear()
+{
+CMtx::lg guard( &mtx_ );
+	gen_++;
+	extents_.clear();
+	nInvalidates_++;
+}
+
+uint64_t
+CShadowCache::getNumHits() const
+{
+CMtx::lg guard( &mtx_ );
+	return nHits_;
+}
+
+uint64_t
+CShadowCache::getNumMisses() const
+{
+CMtx::lg guard( &mtx_ );
+	return nMisses_;
+}
+
+uint64_t
+CShadowCache::getNumBytes() const
+{
+CMtx::lg guard( &mtx_ );
+Extents::const_iterator it;
+uint64_t                rval = 0;
+	for ( it = extents_.begin(); it != extents_.end(); ++it ) {
+		rval += it->second.size();
+	}
+	return rval;
+}
+
+void
+CShadowCache::dump(FILE *f) const
+{
+CMtx::lg guard( &mtx_ );
+Extents::const_iterator it;
+uint64_t                nbytes = 0;
+
+	for ( it = extents_.begin(); it != extents_.end(); ++it ) {
+		nbytes += it->second.size();
+	}
+
+	fprintf(f,"  Shadow Cache      : max. %u bytes/access\n", maxBytes_);
+	fprintf(f,"    Cached extents  : %8lu (%" PRIu64 " bytes)\n", (unsigned long)extents_.size(), nbytes);
+	fprintf(f,"    Hits            : %8" PRIu64 "\n", nHits_);
+	fprintf(f,"    Misses          : %8" PRIu64 "\n", nMisses_);
+	fprintf(f,"    Updates         : %8" PRIu64 "\n", nUpdates_);
+	fprintf(f,"    Invalidations   : %8" PRIu64 "\n", nInvalidates_);
+}
@@ -0,0 +1,105 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_SHADOW_CACHE_H
+#define CPSW_SHADOW_CACHE_H
+
+#include <cpsw_mutex.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <vector>
+
+// A shadow copy of (parts of) an address space.
+//
+// The cache holds non-overlapping, non-adjacent extents of
+// valid bytes keyed by their starting address. A lookup
+// succeeds only if the requested range is entirely covered
+// by a single extent.
+//
+// Whether an access may be served from/recorded in the cache
+// is decided by the caller (based on the 'Cacheable' attribute
+// of the entry being accessed). The cache itself is
+// thread-safe.
+//
+// Data returned by a read may only be recorded ('fill') if
+// no write modified the cache while the read was in flight;
+// otherwise a late read would overwrite newer data. Readers
+// therefore obtain the generation before issuing the request.
+class CShadowCache {
+private:
+	typedef std::vector<uint8_t>           Extent;
+	typedef std::map<uint64_t, Extent>     Extents;
+
+	Extents            extents_;
+	unsigned           maxBytes_;
+	mutable CMtx       mtx_;
+	mutable uint64_t   nHits_;
+	mutable uint64_t   nMisses_;
+	uint64_t           nUpdates_;
+	uint64_t           nInvalidates_;
+	uint64_t           gen_;          // incremented by every modification but 'fill'
+
+	CShadowCache(const CShadowCache&);
+	CShadowCache & operator=(const CShadowCache&);
+
+	bool read_unlocked(uint64_t off, uint8_t *dst, unsigned nbytes) const;
+
+	// remove all bytes in [off, off+nbytes) from the cache
+	void invalidate_unlocked(uint64_t off, uint64_t nbytes);
+
+	void update_unlocked(uint64_t off, const uint8_t *src, unsigned nbytes, uint8_t msk1, uint8_t mskn);
+
+public:
+	// Accesses covering more than 'maxBytes' are never cached
+	// (large transfers typically address memory/FIFO-like
+	// areas). A value of zero disables the cache.
+	CShadowCache(unsigned maxBytes = 0);
+
+	bool     isEnabled()   const { return maxBytes_ > 0;  }
+	unsigned getMaxBytes() const { return maxBytes_;      }
+
+	// whether an access of 'nbytes' is eligible for caching
+	bool     covers(uint64_t nbytes) const
+	{
+		return nbytes > 0 && nbytes <= maxBytes_;
+	}
+
+	// copy [off, off+nbytes) into 'dst' if the range is valid;
+	// RETURNS: true on a hit, false otherwise ('dst' untouched)
+	bool     read(uint64_t off, uint8_t *dst, unsigned nbytes) const;
+
+	// record data in the cache.
+	// If 'msk1'/'mskn' are nonzero then the bits set in these
+	// masks are *preserved* in the first/last byte (as done by a
+	// bit-merging write). If the cache does not hold the original
+	// byte then the respective byte is invalidated instead.
+	void     update(uint64_t off, const uint8_t *src, unsigned nbytes, uint8_t msk1 = 0, uint8_t mskn = 0);
+
+	// current generation; to be passed to 'fill'
+	uint64_t getGeneration() const;
+
+	// record data obtained by a read which was issued when the
+	// cache was at generation 'gen'. The data are dropped if the
+	// cache was modified since.
+	// RETURNS: true if the data were recorded
+	bool     fill(uint64_t off, const uint8_t *src, unsigned nbytes, uint64_t gen);
+
+	void     invalidate(uint64_t off, uint64_t nbytes);
+
+	void     clear();
+
+	uint64_t getNumHits()   const;
+	uint64_t getNumMisses() const;
+	uint64_t getNumBytes()  const;
+
+	void     dump(FILE *f) const;
+};
+
+#endif
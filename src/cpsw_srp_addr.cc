@@ -10,13 +10,18 @@
 #define __STDC_FORMAT_MACROS
 
 #include <inttypes.h>
+#include <string.h>
+#include <typeinfo>
+#include <vector>
 
 #include <cpsw_srp_addr.h>
+#include <cpsw_batch.h>
 #include <cpsw_srp_transactions.h>
 
 #include <cpsw_proto_mod_srpmux.h>
 
 #include <cpsw_mutex.h>
+#include <cpsw_condvar.h>
 #include <cpsw_stdio.h>
 
 #include <cpsw_yaml.h>
@@ -110,8 +115,12 @@ CSRPAddressImpl::CSRPAddressImpl(AKey key, ProtoStackBuilder bldr, ProtoPort sta
                     && bldr->getSRPRetryCount() > 65535                                            ),
   maxWordsRx_     ( 0                                                                              ),
   maxWordsTx_     ( 0                                                                              ),
+  readWindow_     ( bldr->getSRPReadWindow()                                                       ),
+  writeWindow_    ( bldr->getSRPWriteWindow()                                                      ),
   defaultWriteMode_( bldr->getSRPDefaultWriteMode()
                    ),
+  nPipelinedWrites_( 0                                                                             ),
+  shadowCache_    ( bldr->getSRPShadowCacheMaxBytes()                                              ),
   asyncXactMgr_   ( IAsyncIOTransactionManager::create( usrTimeout_.getUs() )                      ),
   asyncIOHandler_ ( asyncXactMgr_, this                                                            ),
   mutex_          ( CMtx::AttrRecursive(), "SRPADDR"                                               )
@@ -121,6 +130,8 @@ int                  nbits;
 
 	setAsync();
 
+	dynTimeout_.setPercentile( bldr->getSRPDynTimeoutPercentile(), bldr->getSRPDynTimeoutMargin() );
+
 	if ( hasRssi( stack ) ) {
 		// have RSSI
 
@@ -137,7 +148,18 @@ int                  nbits;
 	nbits   = srpMuxMod->getTidNumBits();
 	tidMsk_ = (nbits > 31 ? 0xffffffff : ( (1<<nbits) - 1 ) ) << srpMuxMod->getTidLsb();
 
-	asyncIOPort_ = srpMuxMod->createPort( vc_ | 0x80, bldr->getSRPMuxOutQueueDepth() );
+	asyncIOPort_ = srpMuxMod->createPort( vc_ | 0x80, bldr->getSRPMuxOutQueueDepth(), bldr->hasLockFreeQueues() );
+
+	// windowed reads and pipelined writes use the asynchronous VC;
+	// don't have more replies in flight than its queue can hold.
+	if ( readWindow_ > bldr->getSRPMuxOutQueueDepth() )
+		readWindow_ = bldr->getSRPMuxOutQueueDepth();
+	if ( readWindow_ < 1 )
+		readWindow_ = 1;
+	if ( writeWindow_ > bldr->getSRPMuxOutQueueDepth() )
+		writeWindow_ = bldr->getSRPMuxOutQueueDepth();
+	if ( writeWindow_ < 1 )
+		writeWindow_ = 1;
 }
 
 void
@@ -152,6 +174,8 @@ ProtoPort            stack = getProtoStack();
 
 	CCommAddressImpl::startUp();
 
+	CMetricsRegistry::add( this, "SRP" );
+
 	// there seems to be a bug in either the depacketizer or SRP:
 	// weird things happen if fragment payload is not 8-byte
 	// aligned
@@ -188,8 +212,18 @@ CSRPAddressImpl::dumpYamlPart(YAML::Node &node) const
 	writeNode(srpParms, YAML_KEY_protocolVersion , protoVersion_      );
 	writeNode(srpParms, YAML_KEY_timeoutUS       , usrTimeout_.getUs());
 	writeNode(srpParms, YAML_KEY_dynTimeout      , useDynTimeout_     );
+	if ( dynTimeout_.getPercentile() > 0. ) {
+	writeNode(srpParms, YAML_KEY_dynTimeoutPercentile, dynTimeout_.getPercentile() );
+	writeNode(srpParms, YAML_KEY_dynTimeoutMargin    , dynTimeout_.getMargin()     );
+	}
 	writeNode(srpParms, YAML_KEY_retryCount      , retryCnt_          );
 	writeNode(srpParms, YAML_KEY_defaultWriteMode, defaultWriteMode_  );
+	if ( readWindow_ > 1 )
+	writeNode(srpParms, YAML_KEY_readWindow      , readWindow_        );
+	if ( POSTED != defaultWriteMode_ )
+	writeNode(srpParms, YAML_KEY_writeWindow     , writeWindow_       );
+	if ( shadowCache_.isEnabled() )
+	writeNode(srpParms, YAML_KEY_shadowCacheMaxBytes, shadowCache_.getMaxBytes() );
 	writeNode(node, YAML_KEY_SRP, srpParms);
 }
 
@@ -201,12 +235,14 @@ CSRPAddressImpl::getAlignment() const
 
 CSRPAddressImpl::~CSRPAddressImpl()
 {
+	CMetricsRegistry::remove( this );
 	shutdownProtoStack();
 }
 
 void CSRPAddressImpl::setTimeoutUs(unsigned timeoutUs)
 {
 	this->usrTimeout_.set(timeoutUs);
+	this->dynTimeout_.setTimeoutMax(timeoutUs);
 }
 
 void CSRPAddressImpl::setRetryCount(unsigned retryCnt)
@@ -262,6 +298,33 @@ struct timespec now;
 #define PROTO_VERS_3     3
 
 static CFreeList<CSRPAsyncReadTransaction, CAsyncIOTransaction> srpReadTransactionPool;
+static CFreeList<CSRPAsyncWriteTransaction, CAsyncIOTransaction> srpWriteTransactionPool;
+
+// Record the result of an asynchronous read in the shadow cache
+// before passing completion on to the user.
+class CShadowCacheFill : public CAsyncIOCompletion {
+private:
+	CShadowCache *cache_;
+	uint64_t      off_;
+	uint8_t      *dst_;
+	unsigned      nbytes_;
+	uint64_t      gen_;
+public:
+	CShadowCacheFill(AsyncIO parent, CShadowCache *cache, uint64_t off, uint8_t *dst, unsigned nbytes, uint64_t gen)
+	: CAsyncIOCompletion( parent ),
+	  cache_            ( cache  ),
+	  off_              ( off    ),
+	  dst_              ( dst    ),
+	  nbytes_           ( nbytes ),
+	  gen_              ( gen    )
+	{
+	}
+
+	virtual void complete()
+	{
+		cache_->fill( off_, dst_, nbytes_, gen_ );
+	}
+};
 
 uint32_t
 CSRPAddressImpl::extractTid(BufChain rchn) const
@@ -342,6 +405,8 @@ struct timespec retry_then;
 
 		if ( useDynTimeout_ )
 			dynTimeout_.update( &now, &then );
+		else
+			dynTimeout_.sample( &now, &then );
 
 		xact.complete( rchn );
 
@@ -363,6 +428,207 @@ retry:
 	throw IOError(error);
 }
 
+CSRPWindow::CSRPWindow(const char *name)
+: CMtx     ( name ),
+  inFlight_( 0    )
+{
+}
+
+void
+CSRPWindow::posted()
+{
+CMtx::lg guard( this );
+	inFlight_++;
+}
+
+void
+CSRPWindow::done_unlocked()
+{
+int syserr;
+	inFlight_--;
+	if ( (syserr = pthread_cond_signal( CCond::getp() )) ) {
+		throw InternalError("CSRPWindow: pthread_cond_signal failed", syserr);
+	}
+}
+
+void
+CSRPWindow::waitBelow(unsigned n)
+{
+CMtx::lg guard( this );
+int      syserr;
+	while ( inFlight_ >= n ) {
+		if ( (syserr = pthread_cond_wait( CCond::getp(), CMtx::getp() )) ) {
+			throw InternalError("CSRPWindow: pthread_cond_wait failed", syserr);
+		}
+	}
+}
+
+unsigned
+CSRPWindow::getInFlight()
+{
+CMtx::lg guard( this );
+	return inFlight_;
+}
+
+CSRPReadWindow::CSRPReadWindow()
+: CSRPWindow( "SRP_READ_WINDOW" )
+{
+}
+
+void
+CSRPReadWindow::done(const Chunk &chunk, bool failed)
+{
+CMtx::lg guard( this );
+	if ( failed ) {
+		failed_.push_back( chunk );
+	}
+	done_unlocked();
+}
+
+CSRPWriteWindow::CSRPWriteWindow()
+: CSRPWindow( "SRP_WRITE_WINDOW" ),
+  errorOff_ ( 0 ),
+  nFailed_  ( 0 )
+{
+}
+
+void
+CSRPWriteWindow::done(uint64_t off, CPSWError *err)
+{
+CMtx::lg guard( this );
+	if ( err ) {
+		if ( ! error_ ) {
+			error_    = err->clone();
+			errorOff_ = off;
+		}
+		nFailed_++;
+	}
+	done_unlocked();
+}
+
+void
+CSRPWriteWindow::flush()
+{
+CPSWErrorHdl err;
+uint64_t     off;
+char         buf[100];
+
+	waitBelow( 1 );
+
+	{
+	CMtx::lg guard( this );
+		if ( ! error_ ) {
+			return;
+		}
+		err.swap( error_ );
+		off = errorOff_;
+	}
+
+	snprintf( buf, sizeof(buf), "Pipelined SRP write @0x%" PRIx64 " failed: ", off );
+	err->prepend( buf );
+	err->throwMe();
+}
+
+unsigned
+CSRPWriteWindow::getNumFailed()
+{
+CMtx::lg guard( this );
+	return nFailed_;
+}
+
+class CSRPReadWindowSlot : public IAsyncIO {
+private:
+	CSRPReadWindow        *win_;
+	CSRPReadWindow::Chunk  chunk_;
+public:
+	CSRPReadWindowSlot(CSRPReadWindow *win, const CSRPReadWindow::Chunk &chunk)
+	: win_  ( win   ),
+	  chunk_( chunk )
+	{
+	}
+
+	virtual void callback(CPSWError *err)
+	{
+		win_->done( chunk_, !! err );
+	}
+};
+
+class CSRPWriteWindowSlot : public IAsyncIO {
+private:
+	CSRPWriteWindow *win_;
+	CShadowCache    *cache_;
+	uint64_t         off_;
+	unsigned         nbytes_;
+public:
+	CSRPWriteWindowSlot(CSRPWriteWindow *win, CShadowCache *cache, uint64_t off, unsigned nbytes)
+	: win_   ( win    ),
+	  cache_ ( cache  ),
+	  off_   ( off    ),
+	  nbytes_( nbytes )
+	{
+	}
+
+	virtual void callback(CPSWError *err)
+	{
+		if ( cache_->isEnabled() ) {
+			// a read which overtook this write (or the write's
+			// failure) may have left stale data in the cache.
+			cache_->invalidate( off_, nbytes_ );
+		}
+		win_->done( off_, err );
+	}
+};
+
+// Rather than waiting for every chunk's reply before sending the
+// next request we keep up to 'readWindow_' read transactions (each
+// with its own TID) in flight on the asynchronous VC. Replies may
+// arrive in any order; each transaction deposits its payload directly
+// at the proper place in 'dst'. Chunks that failed are re-read
+// synchronously (with the usual retry logic) once the window has
+// drained.
+uint64_t CSRPAddressImpl::readWindowed_unlocked(IField::Cacheable cacheable, uint8_t *dst, uint64_t off, unsigned sbytes, unsigned headbytes) const
+{
+CSRPReadWindow        win;
+CSRPReadWindow::Chunk chunk;
+unsigned              nWords = (headbytes + sbytes + sizeof(SRPWord) - 1)/sizeof(SRPWord);
+unsigned              rval   = sbytes;
+unsigned              i;
+
+	try {
+		while ( sbytes > 0 ) {
+			chunk.dst_    = dst;
+			chunk.off_    = off;
+			if ( nWords > maxWordsRx_ ) {
+				chunk.nbytes_ = maxWordsRx_*sizeof(SRPWord) - headbytes;
+				nWords       -= maxWordsRx_;
+			} else {
+				chunk.nbytes_ = sbytes;
+			}
+
+			win.waitBelow( readWindow_ );
+			win.posted();
+			readBlk_unlocked( cacheable, chunk.dst_, chunk.off_, chunk.nbytes_, cpsw::make_shared<CSRPReadWindowSlot>( &win, chunk ) );
+
+			sbytes   -= chunk.nbytes_;
+			dst      += chunk.nbytes_;
+			off      += chunk.nbytes_;
+			headbytes = 0;
+		}
+	} catch ( CPSWError & ) {
+		// transactions still in flight reference 'win' and 'dst'
+		win.waitBelow( 1 );
+		throw;
+	}
+
+	win.waitBelow( 1 );
+	for ( i = 0; i < win.getFailed().size(); i++ ) {
+		chunk = win.getFailed()[i];
+		nRetries_++;
+		readBlk_unlocked( cacheable, chunk.dst_, chunk.off_, chunk.nbytes_ );
+	}
+
+	return rval;
+}
 
 int
 CSRPAddressImpl::open (CompositePathIterator *node)
@@ -394,7 +660,12 @@ int rval = CAddressImpl::close( node );
 		fprintf(CPSW::fDbg(), "SRP Close\n");
 #endif
 		door_.reset();
+		// let outstanding pipelined writes complete while we
+		// still listen for their replies
+		pendingWrites_.waitBelow( 1 );
 		asyncIOHandler_.threadStop();
+		// nobody is watching the device anymore; it may change under our feet
+		shadowCache_.clear();
 	}
 	return rval;
 }
@@ -409,39 +680,69 @@ unsigned sbytes          = args->nbytes_;
 
 unsigned totbytes;
 unsigned nWords;
+bool     fillCache       = false;
+uint64_t cacheGen        = 0;
 
 	if ( sbytes == 0 )
 		return 0;
 
+	if ( dst && args->cacheable_ >= IField::WT_CACHEABLE && shadowCache_.covers( sbytes ) ) {
+		if ( shadowCache_.read( off, dst, sbytes ) ) {
+			if ( args->aio_ ) {
+				args->aio_->callback( 0 );
+			}
+			return sbytes;
+		}
+		fillCache = true;
+		cacheGen  = shadowCache_.getGeneration();
+	}
+
 	totbytes = headbytes + sbytes;
 	nWords   = (totbytes + sizeof(SRPWord) - 1)/sizeof(SRPWord);
 
 	if ( args->aio_ ) {
+		if ( fillCache ) {
+			args->aio_ = cpsw::make_shared<CShadowCacheFill>( args->aio_, &shadowCache_, off, dst, sbytes, cacheGen );
+		}
+		if ( args->batch_ ) {
+			// the batch merges this with adjacent reads and
+			// eventually hands it back to us
+			args->batch_->deferRead( this, args );
+			return 0;
+		}
 		args->aio_ =  IAsyncIOParallelCompletion::create( args->aio_ );
 	}
 
 	{
 	CMtx::lg GUARD( &mutex_ );
 
-		while ( nWords > maxWordsRx_ ) {
-			int nbytes = maxWordsRx_*4 - headbytes;
+		if ( ! args->aio_ && readWindow_ > 1 && nWords > maxWordsRx_ ) {
+			rval = readWindowed_unlocked(args->cacheable_, dst, off, sbytes, headbytes);
+		} else {
+			while ( nWords > maxWordsRx_ ) {
+				int nbytes = maxWordsRx_*4 - headbytes;
+				if ( args->aio_ ) {
+					rval   += readBlk_unlocked(args->cacheable_, dst, off, nbytes, args->aio_);
+				} else {
+					rval   += readBlk_unlocked(args->cacheable_, dst, off, nbytes);
+				}
+				nWords -= maxWordsRx_;
+				sbytes -= nbytes;
+				dst    += nbytes;
+				off    += nbytes;
+				headbytes = 0;
+			}
+
 			if ( args->aio_ ) {
-				rval   += readBlk_unlocked(args->cacheable_, dst, off, nbytes, args->aio_);
+				rval += readBlk_unlocked(args->cacheable_, dst, off, sbytes, args->aio_);
 			} else {
-				rval   += readBlk_unlocked(args->cacheable_, dst, off, nbytes);
+				rval += readBlk_unlocked(args->cacheable_, dst, off, sbytes);
 			}
-			nWords -= maxWordsRx_;
-			sbytes -= nbytes;
-			dst    += nbytes;
-			off    += nbytes;
-			headbytes = 0;
 		}
+	}
 
-		if ( args->aio_ ) {
-			rval += readBlk_unlocked(args->cacheable_, dst, off, sbytes, args->aio_);
-		} else {
-			rval += readBlk_unlocked(args->cacheable_, dst, off, sbytes);
-		}
+	if ( fillCache && ! args->aio_ ) {
+		shadowCache_.fill( args->off_, args->dst_, args->nbytes_, cacheGen );
 	}
 
 	nReads_++;
@@ -487,7 +788,7 @@ int      j;
 	return xchn;
 }
 
-uint64_t CSRPAddressImpl::writeBlk_unlocked(IField::Cacheable cacheable, uint8_t *src, uint64_t off, unsigned dbytes, uint8_t msk1, uint8_t mskn) const
+uint64_t CSRPAddressImpl::writeBlk_unlocked(IField::Cacheable cacheable, uint8_t *src, uint64_t off, unsigned dbytes, uint8_t msk1, uint8_t mskn, bool pipelined) const
 {
 SRPWord  xbuf[5];
 SRPWord  zero = 0;
@@ -758,6 +1059,26 @@ int      posted   = (    POSTED        == defaultWriteMode_
 	unsigned attempt = 0;
 	unsigned iovlen  = i;
 
+	if ( pipelined && ! posted ) {
+		// Send on the asynchronous VC and let the transaction manager
+		// collect the reply; failures are reported by 'flush()'.
+		SRPAsyncWriteTransaction axact = srpWriteTransactionPool.alloc();
+
+		axact->reset( this, nWords, expected );
+
+		// block while the window is full
+		pendingWrites_.waitBelow( writeWindow_ );
+		pendingWrites_.posted();
+
+		asyncXactMgr_->post( axact, tid, cpsw::make_shared<CSRPWriteWindowSlot>( &pendingWrites_, &shadowCache_, off, dbytes ) );
+
+		asyncIOHandler_.getDoor()->push( assembleXBuf(iov, iovlen, iov_pld, toput), 0, IProtoPort::REL_TIMEOUT );
+
+		nPipelinedWrites_++;
+
+		return dbytes;
+	}
+
 	CSRPWriteTransaction xact( this, nWords, expected );
 
 	do {
@@ -791,6 +1112,8 @@ int      posted   = (    POSTED        == defaultWriteMode_
 
 		if ( useDynTimeout_ )
 			dynTimeout_.update( &now, &then );
+		else
+			dynTimeout_.sample( &now, &then );
 
 		xact.complete( rchn );
 
@@ -818,6 +1141,7 @@ unsigned dbytes          = args->nbytes_;
 uint64_t off             = args->off_;
 uint8_t *src             = args->src_;
 uint8_t  msk1            = args->msk1_;
+bool     pipelined       = args->pipelined_ || PIPELINED == defaultWriteMode_;
 
 unsigned totbytes;
 unsigned nWords;
@@ -825,6 +1149,13 @@ unsigned nWords;
 	if ( dbytes == 0 )
 		return 0;
 
+	if ( args->batch_ ) {
+		// the batch merges this with adjacent writes and
+		// eventually hands it back to us
+		args->batch_->deferWrite( this, args );
+		return dbytes;
+	}
+
 	totbytes = headbytes + dbytes;
 	nWords   = (totbytes + sizeof(SRPWord) - 1)/sizeof(SRPWord);
 
@@ -833,52 +1164,209 @@ unsigned nWords;
 #ifdef SRPADDR_DEBUG
 	fprintf(CPSW::fDbg(), "SRP writeBlk nWordsmaxWordsTx_ %d\n", maxWordsTx_);
 #endif
-	while ( nWords > maxWordsTx_ ) {
-		int nbytes = maxWordsTx_*4 - headbytes;
-		rval += writeBlk_unlocked(args->cacheable_, src, off, nbytes, msk1, 0);
-		nWords -= maxWordsTx_;
-		dbytes -= nbytes;
-		src    += nbytes;
-		off    += nbytes;
-		headbytes = 0;
-		msk1      = 0;
+	try {
+		while ( nWords > maxWordsTx_ ) {
+			int nbytes = maxWordsTx_*4 - headbytes;
+			rval += writeBlk_unlocked(args->cacheable_, src, off, nbytes, msk1, 0, pipelined);
+			nWords -= maxWordsTx_;
+			dbytes -= nbytes;
+			src    += nbytes;
+			off    += nbytes;
+			headbytes = 0;
+			msk1      = 0;
+		}
+
+		rval += writeBlk_unlocked(args->cacheable_, src, off, dbytes, msk1, args->mskn_, pipelined);
+	} catch ( CPSWError & ) {
+		// don't know what made it to the device
+		if ( shadowCache_.isEnabled() )
+			shadowCache_.invalidate( args->off_, args->nbytes_ );
+		throw;
 	}
 
-	rval += writeBlk_unlocked(args->cacheable_, src, off, dbytes, msk1, args->mskn_);
+	if ( shadowCache_.isEnabled() ) {
+		if ( pipelined ) {
+			// not acknowledged yet; the data are only known once the
+			// write completes (see CSRPWriteWindowSlot)
+			shadowCache_.invalidate( args->off_, args->nbytes_ );
+		} else if ( args->cacheable_ >= IField::WT_CACHEABLE && shadowCache_.covers( args->nbytes_ ) ) {
+			// write-through; CPSW never defers writes (not even to WB_CACHEABLE entries)
+			shadowCache_.update( args->off_, args->src_, args->nbytes_, args->msk1_, args->mskn_ );
+		} else {
+			shadowCache_.invalidate( args->off_, args->nbytes_ );
+		}
+	}
 
 	nWrites_++;
 	return rval;
 
 }
 
+bool CSRPAddressImpl::compilePlan(CompositePathIterator *node, CAccessPlan *plan) const
+{
+	if ( typeid( *this ) != typeid( CSRPAddressImpl ) ) {
+		return false;
+	}
+	return terminatePlan( node, plan );
+}
+
+void CSRPAddressImpl::flush() const
+{
+CMtx::lg GUARD( &mutex_ );
+	pendingWrites_.flush();
+}
+
+void CSRPAddressImpl::collectMetrics(IMetricsSink *sink)
+{
+uint64_t tmo, p50, p90, p99;
+
+	{
+	// the recent RTTs are recorded (and decay) under the mutex
+	CMtx::lg GUARD( &mutex_ );
+		tmo = dynTimeout_.get().getUs();
+		p50 = dynTimeout_.getRndTripPercentile( 50. ).getUs();
+		p90 = dynTimeout_.getRndTripPercentile( 90. ).getUs();
+		p99 = dynTimeout_.getRndTripPercentile( 99. ).getUs();
+	}
+
+	sink->counter  ( "reads",            nReads_                       );
+	sink->counter  ( "writes",           nWrites_                      );
+	sink->counter  ( "retries",          nRetries_                     );
+	sink->counter  ( "pipelined_writes", nPipelinedWrites_             );
+	sink->gauge    ( "timeout_us",       tmo                           );
+	sink->histogram( "roundtrip_us",     dynTimeout_.getRndTripHisto() );
+	// percentiles of recent round-trip times
+	sink->gauge    ( "roundtrip_p50_us", p50                           );
+	sink->gauge    ( "roundtrip_p90_us", p90                           );
+	sink->gauge    ( "roundtrip_p99_us", p99                           );
+}
+
 void CSRPAddressImpl::dump(FILE *f) const
 {
+uint64_t p50, p99;
+
+	{
+	CMtx::lg GUARD( &mutex_ );
+		p50 = dynTimeout_.getRndTripPercentile( 50. ).getUs();
+		p99 = dynTimeout_.getRndTripPercentile( 99. ).getUs();
+	}
+
 	fprintf(f,"CSRPAddressImpl:\n");
 	fprintf(f,"SRP Info:\n");
 	fprintf(f,"  Protocol Version  : %8u\n",   protoVersion_);
-	fprintf(f,"  Default Write Mode: %s\n",   SYNCHRONOUS == defaultWriteMode_ ? "Synchronous" : "Posted");
+	fprintf(f,"  Default Write Mode: %s\n",   SYNCHRONOUS == defaultWriteMode_ ? "Synchronous" : (PIPELINED == defaultWriteMode_ ? "Pipelined" : "Posted"));
 	fprintf(f,"  Timeout (user)    : %8" PRIu64 "us\n", usrTimeout_.getUs());
 	fprintf(f,"  Timeout %s : %8" PRIu64 "us\n", useDynTimeout_ ? "(dynamic)" : "(capped) ", dynTimeout_.get().getUs());
 	if ( useDynTimeout_ )
 	{
 	fprintf(f,"  max Roundtrip time: %8" PRIu64 "us\n", dynTimeout_.getMaxRndTrip().getUs());
 	fprintf(f,"  avg Roundtrip time: %8" PRIu64 "us\n", dynTimeout_.getAvgRndTrip().getUs());
+	if ( dynTimeout_.getPercentile() > 0. )
+	fprintf(f,"  Timeout based on  : %8.3g%% percentile + %u%%\n", dynTimeout_.getPercentile(), dynTimeout_.getMargin());
 	}
+	fprintf(f,"  50%% Roundtrip time: %8" PRIu64 "us (recent)\n", p50);
+	fprintf(f,"  99%% Roundtrip time: %8" PRIu64 "us (recent)\n", p99);
 	fprintf(f,"  Retry Limit       : %8u\n",   retryCnt_);
+	fprintf(f,"  Read Window       : %8u\n",   readWindow_);
 	fprintf(f,"  # of retried ops  : %8u\n",   nRetries_);
 	fprintf(f,"  # of writes (OK)  : %8u\n",   nWrites_);
 	fprintf(f,"  # of reads  (OK)  : %8u\n",   nReads_);
+	if ( POSTED != defaultWriteMode_ ) {
+	fprintf(f,"  Write Window      : %8u\n",   writeWindow_);
+	fprintf(f,"  # pipelined writes: %8u\n",   nPipelinedWrites_);
+	fprintf(f,"  # of failed writes: %8u\n",   pendingWrites_.getNumFailed());
+	}
 	fprintf(f,"  Virtual Channel   : %8u\n",   vc_);
 	fprintf(f,"  Async Messages    : %8u\n",   asyncIOHandler_.getMsgCount());
+	if ( shadowCache_.isEnabled() )
+		shadowCache_.dump( f );
 	CCommAddressImpl::dump(f);
 }
 
+CRttHistogram::CRttHistogram()
+{
+	reset();
+}
+
+void CRttHistogram::reset()
+{
+	memset( cnt_, 0, sizeof(cnt_) );
+	tot_         = 0;
+	nSinceDecay_ = 0;
+}
+
+unsigned CRttHistogram::getIndex(uint64_t us)
+{
+unsigned msb, idx;
+
+	if ( us < (1 << LD_SUB) )
+		return us;
+	msb = 63 - __builtin_clzll( us );
+	idx = ((msb - LD_SUB + 1) << LD_SUB) + ((us >> (msb - LD_SUB)) & ((1 << LD_SUB) - 1));
+	return idx < NBUCKETS ? idx : NBUCKETS - 1;
+}
+
+uint64_t CRttHistogram::getLimit(unsigned idx)
+{
+unsigned msb;
+
+	if ( idx < (1 << LD_SUB) )
+		return idx + 1;
+	msb = (idx >> LD_SUB) + LD_SUB - 1;
+	return ((uint64_t)( (1 << LD_SUB) + (idx & ((1 << LD_SUB) - 1)) + 1 )) << (msb - LD_SUB);
+}
+
+void CRttHistogram::decay()
+{
+unsigned i;
+	tot_ = 0;
+	for ( i = 0; i < NBUCKETS; i++ ) {
+		tot_ += (cnt_[i] >>= 1);
+	}
+	nSinceDecay_ = 0;
+}
+
+void CRttHistogram::record(uint64_t us)
+{
+	cnt_[ getIndex( us ) ]++;
+	tot_++;
+	if ( ++nSinceDecay_ >= DECAY_SAMPLES )
+		decay();
+}
+
+uint64_t CRttHistogram::getPercentile(double pct) const
+{
+uint64_t need, sum;
+unsigned i;
+
+	if ( 0 == tot_ )
+		return 0;
+	need = (uint64_t)( (double)tot_ * pct / 100. + 0.5 );
+	if ( need < 1 )
+		need = 1;
+	for ( i = 0, sum = 0; i < NBUCKETS - 1; i++ ) {
+		if ( (sum += cnt_[i]) >= need )
+			break;
+	}
+	return getLimit( i );
+}
+
 DynTimeout::DynTimeout(const CTimeout &iniv)
-: timeoutCap_( CAP_US )
+: timeoutCap_( CAP_US        ),
+  timeoutMax_( iniv.getUs()  ),
+  relaxedUs_ ( 0             ),
+  percentile_( 0.     ),
+  marginPct_ ( 100    )
 {
 	reset( iniv );
 }
 
+void DynTimeout::setPercentile(double pct, unsigned marginPct)
+{
+	percentile_ = pct;
+	marginPct_  = marginPct;
+}
+
 void DynTimeout::setLastUpdate()
 {
 	if ( clock_gettime( CLOCK_MONOTONIC, &lastUpdate_.tv_ ) ) {
@@ -891,7 +1379,20 @@ void DynTimeout::setLastUpdate()
 	// seem to get CPU time quickly enough.
 	// We mitigate by capping the timeout if that happens.
 
-	uint64_t new_timeout = avgRndTrip_ >> (AVG_SHFT-MARG_SHFT);
+	uint64_t new_timeout;
+
+	if ( percentile_ > 0. && rttRecent_.getCount() >= PCTL_MIN_SAMPLES ) {
+		// the average is a poor predictor under bursty load;
+		// use the tail of the recent distribution instead
+		new_timeout  = rttRecent_.getPercentile( percentile_ );
+		new_timeout += new_timeout * marginPct_ / 100;
+		if ( new_timeout < relaxedUs_ )
+			new_timeout = relaxedUs_;
+		if ( new_timeout > timeoutMax_ )
+			new_timeout = timeoutMax_;
+	} else {
+		new_timeout  = avgRndTrip_ >> (AVG_SHFT-MARG_SHFT);
+	}
 	if ( new_timeout < timeoutCap_ )
 		new_timeout = timeoutCap_;
 	dynTimeout_.set( new_timeout );
@@ -908,6 +1409,8 @@ void DynTimeout::reset(const CTimeout &iniv)
 {
 	maxRndTrip_.set(0);
 	avgRndTrip_ = iniv.getUs() << (AVG_SHFT - MARG_SHFT);
+	rttRecent_.reset();
+	relaxedUs_  = 0;
 	setLastUpdate();
 #ifdef TIMEOUT_DEBUG
 	fprintf(CPSW::fDbg(), "dynTimeout reset to %" PRId64 "\n", dynTimeout_.getUs());
@@ -919,6 +1422,9 @@ void DynTimeout::relax()
 
 	// increase
 	avgRndTrip_ += (dynTimeout_.getUs()<<1) - (avgRndTrip_ >> AVG_SHFT);
+	// don't record a synthetic sample in the histogram; the
+	// percentile would feed on its own back-off.
+	relaxedUs_   = dynTimeout_.getUs()<<1;
 
 	setLastUpdate();
 #ifdef TIMEOUT_DEBUG
@@ -926,17 +1432,28 @@ void DynTimeout::relax()
 #endif
 }
 
-void DynTimeout::update(const struct timespec *now, const struct timespec *then)
+CTimeout DynTimeout::sample(const struct timespec *now, const struct timespec *then)
 {
 CTimeout diff(*now);
-int64_t  diffus;
 
 	diff -= CTimeout( *then );
 
 	if ( maxRndTrip_ < diff )
 		maxRndTrip_ = diff;
 
+	rndTripHisto_.record( diff.getUs() );
+	rttRecent_.record( diff.getUs() );
+
+	return diff;
+}
+
+void DynTimeout::update(const struct timespec *now, const struct timespec *then)
+{
+CTimeout diff( sample( now, then ) );
+int64_t  diffus;
+
 	avgRndTrip_ += (diffus = diff.getUs() - (avgRndTrip_ >> AVG_SHFT));
+	relaxedUs_   = 0;
 
 	setLastUpdate();
 #ifdef TIMEOUT_DEBUG
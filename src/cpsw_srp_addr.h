@@ -13,7 +13,48 @@
 #include <cpsw_comm_addr.h>
 #include <cpsw_thread.h>
 #include <cpsw_async_io.h>
+#include <cpsw_condvar.h>
+#include <cpsw_shadow_cache.h>
+#include <cpsw_metrics.h>
 
+#include <vector>
+
+
+// Compact histogram of recent round-trip times (in us) with
+// 2^LD_SUB logarithmically spaced buckets per octave (i.e., ~19%
+// resolution). Counts are halved every DECAY_SAMPLES samples so
+// that the distribution follows changing conditions.
+// Not thread-safe; protected by the SRP address' mutex.
+class CRttHistogram {
+public:
+	static const unsigned LD_SUB        = 2;
+	static const unsigned NBUCKETS      = 34 << LD_SUB; // up to ~2^34us
+	static const unsigned DECAY_SAMPLES = 512;
+
+private:
+	uint32_t  cnt_[NBUCKETS];
+	uint32_t  tot_;
+	unsigned  nSinceDecay_;
+
+	void decay();
+
+public:
+	CRttHistogram();
+
+	static unsigned getIndex(uint64_t us);
+	// upper (exclusive) limit of bucket 'idx'
+	static uint64_t getLimit(unsigned idx);
+
+	void     record(uint64_t us);
+	void     reset();
+
+	uint32_t getCount() const { return tot_; }
+
+	// upper limit of the bucket where the fraction of
+	// samples reaches 'pct' percent; 0 if there are no
+	// samples.
+	uint64_t getPercentile(double pct) const;
+};
 
 // Dynamical timeout based on round-trip times
 class DynTimeout {
@@ -27,6 +68,14 @@ private:
 	CTimeout  dynTimeout_;
 	unsigned  nSinceLast_;
 	uint64_t  timeoutCap_;
+	uint64_t  timeoutMax_;   // percentile mode never exceeds this (user timeout)
+	uint64_t  relaxedUs_;    // backed-off timeout after lost replies; 0 if none
+	CMetricHistogram rndTripHisto_; // in us (since startup)
+	CRttHistogram    rttRecent_;    // in us (decaying)
+	double    percentile_;
+	unsigned  marginPct_;
+	// use the average until this many RTTs are recorded
+	static const unsigned PCTL_MIN_SAMPLES = 16;
 protected:
 	void  setLastUpdate();
 public:
@@ -38,6 +87,24 @@ public:
 	const CTimeout &getMaxRndTrip() const { return maxRndTrip_; }
 	const CTimeout  getAvgRndTrip() const;
 
+	const CMetricHistogram &getRndTripHisto() const { return rndTripHisto_; }
+
+	// percentile of recent round-trip times
+	const CTimeout  getRndTripPercentile(double pct) const
+	{
+		return CTimeout( rttRecent_.getPercentile( pct ) );
+	}
+
+	// derive the timeout from the 'pct' percentile of recent
+	// round-trip times plus 'marginPct' percent; a 'pct' of zero
+	// selects the average-based algorithm.
+	void setPercentile(double pct, unsigned marginPct);
+
+	double   getPercentile() const { return percentile_; }
+	unsigned getMargin()     const { return marginPct_;  }
+
+	// record a round-trip time (w/o adjusting the timeout)
+	CTimeout sample(const struct timespec *now, const struct timespec *then);
 	void update(const struct timespec *now, const struct timespec *then);
 
 	void setTimeoutCap(uint64_t cap)
@@ -47,6 +114,12 @@ public:
 			dynTimeout_.set( cap );
 	}
 
+	void setTimeoutMax(uint64_t max)
+	{
+		timeoutMax_ = max;
+	}
+
+	// a reply was lost; back off (until the next reply arrives)
 	void relax();
 	void reset(const CTimeout &);
 
@@ -54,6 +127,76 @@ public:
 
 class CSRPAddressImpl;
 
+// Keep track of transactions which are in flight on the
+// asynchronous VC (windowed reads, pipelined writes).
+class CSRPWindow : public CMtx, public CCond {
+private:
+	unsigned  inFlight_;
+
+	CSRPWindow(const CSRPWindow&);
+	CSRPWindow & operator=(const CSRPWindow&);
+
+protected:
+	// caller must hold the mutex
+	void      done_unlocked();
+
+public:
+	CSRPWindow(const char *name);
+
+	void      posted();
+
+	// block until less than 'n' transactions are in flight
+	void      waitBelow(unsigned n);
+
+	unsigned  getInFlight();
+
+	virtual ~CSRPWindow() {}
+};
+
+// Windowed read; remembers the chunks which failed so
+// they can be re-read.
+class CSRPReadWindow : public CSRPWindow {
+public:
+	struct Chunk {
+		uint8_t  *dst_;
+		uint64_t  off_;
+		unsigned  nbytes_;
+	};
+
+private:
+	std::vector<Chunk> failed_;
+
+public:
+	CSRPReadWindow();
+
+	void done(const Chunk &chunk, bool failed);
+
+	const std::vector<Chunk> & getFailed() const
+	{
+		return failed_;
+	}
+};
+
+// Pipelined writes; remembers the first failure until
+// the next flush.
+class CSRPWriteWindow : public CSRPWindow {
+private:
+	CPSWErrorHdl error_;
+	uint64_t     errorOff_;
+	unsigned     nFailed_;
+
+public:
+	CSRPWriteWindow();
+
+	void done(uint64_t off, CPSWError *err);
+
+	// wait for all writes to complete; throw if any of
+	// them failed since the last flush.
+	void flush();
+
+	unsigned getNumFailed();
+};
+
 class CSRPAsyncHandler : CRunnable {
 private:
 	AsyncIOTransactionManager xactMgr_;	
@@ -82,7 +225,7 @@ public:
 	}
 };
 
-class CSRPAddressImpl : public CCommAddressImpl {
+class CSRPAddressImpl : public CCommAddressImpl, public IMetricsSource {
 private:
 	INetIODev::ProtocolVersion protoVersion_;
 	CTimeout                  usrTimeout_;
@@ -101,7 +244,14 @@ private:
 	bool                      byteResolution_;
 	unsigned                  maxWordsRx_;
 	unsigned                  maxWordsTx_;
+	unsigned                  readWindow_;
+	unsigned                  writeWindow_;
 	WriteMode                 defaultWriteMode_;
+	mutable unsigned          nPipelinedWrites_;
+	// the following are referenced by asynchronous completions
+	// and must outlive the transaction manager
+	mutable CShadowCache      shadowCache_;
+	mutable CSRPWriteWindow   pendingWrites_;
 	ProtoPort                 asyncIOPort_;
 	AsyncIOTransactionManager asyncXactMgr_;
 	CSRPAsyncHandler          asyncIOHandler_;
@@ -112,7 +262,10 @@ protected:
 	mutable CMtx     mutex_;
 	virtual uint64_t readBlk_unlocked(IField::Cacheable cacheable, uint8_t *dst, uint64_t off, unsigned sbytes, AsyncIO aio) const;
 	virtual uint64_t readBlk_unlocked(IField::Cacheable cacheable, uint8_t *dst, uint64_t off, unsigned sbytes) const;
-	virtual uint64_t writeBlk_unlocked(IField::Cacheable cacheable, uint8_t *src, uint64_t off, unsigned dbytes, uint8_t msk1, uint8_t mskn) const;
+	// read a block which spans multiple transactions keeping up to 'readWindow_' of them in flight
+	virtual uint64_t readWindowed_unlocked(IField::Cacheable cacheable, uint8_t *dst, uint64_t off, unsigned sbytes, unsigned headbytes) const;
+	// 'pipelined': post on the async VC; the status is collected by 'flush()'
+	virtual uint64_t writeBlk_unlocked(IField::Cacheable cacheable, uint8_t *src, uint64_t off, unsigned dbytes, uint8_t msk1, uint8_t mskn, bool pipelined) const;
 
 public:
 	CSRPAddressImpl(AKey key, ProtoStackBuilder, ProtoPort);
@@ -132,10 +285,17 @@ public:
 	virtual uint64_t read (CReadArgs *args)  const;
 	virtual uint64_t write(CWriteArgs *args) const;
 
+	virtual bool     compilePlan(CompositePathIterator *node, CAccessPlan *plan) const;
+
+	// wait for pipelined writes to complete and report failures
+	virtual void     flush() const;
+
 	virtual void dump(FILE *f) const;
 
 	virtual void startUp();
 
+	virtual void collectMetrics(IMetricsSink *sink);
+
 	virtual unsigned getAlignment()                      const;
 
 	// ANY subclass must implement clone(AKey) !
@@ -145,6 +305,8 @@ public:
 	virtual unsigned getTimeoutUs()                      const { return usrTimeout_.getUs();               }
 	virtual unsigned getDynTimeoutUs()                   const { return dynTimeout_.get().getUs();         }
 	virtual unsigned getRetryCount()                     const { return retryCnt_;                         }
+	virtual unsigned getReadWindow()                     const { return readWindow_;                       }
+	virtual unsigned getWriteWindow()                    const { return writeWindow_;                      }
 	virtual INetIODev::ProtocolVersion getProtoVersion() const { return protoVersion_;                     }
 	virtual bool     getByteResolution()                 const { return byteResolution_;                   }
 	virtual uint8_t  getVC()                             const { return vc_;                               }
@@ -155,6 +317,8 @@ public:
 	virtual bool     needsPayloadSwap()                  const { return needsPldSwap_;                     }
 	virtual void     dumpYamlPart(YAML::Node &) const;
 	virtual uint32_t extractTid(BufChain msg) const;
+
+	virtual CShadowCache *getShadowCache()               const { return &shadowCache_;                     }
 };
 
 #endif
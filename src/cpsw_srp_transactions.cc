@@ -55,6 +55,13 @@ CSRPAsyncReadTransaction::CSRPAsyncReadTransaction(
 {
 }
 
+CSRPAsyncWriteTransaction::CSRPAsyncWriteTransaction(
+		const CAsyncIOTransactionKey &key)
+: CAsyncIOTransaction( key ),
+  CSRPWriteTransaction( 0, 0, 0 )
+{
+}
+
 CSRPTransaction::CSRPTransaction(
 	const CSRPAddressImpl *srpAddr
 )
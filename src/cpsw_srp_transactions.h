@@ -87,6 +87,26 @@ public:
 
 };
 
+class CSRPAsyncWriteTransaction : public CAsyncIOTransaction, public CSRPWriteTransaction {
+public:
+	CSRPAsyncWriteTransaction(
+		const CAsyncIOTransactionKey &key);
+
+	virtual void complete(BufChain bc)
+	{
+		// if bc is NULL then a timeout occurred and we don't do anything
+		if ( bc )
+			CSRPWriteTransaction::complete(bc);
+	}
+
+	virtual AsyncIOTransaction getSelfAsAsyncIOTransaction()
+	{
+		return getSelfAs<AsyncIOTransaction>();
+	}
+};
+
+typedef shared_ptr<CSRPAsyncWriteTransaction> SRPAsyncWriteTransaction;
+
 class CSRPAsyncReadTransaction;
 typedef shared_ptr<CSRPAsyncReadTransaction> SRPAsyncReadTransaction;
 
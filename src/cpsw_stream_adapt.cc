@@ -8,6 +8,48 @@
  //@C distributed except according to the terms contained in the LICENSE.txt file.
 #include <cpsw_api_user.h>
 #include <cpsw_stream_adapt.h>
+#include <cpsw_comm_addr.h>
+
+using cpsw::dynamic_pointer_cast;
+
+CStreamFrame::CStreamFrame(BufChain chain)
+: chain_( chain )
+{
+Buf     b;
+Segment s;
+
+	segs_.reserve( chain_->getLen() );
+	for ( b = chain_->getHead(); b; b = b->getNext() ) {
+		if ( (s.size = b->getSize()) > 0 ) {
+			s.data = b->getPayload();
+			segs_.push_back( s );
+		}
+	}
+}
+
+uint64_t
+CStreamFrame::getSize() const
+{
+	return chain_->getSize();
+}
+
+unsigned
+CStreamFrame::getNumSegments() const
+{
+	return segs_.size();
+}
+
+const IStreamFrame::Segment *
+CStreamFrame::getSegments() const
+{
+	return segs_.empty() ? 0 : &segs_[0];
+}
+
+uint64_t
+CStreamFrame::extract(uint8_t *buf, uint64_t off, uint64_t size) const
+{
+	return chain_->extract( buf, off, size );
+}
 
 
 CStreamAdapt::CStreamAdapt(Key &k, ConstPath p, shared_ptr<const CEntryImpl> ie)
@@ -38,6 +80,22 @@ CStreamAdapt::read(uint8_t *buf, uint64_t size, const CTimeout timeout, uint64_t
 	return cl->read( &it, &args );
 }
 
+StreamFrame
+CStreamAdapt::readChain(const CTimeout timeout)
+{
+	CompositePathIterator it( p_ );
+	shared_ptr<const CCommAddressImpl> cl = dynamic_pointer_cast<const CCommAddressImpl>( it->c_p_ );
+	BufChain bch;
+
+	if ( ! cl ) {
+		throw InterfaceNotImplementedError("CStreamAdapt -- readChain only supported on stream endpoints attached to a NetIODev");
+	}
+	if ( ! (bch = cl->readChain( &timeout )) ) {
+		return StreamFrame();
+	}
+	return cpsw::make_shared<CStreamFrame>( bch );
+}
+
 int64_t
 CStreamAdapt::write(uint8_t *buf, uint64_t size, const CTimeout timeout)
 {
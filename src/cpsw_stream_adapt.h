@@ -11,16 +11,42 @@
 
 #include <cpsw_api_user.h>
 #include <cpsw_entry_adapt.h>
+#include <cpsw_buf.h>
+
+#include <vector>
 
 class CStreamAdapt;
 typedef shared_ptr<CStreamAdapt> StreamAdapt;
 
+// Frame view backed by the BufChain it was received in
+class CStreamFrame : public IStreamFrame {
+private:
+	BufChain             chain_;
+	std::vector<Segment> segs_;
+
+public:
+	CStreamFrame(BufChain chain);
+
+	virtual uint64_t       getSize()        const;
+	virtual unsigned       getNumSegments() const;
+	virtual const Segment *getSegments()    const;
+	virtual uint64_t       extract(uint8_t *buf, uint64_t off, uint64_t size) const;
+
+	// for internal users who want to forward the frame
+	BufChain getChain() const
+	{
+		return chain_;
+	}
+};
+
 class CStreamAdapt : public IEntryAdapt, public virtual IStream {
 public:
 	CStreamAdapt(Key &k, ConstPath p, shared_ptr<const CEntryImpl> ie);
 
 	virtual int64_t read(uint8_t *buf, uint64_t size, const CTimeout timeout, uint64_t off);
 
+	virtual StreamFrame readChain(const CTimeout timeout);
+
 	virtual int64_t write(uint8_t *buf, uint64_t size, const CTimeout timeout);
 
 	virtual Encoding getEncoding() const;
@@ -14,11 +14,14 @@
 #include <cpsw_path.h>
 #include <cpsw_entry_adapt.h>
 #include <cpsw_sval.h>
+#include <cpsw_sval_conv.h>
 #include <cpsw_address.h>
 #include <cpsw_async_io.h>
+#include <cpsw_config_loader.h>
 #include <cpsw_stdio.h>
 
 #include <string>
+#include <typeinfo>
 
 #include <cpsw_yaml.h>
 
@@ -409,9 +412,17 @@ CIntEntryImpl::createAdapter(IEntryAdapterKey &key, ConstPath p, const std::type
 }
 
 IIntEntryAdapt::IIntEntryAdapt(Key &k, ConstPath p, shared_ptr<const CIntEntryImpl> ie)
-: IEntryAdapt(k, p, ie), nelms_(-1)
+: IEntryAdapt(k, p, ie), nelms_(-1), nativeSize_(0)
 {
+uint64_t sizeBits = ie->getSizeBits();
+
+	// properties of the entry are immutable; decide once whether
+	// a getVal/setVal may bypass the conversion machinery
+	if ( 0 == ie->getLsBit() && 0 == ie->getWordSwap() && 0 == sizeBits % 8 && sizeBits <= 64 ) {
+		nativeSize_ = sizeBits/8;
+	}
 	open();
+	plan_.compile( CompositePathIterator( p_ ) );
 }
 
 IIntEntryAdapt::~IIntEntryAdapt()
@@ -651,16 +662,33 @@ public:
 	}
 };
 
+unsigned
+CDoubleVal_ROAdapt::getRawElsz() const
+{
+uint64_t sizeBits = getSizeBits();
+
+	if ( IScalVal_Base::IEEE_754 == getEncoding() ) {
+		return 64 == sizeBits ? sizeof(double) : sizeof(float);
+	}
+	// smallest integer holding the (sign-extended) value
+	if ( sizeBits <= 8 )
+		return 1;
+	if ( sizeBits <= 16 )
+		return 2;
+	if ( sizeBits <= 32 )
+		return 4;
+	return 8;
+}
+
 void
-CDoubleVal_ROAdapt::int2dbl(double *dst, uint64_t *src, unsigned nelms)
+CDoubleVal_ROAdapt::int2dbl(double *dst, const uint8_t *src, unsigned elsz, unsigned nelms)
 {
-	if ( isSigned() ) {
-		for ( unsigned i = 0; i<nelms; i++ )
-			dst[i] = (int64_t)src[i];
-	} else {
-		for ( unsigned i = 0; i<nelms; i++ )
-			dst[i] = src[i];
+CDblConv conv;
+
+	if ( ! conv.initInt( elsz, isSigned() ) ) {
+		throw InternalError("CDoubleVal_ROAdapt::int2dbl -- unsupported element size");
 	}
+	conv( dst, src, nelms );
 }
 
 void
@@ -815,7 +843,15 @@ public:
 				|| truncate
 				|| wlen               >  0 ) {
 
-			// transformation necessary
+			// transformation necessary; try a kernel which does all of it
+			// in a single pass first
+			CIntConv     conv;
+
+			if ( 0 == wlen && conv.initGet( sbytes, dbytes_, sizeBits, lsb, adapter_->isSigned(), targetEndian_ != hostEndian ) ) {
+				conv( obufp_, ibufp_, nelms_ );
+				return;
+			}
+
 			SignExtender signExtend( adapter_->isSigned(), sizeBits, dbytes_ );
 			Swapper      byteSwap( sbytes,    1 );
 			Swapper      wordSwap( nbytes, wlen );
@@ -908,13 +944,40 @@ unsigned nelmsOnPath  = (*it).getNelmsLeft();
 
 unsigned IIntEntryAdapt::getVal(AsyncIO aio, uint8_t *buf, unsigned nelms, unsigned elsz, SlicedPathIterator *it)
 {
-Address            cl           = (*it)->c_p_;
-ByteOrder          targetEndian = cl->getByteOrder();
+	return getVal( aio, buf, nelms, elsz, it, 0 );
+}
+
+unsigned IIntEntryAdapt::getVal(CAccessBatch *batch, AsyncIO aio, uint8_t *buf, unsigned nelms, unsigned elsz, IndexRange *r)
+{
+SlicedPathIterator it(p_, r);
+	try {
+		return getVal( aio, buf, nelms, elsz, &it, batch );
+	} catch (const IOError &ex)  {
+		throw IOError((ex.what() + std::string(": ") + p_->toString()).c_str());
+	}
+}
+
+unsigned IIntEntryAdapt::getVal(AsyncIO aio, uint8_t *buf, unsigned nelms, unsigned elsz, SlicedPathIterator *it, CAccessBatch *batch)
+{
+ByteOrder          targetEndian = (*it)->c_p_->getByteOrder();
 
 	nelms = checkNelms(nelms, it);
 
 	CReadArgs args;
 
+	if ( aio && isNative( elsz, targetEndian ) ) {
+		// no conversion; read straight into the user buffer and
+		// have the user's callback executed directly
+		args.cacheable_ = ie_->getCacheable();
+		args.dst_       = buf;
+		args.nbytes_    = elsz;
+		args.off_       = 0;
+		args.aio_       = aio;
+		args.batch_     = batch;
+		read( it, &args );
+		return nelms;
+	}
+
 	shared_ptr<CGetIntValContext> ctxt = cpsw::make_shared<CGetIntValContext> (
 	                                             getSelfAs<IntEntryAdapt>(),
 	                                             buf,
@@ -925,6 +988,7 @@ ByteOrder          targetEndian = cl->getByteOrder();
 	args.cacheable_ = ie_->getCacheable();
 	args.off_       = 0;
 	args.aio_       = ctxt;
+	args.batch_     = batch;
 
 	ctxt->getReadParms( &args );
 
@@ -932,31 +996,39 @@ ByteOrder          targetEndian = cl->getByteOrder();
 	fprintf(CPSW::fDbg(), "READ PARMS: nbytes %u, nelms %u, off %llu, elsz %u\n", args.nbytes_, nelms, (unsigned long long)args.off_, elsz);
 #endif
 
-	cl->read( it, &args );
+	read( it, &args );
 
 	return nelms;
 }
 
 unsigned IIntEntryAdapt::getVal(uint8_t *buf, unsigned nelms, unsigned elsz, SlicedPathIterator *it)
 {
-Address            cl           = (*it)->c_p_;
-ByteOrder          targetEndian = cl->getByteOrder();
+ByteOrder          targetEndian = (*it)->c_p_->getByteOrder();
 
 	nelms = checkNelms( nelms, it );
 
 	CReadArgs args;
 
-	CGetIntValContext ctxt( getSelfAs<IntEntryAdapt>(), buf, nelms, elsz, targetEndian );
-
 	args.cacheable_ = ie_->getCacheable();
 	args.off_       = 0;
+
+	if ( isNative( elsz, targetEndian ) ) {
+		// no conversion; read straight into the user buffer
+		args.dst_       = buf;
+		args.nbytes_    = elsz;
+		read( it, &args );
+		return nelms;
+	}
+
+	CGetIntValContext ctxt( getSelfAs<IntEntryAdapt>(), buf, nelms, elsz, targetEndian );
+
 	ctxt.getReadParms( &args );
 
 #ifdef SVAL_DEBUG
 	fprintf(CPSW::fDbg(), "READ PARMS: nbytes %u, nelms %u, off %llu, elsz %u\n", args.nbytes_, nelms, (unsigned long long)args.off_, elsz);
 #endif
 
-	cl->read( it, &args );
+	read( it, &args );
 
 	ctxt.callback( 0 );
 	return nelms;
@@ -1093,32 +1165,40 @@ private:
 	CDoubleVal_ROAdapt *adapter_;
 	double             *buf_;
 	unsigned            nelms_;
+	unsigned            elsz_;
 
 public:
 	CGetDoubleValContext(IntEntryAdapt handle, CDoubleVal_ROAdapt *adapter, double *buf, unsigned nelms, AsyncIO stack = AsyncIO())
 	: CGetValContext( handle, stack ),
 	  adapter_ ( adapter ),
 	  buf_     ( buf     ),
-	  nelms_   ( nelms   )
+	  nelms_   ( nelms   ),
+	  elsz_    ( adapter->getRawElsz() )
 	{
 	}
 
-	void doComplete()
+	// the raw data are read into the tail of the user
+	// buffer and expanded from there
+	uint8_t *getRawBuf() const
 	{
-	int i;
+		return reinterpret_cast<uint8_t*>( buf_ ) + nelms_ * (sizeof(*buf_) - elsz_);
+	}
 
+	unsigned getRawElsz() const
+	{
+		return elsz_;
+	}
+
+	void doComplete()
+	{
 		if ( IScalVal_Base::IEEE_754 == adapter_->getEncoding() ) {
-			if ( 64 != adapter_->getSizeBits() ) {
-				for ( i=(nelms_ - 1); i>=0; i-- ) {
-					float f;
-					::memcpy( &f, reinterpret_cast<float*>(buf_) + i, sizeof(f) );
-					buf_[i] = (double)f;
-				}
+			if ( sizeof(*buf_) != elsz_ ) {
+				CDblConv conv;
+				conv.initFloat();
+				conv( buf_, getRawBuf(), nelms_ );
 			}
 		} else {
-			// FIXME -- this is a violation of the alias rule -- we might
-			//          have to allocate an intermediate buffer...
-			adapter_->int2dbl( buf_, reinterpret_cast<uint64_t*>(buf_), nelms_ );
+			adapter_->int2dbl( buf_, getRawBuf(), elsz_, nelms_ );
 		}
 
 		adapter_->dbl2dbl( buf_, nelms_ );
@@ -1129,20 +1209,11 @@ unsigned CDoubleVal_ROAdapt::getVal(AsyncIO aio, double *buf, unsigned nelms, In
 {
 SlicedPathIterator it(p_, range);
 
-unsigned rval;
-
 	nelms = checkNelms(nelms, &it);
 
 shared_ptr<CGetDoubleValContext> ctxt = cpsw::make_shared<CGetDoubleValContext>( getSelfAs<IntEntryAdapt>(), this, buf, nelms, aio );
 
-	if ( IScalVal_Base::IEEE_754 == getEncoding() && 64 != getSizeBits() ) {
-		float *fBuf = reinterpret_cast<float*>(buf);
-		rval = IIntEntryAdapt::getVal<float>( ctxt, fBuf, nelms, &it );
-	} else {
-		rval = IIntEntryAdapt::getVal<double>( ctxt, buf, nelms, &it );
-	}
-
-	return rval;
+	return IIntEntryAdapt::getVal( ctxt, ctxt->getRawBuf(), nelms, ctxt->getRawElsz(), &it );
 }
 
 unsigned CDoubleVal_ROAdapt::getVal(double *buf, unsigned nelms, IndexRange *range)
@@ -1155,12 +1226,7 @@ unsigned rval;
 
 	CGetDoubleValContext ctxt( getSelfAs<IntEntryAdapt>(), this, buf, nelms );
 
-	if ( IScalVal_Base::IEEE_754 == getEncoding() && 64 != getSizeBits() ) {
-		float *fBuf = reinterpret_cast<float*>(buf);
-		rval = IIntEntryAdapt::getVal<float>( fBuf, nelms, &it );
-	} else {
-		rval = IIntEntryAdapt::getVal<double>( buf, nelms, &it );
-	}
+	rval = IIntEntryAdapt::getVal( ctxt.getRawBuf(), nelms, ctxt.getRawElsz(), &it );
 
 	ctxt.callback( 0 );
 
@@ -1179,8 +1245,42 @@ static void prib(const char *pre, uint8_t *b)
 #endif
 
 unsigned IIntEntryAdapt::setVal(uint8_t *buf, unsigned nelms, unsigned elsz, IndexRange *range)
+{
+	return setVal( buf, nelms, elsz, range, 0 );
+}
+
+unsigned IIntEntryAdapt::setVal(CAccessBatch *batch, uint8_t *buf, unsigned nelms, unsigned elsz, IndexRange *range)
+{
+	return setVal( buf, nelms, elsz, range, batch );
+}
+
+unsigned IIntEntryAdapt::setVal(uint8_t *buf, unsigned nelms, unsigned elsz, IndexRange *range, CAccessBatch *batch)
 {
 SlicedPathIterator   it( p_, range );
+
+	if ( isNative( elsz, it->c_p_->getByteOrder() ) ) {
+		// no conversion; write straight from the user buffer
+		CWriteArgs args;
+
+		nelms = checkNelms( nelms, &it );
+
+		args.cacheable_ = ( IVal_Base::WO == getMode() ) ? IField::NOT_CACHEABLE : ie_->getCacheable();
+		args.src_       = buf;
+		args.off_       = 0;
+		args.nbytes_    = elsz;
+		args.batch_     = batch;
+
+		write( &it, &args );
+
+		return nelms;
+	}
+
+	return setValConv( buf, nelms, elsz, &it, batch );
+}
+
+unsigned IIntEntryAdapt::setValConv(uint8_t *buf, unsigned nelms, unsigned elsz, SlicedPathIterator *itp, CAccessBatch *batch)
+{
+SlicedPathIterator  &it = *itp;
 Address          cl = it->c_p_;
 uint64_t         off = 0;
 unsigned         dbytes   = getSize(); // byte-size including lsb shift
@@ -1263,42 +1363,49 @@ uint8_t          mskn     = 0x00;
 #ifdef SVAL_DEBUG
 		fprintf(CPSW::fDbg(), "For NELMS %i, iinc %i, ioff %i, oinc %i, ooff %i, noff %i\n", nelms, iinc, ioff, oinc, ooff, noff);
 #endif
-		for ( n = nelms-1; n >= 0; n--, oidx += oinc, iidx += iinc ) {
+		CIntConv conv;
+
+		if ( 0 == wlen && conv.initSet( sbytes, dbytes, lsb, isSigned(), targetEndian != hostEndian ) ) {
+			// single-pass kernel
+			conv( obufp, ibufp, nelms );
+		} else {
+			for ( n = nelms-1; n >= 0; n--, oidx += oinc, iidx += iinc ) {
 
 #ifdef SVAL_DEBUG
-			prib("orig", ibufp+iidx);
+				prib("orig", ibufp+iidx);
 #endif
-			memcpy( obufp + oidx + ooff, ibufp + iidx + ioff, dbytes >= sbytes ? sbytes : dbytes );
+				memcpy( obufp + oidx + ooff, ibufp + iidx + ioff, dbytes >= sbytes ? sbytes : dbytes );
 #ifdef SVAL_DEBUG
-			prib("after memcpy", obufp + oidx);
+				prib("after memcpy", obufp + oidx);
 #endif
 
-			if ( sign_extend ) {
-				signExtend.work(obufp + oidx, obufp + oidx);
+				if ( sign_extend ) {
+					signExtend.work(obufp + oidx, obufp + oidx);
 #ifdef SVAL_DEBUG
-				prib("sign-extended", obufp + oidx);
+					prib("sign-extended", obufp + oidx);
 #endif
-			}
+				}
 
-			if ( wlen  > 0 ) {
-				wordSwap.work( obufp + oidx + noff );
+				if ( wlen  > 0 ) {
+					wordSwap.work( obufp + oidx + noff );
 #ifdef SVAL_DEBUG
-				prib("word-swapped", obufp + oidx);
+					prib("word-swapped", obufp + oidx);
 #endif
-			}
+				}
 
-			if ( lsb != 0 ) {
-				bits.shiftLeft( obufp + oidx );
+				if ( lsb != 0 ) {
+					bits.shiftLeft( obufp + oidx );
 #ifdef SVAL_DEBUG
-				prib("shifted", obufp + oidx);
+					prib("shifted", obufp + oidx);
 #endif
-			}
+				}
 
-			if ( targetEndian != hostEndian ) {
-				byteSwap.work( obufp + oidx );
+				if ( targetEndian != hostEndian ) {
+					byteSwap.work( obufp + oidx );
 #ifdef SVAL_DEBUG
-				prib("byte-swapped", obufp + oidx);
+					prib("byte-swapped", obufp + oidx);
 #endif
+				}
 			}
 		}
 	}
@@ -1311,8 +1418,9 @@ uint8_t          mskn     = 0x00;
 	args.nbytes_    = dbytes;
 	args.msk1_      = msk1;
 	args.mskn_      = mskn;
+	args.batch_     = batch;
 
-	cl->write( &it, &args );
+	write( &it, &args );
 
 	return nelms;
 }
@@ -1419,6 +1527,18 @@ unsigned nelms = nelmsFromIdx(r);
 	}
 }
 
+bool
+CIntEntryImpl::batchesConfigLoad() const
+{
+	return typeid(*this) == typeid(CIntEntryImpl);
+}
+
+bool
+CIntEntryImpl::batchesConfigDump() const
+{
+	return typeid(*this) == typeid(CIntEntryImpl);
+}
+
 typedef union VU_ {
 	double   d;
 	uint64_t u;
@@ -1436,14 +1556,27 @@ CIntEntryImpl::dumpMyConfigToYaml(Path p, YAML::Node &node) const
 			return 0;
 		}
 
+		bool         isFloat = (IScalVal_Base::IEEE_754 == getEncoding());
+
+		// integers are read (in parallel) ahead of time by the dumper
+		CConfigDumper *dmp = IPathImpl::toPathImpl( p )->getConfigDumper();
+
+		if ( dmp && dmp->isPrefetching() ) {
+			if ( ! isFloat ) {
+				dmp->prefetch( this, IScalVal_RO::create( p ), nelms );
+			}
+			node = YAML::Node( YAML::NodeType::Undefined );
+			return nelms;
+		}
+
 		TMP_BUF_DECL(VU,   valBuf, nelms );
 
 		unsigned     got;
-		unsigned     i;
-
-		bool         isFloat;
 
-		if ( (isFloat = (IScalVal_Base::IEEE_754 == getEncoding())) ) {
+		if ( dmp && ! isFloat ) {
+			dmp->getVals( this, & valBuf[0].u, nelms );
+			got = nelms;
+		} else if ( isFloat ) {
 			DoubleVal_RO val( IDoubleVal_RO::create( p ) );
 			got = val->getVal( & valBuf[0].d, nelms, 0 );
 		} else {
@@ -1455,65 +1588,75 @@ CIntEntryImpl::dumpMyConfigToYaml(Path p, YAML::Node &node) const
 			throw ConfigurationError("CIntEntryImpl::dumpMyConfigToYaml -- unexpected number of elements read");
 		}
 
-		// check if all values are identical - just do comparison of the bit pattern
-		// (since Nan == Nan is false we would end up writing unnecessary stuff)
-		uint64_t u0 = valBuf[0].u;
-		for ( i=nelms-1; i>0; i-- ) {
-			if ( u0 != valBuf[i].u )
-				break;
-		}
+		dumpValsToYaml( node, & valBuf[0].u, nelms, isFloat );
+
+		return nelms;
+	}
+	node = YAML::Node( YAML::NodeType::Undefined );
+	return 0;
+}
 
-		// base 10 settings
-		int field_width = 0;
-		const char *fmt = isSigned() ? "%*" PRId64 : "%*" PRIu64;
+void
+CIntEntryImpl::dumpValsToYaml(YAML::Node &node, const uint64_t *bits, unsigned nelms, bool isFloat) const
+{
+const VU *valBuf = reinterpret_cast<const VU*>( bits );
+unsigned  i;
 
-		if ( 16 == getConfigBase() ) {
-			// base 16 settings
-			field_width = (getSizeBits() + 3) / 4; // one hex char per nibble
-			fmt         = "0x%0*" PRIx64;
-		}
+	// check if all values are identical - just do comparison of the bit pattern
+	// (since Nan == Nan is false we would end up writing unnecessary stuff)
+	uint64_t u0 = valBuf[0].u;
+	for ( i=nelms-1; i>0; i-- ) {
+		if ( u0 != valBuf[i].u )
+			break;
+	}
 
-		if ( i ) {
-			// must save full array;
-			YAML::Node n( YAML::NodeType::Sequence );
+	// base 10 settings
+	int field_width = 0;
+	const char *fmt = isSigned() ? "%*" PRId64 : "%*" PRIu64;
 
-			if ( isFloat ) {
-				for ( i=0; i<nelms; i++ ) {
-					n.push_back( valBuf[i].d );
-				}
-			} else if ( enum_ ) {
-				for ( i=0; i<nelms; i++ ) {
-					n.push_back( *(enum_->map( valBuf[i].u ).first) );
-				}
-			} else {
-				char cbuf[66];
+	if ( 16 == getConfigBase() ) {
+		// base 16 settings
+		field_width = (getSizeBits() + 3) / 4; // one hex char per nibble
+		fmt         = "0x%0*" PRIx64;
+	}
 
-				for ( i=0; i<nelms; i++ ) {
-					// yaml-cpp dumps integers in decimal representation
-					::snprintf(cbuf, sizeof(cbuf), fmt, field_width, valBuf[i].u);
-					n.push_back( cbuf );
-				}
+	if ( i ) {
+		// must save full array;
+		YAML::Node n( YAML::NodeType::Sequence );
+
+		if ( isFloat ) {
+			for ( i=0; i<nelms; i++ ) {
+				n.push_back( valBuf[i].d );
+			}
+		} else if ( enum_ ) {
+			for ( i=0; i<nelms; i++ ) {
+				n.push_back( *(enum_->map( valBuf[i].u ).first) );
 			}
-			node = n;
 		} else {
-			// can save single value
-			YAML::Node n( YAML::NodeType::Scalar );
+			char cbuf[66];
 
-			if ( isFloat ) {
-				n = valBuf[0].d;
-			} else if ( enum_ ) {
-				n = *enum_->map( valBuf[0].u ).first;
-			} else {
-				char cbuf[66];
-				::snprintf(cbuf, sizeof(cbuf), fmt, field_width, valBuf[0].u);
-				n = cbuf;
+			for ( i=0; i<nelms; i++ ) {
+				// yaml-cpp dumps integers in decimal representation
+				::snprintf(cbuf, sizeof(cbuf), fmt, field_width, valBuf[i].u);
+				n.push_back( cbuf );
 			}
-			node = n;
 		}
-		return nelms;
+		node = n;
+	} else {
+		// can save single value
+		YAML::Node n( YAML::NodeType::Scalar );
+
+		if ( isFloat ) {
+			n = valBuf[0].d;
+		} else if ( enum_ ) {
+			n = *enum_->map( valBuf[0].u ).first;
+		} else {
+			char cbuf[66];
+			::snprintf(cbuf, sizeof(cbuf), fmt, field_width, valBuf[0].u);
+			n = cbuf;
+		}
+		node = n;
 	}
-	node = YAML::Node( YAML::NodeType::Undefined );
-	return 0;
 }
 
 uint64_t
@@ -1556,6 +1699,13 @@ unsigned nelms, i;
 
 	bool isFloat = (IScalVal_Base::IEEE_754 == getEncoding());
 
+	// integers are queued on the loader (if there is one)
+	CConfigLoader *ldr = IPathImpl::toPathImpl( p )->getConfigLoader();
+
+	if ( isFloat && ldr ) {
+		ldr->barrier();
+	}
+
 	if ( n.IsScalar() ) {
 		double   d;
 		uint64_t u;
@@ -1593,7 +1743,11 @@ unsigned nelms, i;
 		} else {
 			ScalVal val = IScalVal::create( p );
 			try {
-				val->setVal( u );
+				if ( ldr ) {
+					ldr->setVal( val, u );
+				} else {
+					val->setVal( u );
+				}
 			}
 			catch (const BadStatusError &ex) {
 				throw BadStatusError( (std::string(__FILE__) + std::string(":") +
@@ -1644,7 +1798,11 @@ unsigned nelms, i;
 		} else {
 			ScalVal val = IScalVal::create( p );
 			try {
-				val->setVal( &valBuf[0].u, nelms );
+				if ( ldr ) {
+					ldr->setVal( val, &valBuf[0].u, nelms );
+				} else {
+					val->setVal( &valBuf[0].u, nelms );
+				}
 			}
 			catch (const BadStatusError &ex) {
 				throw BadStatusError( (std::string(__FILE__) + std::string(":") +
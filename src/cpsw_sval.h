@@ -128,6 +128,15 @@ public:
 
 	virtual uint64_t dumpMyConfigToYaml(Path p, YAML::Node &n) const;
 	virtual uint64_t loadMyConfigFromYaml(Path p, YAML::Node &n) const;
+	// Only this class' load/dump use the batch; subclasses which
+	// override 'loadMyConfigFromYaml'/'dumpMyConfigToYaml' must not
+	// inherit 'true'. Subclasses keeping our implementation may
+	// override these to return 'true'.
+	virtual bool     batchesConfigLoad() const;
+	virtual bool     batchesConfigDump() const;
+
+	// format 'nelms' values (raw bits of doubles if 'isFloat') into 'node'
+	virtual void     dumpValsToYaml(YAML::Node &node, const uint64_t *bits, unsigned nelms, bool isFloat) const;
 
 	CIntEntryImpl(const CIntEntryImpl &orig, Key &k)
 	:CEntryImpl(orig, k),
@@ -171,7 +180,9 @@ public:
 
 class IIntEntryAdapt : public IEntryAdapt, public virtual IScalVal_Base {
 private:
-	int nelms_;
+	int      nelms_;
+	unsigned nativeSize_; // element size if only byte-swapping may be needed; 0 otherwise
+	CAccessPlan plan_;    // for accessing the entire path
 public:
 	IIntEntryAdapt(Key &k, ConstPath p, shared_ptr<const CIntEntryImpl> ie);
 	virtual bool     isSigned()    const { return asIntEntry()->isSigned();    }
@@ -185,6 +196,11 @@ public:
 
 	virtual unsigned nelmsFromIdx(IndexRange *r);
 
+	// queue an access on a batch; addresses which support batching
+	// defer the transfer until the batch is executed.
+	virtual unsigned getVal(CAccessBatch *batch, AsyncIO aio, uint8_t *, unsigned, unsigned, IndexRange *r);
+	virtual unsigned setVal(CAccessBatch *batch, uint8_t *, unsigned, unsigned, IndexRange *r);
+
 	virtual ~IIntEntryAdapt();
 
 protected:
@@ -192,6 +208,7 @@ protected:
 
 	virtual unsigned getVal(uint8_t  *, unsigned, unsigned, SlicedPathIterator *it);
 	virtual unsigned getVal(AsyncIO aio, uint8_t  *, unsigned, unsigned, SlicedPathIterator *it);
+	unsigned         getVal(AsyncIO aio, uint8_t  *, unsigned, unsigned, SlicedPathIterator *it, CAccessBatch *batch);
 
 	template <typename E> unsigned getVal(E *e, unsigned nelms, IndexRange *r)
 	{
@@ -234,7 +251,34 @@ protected:
 
 	virtual unsigned checkNelms(unsigned nelms, SlicedPathIterator *it);
 
+	// route I/O through the precompiled plan unless the
+	// path was sliced by an IndexRange
+	uint64_t read(SlicedPathIterator *it, CReadArgs *args) const
+	{
+		if ( plan_.isValid() && ! it->suffix ) {
+			return plan_.read( args );
+		}
+		return (*it)->c_p_->read( it, args );
+	}
+
+	uint64_t write(SlicedPathIterator *it, CWriteArgs *args) const
+	{
+		if ( plan_.isValid() && ! it->suffix ) {
+			return plan_.write( args );
+		}
+		return (*it)->c_p_->write( it, args );
+	}
+
+	// elements of 'elsz' octets may be transferred as-is
+	// to/from an address with byte order 'order'
+	bool isNative(unsigned elsz, ByteOrder order) const
+	{
+		return elsz == nativeSize_ && ( 1 == elsz || NATIVE == order || hostByteOrder() == order );
+	}
+
 	virtual unsigned setVal(uint8_t  *, unsigned, unsigned, IndexRange *r = 0);
+	unsigned         setVal(uint8_t  *, unsigned, unsigned, IndexRange *r, CAccessBatch *batch);
+	unsigned         setValConv(uint8_t  *, unsigned, unsigned, SlicedPathIterator *it, CAccessBatch *batch);
 
 	template <typename E> unsigned setVal(E *e, unsigned nelms, IndexRange *r)
 	{
@@ -298,7 +342,12 @@ class CDoubleVal_ROAdapt : public virtual IDoubleVal_RO, public virtual IIntEntr
 public:
 	CDoubleVal_ROAdapt(Key &k, ConstPath p, shared_ptr<const CIntEntryImpl> ie);
 
-	virtual void     int2dbl(double *dst, uint64_t *src, unsigned n);
+	// size of the elements read from the device (into the
+	// tail of the user's buffer) prior to conversion to double
+	unsigned         getRawElsz() const;
+
+	// 'src' holds host-order integers of 'elsz' octets
+	virtual void     int2dbl(double *dst, const uint8_t *src, unsigned elsz, unsigned n);
 	virtual void     dbl2dbl(double *dst, unsigned n);
 
 	virtual unsigned getVal(double   *p, unsigned n, IndexRange *r=0);
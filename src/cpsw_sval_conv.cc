@@ -0,0 +1,640 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_sval_conv.h>
+#include <cpsw_api_builder.h>
+
+#include <string.h>
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HOST_LE true
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define HOST_LE false
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CONV_HAVE_AVX2
+#include <immintrin.h>
+#define AVX2 __attribute__((target("avx2")))
+#endif
+
+typedef CIntConv::Kernel Kernel;
+
+static bool vecEnabled = true;
+
+#ifdef CONV_HAVE_AVX2
+static bool
+haveAvx2()
+{
+static const bool have_ = (__builtin_cpu_init(), __builtin_cpu_supports( "avx2" ));
+	return have_;
+}
+#endif
+
+#ifdef HOST_LE
+
+// octet order given at compile time; natural sizes map
+// to plain (possibly byte-swapping) loads/stores
+template <unsigned S, bool LEORD>
+static inline uint64_t
+ld(const uint8_t *p)
+{
+uint16_t v16;
+uint32_t v32;
+uint64_t v;
+unsigned i;
+	switch ( S ) {
+		case 2:
+			memcpy( &v16, p, sizeof(v16) );
+			return LEORD == HOST_LE ? v16 : __builtin_bswap16( v16 );
+		case 4:
+			memcpy( &v32, p, sizeof(v32) );
+			return LEORD == HOST_LE ? v32 : __builtin_bswap32( v32 );
+		case 8:
+			memcpy( &v,   p, sizeof(v)   );
+			return LEORD == HOST_LE ? v   : __builtin_bswap64( v   );
+		default:
+		break;
+	}
+	for ( i = 0, v = 0; i < S; i++ ) {
+		v |= ((uint64_t)p[i]) << ( 8 * ( LEORD ? i : S - 1 - i ) );
+	}
+	return v;
+}
+
+template <unsigned S, bool LEORD>
+static inline void
+st(uint8_t *p, uint64_t v)
+{
+uint16_t v16;
+uint32_t v32;
+unsigned i;
+	switch ( S ) {
+		case 2:
+			v16 = LEORD == HOST_LE ? v : __builtin_bswap16( v );
+			memcpy( p, &v16, sizeof(v16) );
+			return;
+		case 4:
+			v32 = LEORD == HOST_LE ? v : __builtin_bswap32( v );
+			memcpy( p, &v32, sizeof(v32) );
+			return;
+		case 8:
+			v   = LEORD == HOST_LE ? v : __builtin_bswap64( v );
+			memcpy( p, &v,   sizeof(v)   );
+			return;
+		default:
+		break;
+	}
+	for ( i = 0; i < S; i++ ) {
+		p[i] = (uint8_t)( v >> ( 8 * ( LEORD ? i : S - 1 - i ) ) );
+	}
+}
+
+// (v ^ sgn) - sgn extends the sign bit 'sgn' (no-op if sgn == 0)
+
+template <unsigned S, unsigned D, bool SWAP>
+static void
+getScalar(const CIntConv *c, uint8_t *dst, const uint8_t *src, unsigned n)
+{
+const unsigned shift = c->shift_;
+const uint64_t msk   = c->msk_;
+const uint64_t sgn   = c->sgn_;
+uint64_t       v;
+
+	if ( D > S && dst >= src ) {
+		// expanding in place; work top-down
+		dst += n*D;
+		src += n*S;
+		while ( n-- > 0 ) {
+			src -= S;
+			dst -= D;
+			v    = ( ( ld<S, HOST_LE != SWAP>( src ) >> shift ) & msk );
+			st<D, HOST_LE>( dst, ( v ^ sgn ) - sgn );
+		}
+	} else {
+		while ( n-- > 0 ) {
+			v    = ( ( ld<S, HOST_LE != SWAP>( src ) >> shift ) & msk );
+			st<D, HOST_LE>( dst, ( v ^ sgn ) - sgn );
+			src += S;
+			dst += D;
+		}
+	}
+}
+
+template <unsigned S, unsigned D, bool SWAP>
+static void
+setScalar(const CIntConv *c, uint8_t *dst, const uint8_t *src, unsigned n)
+{
+const unsigned shift = c->shift_;
+const uint64_t sgn   = c->sgn_;
+uint64_t       v;
+
+	while ( n-- > 0 ) {
+		v    = ld<S, HOST_LE>( src );
+		st<D, HOST_LE != SWAP>( dst, ( ( v ^ sgn ) - sgn ) << shift );
+		src += S;
+		dst += D;
+	}
+}
+
+template <unsigned S, unsigned D>
+static Kernel
+selGetScalar(bool swap)
+{
+	return swap ? getScalar<S, D, true> : getScalar<S, D, false>;
+}
+
+template <unsigned S, unsigned D>
+static Kernel
+selSetScalar(bool swap)
+{
+	return swap ? setScalar<S, D, true> : setScalar<S, D, false>;
+}
+
+// any device size, user size D
+template <unsigned D>
+static Kernel
+selGetScalarS(unsigned s, bool swap)
+{
+	switch ( s ) {
+		case 1: return selGetScalar<1, D>( swap );
+		case 2: return selGetScalar<2, D>( swap );
+		case 3: return selGetScalar<3, D>( swap );
+		case 4: return selGetScalar<4, D>( swap );
+		case 5: return selGetScalar<5, D>( swap );
+		case 6: return selGetScalar<6, D>( swap );
+		case 7: return selGetScalar<7, D>( swap );
+		case 8: return selGetScalar<8, D>( swap );
+		default:
+		break;
+	}
+	return 0;
+}
+
+// user size S, any device size
+template <unsigned S>
+static Kernel
+selSetScalarD(unsigned d, bool swap)
+{
+	switch ( d ) {
+		case 1: return selSetScalar<S, 1>( swap );
+		case 2: return selSetScalar<S, 2>( swap );
+		case 3: return selSetScalar<S, 3>( swap );
+		case 4: return selSetScalar<S, 4>( swap );
+		case 5: return selSetScalar<S, 5>( swap );
+		case 6: return selSetScalar<S, 6>( swap );
+		case 7: return selSetScalar<S, 7>( swap );
+		case 8: return selSetScalar<S, 8>( swap );
+		default:
+		break;
+	}
+	return 0;
+}
+
+#ifdef CONV_HAVE_AVX2
+
+// operations on 256-bit registers holding D-octet lanes
+template <unsigned D> struct Lanes;
+
+template <> struct Lanes<2> {
+	AVX2 static __m256i set1(uint64_t v)           { return _mm256_set1_epi16( (short)v );   }
+	AVX2 static __m256i srl (__m256i x, __m128i c) { return _mm256_srl_epi16( x, c );        }
+	AVX2 static __m256i sll (__m256i x, __m128i c) { return _mm256_sll_epi16( x, c );        }
+	AVX2 static __m256i sub (__m256i x, __m256i y) { return _mm256_sub_epi16( x, y );        }
+};
+
+template <> struct Lanes<4> {
+	AVX2 static __m256i set1(uint64_t v)           { return _mm256_set1_epi32( (int)v );     }
+	AVX2 static __m256i srl (__m256i x, __m128i c) { return _mm256_srl_epi32( x, c );        }
+	AVX2 static __m256i sll (__m256i x, __m128i c) { return _mm256_sll_epi32( x, c );        }
+	AVX2 static __m256i sub (__m256i x, __m256i y) { return _mm256_sub_epi32( x, y );        }
+};
+
+template <> struct Lanes<8> {
+	AVX2 static __m256i set1(uint64_t v)           { return _mm256_set1_epi64x( (long long)v ); }
+	AVX2 static __m256i srl (__m256i x, __m128i c) { return _mm256_srl_epi64( x, c );        }
+	AVX2 static __m256i sll (__m256i x, __m128i c) { return _mm256_sll_epi64( x, c );        }
+	AVX2 static __m256i sub (__m256i x, __m256i y) { return _mm256_sub_epi64( x, y );        }
+};
+
+// shuffle reversing the octets of each S-octet element
+template <unsigned S>
+AVX2 static inline __m128i
+swapMsk()
+{
+uint8_t  m[16];
+unsigned i;
+	for ( i = 0; i < 16; i++ ) {
+		m[i] = (i - i % S) + (S - 1 - i % S);
+	}
+	return _mm_loadu_si128( (const __m128i*)m );
+}
+
+// load 32/D elements of S octets and zero-extend them to D-octet lanes
+template <unsigned S, unsigned D, bool SWAP>
+AVX2 static inline __m256i
+ldw(const uint8_t *p, __m128i smsk)
+{
+__m128i  x;
+__m256i  y;
+uint32_t w;
+
+	if ( S == D ) {
+		y = _mm256_loadu_si256( (const __m256i*)p );
+		if ( SWAP && S > 1 ) {
+			y = _mm256_shuffle_epi8( y, _mm256_broadcastsi128_si256( smsk ) );
+		}
+		return y;
+	}
+
+	switch ( 32/D*S ) {
+		case 16: x = _mm_loadu_si128( (const __m128i*)p );  break;
+		case  8: x = _mm_loadl_epi64( (const __m128i*)p );  break;
+		default: memcpy( &w, p, sizeof(w) ); x = _mm_cvtsi32_si128( w ); break;
+	}
+	if ( SWAP && S > 1 ) {
+		x = _mm_shuffle_epi8( x, smsk );
+	}
+	switch ( S*16 + D ) {
+		case 0x12: return _mm256_cvtepu8_epi16 ( x );
+		case 0x14: return _mm256_cvtepu8_epi32 ( x );
+		case 0x18: return _mm256_cvtepu8_epi64 ( x );
+		case 0x24: return _mm256_cvtepu16_epi32( x );
+		case 0x28: return _mm256_cvtepu16_epi64( x );
+		default:   return _mm256_cvtepu32_epi64( x );
+	}
+}
+
+template <unsigned S, unsigned D, bool SWAP>
+AVX2 static void
+getAvx2(const CIntConv *c, uint8_t *dst, const uint8_t *src, unsigned n)
+{
+const unsigned N    = 32/D;
+const __m128i  cnt  = _mm_cvtsi32_si128( c->shift_ );
+const __m256i  msk  = Lanes<D>::set1( c->msk_ );
+const __m256i  sgn  = Lanes<D>::set1( c->sgn_ );
+const __m128i  smsk = swapMsk<S>();
+unsigned       nblk = n / N;
+unsigned       rem  = n % N;
+unsigned       i;
+__m256i        x;
+
+	if ( D > S && dst >= src ) {
+		// expanding in place; work top-down
+		getScalar<S, D, SWAP>( c, dst + nblk*N*D, src + nblk*N*S, rem );
+		while ( nblk-- > 0 ) {
+			x = ldw<S, D, SWAP>( src + nblk*N*S, smsk );
+			x = _mm256_and_si256( Lanes<D>::srl( x, cnt ), msk );
+			x = Lanes<D>::sub( _mm256_xor_si256( x, sgn ), sgn );
+			_mm256_storeu_si256( (__m256i*)(dst + nblk*N*D), x );
+		}
+	} else {
+		for ( i = 0; i < nblk; i++ ) {
+			x = ldw<S, D, SWAP>( src, smsk );
+			x = _mm256_and_si256( Lanes<D>::srl( x, cnt ), msk );
+			x = Lanes<D>::sub( _mm256_xor_si256( x, sgn ), sgn );
+			_mm256_storeu_si256( (__m256i*)dst, x );
+			src += N*S;
+			dst += N*D;
+		}
+		getScalar<S, D, SWAP>( c, dst, src, rem );
+	}
+}
+
+// same-size elements only; there is no sign to extend
+template <unsigned S, bool SWAP>
+AVX2 static void
+setAvx2(const CIntConv *c, uint8_t *dst, const uint8_t *src, unsigned n)
+{
+const unsigned N    = 32/S;
+const __m128i  cnt  = _mm_cvtsi32_si128( c->shift_ );
+const __m256i  smsk = _mm256_broadcastsi128_si256( swapMsk<S>() );
+unsigned       nblk = n / N;
+unsigned       i;
+__m256i        x;
+
+	for ( i = 0; i < nblk; i++ ) {
+		x = Lanes<S>::sll( _mm256_loadu_si256( (const __m256i*)src ), cnt );
+		if ( SWAP ) {
+			x = _mm256_shuffle_epi8( x, smsk );
+		}
+		_mm256_storeu_si256( (__m256i*)dst, x );
+		src += N*S;
+		dst += N*S;
+	}
+	setScalar<S, S, SWAP>( c, dst, src, n % N );
+}
+
+template <unsigned S, unsigned D>
+static Kernel
+selGetAvx2(bool swap)
+{
+	return swap ? getAvx2<S, D, true> : getAvx2<S, D, false>;
+}
+
+static Kernel
+selGetVec(unsigned s, unsigned d, bool swap)
+{
+	if ( ! vecEnabled || ! haveAvx2() ) {
+		return 0;
+	}
+	switch ( s*16 + d ) {
+		case 0x22: return selGetAvx2<2, 2>( swap );
+		case 0x44: return selGetAvx2<4, 4>( swap );
+		case 0x88: return selGetAvx2<8, 8>( swap );
+		case 0x12: return selGetAvx2<1, 2>( swap );
+		case 0x14: return selGetAvx2<1, 4>( swap );
+		case 0x18: return selGetAvx2<1, 8>( swap );
+		case 0x24: return selGetAvx2<2, 4>( swap );
+		case 0x28: return selGetAvx2<2, 8>( swap );
+		case 0x48: return selGetAvx2<4, 8>( swap );
+		default:
+		break;
+	}
+	return 0;
+}
+
+static Kernel
+selSetVec(unsigned s, unsigned d, bool swap)
+{
+	if ( ! vecEnabled || ! haveAvx2() || s != d ) {
+		return 0;
+	}
+	switch ( s ) {
+		case 2: return swap ? setAvx2<2, true> : setAvx2<2, false>;
+		case 4: return swap ? setAvx2<4, true> : setAvx2<4, false>;
+		case 8: return swap ? setAvx2<8, true> : setAvx2<8, false>;
+		default:
+		break;
+	}
+	return 0;
+}
+
+#else
+
+static Kernel selGetVec(unsigned s, unsigned d, bool swap) { return 0; }
+static Kernel selSetVec(unsigned s, unsigned d, bool swap) { return 0; }
+
+#endif /* CONV_HAVE_AVX2 */
+
+#endif /* HOST_LE */
+
+bool
+CIntConv::initGet(unsigned sbytes, unsigned dbytes, unsigned sizeBits, unsigned lsb, bool isSigned, bool swap)
+{
+#ifdef HOST_LE
+	// the byte order may be overridden at run-time (testing)
+	if ( hostByteOrder() != ( HOST_LE ? LE : BE ) ) {
+		return false;
+	}
+	if ( sbytes < 1 || sbytes > 8 || sizeBits < 1 || sizeBits > 64 || lsb > 7 ) {
+		return false;
+	}
+
+	sbytes_ = sbytes;
+	dbytes_ = dbytes;
+	shift_  = lsb;
+	msk_    = sizeBits < 64 ? (((uint64_t)1) << sizeBits) - 1 : ~(uint64_t)0;
+	sgn_    = isSigned && sizeBits < 64 ? ((uint64_t)1) << (sizeBits - 1) : 0;
+	vec_    = !! (kern_ = selGetVec( sbytes, dbytes, swap ));
+
+	if ( ! kern_ ) {
+		switch ( dbytes ) {
+			case 1: kern_ = selGetScalarS<1>( sbytes, swap ); break;
+			case 2: kern_ = selGetScalarS<2>( sbytes, swap ); break;
+			case 4: kern_ = selGetScalarS<4>( sbytes, swap ); break;
+			case 8: kern_ = selGetScalarS<8>( sbytes, swap ); break;
+			default:
+			break;
+		}
+	}
+	return !! kern_;
+#else
+	return false;
+#endif
+}
+
+bool
+CIntConv::initSet(unsigned sbytes, unsigned dbytes, unsigned lsb, bool isSigned, bool swap)
+{
+#ifdef HOST_LE
+	if ( hostByteOrder() != ( HOST_LE ? LE : BE ) ) {
+		return false;
+	}
+	if ( dbytes < 1 || dbytes > 8 || lsb > 7 ) {
+		return false;
+	}
+
+	sbytes_ = sbytes;
+	dbytes_ = dbytes;
+	shift_  = lsb;
+	msk_    = ~(uint64_t)0;
+	sgn_    = isSigned && sbytes < 8 ? ((uint64_t)1) << (8*sbytes - 1) : 0;
+	vec_    = !! (kern_ = selSetVec( sbytes, dbytes, swap ));
+
+	if ( ! kern_ ) {
+		switch ( sbytes ) {
+			case 1: kern_ = selSetScalarD<1>( dbytes, swap ); break;
+			case 2: kern_ = selSetScalarD<2>( dbytes, swap ); break;
+			case 4: kern_ = selSetScalarD<4>( dbytes, swap ); break;
+			case 8: kern_ = selSetScalarD<8>( dbytes, swap ); break;
+			default:
+			break;
+		}
+	}
+	return !! kern_;
+#else
+	return false;
+#endif
+}
+
+const char *
+CIntConv::getKernelName() const
+{
+	if ( ! kern_ )
+		return "none";
+	return vec_ ? "avx2" : "scalar";
+}
+
+void
+CIntConv::setVectorEnabled(bool enabled)
+{
+	vecEnabled = enabled;
+}
+
+template <typename T>
+static void
+toDblScalar(double *dst, const uint8_t *src, unsigned n)
+{
+T        v;
+unsigned i;
+	for ( i = 0; i < n; i++ ) {
+		memcpy( &v, src + i*sizeof(v), sizeof(v) );
+		dst[i] = (double)v;
+	}
+}
+
+#ifdef CONV_HAVE_AVX2
+
+// 4 elements -> 4 doubles
+template <typename T> struct Dbl4;
+
+template <> struct Dbl4<int8_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+	uint32_t w;
+		memcpy( &w, p, sizeof(w) );
+		return _mm256_cvtepi32_pd( _mm_cvtepi8_epi32( _mm_cvtsi32_si128( w ) ) );
+	}
+};
+
+template <> struct Dbl4<uint8_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+	uint32_t w;
+		memcpy( &w, p, sizeof(w) );
+		return _mm256_cvtepi32_pd( _mm_cvtepu8_epi32( _mm_cvtsi32_si128( w ) ) );
+	}
+};
+
+template <> struct Dbl4<int16_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+		return _mm256_cvtepi32_pd( _mm_cvtepi16_epi32( _mm_loadl_epi64( (const __m128i*)p ) ) );
+	}
+};
+
+template <> struct Dbl4<uint16_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+		return _mm256_cvtepi32_pd( _mm_cvtepu16_epi32( _mm_loadl_epi64( (const __m128i*)p ) ) );
+	}
+};
+
+template <> struct Dbl4<int32_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+		return _mm256_cvtepi32_pd( _mm_loadu_si128( (const __m128i*)p ) );
+	}
+};
+
+template <> struct Dbl4<uint32_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+	// flip the sign bit, convert as signed and add 2^31 back (exact)
+	__m128i x = _mm_xor_si128( _mm_loadu_si128( (const __m128i*)p ), _mm_set1_epi32( (int)0x80000000 ) );
+		return _mm256_add_pd( _mm256_cvtepi32_pd( x ), _mm256_set1_pd( 2147483648.0 ) );
+	}
+};
+
+/* There is no 64-bit integer conversion before AVX-512. The halves
+ * are embedded into the mantissae of two doubles with a suitable
+ * exponent; subtracting the magic offset is exact and the final
+ * addition is the only (correctly) rounded operation.
+ */
+template <> struct Dbl4<int64_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+	__m256i x  = _mm256_loadu_si256( (const __m256i*)p );
+	// upper 48 bits (arithmetically shifted) + 3*2^67
+	__m256i hi = _mm256_blend_epi16( _mm256_srai_epi32( x, 16 ), _mm256_setzero_si256(), 0x33 );
+	// lower 16 bits + 2^52
+	__m256i lo = _mm256_blend_epi16( x, _mm256_castpd_si256( _mm256_set1_pd( 4503599627370496.0 ) ), 0x88 );
+		hi = _mm256_add_epi64( hi, _mm256_castpd_si256( _mm256_set1_pd( 442721857769029238784.0 ) ) );
+		return _mm256_add_pd( _mm256_sub_pd( _mm256_castsi256_pd( hi ), _mm256_set1_pd( 442726361368656609280.0 ) ),
+		                      _mm256_castsi256_pd( lo ) );
+	}
+};
+
+template <> struct Dbl4<uint64_t> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+	__m256i x  = _mm256_loadu_si256( (const __m256i*)p );
+	// upper 32 bits + 2^84
+	__m256i hi = _mm256_or_si256( _mm256_srli_epi64( x, 32 ), _mm256_castpd_si256( _mm256_set1_pd( 19342813113834066795298816.0 ) ) );
+	// lower 32 bits + 2^52
+	__m256i lo = _mm256_blend_epi16( x, _mm256_castpd_si256( _mm256_set1_pd( 4503599627370496.0 ) ), 0xcc );
+		return _mm256_add_pd( _mm256_sub_pd( _mm256_castsi256_pd( hi ), _mm256_set1_pd( 19342813118337666422669312.0 ) ),
+		                      _mm256_castsi256_pd( lo ) );
+	}
+};
+
+template <> struct Dbl4<float> {
+	AVX2 static __m256d cvt(const uint8_t *p)
+	{
+		return _mm256_cvtps_pd( _mm_loadu_ps( (const float*)p ) );
+	}
+};
+
+// working upwards is safe if the source occupies the tail of
+// the destination: a block is loaded before it is overwritten
+// and stores never reach beyond the current source block.
+template <typename T>
+AVX2 static void
+toDblAvx2(double *dst, const uint8_t *src, unsigned n)
+{
+unsigned i;
+
+	for ( i = 0; i + 4 <= n; i += 4 ) {
+		_mm256_storeu_pd( dst + i, Dbl4<T>::cvt( src + i*sizeof(T) ) );
+	}
+	toDblScalar<T>( dst + i, src + i*sizeof(T), n - i );
+}
+
+template <typename T>
+static CDblConv::Kernel
+selToDbl(bool *vec)
+{
+	if ( ( *vec = vecEnabled && haveAvx2() ) ) {
+		return toDblAvx2<T>;
+	}
+	return toDblScalar<T>;
+}
+
+#else
+
+template <typename T>
+static CDblConv::Kernel
+selToDbl(bool *vec)
+{
+	*vec = false;
+	return toDblScalar<T>;
+}
+
+#endif /* CONV_HAVE_AVX2 */
+
+bool
+CDblConv::initInt(unsigned sbytes, bool isSigned)
+{
+	switch ( sbytes ) {
+		case 1: kern_ = isSigned ? selToDbl<int8_t> ( &vec_ ) : selToDbl<uint8_t> ( &vec_ ); break;
+		case 2: kern_ = isSigned ? selToDbl<int16_t>( &vec_ ) : selToDbl<uint16_t>( &vec_ ); break;
+		case 4: kern_ = isSigned ? selToDbl<int32_t>( &vec_ ) : selToDbl<uint32_t>( &vec_ ); break;
+		case 8: kern_ = isSigned ? selToDbl<int64_t>( &vec_ ) : selToDbl<uint64_t>( &vec_ ); break;
+		default:
+			kern_ = 0;
+		break;
+	}
+	return !! kern_;
+}
+
+bool
+CDblConv::initFloat()
+{
+	kern_ = selToDbl<float>( &vec_ );
+	return true;
+}
+
+const char *
+CDblConv::getKernelName() const
+{
+	if ( ! kern_ )
+		return "none";
+	return vec_ ? "avx2" : "scalar";
+}
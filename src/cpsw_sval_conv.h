@@ -0,0 +1,109 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_SVAL_CONV_H
+#define CPSW_SVAL_CONV_H
+
+#include <stdint.h>
+
+/* Array conversion between the representation of an integer
+ * entry in the device and the user's buffer.
+ *
+ * The ScalVal adapters used to transform every element with a
+ * sequence of byte-wise operations (swap, shift, sign-extension,
+ * truncation). CIntConv selects a kernel once per call which
+ * does all of these in a single pass over the array; kernels
+ * exist for all combinations of element sizes up to 8 octets.
+ * Word-swapped entries and fields spanning more than 8 octets
+ * are not supported ('init' returns false) and must be handled
+ * by the caller.
+ *
+ * Source and destination may overlap if they start at the same
+ * address or if the destination starts below the source.
+ */
+class CIntConv {
+public:
+	typedef void (*Kernel)(const CIntConv *c, uint8_t *dst, const uint8_t *src, unsigned nelms);
+
+	unsigned sbytes_;
+	unsigned dbytes_;
+	unsigned shift_;
+	uint64_t msk_;     // applied after shifting right (get only)
+	uint64_t sgn_;     // sign bit to extend; 0 if none
+
+private:
+	Kernel   kern_;
+	bool     vec_;
+
+public:
+	CIntConv()
+	: kern_( 0 ),
+	  vec_ ( false )
+	{
+	}
+
+	// device -> user; 'sbytes' device octets (including the 'lsb' shift)
+	// in foreign byte order if 'swap' to 'dbytes' host-order octets
+	bool initGet(unsigned sbytes, unsigned dbytes, unsigned sizeBits, unsigned lsb, bool isSigned, bool swap);
+
+	// user -> device; 'sbytes' host-order octets to 'dbytes' device
+	// octets (including the 'lsb' shift) in foreign byte order if 'swap'
+	bool initSet(unsigned sbytes, unsigned dbytes, unsigned lsb, bool isSigned, bool swap);
+
+	void operator()(uint8_t *dst, const uint8_t *src, unsigned nelms) const
+	{
+		kern_( this, dst, src, nelms );
+	}
+
+	// name of the instruction set used by the selected kernel
+	const char *getKernelName() const;
+
+	// use vector kernels if the CPU supports them (default: true);
+	// affects subsequent 'init' calls (also of CDblConv). Mostly for testing.
+	static void setVectorEnabled(bool enabled);
+};
+
+/* Array conversion of host-order integers (as produced by
+ * CIntConv) or single-precision floats to double.
+ *
+ * The source may occupy the tail of the destination array,
+ * i.e., 'src' may equal 'dst + nelms' minus the size of the
+ * source array. This lets the device data be read straight into
+ * the user's buffer and then be expanded without a copy.
+ */
+class CDblConv {
+public:
+	typedef void (*Kernel)(double *dst, const uint8_t *src, unsigned nelms);
+
+private:
+	Kernel   kern_;
+	bool     vec_;
+
+public:
+	CDblConv()
+	: kern_( 0 ),
+	  vec_ ( false )
+	{
+	}
+
+	// integers of 'sbytes' (1, 2, 4 or 8) octets
+	bool initInt(unsigned sbytes, bool isSigned);
+
+	// IEEE-754 single precision
+	bool initFloat();
+
+	void operator()(double *dst, const uint8_t *src, unsigned nelms) const
+	{
+		kern_( dst, src, nelms );
+	}
+
+	const char *getKernelName() const;
+};
+
+#endif
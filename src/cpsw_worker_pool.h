@@ -0,0 +1,92 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#ifndef CPSW_WORKER_POOL_H
+#define CPSW_WORKER_POOL_H
+
+#include <cpsw_api_user.h>
+#include <cpsw_error.h>
+#include <cpsw_mutex.h>
+#include <cpsw_compat.h>
+
+#include <vector>
+#include <map>
+
+/* A process-wide pool of worker threads (I/O engines, RSSI
+ * reactors) which are shared by many clients.
+ *
+ * 'T' must be constructible from a thread priority and provide
+ * 'threadStart()' and 'getLoad()'. The pool only holds weak
+ * references; a worker goes away with its last client.
+ *
+ * Workers are kept in separate pools per thread priority so
+ * that a client never ends up being served at a priority other
+ * than the one it asked for.
+ */
+template <typename T>
+class CWorkerPool {
+private:
+	typedef std::vector< cpsw::weak_ptr<T> > Slots;
+	typedef std::map<int, Slots>             Pools;
+
+	CMtx  mtx_;
+	Pools pools_;
+
+	CWorkerPool(const CWorkerPool &);
+	CWorkerPool & operator=(const CWorkerPool &);
+
+public:
+	CWorkerPool(const char *name)
+	: mtx_( name )
+	{
+	}
+
+	// obtain the least busy worker of priority 'prio' from a
+	// pool of (up to) 'poolSize'; an idle slot is filled with a
+	// new worker. 'claim' (if any) is executed on the selected
+	// worker before the pool is unlocked, i.e., it may update
+	// the load seen by the next caller.
+	shared_ptr<T> get(unsigned poolSize, int prio, void (T::*claim)() = 0)
+	{
+	CMtx::lg      guard( &mtx_ );
+	Slots        &slots = pools_[ prio ];
+	shared_ptr<T> rval, w;
+	unsigned      i;
+
+		if ( 0 == poolSize ) {
+			throw InvalidArgError("CWorkerPool::get: pool size must be > 0");
+		}
+
+		if ( slots.size() < poolSize ) {
+			slots.resize( poolSize );
+		}
+
+		for ( i = 0; i < poolSize; i++ ) {
+			if ( ! (w = slots[i].lock()) ) {
+				// an idle slot beats any running worker
+				w = shared_ptr<T>( new T( prio ) );
+				w->threadStart();
+				slots[i] = w;
+				rval = w;
+				break;
+			}
+			if ( ! rval || w->getLoad() < rval->getLoad() ) {
+				rval = w;
+			}
+		}
+
+		if ( claim ) {
+			((*rval).*claim)();
+		}
+
+		return rval;
+	}
+};
+
+#endif
@@ -236,6 +236,8 @@ namespace YAML {
 					rhs = POSTED;
 				else if (str.compare( "SYNCHRONOUS" ) == 0 )
 					rhs = SYNCHRONOUS;
+				else if (str.compare( "PIPELINED" ) == 0 )
+					rhs = PIPELINED;
 				else
 					return false;
 
@@ -248,6 +250,8 @@ namespace YAML {
 					node = "POSTED";
 				else if ( SYNCHRONOUS == rhs )
 					node = "SYNCHRONOUS";
+				else if ( PIPELINED == rhs )
+					node = "PIPELINED";
 				return node;
 			}
 		};
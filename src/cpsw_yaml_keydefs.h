@@ -29,11 +29,14 @@
 #define YAML_KEY_depack  "depack"
 #define YAML_KEY_description  "description"
 #define YAML_KEY_dynTimeout  "dynTimeout"
+#define YAML_KEY_dynTimeoutMargin  "dynTimeoutMargin"
+#define YAML_KEY_dynTimeoutPercentile  "dynTimeoutPercentile"
 #define YAML_KEY_encoding  "encoding"
 #define YAML_KEY_entry  "entry"
 #define YAML_KEY_enums  "enums"
 #define YAML_KEY_fileName "fileName"
 #define YAML_KEY_instantiate  "instantiate"
+#define YAML_KEY_ioEngineThreads  "ioEngineThreads"
 #define YAML_KEY_ipAddr  "ipAddr"
 #define YAML_KEY_isSigned  "isSigned"
 #define YAML_KEY_ldFragWinSize  "ldFragWinSize"
@@ -42,7 +45,9 @@
 #define YAML_KEY_lsBit  "lsBit"
 #define YAML_KEY_maxCumulativeAcks "maxCumulativeAcks"
 #define YAML_KEY_maxRetransmissions "maxRetransmissions"
+#define YAML_KEY_maxRetransmissionTimeoutUS "maxRetransmissionTimeoutUS"
 #define YAML_KEY_maxSegmentSize "maxSegmentSize"
+#define YAML_KEY_minRetransmissionTimeoutUS "minRetransmissionTimeoutUS"
 #define YAML_KEY_mode  "mode"
 #define YAML_KEY_name  "name"
 #define YAML_KEY_nelms  "nelms"
@@ -51,15 +56,21 @@
 #define YAML_KEY_offset  "offset"
 #define YAML_KEY_outQueueDepth  "outQueueDepth"
 #define YAML_KEY_inpQueueDepth  "inpQueueDepth"
+#define YAML_KEY_lockFreeQueues "lockFreeQueues"
 #define YAML_KEY_pollSecs  "pollSecs"
 #define YAML_KEY_port  "port"
 #define YAML_KEY_protocolVersion  "protocolVersion"
+#define YAML_KEY_reactorThreads  "reactorThreads"
+#define YAML_KEY_readWindow  "readWindow"
 #define YAML_KEY_retryCount  "retryCount"
 #define YAML_KEY_retransmissionTimeoutUS "retransmissionTimeoutUS"
+#define YAML_KEY_rxBatchSize  "rxBatchSize"
 #define YAML_KEY_RSSI  "RSSI"
 #define YAML_KEY_rssiBridge  "rssiBridge"
 #define YAML_KEY_seekable  "seekable"
+#define YAML_KEY_selectiveAck  "selectiveAck"
 #define YAML_KEY_sequence  "sequence"
+#define YAML_KEY_shadowCacheMaxBytes  "shadowCacheMaxBytes"
 #define YAML_KEY_singleInterfaceOnly  "singleInterfaceOnly"
 #define YAML_KEY_size  "size"
 #define YAML_KEY_sizeBits  "sizeBits"
@@ -72,10 +83,12 @@
 #define YAML_KEY_TDESTMux  "TDESTMux"
 #define YAML_KEY_threadPriority "threadPriority"
 #define YAML_KEY_timeoutUS  "timeoutUS"
+#define YAML_KEY_txBatchSize  "txBatchSize"
 #define YAML_KEY_UDP  "UDP"
 #define YAML_KEY_TCP  "TCP"
 #define YAML_KEY_value  "value"
 #define YAML_KEY_virtualChannel  "virtualChannel"
 #define YAML_KEY_wordSwap  "wordSwap"
+#define YAML_KEY_writeWindow  "writeWindow"
 
 #endif
@@ -45,8 +45,8 @@ private:
 	ProtoPort  upstream_;
 	ConnHandler hdlr;
 public:
-	CRssiPort(bool isServer)
-	: CRssi(isServer)
+	CRssiPort(bool isServer, const CRssiConfigParams *config = 0)
+	: CRssi(isServer, DFLT_PRIORITY, 0, config)
 	{
 		StreamStateMonitor::getTheMonitor()->getEventSet()->add((CConnectionStateChangedEventSource*)this, &hdlr);
 	}
@@ -107,9 +107,9 @@ public:
 		return outQ_->getWriteEventSource();
 	}
 
-	static RssiPort create(bool isServer)
+	static RssiPort create(bool isServer, const CRssiConfigParams *config = 0)
 	{
-	CRssiPort *p = new CRssiPort(isServer);
+	CRssiPort *p = new CRssiPort(isServer, config);
 		return RssiPort(p);
 	}
 
@@ -0,0 +1,236 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+// Replaying a CAccessPlan must be indistinguishable from walking
+// the path with a CompositePathIterator.
+
+#include <cpsw_api_builder.h>
+#include <cpsw_address.h>
+#include <cpsw_path.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+
+using std::string;
+
+class TestFailed {
+public:
+	string e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+#define MEMSZ    4096
+#define SUBOFF   0x10
+#define NSUBS    4
+#define SUBSTRD  0x80
+#define NLEAFS   8
+#define NSPARSE  4
+#define SPRSTRD  8
+
+class CountingAIO : public IAsyncIO {
+public:
+	unsigned calls_;
+	unsigned errors_;
+
+	CountingAIO()
+	: calls_ ( 0 ),
+	  errors_( 0 )
+	{
+	}
+
+	virtual void callback(CPSWError *status)
+	{
+		calls_++;
+		if ( status ) {
+			errors_++;
+		}
+	}
+};
+
+static void
+fillMem(MemDev mem)
+{
+uint8_t *p = mem->getBufp();
+unsigned i;
+	for ( i = 0; i < MEMSZ; i++ ) {
+		p[i] = (uint8_t)(i*7 + 3);
+	}
+}
+
+static void
+check(bool ok, const char *nm, const char *msg)
+{
+	if ( ! ok ) {
+		fprintf(stderr, "%s: ", nm);
+		throw TestFailed( msg );
+	}
+}
+
+// compare a plan with the walk; returns whether 'nm' was planned
+static bool
+compare(MemDev mem, Path root, const char *nm, unsigned elsz, bool async)
+{
+Path                 p     = root->findByName( nm );
+unsigned             nelms = p->getNelms();
+unsigned             nbytes= nelms * elsz;
+CAccessPlan          plan;
+uint8_t              bufw[1024], bufp[1024];
+uint8_t              memw[MEMSZ];
+CReadArgs            rargs;
+CWriteArgs           wargs;
+uint64_t             gotw, gotp;
+unsigned             i;
+
+	check( nbytes <= sizeof(bufw), nm, "test buffer too small" );
+
+	if ( ! plan.compile( CompositePathIterator( p ) ) ) {
+		return false;
+	}
+
+	// reads
+	fillMem( mem );
+	memset( bufw, 0xaa, sizeof(bufw) );
+	memset( bufp, 0x55, sizeof(bufp) );
+
+	rargs.nbytes_ = elsz;
+
+	{
+	shared_ptr<CountingAIO> aiow = cpsw::make_shared<CountingAIO>();
+	shared_ptr<CountingAIO> aiop = cpsw::make_shared<CountingAIO>();
+
+		if ( async ) {
+			rargs.aio_ = aiow;
+		}
+		rargs.dst_ = bufw;
+		{
+		CompositePathIterator it( p );
+			gotw = it->c_p_->read( &it, &rargs );
+		}
+
+		if ( async ) {
+			rargs.aio_ = aiop;
+		}
+		rargs.dst_ = bufp;
+		gotp = plan.read( &rargs );
+
+		rargs.aio_.reset();
+
+		check( gotw == gotp,                         nm, "plan read returned a different count" );
+		check( 0 == memcmp( bufw, bufp, nbytes ),    nm, "plan read different data" );
+		check( bufp[nbytes] == 0x55,                 nm, "plan read past the end" );
+		if ( async ) {
+			check( 1 == aiow->calls_,                nm, "walk: expected exactly one callback" );
+			check( aiow->calls_ == aiop->calls_,     nm, "plan executed a different number of callbacks" );
+			check( 0 == aiop->errors_,               nm, "plan reported an error" );
+		}
+	}
+
+	// writes
+	for ( i = 0; i < nbytes; i++ ) {
+		bufw[i] = (uint8_t)~i;
+	}
+	wargs.nbytes_ = elsz;
+	wargs.src_    = bufw;
+
+	fillMem( mem );
+	{
+	CompositePathIterator it( p );
+		gotw = it->c_p_->write( &it, &wargs );
+	}
+	memcpy( memw, mem->getBufp(), MEMSZ );
+
+	fillMem( mem );
+	gotp = plan.write( &wargs );
+
+	check( gotw == gotp,                              nm, "plan write returned a different count" );
+	check( 0 == memcmp( memw, mem->getBufp(), MEMSZ ), nm, "plan wrote different data" );
+
+	return true;
+}
+
+static void
+expect(MemDev mem, Path root, const char *nm, unsigned elsz, bool planned)
+{
+	check( compare( mem, root, nm, elsz, false ) == planned, nm, planned ? "not planned" : "unexpectedly planned" );
+	compare( mem, root, nm, elsz, true );
+}
+
+int
+main(int argc, char **argv)
+{
+MemDev mem = IMemDev::create( "mem", MEMSZ );
+
+try {
+	{
+	MMIODev  hub    = IMMIODev::create ( "hub",    MEMSZ          );
+	MMIODev  sub    = IMMIODev::create ( "sub",    SUBSTRD, LE    );
+	IntField leaf   = IIntField::create( "leaf",   16, false, 0   );
+	IntField sparse = IIntField::create( "sparse", 32, false, 0   );
+	IntField raw    = IIntField::create( "raw",    32, false, 0   );
+	NullDev  nul    = INullDev::create ( "nul",    16             );
+	MMIODev  nulm   = IMMIODev::create ( "nulm",   16             );
+	IntField nulf   = IIntField::create( "nulf",   32, false, 0   );
+
+		// contiguous and cacheable: read/written in one chunk
+		leaf->setCacheable( IField::WT_CACHEABLE );
+
+		sub->addAtAddress( leaf,   0x04, NLEAFS           );
+		sub->addAtAddress( sparse, 0x20, NSPARSE, SPRSTRD );
+		hub->addAtAddress( sub,    SUBOFF, NSUBS, SUBSTRD );
+		hub->addAtAddress( raw,    0x00                   );
+		mem->addAtAddress( hub );
+
+		nulm->addAtAddress( nulf,   0x00                   );
+		nul->addAtAddress ( nulm );
+		hub->addAtAddress( nul,    0x400                  );
+	}
+
+	Path root = IPath::create( mem );
+
+	// nested hubs, scalars and arrays
+	expect( mem, root, "hub/raw",                4, true  );
+	expect( mem, root, "hub/sub[0]/leaf[0]",     2, true  );
+	expect( mem, root, "hub/sub[2]/leaf",        2, true  );
+	expect( mem, root, "hub/sub[3]/leaf[2-6]",   2, true  );
+	expect( mem, root, "hub/sub[1]/sparse",      4, true  );
+	expect( mem, root, "hub/sub[1]/sparse[1-2]", 4, true  );
+
+	// multi-dimensional arrays fall back to the walk
+	expect( mem, root, "hub/sub/leaf[1]",        2, false );
+	expect( mem, root, "hub/sub[1-2]/sparse",    4, false );
+
+	// addresses which don't opt in are never planned
+	expect( mem, root, "hub/nul/nulm/nulf",      4, false );
+
+	// the ScalVal fast path agrees with the memory contents
+	{
+	ScalVal  v = IScalVal::create( root->findByName( "hub/sub[3]/leaf[2-6]" ) );
+	uint16_t got[5];
+	uint8_t *exp = mem->getBufp() + SUBOFF + 3*SUBSTRD + 0x04 + 2*2;
+	unsigned i;
+		fillMem( mem );
+		check( 5 == v->getVal( got, 5 ), "ScalVal", "getVal returned wrong count" );
+		for ( i = 0; i < 5; i++ ) {
+			check( got[i] == (exp[2*i] | (exp[2*i+1] << 8)), "ScalVal", "getVal returned wrong data" );
+		}
+	}
+
+} catch ( CPSWError &e ) {
+	fprintf(stderr, "CPSW Error: %s\n", e.getInfo().c_str());
+	return 1;
+} catch ( TestFailed &e ) {
+	fprintf(stderr, "Test failed: %s\n", e.e_.c_str());
+	return 1;
+}
+
+	fprintf(stderr, "Access plan test PASSED\n");
+	return 0;
+}
@@ -0,0 +1,249 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_api_builder.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <udpsrv_regdefs.h>
+
+#include <cpsw_obj_cnt.h>
+
+#include <vector>
+#include <yaml-cpp/yaml.h>
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+#define NELMS 64
+#define NBITS  2
+
+static void
+checkDeferred(Batch b, unsigned exp, const char *what)
+{
+	if ( b->getNumDeferred() != exp ) {
+		fprintf(stderr, "%s: expected %u deferred accesses, got %u\n", what, exp, b->getNumDeferred());
+		throw TestFailed("unexpected number of deferred accesses");
+	}
+}
+
+static uint64_t
+pipelinedWrites()
+{
+IMetrics::Snapshot snap;
+unsigned           i;
+	IMetrics::snapshot( &snap );
+	for ( i = 0; i < snap.size(); i++ ) {
+		if ( snap[i].source == "SRP" && snap[i].name == "pipelined_writes" ) {
+			return snap[i].value;
+		}
+	}
+	throw TestFailed("SRP metrics not found");
+}
+
+int
+main(int argc, char **argv)
+{
+const char *ip_addr = "127.0.0.1";
+unsigned    port    = 8200;
+unsigned    tdest   = 1;
+int         rval    = 1;
+unsigned    i;
+int         opt;
+unsigned   *u_p;
+
+	while ( (opt = getopt(argc, argv, "p:t:h")) > 0 ) {
+		u_p = 0;
+		switch ( opt ) {
+			case 'p': u_p = &port;  break;
+			case 't': u_p = &tdest; break;
+			case 'h':
+				rval = 0; /* fall thru */
+			default:
+				fprintf(stderr,"usage: %s [-p <port> ] [-t <tdest> ] [-h]\n", argv[0]);
+				return rval;
+		}
+		if ( u_p && (1 != sscanf(optarg, "%i", u_p)) ) {
+			fprintf(stderr,"ERROR: Unable to scan value for option '-%c'\n", opt);
+			return 1;
+		}
+	}
+
+	{
+	NetIODev root;
+	try {
+		{
+		        root   = INetIODev::create("netio", ip_addr);
+		MMIODev mmio   = IMMIODev::create ("mmio",  MEM_SIZE);
+		MMIODev srvm   = IMMIODev::create ("srvm",  REG_ARR_SZ, LE);
+		IntField arr   = IIntField::create("arr",   32, false, 0);
+		IntField raw   = IIntField::create("raw",   32, false, 0);
+		IntField bits  = IIntField::create("bits",   8, false, 4);
+
+		bits->setCacheable( IField::WB_CACHEABLE );
+
+		srvm->addAtAddress( arr,  0,       NELMS    );
+		srvm->addAtAddress( raw,  NELMS*4, NBITS    );
+		srvm->addAtAddress( bits, NELMS*4, NBITS, 4 );
+
+		mmio->addAtAddress( srvm, REGBASE+REG_ARR_OFF );
+
+		ProtoStackBuilder pbldr( IProtoStackBuilder::create() );
+
+		pbldr->setSRPVersion   ( IProtoStackBuilder::SRP_UDP_V3 );
+		pbldr->setUdpPort      (                           port );
+		pbldr->useRssi         (                           true );
+		pbldr->setTDestMuxTDEST(                          tdest );
+		// batched writes stream even to synchronous devices
+		pbldr->setSRPDefaultWriteMode(              SYNCHRONOUS );
+
+		root->addAtAddress( mmio, pbldr );
+		}
+
+		std::vector<ScalVal> elms;
+		std::vector<ScalVal> bitv;
+		for ( i = 0; i < NELMS; i++ ) {
+			char nm[100];
+			sprintf( nm, "mmio/srvm/arr[%u]", i );
+			elms.push_back( IScalVal::create( root->findByName( nm ) ) );
+		}
+		for ( i = 0; i < NBITS; i++ ) {
+			char nm[100];
+			sprintf( nm, "mmio/srvm/bits[%u]", i );
+			bitv.push_back( IScalVal::create( root->findByName( nm ) ) );
+		}
+		ScalVal arr = IScalVal::create( root->findByName("mmio/srvm/arr") );
+		ScalVal raw = IScalVal::create( root->findByName("mmio/srvm/raw") );
+
+		uint64_t all[NELMS], rb[NELMS], bitsrb[NBITS], rawrb[NBITS];
+
+		raw->setVal( (uint64_t)0xffffffff );
+
+		Batch batch = IBatch::create();
+
+		// adjacent writes are merged; bit-fields cannot be
+		for ( i = 0; i < NELMS; i++ ) {
+			batch->setVal( elms[i], (uint64_t)(0xbeef0000 + i) );
+		}
+		checkDeferred( batch, 1, "merged writes" );
+
+		for ( i = 0; i < NBITS; i++ ) {
+			batch->setVal( bitv[i], (uint64_t)(0xa5 + i) );
+		}
+		checkDeferred( batch, 1 + NBITS, "bit-field writes" );
+
+		// must not be merged with the first write as that would
+		// reorder it with the bit-field writes
+		batch->setVal( elms[0], (uint64_t)0xbeef0000 );
+		checkDeferred( batch, 2 + NBITS, "writes in queue order" );
+
+		batch->execute();
+		checkDeferred( batch, 0, "after write execution" );
+		if ( 0 == pipelinedWrites() ) {
+			throw TestFailed("batched writes to a SYNCHRONOUS device were not pipelined");
+		}
+
+		arr->getVal( all, NELMS );
+		raw->getVal( rawrb, NBITS );
+		for ( i = 0; i < NELMS; i++ ) {
+			if ( all[i] != 0xbeef0000 + i ) {
+				fprintf(stderr, "arr[%u] = 0x%" PRIx64 "\n", i, all[i]);
+				throw TestFailed("batched write readback mismatch");
+			}
+		}
+		for ( i = 0; i < NBITS; i++ ) {
+			if ( rawrb[i] != ((0xfffff00f) | ((0xa5 + i) << 4)) ) {
+				fprintf(stderr, "raw[%u] = 0x%" PRIx64 "\n", i, rawrb[i]);
+				throw TestFailed("batched bit-field write mismatch");
+			}
+		}
+
+		// reads are collected in any order and merged on execution
+		memset( rb,     0, sizeof(rb)     );
+		memset( bitsrb, 0, sizeof(bitsrb) );
+		for ( i = NELMS; i > 0; i-- ) {
+			batch->getVal( elms[i-1], &rb[i-1] );
+		}
+		for ( i = 0; i < NBITS; i++ ) {
+			batch->getVal( bitv[i], &bitsrb[i] );
+		}
+		batch->getVal( raw, rawrb, NBITS );
+		checkDeferred( batch, NELMS + NBITS + 1, "deferred reads" );
+
+		batch->execute();
+
+		for ( i = 0; i < NELMS; i++ ) {
+			if ( rb[i] != 0xbeef0000 + i ) {
+				fprintf(stderr, "rb[%u] = 0x%" PRIx64 "\n", i, rb[i]);
+				throw TestFailed("batched read mismatch");
+			}
+		}
+		for ( i = 0; i < NBITS; i++ ) {
+			if ( bitsrb[i] != 0xa5 + i ) {
+				fprintf(stderr, "bits[%u] = 0x%" PRIx64 "\n", i, bitsrb[i]);
+				throw TestFailed("batched bit-field read mismatch");
+			}
+		}
+
+		// mixed batch; writes execute before reads
+		batch->setVal( elms[3], (uint64_t)0x12345678 );
+		batch->getVal( elms[3], &rb[3] );
+		batch->execute();
+		if ( rb[3] != 0x12345678 ) {
+			throw TestFailed("mixed batch: read did not observe write");
+		}
+
+		// configuration dump and load go through batches, too
+		{
+		YAML::Node cnfg;
+		Path       top = IPath::create( root );
+		uint64_t   zero[NELMS];
+
+			arr->getVal( all, NELMS );
+			raw->getVal( rawrb, NBITS );
+			setCPSWVerbosity( "config", 1 );
+			// the dump reads all values in one go
+			if ( top->dumpConfigToYaml( cnfg ) != NELMS + 2*NBITS ) {
+				throw TestFailed("unexpected number of config values dumped");
+			}
+
+			memset( zero, 0, sizeof(zero) );
+			arr->setVal( zero, NELMS );
+			raw->setVal( zero, NBITS );
+
+			if ( top->loadConfigFromYaml( cnfg ) != NELMS + 2*NBITS ) {
+				throw TestFailed("unexpected number of config values loaded");
+			}
+			setCPSWVerbosity( "config", 0 );
+
+			arr->getVal( rb, NELMS );
+			raw->getVal( bitsrb, NBITS );
+			if ( memcmp( rb, all, sizeof(all) ) || memcmp( bitsrb, rawrb, sizeof(rawrb) ) ) {
+				throw TestFailed("config readback mismatch");
+			}
+		}
+
+	} catch ( CPSWError &e ) {
+		fprintf(stderr,"CPSW Error caught: %s\n", e.getInfo().c_str());
+		throw;
+	} catch ( TestFailed &e ) {
+		fprintf(stderr,"TEST FAILED: %s\n", e.e_);
+		throw;
+	}
+	}
+	if ( CpswObjCounter::report(stderr) ) {
+		printf("Leaked Objects!\n");
+		throw TestFailed("leaked objects");
+	}
+	printf("Batch test PASSED\n");
+	return 0;
+}
@@ -0,0 +1,611 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+// End-to-end benchmarks against the 'udpsrv' firmware emulator.
+//
+// For every supported protocol-stack variant we measure
+//  - register read/write latency (percentiles),
+//  - block read/write throughput at several sizes,
+//  - stream throughput
+// and the CPU time (user + system, this process only) spent per MB.
+//
+// Results are written as JSON (machine-readable); a human-readable
+// summary goes to stderr. Unless '-x' is given the emulator is started
+// (and stopped) by this program: one instance serving UDP and a second
+// one ('-t') serving TCP.
+//
+// NOTE: udpsrv paces its stream (one frame per 10ms); stream numbers
+//       are thus mostly useful for the CPU cost per MB.
+
+#include <cpsw_api_builder.h>
+#include <cpsw_proto_mod_depack.h>
+#include <crc32-le-tbl-4.h>
+
+#include <udpsrv_regdefs.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/prctl.h>
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#define BLK_OFF   0x10000 /* keep clear of the pseudo registers at REGBASE */
+#define MAX_BLK   8192    /* w/o RSSI a transaction must fit in a jumbo frame */
+
+#define STRT(chnl) (0x01<<(chnl))
+#define STOP(chnl) (0x10<<(chnl))
+
+class BenchFailed {
+public:
+	std::string e_;
+	BenchFailed(const std::string &e):e_(e) {}
+};
+
+typedef enum Xprt { UDP, TCP } Xprt;
+
+struct SrpVariant {
+	const char                       *name;
+	Xprt                              xprt;
+	unsigned                          port;
+	IProtoStackBuilder::SRPProtoVersion vers;
+	bool                              rssi;
+	int                               tdest;   // < 0: no TDEST demuxer
+	bool                              depack2;
+};
+
+// ports match the udpsrv defaults
+static const SrpVariant srpVariants[] = {
+	{ "udp-srpv1",                    UDP, 8191, IProtoStackBuilder::SRP_UDP_V1, false, -1, false },
+	{ "udp-srpv2",                    UDP, 8192, IProtoStackBuilder::SRP_UDP_V2, false, -1, false },
+	{ "udp-srpv3",                    UDP, 8190, IProtoStackBuilder::SRP_UDP_V3, false, -1, false },
+	{ "udp-rssi-srpv2",               UDP, 8202, IProtoStackBuilder::SRP_UDP_V2, true,  -1, false },
+	{ "udp-rssi-srpv3",               UDP, 8188, IProtoStackBuilder::SRP_UDP_V3, true,  -1, false },
+	{ "udp-rssi-depack-tdest-srpv2",  UDP, 8203, IProtoStackBuilder::SRP_UDP_V2, true,   1, false },
+	{ "udp-rssi-depack2-tdest-srpv3", UDP, 8204, IProtoStackBuilder::SRP_UDP_V3, true,   1, true  },
+	{ "tcp-srpv2",                    TCP, 8192, IProtoStackBuilder::SRP_UDP_V2, false, -1, false },
+	{ "tcp-srpv3",                    TCP, 8190, IProtoStackBuilder::SRP_UDP_V3, false, -1, false },
+};
+
+struct StrmVariant {
+	const char *name;
+	unsigned    port;
+	bool        rssi;
+	bool        depack2;
+};
+
+static const StrmVariant strmVariants[] = {
+	{ "udp-depack-tdest",        8193, false, false },
+	{ "udp-rssi-depack-tdest",   8203, true,  false },
+	{ "udp-rssi-depack2-tdest",  8204, true,  true  },
+};
+
+static const unsigned blkSizes[] = { 64, 512, 2048, MAX_BLK };
+
+struct Opts {
+	const char *ip_addr;
+	const char *filter;
+	unsigned    nLat;
+	unsigned    msPerPoint;
+	unsigned    ioEngine;
+	int         debug;
+};
+
+static uint64_t
+nowUs()
+{
+struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static uint64_t
+tv2usec(struct timeval *a)
+{
+	return (uint64_t)a->tv_sec * 1000000ULL + (uint64_t)a->tv_usec;
+}
+
+static uint64_t
+cpuUs()
+{
+struct rusage r;
+	if ( getrusage( RUSAGE_SELF, &r ) ) {
+		throw BenchFailed("getrusage failed");
+	}
+	return tv2usec( &r.ru_utime ) + tv2usec( &r.ru_stime );
+}
+
+static bool
+selected(const Opts *o, const char *name)
+{
+	return ! o->filter || strstr( name, o->filter );
+}
+
+// Collect results; every entry is one flat JSON object
+class Results {
+private:
+	std::vector<std::string> res_;
+	std::string              cur_;
+	bool                     first_;
+
+public:
+	void begin(const char *variant, const char *test)
+	{
+		cur_   = "{";
+		first_ = true;
+		add( "variant", variant );
+		add( "test",    test    );
+	}
+
+	void add(const char *key, const char *val)
+	{
+		cur_ += first_ ? "\"" : ",\"";
+		cur_ += key;
+		cur_ += "\":\"";
+		for ( ; *val; val++ ) {
+			if ( '"' == *val || '\\' == *val )
+				cur_ += '\\';
+			cur_ += *val;
+		}
+		cur_ += "\"";
+		first_ = false;
+	}
+
+	void add(const char *key, double val)
+	{
+	char buf[100];
+		snprintf( buf, sizeof(buf), "%s\"%s\":%.3f", first_ ? "" : ",", key, val );
+		cur_  += buf;
+		first_ = false;
+	}
+
+	void add(const char *key, uint64_t val)
+	{
+	char buf[100];
+		snprintf( buf, sizeof(buf), "%s\"%s\":%" PRIu64, first_ ? "" : ",", key, val );
+		cur_  += buf;
+		first_ = false;
+	}
+
+	void end()
+	{
+		res_.push_back( cur_ + "}" );
+	}
+
+	void error(const char *variant, const char *test, const std::string &msg)
+	{
+		begin( variant, test );
+		add( "error", msg.c_str() );
+		end();
+		fprintf(stderr, "%-30s %-12s ERROR: %s\n", variant, test, msg.c_str());
+	}
+
+	void dump(FILE *f)
+	{
+	unsigned i;
+		fprintf(f, "{\"benchmark\":\"cpsw_bench\",\"results\":[");
+		for ( i = 0; i < res_.size(); i++ ) {
+			fprintf(f, "%s\n %s", i ? "," : "", res_[i].c_str());
+		}
+		fprintf(f, "\n]}\n");
+	}
+};
+
+// Start/stop an emulator instance
+class Emulator {
+private:
+	pid_t pid_;
+
+public:
+	Emulator()
+	: pid_( -1 )
+	{
+	}
+
+	void start(const char *path, bool tcp, int debug)
+	{
+	int fd;
+		if ( (pid_ = fork()) < 0 ) {
+			throw BenchFailed("fork failed");
+		}
+		if ( 0 == pid_ ) {
+			// don't leave the emulator behind if we crash
+			prctl( PR_SET_PDEATHSIG, SIGINT );
+			if ( ! debug && (fd = open( "/dev/null", O_WRONLY )) >= 0 ) {
+				dup2( fd, 1 );
+				dup2( fd, 2 );
+				close( fd );
+			}
+			if ( tcp ) {
+				execl( path, path, "-S0", "-L0", "-t", (char*)0 );
+			} else {
+				execl( path, path, "-S0", "-L0", (char*)0 );
+			}
+			_exit( 127 );
+		}
+	}
+
+	void stop()
+	{
+		if ( pid_ > 0 ) {
+			kill( pid_, SIGINT );
+			waitpid( pid_, 0, 0 );
+			pid_ = -1;
+		}
+	}
+
+	~Emulator()
+	{
+		stop();
+	}
+};
+
+static Hub
+buildSrpStack(const Opts *o, const SrpVariant *v)
+{
+NetIODev          root  = INetIODev::create("fpga", o->ip_addr);
+MMIODev           mmio  = IMMIODev::create ("mmio", MEM_SIZE);
+ProtoStackBuilder pbldr( IProtoStackBuilder::create() );
+
+	mmio->addAtAddress( IIntField::create("scratch", 32), REGBASE + REG_SCR_OFF );
+	mmio->addAtAddress( IIntField::create("mem",     32), BLK_OFF, (MEM_SIZE - BLK_OFF)/4 );
+
+	pbldr->setSRPVersion     ( v->vers );
+	pbldr->setSRPTimeoutUS   ( 1000000 );
+	pbldr->setSRPRetryCount  (       4 );
+	if ( TCP == v->xprt ) {
+		pbldr->setTcpPort    ( v->port );
+		pbldr->setTcpIoEngineThreads( o->ioEngine );
+	} else {
+		pbldr->setUdpPort    ( v->port );
+		pbldr->setUdpIoEngineThreads( o->ioEngine );
+	}
+	pbldr->useRssi           ( v->rssi );
+	if ( v->tdest >= 0 ) {
+		pbldr->setTDestMuxTDEST( v->tdest );
+	}
+	if ( v->depack2 ) {
+		pbldr->useDepack( true );
+		pbldr->setDepackVersion( IProtoStackBuilder::DEPACKETIZER_V2 );
+	}
+
+	root->addAtAddress( mmio, pbldr );
+
+	return root;
+}
+
+static void
+benchLatency(const Opts *o, Results *r, const SrpVariant *v, ScalVal reg, bool wr)
+{
+std::vector<uint64_t> lat( o->nLat );
+uint64_t              then, cpu;
+uint32_t              val = 0;
+unsigned              i;
+
+	cpu = cpuUs();
+	for ( i = 0; i < o->nLat; i++ ) {
+		then = nowUs();
+		if ( wr ) {
+			val = i;
+			reg->setVal( &val, 1 );
+		} else {
+			reg->getVal( &val, 1 );
+		}
+		lat[i] = nowUs() - then;
+	}
+	cpu = cpuUs() - cpu;
+
+	std::sort( lat.begin(), lat.end() );
+
+	r->begin( v->name, wr ? "reg_write" : "reg_read" );
+	r->add( "ops",        (uint64_t)o->nLat );
+	r->add( "p50_us",     lat[ o->nLat * 50 / 100 ] );
+	r->add( "p90_us",     lat[ o->nLat * 90 / 100 ] );
+	r->add( "p99_us",     lat[ o->nLat * 99 / 100 ] );
+	r->add( "max_us",     lat[ o->nLat - 1        ] );
+	r->add( "cpu_us_per_op", (double)cpu / (double)o->nLat );
+	r->end();
+
+	fprintf(stderr, "%-30s %-12s p50 %6" PRIu64 "us  p90 %6" PRIu64 "us  p99 %6" PRIu64 "us  max %6" PRIu64 "us\n",
+		v->name, wr ? "reg_write" : "reg_read",
+		lat[ o->nLat * 50 / 100 ], lat[ o->nLat * 90 / 100 ], lat[ o->nLat * 99 / 100 ], lat[ o->nLat - 1 ]);
+}
+
+static void
+benchBlock(const Opts *o, Results *r, const SrpVariant *v, ScalVal mem, unsigned size, bool wr)
+{
+static uint32_t buf[MAX_BLK/4];
+unsigned        nelms = size / 4;
+IndexRange      rng( 0, nelms - 1 );
+uint64_t        start, end, cpu, ops, tot;
+double          mb;
+unsigned        i;
+
+	for ( i = 0; i < nelms; i++ ) {
+		buf[i] = i;
+	}
+
+	ops   = 0;
+	cpu   = cpuUs();
+	start = nowUs();
+	end   = start + (uint64_t)o->msPerPoint * 1000;
+	do {
+		if ( wr ) {
+			mem->setVal( buf, nelms, &rng );
+		} else {
+			mem->getVal( buf, nelms, &rng );
+		}
+		ops++;
+	} while ( nowUs() < end );
+	tot = nowUs() - start;
+	cpu = cpuUs() - cpu;
+
+	mb  = (double)(ops * size) / 1.0E6;
+
+	r->begin( v->name, wr ? "block_write" : "block_read" );
+	r->add( "size",          (uint64_t)size );
+	r->add( "ops",           ops );
+	r->add( "MBps",          mb / ((double)tot / 1.0E6) );
+	r->add( "cpu_us_per_MB", (double)cpu / mb );
+	r->end();
+
+	fprintf(stderr, "%-30s %-12s %6u bytes: %9.3f MB/s  %10.1f cpu us/MB\n",
+		v->name, wr ? "block_write" : "block_read", size, mb / ((double)tot / 1.0E6), (double)cpu / mb);
+}
+
+static void
+benchSrp(const Opts *o, Results *r, const SrpVariant *v)
+{
+Hub      root( buildSrpStack( o, v ) );
+ScalVal  reg( IScalVal::create( root->findByName( "mmio/scratch" ) ) );
+ScalVal  mem( IScalVal::create( root->findByName( "mmio/mem"     ) ) );
+unsigned i;
+
+	// warm up (also makes sure the peer is there)
+	for ( i = 0; i < 10; i++ ) {
+		uint32_t val;
+		reg->getVal( &val, 1 );
+	}
+
+	benchLatency( o, r, v, reg, false );
+	benchLatency( o, r, v, reg, true  );
+
+	for ( i = 0; i < sizeof(blkSizes)/sizeof(blkSizes[0]); i++ ) {
+		benchBlock( o, r, v, mem, blkSizes[i], false );
+		benchBlock( o, r, v, mem, blkSizes[i], true  );
+	}
+}
+
+// start/stop message understood by the udpsrv streamer
+static void
+sendCtrl(Stream strm, uint8_t m, bool depack2)
+{
+uint8_t  buf[1500];
+uint32_t crc;
+unsigned i, endi;
+
+	if ( depack2 ) {
+		CDepack2Header hdr;
+		endi = hdr.getSize();
+		hdr.insert( buf, sizeof(buf) );
+	} else {
+		CAxisFrameHeader hdr;
+		endi = hdr.getSize();
+		hdr.insert( buf, sizeof(buf) );
+	}
+
+	buf[ endi ] = m;
+	for ( i = 1; i < 100; i++ )
+		buf[ endi + i ] = i;
+	crc   = crc32_le_t4( -1, buf + endi, 100 ) ^ -1;
+	endi += 100;
+	for ( i = 0; i < sizeof(crc); i++ ) {
+		buf[ endi + i ] = crc & 0xff;
+		crc >>= 8;
+	}
+	endi += i;
+	if ( depack2 ) {
+		endi += CDepack2Header::appendTail( buf, endi, true );
+		crc   = crc32_le_t4( -1, buf, endi - sizeof(crc) );
+		CDepack2Header::insertCrc( buf + endi - CDepack2Header::getTailSize(), ~crc );
+	}
+	strm->write( buf, endi );
+}
+
+static void
+benchStream(const Opts *o, Results *r, const StrmVariant *v)
+{
+NetIODev          root  = INetIODev::create("fpga", o->ip_addr);
+Field             data  = IField::create("data");
+ProtoStackBuilder bldr( IProtoStackBuilder::create() );
+uint8_t           buf[100000];
+uint64_t          start, end, now, cpu, frames, octets, lastStrt;
+int64_t           got;
+double            mb, secs;
+
+	bldr->setSRPVersion   ( IProtoStackBuilder::SRP_UDP_NONE );
+	bldr->setUdpPort      (                          v->port );
+	// udpsrv sends all fragments of a frame back-to-back
+	bldr->setUdpOutQueueDepth(                            40 );
+	bldr->setUdpIoEngineThreads(                   o->ioEngine );
+	bldr->useRssi         (                          v->rssi );
+	if ( v->depack2 ) {
+		bldr->setDepackVersion( IProtoStackBuilder::DEPACKETIZER_V2 );
+	}
+	bldr->setTDestMuxTDEST(                                0 );
+
+	root->addAtAddress( data, bldr );
+
+	Stream strm( IStream::create( root->findByName( "data" ) ) );
+
+	frames   = 0;
+	octets   = 0;
+	cpu      = cpuUs();
+	start    = nowUs();
+	end      = start + (uint64_t)o->msPerPoint * 1000 * 4;
+	lastStrt = 0;
+	while ( (now = nowUs()) < end ) {
+		// the start message may be lost (UDP)
+		if ( 0 == frames && now - lastStrt > 200000 ) {
+			sendCtrl( strm, STRT(0), v->depack2 );
+			lastStrt = now;
+		}
+		got = strm->read( buf, sizeof(buf), CTimeout( 100000 ) );
+		if ( got > 0 ) {
+			frames++;
+			octets += got;
+		}
+	}
+	secs = (double)(nowUs() - start) / 1.0E6;
+	cpu  = cpuUs() - cpu;
+	sendCtrl( strm, STOP(0), v->depack2 );
+
+	if ( 0 == frames ) {
+		throw BenchFailed("no frames received");
+	}
+
+	mb = (double)octets / 1.0E6;
+
+	r->begin( v->name, "stream" );
+	r->add( "frames",        frames );
+	r->add( "octets",        octets );
+	r->add( "frames_per_s",  (double)frames / secs );
+	r->add( "MBps",          mb / secs );
+	r->add( "cpu_us_per_MB", (double)cpu / mb );
+	r->end();
+
+	fprintf(stderr, "%-30s %-12s %8.1f frames/s  %9.3f MB/s  %10.1f cpu us/MB\n",
+		v->name, "stream", (double)frames / secs, mb / secs, (double)cpu / mb);
+}
+
+static void usage(const char *nm)
+{
+	fprintf(stderr,"Usage: %s [-h] [-a <ip_addr>] [-u <udpsrv_path> | -x] [-o <json_file>] [-v <variant_substring>] [-n <latency_ops>] [-T <ms_per_point>] [-E <io_engine_threads>] [-d]\n", nm);
+	fprintf(stderr,"       -u udpsrv : emulator to start (default: 'udpsrv' next to this program)\n");
+	fprintf(stderr,"       -x        : do not start the emulator; use a running one\n");
+	fprintf(stderr,"       -o file   : write JSON results to 'file' (default: stdout)\n");
+	fprintf(stderr,"       -v substr : only run variants whose name contains 'substr'\n");
+	fprintf(stderr,"       -n ops    : number of register accesses per latency point (default 2000)\n");
+	fprintf(stderr,"       -T ms     : duration of each throughput point (default 500)\n");
+	fprintf(stderr,"       -E n      : serve UDP/TCP sockets from a pool of 'n' I/O engine threads (default 0)\n");
+}
+
+int
+main(int argc, char **argv)
+{
+Opts         o;
+Results      res;
+Emulator     udpSrv, tcpSrv;
+std::string  srvPath;
+const char  *outFile = 0;
+bool         spawn   = true;
+unsigned    *u_p;
+unsigned     i;
+int          opt;
+FILE        *f;
+
+	o.ip_addr    = "127.0.0.1";
+	o.filter     = 0;
+	o.nLat       = 2000;
+	o.msPerPoint = 500;
+	o.ioEngine   = 0;
+	o.debug      = 0;
+
+	srvPath = argv[0];
+	srvPath = srvPath.substr( 0, srvPath.find_last_of( '/' ) + 1 ) + "udpsrv";
+
+	while ( (opt = getopt(argc, argv, "a:u:xo:v:n:T:E:dh")) > 0 ) {
+		u_p = 0;
+		switch ( opt ) {
+			case 'a': o.ip_addr = optarg;     break;
+			case 'u': srvPath   = optarg;     break;
+			case 'x': spawn     = false;      break;
+			case 'o': outFile   = optarg;     break;
+			case 'v': o.filter  = optarg;     break;
+			case 'n': u_p       = &o.nLat;    break;
+			case 'T': u_p       = &o.msPerPoint; break;
+			case 'E': u_p       = &o.ioEngine;   break;
+			case 'd': o.debug++;              break;
+			case 'h': usage( argv[0] );       return 0;
+			default:  usage( argv[0] );       return 1;
+		}
+		if ( u_p && 1 != sscanf(optarg, "%i", u_p) ) {
+			fprintf(stderr,"Unable to scan argument to option '-%c'\n", opt);
+			return 1;
+		}
+	}
+
+	if ( o.nLat < 1 ) {
+		fprintf(stderr,"-n <latency_ops> must be > 0\n");
+		return 1;
+	}
+
+	setCPSWVerbosity( "rssi", 0 );
+
+	if ( spawn ) {
+		if ( access( srvPath.c_str(), X_OK ) ) {
+			fprintf(stderr,"Emulator '%s' not found (use -u or -x)\n", srvPath.c_str());
+			return 1;
+		}
+		udpSrv.start( srvPath.c_str(), false, o.debug );
+		tcpSrv.start( srvPath.c_str(), true,  o.debug );
+		sleep( 1 );
+	}
+
+	for ( i = 0; i < sizeof(srpVariants)/sizeof(srpVariants[0]); i++ ) {
+		if ( ! selected( &o, srpVariants[i].name ) )
+			continue;
+		try {
+			benchSrp( &o, &res, &srpVariants[i] );
+		} catch ( CPSWError &e ) {
+			res.error( srpVariants[i].name, "srp", e.getInfo() );
+		} catch ( BenchFailed &e ) {
+			res.error( srpVariants[i].name, "srp", e.e_ );
+		}
+	}
+
+	for ( i = 0; i < sizeof(strmVariants)/sizeof(strmVariants[0]); i++ ) {
+		if ( ! selected( &o, strmVariants[i].name ) )
+			continue;
+		try {
+			benchStream( &o, &res, &strmVariants[i] );
+		} catch ( CPSWError &e ) {
+			res.error( strmVariants[i].name, "stream", e.getInfo() );
+		} catch ( BenchFailed &e ) {
+			res.error( strmVariants[i].name, "stream", e.e_ );
+		}
+	}
+
+	udpSrv.stop();
+	tcpSrv.stop();
+
+	if ( outFile ) {
+		if ( ! (f = fopen( outFile, "w" )) ) {
+			perror("unable to open output file");
+			return 1;
+		}
+		res.dump( f );
+		fclose( f );
+	} else {
+		res.dump( stdout );
+	}
+
+	return 0;
+}
@@ -339,6 +339,58 @@ try {
 		throw TestFailed("insert/extract (offset 55, buf NULL) FAILED");
 	}
 
+	// buffers carved out of an application-supplied memory region
+	{
+	static uint8_t region[4*1000 + 7];
+	BufPool        pool( IBufPool::create( region, sizeof(region), 1000 ) );
+	Buf            pb[5];
+	unsigned       nb = IBuf::numBufsInUse();
+
+		if ( pool->getNumSlots() != 4 || pool->getNumFree() != 4 || pool->getSlotSize() != 1000 ) {
+			throw TestFailed("buffer pool geometry wrong");
+		}
+		for ( i = 0; i < 5; i++ ) {
+			pb[i] = pool->getBuf();
+		}
+		if ( pb[4] || pool->getNumFree() != 0 ) {
+			throw TestFailed("exhausted buffer pool should return NULL");
+		}
+		for ( i = 0; i < 4; i++ ) {
+			if (    pb[i]->getCapacity() != 1000
+			     || pb[i]->getHeadroom() != 0
+			     || ! pool->contains( pb[i]->getPayload() ) ) {
+				throw TestFailed("pool buffer not located in memory region");
+			}
+		}
+		if ( pool->contains( rawmemi ) ) {
+			throw TestFailed("pool claims foreign memory");
+		}
+		if ( IBuf::numBufsInUse() != nb ) {
+			throw TestFailed("pool buffers should not be accounted as regular buffers");
+		}
+		ch0 = IBufChain::create();
+		ch0->addAtTail( pb[1] );
+		pb[1].reset();
+		pb[2].reset();
+		if ( pool->getNumFree() != 1 ) {
+			throw TestFailed("buffer not returned to pool");
+		}
+		ch0.reset();
+		if ( pool->getNumFree() != 2 ) {
+			throw TestFailed("chained buffer not returned to pool");
+		}
+		pb[0].reset();
+		pb[3].reset();
+		if ( pool->getNumFree() != 4 ) {
+			throw TestFailed("buffer pool leaks slots");
+		}
+		try {
+			IBufPool::create( region, 10, 1000 );
+			throw TestFailed("region smaller than a slot should be rejected");
+		} catch ( InvalidArgError &e ) {
+		}
+	}
+
 } catch ( CPSWError &e ) {
 	fprintf(stderr,"ERROR: %s\n", e.getInfo().c_str());
 	throw;
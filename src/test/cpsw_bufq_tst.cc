@@ -0,0 +1,168 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <cpsw_api_user.h>
+#include <cpsw_error.h>
+
+#include <cpsw_buf.h>
+
+#define DEPTH     16
+#define NPROD      3
+#define NCONS      2
+#define NPERPROD 20000
+#define BATCH      8
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+struct Ctxt {
+	BufQueue  q;
+	unsigned  id;
+	uint64_t  sum;
+	unsigned  cnt;
+	pthread_t tid;
+};
+
+static void *
+producer(void *arg)
+{
+Ctxt     *c = (Ctxt*)arg;
+BufChain  bcs[BATCH];
+unsigned  i, n, k, got;
+uint32_t  v;
+
+	for ( i = 0; i < NPERPROD; i += got ) {
+		n = NPERPROD - i < BATCH ? NPERPROD - i : BATCH;
+		for ( k = 0; k < n; k++ ) {
+			v        = c->id * NPERPROD + i + k;
+			bcs[k]   = IBufChain::create();
+			bcs[k]->insert( &v, 0, sizeof(v) );
+		}
+		if ( c->id & 1 ) {
+			got = c->q->pushN( bcs, n, NULL );
+		} else {
+			got = c->q->push( bcs[0], NULL ) ? 1 : 0;
+		}
+		for ( k = 0; k < n; k++ ) {
+			bcs[k].reset();
+		}
+	}
+	return 0;
+}
+
+static void *
+consumer(void *arg)
+{
+Ctxt     *c = (Ctxt*)arg;
+BufChain  bcs[BATCH];
+CTimeout  tmo;
+CTimeout  rel( 500000 );
+unsigned  k, got;
+uint32_t  v;
+
+	while ( 1 ) {
+		tmo = c->q->getAbsTimeoutPop( &rel );
+		if ( 0 == (got = c->q->popN( bcs, (c->id & 1) ? BATCH : 1, &tmo )) ) {
+			break;
+		}
+		for ( k = 0; k < got; k++ ) {
+			bcs[k]->extract( &v, 0, sizeof(v) );
+			c->sum += v;
+			c->cnt++;
+			bcs[k].reset();
+		}
+	}
+	return 0;
+}
+
+static void
+testQueue(bool lockFree)
+{
+BufQueue q( IBufQueue::create( DEPTH, lockFree ) );
+Ctxt     prod[NPROD];
+Ctxt     cons[NCONS];
+unsigned i, cnt;
+uint64_t sum, n;
+BufChain bcs[DEPTH + 1];
+CTimeout tmo;
+CTimeout rel( 1000 );
+
+	// timeouts on empty and full queues
+	tmo = q->getAbsTimeoutPop( &rel );
+	if ( 0 != q->popN( bcs, DEPTH, &tmo ) || ! q->isEmpty() ) {
+		throw TestFailed("popN from empty queue should time out");
+	}
+	for ( i = 0; i <= DEPTH; i++ ) {
+		bcs[i] = IBufChain::create();
+	}
+	if ( DEPTH != q->pushN( bcs, DEPTH + 1, NULL ) || ! q->isFull() ) {
+		throw TestFailed("pushN should stop when the queue is full");
+	}
+	tmo = q->getAbsTimeoutPush( &rel );
+	if ( 0 != q->pushN( bcs + DEPTH, 1, &tmo ) ) {
+		throw TestFailed("pushN to full queue should time out");
+	}
+	if ( DEPTH != q->popN( bcs, DEPTH + 1, NULL ) || ! q->isEmpty() ) {
+		throw TestFailed("popN should drain the queue");
+	}
+
+	// many producers, many consumers
+	for ( i = 0; i < NCONS; i++ ) {
+		cons[i].q   = q;
+		cons[i].id  = i;
+		cons[i].sum = 0;
+		cons[i].cnt = 0;
+		if ( pthread_create( &cons[i].tid, 0, consumer, &cons[i] ) ) {
+			throw TestFailed("pthread_create failed");
+		}
+	}
+	for ( i = 0; i < NPROD; i++ ) {
+		prod[i].q   = q;
+		prod[i].id  = i;
+		if ( pthread_create( &prod[i].tid, 0, producer, &prod[i] ) ) {
+			throw TestFailed("pthread_create failed");
+		}
+	}
+	for ( i = 0; i < NPROD; i++ ) {
+		pthread_join( prod[i].tid, 0 );
+	}
+	sum = 0;
+	cnt = 0;
+	for ( i = 0; i < NCONS; i++ ) {
+		pthread_join( cons[i].tid, 0 );
+		sum += cons[i].sum;
+		cnt += cons[i].cnt;
+	}
+
+	n = NPROD * NPERPROD;
+	if ( cnt != n || sum != n * (n - 1) / 2 ) {
+		fprintf(stderr, "lockFree %d: got %u elements (sum %llu)\n", lockFree, cnt, (unsigned long long)sum);
+		throw TestFailed("elements lost or duplicated");
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	try {
+		testQueue( false );
+		testQueue( true  );
+	} catch ( TestFailed &e ) {
+		fprintf(stderr, "TEST FAILED: %s\n", e.e_);
+		return 1;
+	}
+	printf("Buffer queue test PASSED\n");
+	return 0;
+}
@@ -0,0 +1,177 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_crc32_le.h>
+#include <cpsw_error.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define MAXLEN 4096
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+static void usage(const char *nm)
+{
+	fprintf(stderr,"Usage: %s [-h] [-b <MB>]\n", nm);
+	fprintf(stderr,"       -h      : this message\n");
+	fprintf(stderr,"       -b <MB> : benchmark the implementations; process <MB> megabytes per\n");
+	fprintf(stderr,"                 buffer size\n");
+}
+
+static void
+check(uint32_t expected, uint32_t got, const char *what)
+{
+	if ( expected != got ) {
+		fprintf(stderr, "%s: expected 0x%08x, got 0x%08x\n", what, expected, got);
+		throw TestFailed("CRC mismatch");
+	}
+}
+
+static void
+testImpls(CCpswCrc32LE::Impl accel)
+{
+uint8_t         buf[MAXLEN + 16];
+unsigned        i, off, len;
+uint32_t        ref, seed;
+CCpswCrc32LE    crc32;
+const char     *chk = "123456789";
+
+	check( 0xcbf43926, ~CCpswCrc32LE::bytewise( ~0, (const uint8_t*)chk, strlen(chk) ), "bytewise check value" );
+
+	for ( i = 0; i < sizeof(buf); i++ ) {
+		buf[i] = random();
+	}
+
+	for ( i = 0; i < 2000; i++ ) {
+		// cover all short lengths and misalignments, then random ones
+		len  = i < 300 ? i : random() % MAXLEN;
+		off  = random() % 16;
+		seed = random();
+		ref  = CCpswCrc32LE::bytewise( seed, buf + off, len );
+		check( ref, CCpswCrc32LE::slice8( seed, buf + off, len ), "slice8" );
+		if ( accel ) {
+			check( ref, accel( seed, buf + off, len ), "accelerated" );
+		}
+		check( ref, crc32( seed, buf + off, len ), "operator()" );
+	}
+}
+
+static void
+testChain()
+{
+uint8_t       buf[MAXLEN];
+BufChain      bc = IBufChain::create();
+Buf           b;
+unsigned      i, pos, l;
+unsigned long off, len;
+CCpswCrc32LE  crc32;
+
+	for ( i = 0; i < sizeof(buf); i++ ) {
+		buf[i] = random();
+	}
+
+	for ( pos = 0; pos < sizeof(buf); pos += l ) {
+		l = 1 + random() % 700;
+		if ( l > sizeof(buf) - pos ) {
+			l = sizeof(buf) - pos;
+		}
+		b = bc->createAtTail( IBuf::CAPA_ETH_BIG );
+		b->setSize( l );
+		memcpy( b->getPayload(), buf + pos, l );
+	}
+
+	for ( i = 0; i < 200; i++ ) {
+		off = random() % sizeof(buf);
+		len = random() % (sizeof(buf) - off + 1);
+		check( CCpswCrc32LE::bytewise( ~0, buf + off, len ), crc32( ~0, bc->getHead(), off, len ), "chain" );
+	}
+
+	// chain shorter than requested
+	check( CCpswCrc32LE::bytewise( ~0, buf + 10, sizeof(buf) - 10 ), crc32( ~0, bc->getHead(), 10, 2*sizeof(buf) ), "short chain" );
+}
+
+static double
+bench(CCpswCrc32LE::Impl impl, unsigned len, unsigned mb)
+{
+uint8_t         *buf = (uint8_t*)malloc( len );
+unsigned long    n, i;
+struct timespec  then, now;
+volatile uint32_t crc = 0;
+double           secs;
+
+	memset( buf, 0x5a, len );
+	n = ((unsigned long)mb << 20) / len;
+	clock_gettime( CLOCK_MONOTONIC, &then );
+	for ( i = 0; i < n; i++ ) {
+		crc = impl( crc, buf, len );
+	}
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	free( buf );
+	secs = (double)(now.tv_sec - then.tv_sec) + 1.0E-9*(double)(now.tv_nsec - then.tv_nsec);
+	return (double)n*(double)len/secs/1.0E6;
+}
+
+int
+main(int argc, char **argv)
+{
+int                 opt;
+unsigned            mb = 0;
+unsigned           *u_p;
+CCpswCrc32LE::Impl  accel = CCpswCrc32LE::getAccel();
+static const unsigned lens[] = { 64, 256, 1024, 8192, 65536 };
+unsigned            i;
+
+	while ( (opt = getopt(argc, argv, "hb:")) > 0 ) {
+		u_p = 0;
+		switch ( opt ) {
+			case 'h': usage( argv[0] ); return 0;
+			case 'b': u_p = &mb;       break;
+			default:
+				fprintf(stderr,"Unknown option '%c'\n", opt);
+				usage( argv[0] );
+				return 1;
+		}
+		if ( u_p && 1 != sscanf(optarg, "%i", u_p) ) {
+			fprintf(stderr,"Unable to scan argument to option '-%c'\n", opt);
+			return 1;
+		}
+	}
+
+	printf("Using CRC32 implementation: %s\n", CCpswCrc32LE::getImplName());
+
+	try {
+		testImpls( accel );
+		testChain();
+	} catch ( TestFailed &e ) {
+		fprintf(stderr, "TEST FAILED: %s\n", e.e_);
+		return 1;
+	}
+
+	if ( mb ) {
+		printf("%8s %14s %14s %14s\n", "Size", "bytewise MB/s", "slice8 MB/s", "accel MB/s");
+		for ( i = 0; i < sizeof(lens)/sizeof(lens[0]); i++ ) {
+			printf("%8u %14.1f %14.1f", lens[i], bench( CCpswCrc32LE::bytewise, lens[i], mb ), bench( CCpswCrc32LE::slice8, lens[i], mb ));
+			if ( accel ) {
+				printf(" %14.1f", bench( accel, lens[i], mb ));
+			}
+			printf("\n");
+		}
+	}
+
+	printf("CRC32 test PASSED\n");
+	return 0;
+}
@@ -0,0 +1,240 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <cpsw_api_user.h>
+#include <cpsw_error.h>
+
+#include <cpsw_event.h>
+#include <cpsw_buf.h>
+
+#define NITEMS 20000
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+class FdHandler : public IEventHandler {
+public:
+	unsigned cnt_;
+	short    revents_;
+
+	FdHandler() : cnt_(0), revents_(0) {}
+
+	virtual void handle(CFdEventSource *src)
+	{
+	char c;
+		revents_ = src->getREvents();
+		// consume one byte only; the set must come back for the rest
+		if ( 1 != read( src->getFd(), &c, 1 ) ) {
+			throw TestFailed("unable to read pipe");
+		}
+		cnt_++;
+	}
+};
+
+class QHandler : public IEventHandler {
+public:
+	BufQueue q_;
+	unsigned cnt_;
+
+	QHandler(bool lockFree) : q_( IBufQueue::create( 8, lockFree ) ), cnt_(0) {}
+
+	virtual void handle(IIntEventSource *src)
+	{
+		// one element per dispatch
+		if ( q_->tryPop() ) {
+			cnt_++;
+		}
+	}
+};
+
+static void *
+producer(void *arg)
+{
+QHandler *h = (QHandler*)arg;
+unsigned  i;
+
+	for ( i = 0; i < NITEMS; i++ ) {
+		h->q_->push( IBufChain::create(), NULL );
+	}
+	return 0;
+}
+
+static void *
+sender(void *arg)
+{
+struct timespec t;
+	t.tv_sec  = 0;
+	t.tv_nsec = 10000000;
+	nanosleep( &t, 0 );
+	((CIntEventSource*)arg)->sendEvent( 42 );
+	return 0;
+}
+
+static void
+testFdSource()
+{
+EventSet       evs = IEventSet::createPollable();
+int            fds[2];
+FdHandler      h;
+
+	if ( pipe( fds ) ) {
+		throw TestFailed("pipe failed");
+	}
+	{
+	CFdEventSource src( fds[0], POLLIN );
+
+		evs->add( &src, &h );
+		if ( evs->processEvent( false, NULL ) ) {
+			throw TestFailed("fd source: unexpected event");
+		}
+		if ( 3 != write( fds[1], "abc", 3 ) ) {
+			throw TestFailed("unable to write pipe");
+		}
+		while ( evs->processEvent( false, NULL ) )
+			;
+		if ( 3 != h.cnt_ || ! (h.revents_ & POLLIN) ) {
+			throw TestFailed("fd source: level-triggered events not all dispatched");
+		}
+		evs->del( &src );
+	}
+	close( fds[0] );
+	close( fds[1] );
+
+	// not supported by the default set
+	{
+	EventSet       plain = IEventSet::create();
+	CFdEventSource src( 0, POLLIN );
+		if ( plain->getFd() >= 0 ) {
+			throw TestFailed("default event set should not be pollable");
+		}
+		try {
+			plain->add( &src, &h );
+			throw TestFailed("default event set should reject fd sources");
+		} catch ( InvalidArgError & ) {
+		}
+	}
+}
+
+static void
+testExportedFd()
+{
+EventSet         evs = IEventSet::createPollable();
+CIntEventSource  src;
+CIntEventHandler h;
+struct pollfd    p;
+pthread_t        tid;
+
+	evs->add( &src, &h );
+
+	if ( pthread_create( &tid, 0, sender, &src ) ) {
+		throw TestFailed("pthread_create failed");
+	}
+	p.fd     = evs->getFd();
+	p.events = POLLIN;
+	if ( 1 != poll( &p, 1, 2000 ) ) {
+		throw TestFailed("exported descriptor did not become readable");
+	}
+	pthread_join( tid, 0 );
+	if ( 42 != h.receiveEvent( evs, false, NULL ) ) {
+		throw TestFailed("exported descriptor: event not dispatched");
+	}
+	if ( evs->processEvent( false, NULL ) ) {
+		throw TestFailed("exported descriptor: spurious event");
+	}
+
+	// disabled handlers are skipped until re-enabled
+	h.disable();
+	src.sendEvent( 7 );
+	if ( evs->processEvent( false, NULL ) ) {
+		throw TestFailed("event dispatched to disabled handler");
+	}
+	h.enable();
+	if ( 7 != h.receiveEvent( evs, false, NULL ) ) {
+		throw TestFailed("event lost while handler was disabled");
+	}
+	evs->del( &src );
+}
+
+static void
+testTimeout()
+{
+EventSet         evs = IEventSet::createPollable();
+CIntEventSource  src;
+CIntEventHandler h;
+CTimeout         rel( 50000 );
+CTimeout         tmo, now;
+
+	evs->add( &src, &h );
+	tmo = evs->getAbsTimeout( &rel );
+	if ( evs->processEvent( true, &tmo ) ) {
+		throw TestFailed("timeout: unexpected event");
+	}
+	evs->getAbsTime( &now );
+	if ( now < tmo ) {
+		throw TestFailed("timeout: returned early");
+	}
+	evs->del( &src );
+}
+
+static void
+testQueues()
+{
+EventSet  evs = IEventSet::createPollable();
+QHandler  h0( false ), h1( true );
+pthread_t t0, t1;
+
+	evs->add( h0.q_->getReadEventSource(), &h0 );
+	evs->add( h1.q_->getReadEventSource(), &h1 );
+
+	if ( pthread_create( &t0, 0, producer, &h0 ) || pthread_create( &t1, 0, producer, &h1 ) ) {
+		throw TestFailed("pthread_create failed");
+	}
+
+	while ( h0.cnt_ + h1.cnt_ < 2*NITEMS ) {
+	CTimeout rel( 2000000 );
+	CTimeout tmo = evs->getAbsTimeout( &rel );
+		if ( ! evs->processEvent( true, &tmo ) ) {
+			fprintf(stderr, "got %u + %u elements\n", h0.cnt_, h1.cnt_);
+			throw TestFailed("queues: timeout -- event lost");
+		}
+	}
+
+	pthread_join( t0, 0 );
+	pthread_join( t1, 0 );
+
+	evs->del( h0.q_->getReadEventSource() );
+	evs->del( h1.q_->getReadEventSource() );
+}
+
+int
+main(int argc, char **argv)
+{
+	try {
+		testFdSource();
+		testExportedFd();
+		testTimeout();
+		testQueues();
+	} catch ( TestFailed &e ) {
+		fprintf(stderr, "TEST FAILED: %s\n", e.e_);
+		return 1;
+	} catch ( CPSWError &e ) {
+		fprintf(stderr, "TEST FAILED: %s\n", e.getInfo().c_str());
+		return 1;
+	}
+	printf("Event set test PASSED\n");
+	return 0;
+}
@@ -0,0 +1,329 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_api_builder.h>
+#include <cpsw_metrics.h>
+#include <cpsw_srp_addr.h>
+#include <cpsw_rssi.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <udpsrv_regdefs.h>
+
+#include <cpsw_obj_cnt.h>
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+#define NREADS 100
+
+static const IMetrics::Sample *
+find(const IMetrics::Snapshot &snap, const char *source, const char *name)
+{
+IMetrics::Snapshot::const_iterator it;
+	for ( it = snap.begin(); it != snap.end(); ++it ) {
+		if ( it->source == source && it->name == name )
+			return &(*it);
+	}
+	fprintf(stderr, "metric %s/%s not found\n", source, name);
+	throw TestFailed("metric missing from snapshot");
+}
+
+static void
+testHisto()
+{
+CMetricHistogram h;
+unsigned         i;
+uint64_t         tot;
+
+	h.record( 0 );
+	h.record( 1 );
+	h.record( 3 );
+	h.record( 4 );
+	h.record( (uint64_t)-1 );
+	if ( h.getBucket(0) != 1 || h.getBucket(1) != 1 || h.getBucket(2) != 1 || h.getBucket(3) != 1 ) {
+		throw TestFailed("histogram values recorded in wrong bucket");
+	}
+	if ( h.getBucket( CMetricHistogram::NBUCKETS - 1 ) != 1 ) {
+		throw TestFailed("histogram overflow bucket wrong");
+	}
+	for ( i = 0, tot = 0; i < CMetricHistogram::NBUCKETS; i++ ) {
+		if ( i > 0 && CMetricHistogram::getBucketLimit( i - 1 ) >= CMetricHistogram::getBucketLimit( i ) ) {
+			throw TestFailed("histogram bucket limits not monotonic");
+		}
+		tot += h.getBucket( i );
+	}
+	if ( tot != 5 || h.getCount() != 5 || h.getSum() != (uint64_t)-1 + 8 ) {
+		throw TestFailed("histogram count/sum wrong");
+	}
+	h.reset();
+	if ( h.getCount() || h.getSum() || h.getBucket(0) ) {
+		throw TestFailed("histogram reset failed");
+	}
+}
+
+static void
+feed(DynTimeout *t, uint64_t us, unsigned n)
+{
+struct timespec then, now;
+	then.tv_sec  = 0;
+	then.tv_nsec = 0;
+	now.tv_sec   = us / 1000000;
+	now.tv_nsec  = (us % 1000000) * 1000;
+	while ( n-- > 0 ) {
+		t->update( &now, &then );
+	}
+}
+
+static void
+testRttPercentile()
+{
+CRttHistogram h;
+unsigned      i;
+uint64_t      us;
+
+	// buckets are contiguous and the resolution is better than 25%
+	for ( i = 1; i < CRttHistogram::NBUCKETS - 1; i++ ) {
+		us = CRttHistogram::getLimit( i - 1 );
+		if ( CRttHistogram::getIndex( us ) != i || CRttHistogram::getIndex( us - 1 ) != i - 1 ) {
+			fprintf(stderr, "bucket %u, limit %llu\n", i, (unsigned long long)us);
+			throw TestFailed("RTT histogram buckets not contiguous");
+		}
+		if ( i > 4 && (CRttHistogram::getLimit( i ) - us) * 4 > us ) {
+			throw TestFailed("RTT histogram resolution too coarse");
+		}
+	}
+
+	if ( h.getPercentile( 99. ) != 0 ) {
+		throw TestFailed("percentile of empty RTT histogram should be 0");
+	}
+	for ( i = 0; i < 90; i++ )
+		h.record( 100 );
+	for ( i = 0; i < 10; i++ )
+		h.record( 1000 );
+	us = h.getPercentile( 50. );
+	if ( us <= 100 || us > 125 ) {
+		throw TestFailed("RTT median wrong");
+	}
+	us = h.getPercentile( 99. );
+	if ( us <= 1000 || us > 1250 ) {
+		throw TestFailed("RTT 99th percentile wrong");
+	}
+
+	// old samples decay
+	for ( i = 0; i < 8*CRttHistogram::DECAY_SAMPLES; i++ )
+		h.record( 10 );
+	if ( h.getPercentile( 99. ) > 12 || h.getCount() > CRttHistogram::DECAY_SAMPLES*2 ) {
+		throw TestFailed("RTT histogram does not decay");
+	}
+
+	// percentile-based timeout follows the tail, not the mean
+	{
+	DynTimeout t( CTimeout( 100000 ) );
+		t.setTimeoutCap( 0 );
+		t.setPercentile( 99., 100 );
+		feed( &t, 100,  95 );
+		feed( &t, 5000,  5 );
+		us = t.getRndTripPercentile( 99. ).getUs();
+		if ( us <= 5000 || t.get().getUs() != 2*us ) {
+			fprintf(stderr, "timeout %llu, p99 %llu\n", (unsigned long long)t.get().getUs(), (unsigned long long)us);
+			throw TestFailed("percentile-based timeout wrong");
+		}
+
+		// sustained loss backs off but never beyond the user timeout
+		for ( i = 0; i < 100; i++ ) {
+			t.relax();
+			if ( t.get().getUs() > 100000 ) {
+				throw TestFailed("relaxed timeout exceeds user timeout");
+			}
+		}
+		if ( t.get().getUs() != 100000 ) {
+			throw TestFailed("timeout did not back off");
+		}
+		if ( t.getRndTripPercentile( 99. ).getUs() != us ) {
+			throw TestFailed("back-off recorded in RTT histogram");
+		}
+		// the next reply ends the back-off
+		feed( &t, 100, 1 );
+		if ( t.get().getUs() != 2*us ) {
+			throw TestFailed("timeout did not recover after back-off");
+		}
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+const char *ip_addr = "127.0.0.1";
+unsigned    port    = 8200;
+unsigned    tdest   = 1;
+int         rval    = 1;
+unsigned    i;
+int         opt;
+unsigned   *u_p;
+int         dump    = 0;
+
+	while ( (opt = getopt(argc, argv, "p:t:dh")) > 0 ) {
+		u_p = 0;
+		switch ( opt ) {
+			case 'p': u_p = &port;  break;
+			case 't': u_p = &tdest; break;
+			case 'd': dump  = 1;    break;
+			case 'h':
+				rval = 0; /* fall thru */
+			default:
+				fprintf(stderr,"usage: %s [-p <port> ] [-t <tdest> ] [-d] [-h]\n", argv[0]);
+				return rval;
+		}
+		if ( u_p && (1 != sscanf(optarg, "%i", u_p)) ) {
+			fprintf(stderr,"ERROR: Unable to scan value for option '-%c'\n", opt);
+			return 1;
+		}
+	}
+
+	try {
+		testHisto();
+		testRttPercentile();
+
+		{
+		NetIODev root = INetIODev::create("netio", ip_addr);
+		{
+		MMIODev  mmio = IMMIODev::create ("mmio",  MEM_SIZE);
+		IntField arr  = IIntField::create("arr",   32, false, 0);
+
+			mmio->addAtAddress( arr, REGBASE+REG_ARR_OFF, REG_ARR_SZ/4 );
+
+			ProtoStackBuilder pbldr( IProtoStackBuilder::create() );
+
+			pbldr->setSRPVersion   ( IProtoStackBuilder::SRP_UDP_V3 );
+			pbldr->setUdpPort      (                           port );
+			pbldr->useRssi         (                           true );
+			pbldr->setTDestMuxTDEST(                          tdest );
+
+			root->addAtAddress( mmio, pbldr );
+		}
+
+		ScalVal  arr = IScalVal::create( root->findByName("mmio/arr[0]") );
+		uint64_t v;
+
+			for ( i = 0; i < NREADS; i++ ) {
+				arr->getVal( &v, 1 );
+			}
+
+			IMetrics::Snapshot       snap;
+			const IMetrics::Sample  *s;
+			uint64_t                 tot;
+
+			IMetrics::snapshot( &snap );
+
+			s = find( snap, "SRP", "reads" );
+			if ( s->kind != IMetrics::COUNTER || s->value < NREADS ) {
+				throw TestFailed("SRP read counter wrong");
+			}
+			s = find( snap, "SRP", "roundtrip_us" );
+			if ( s->kind != IMetrics::HISTOGRAM || s->value < NREADS || s->bucketCounts.size() != s->bucketLimits.size() ) {
+				throw TestFailed("SRP round-trip histogram wrong");
+			}
+			for ( i = 0, tot = 0; i < s->bucketCounts.size(); i++ ) {
+				tot += s->bucketCounts[i];
+			}
+			if ( tot != s->value ) {
+				throw TestFailed("SRP round-trip histogram buckets do not add up");
+			}
+			s = find( snap, "UDP", "rx_dgrams" );
+			if ( s->value < NREADS ) {
+				throw TestFailed("UDP RX datagram counter wrong");
+			}
+			s = find( snap, "UDP", "rx_drops" );
+			if ( s->kind != IMetrics::COUNTER || 0 != s->value ) {
+				throw TestFailed("UDP RX drop counter wrong");
+			}
+			s = find( snap, "UDP", "queue_hwm" );
+			if ( s->kind != IMetrics::GAUGE || s->value < 1 ) {
+				throw TestFailed("UDP queue high-water mark wrong");
+			}
+			find( snap, "RSSI", "rex_segments" );
+			s = find( snap, "RSSI", "srtt_us" );
+			if ( s->kind != IMetrics::GAUGE || 0 == s->value ) {
+				throw TestFailed("RSSI smoothed RTT not estimated");
+			}
+			if ( s->value >= find( snap, "RSSI", "rex_timeout_us" )->value ) {
+				throw TestFailed("RSSI retransmission timeout below RTT");
+			}
+			// the RTT over loopback is far below any of the static
+			// timeouts; the retransmission timeout must follow it
+			if ( find( snap, "RSSI", "rex_timeout_us" )->value >= CRssiConfigParams::CAK_TIMEOUT_US_DFLT ) {
+				fprintf(stderr, "RSSI RTO %" PRIu64 "us (SRTT %" PRIu64 "us)\n", find( snap, "RSSI", "rex_timeout_us" )->value, s->value);
+				throw TestFailed("RSSI retransmission timeout does not follow a low RTT");
+			}
+			s = find( snap, "SRP", "roundtrip_p99_us" );
+			if ( s->kind != IMetrics::GAUGE || 0 == s->value ) {
+				throw TestFailed("SRP round-trip percentile missing");
+			}
+
+			FILE *f = tmpfile();
+			if ( ! f ) {
+				throw TestFailed("tmpfile failed");
+			}
+			IMetrics::dumpJSON( f );
+			if ( ftell( f ) < 1000 ) {
+				throw TestFailed("metrics export too short");
+			}
+			fclose( f );
+
+			f = tmpfile();
+			if ( ! f ) {
+				throw TestFailed("tmpfile failed");
+			}
+			IMetrics::dumpPrometheus( f );
+			{
+			std::string prom;
+			char        line[1000];
+				rewind( f );
+				while ( fgets( line, sizeof(line), f ) ) {
+					prom += line;
+				}
+				if ( std::string::npos == prom.find( "cpsw_udp_rx_dgrams_total{cpsw_instance=" ) ) {
+					throw TestFailed("Prometheus counter not exported as '_total'");
+				}
+				if ( std::string::npos != prom.find( "{instance=" ) ) {
+					throw TestFailed("Prometheus export uses reserved label 'instance'");
+				}
+			}
+			fclose( f );
+			if ( dump ) {
+				IMetrics::dumpPrometheus( stdout );
+			}
+		}
+
+		// sources unregister when the stacks go away
+		{
+		IMetrics::Snapshot snap;
+			IMetrics::snapshot( &snap );
+			if ( ! snap.empty() ) {
+				throw TestFailed("metrics sources still registered after shutdown");
+			}
+		}
+	} catch ( CPSWError &e ) {
+		fprintf(stderr,"CPSW Error caught: %s\n", e.getInfo().c_str());
+		throw;
+	} catch ( TestFailed &e ) {
+		fprintf(stderr,"TEST FAILED: %s\n", e.e_);
+		throw;
+	}
+	if ( CpswObjCounter::report(stderr) ) {
+		printf("Leaked Objects!\n");
+		throw TestFailed("leaked objects");
+	}
+	printf("Metrics test PASSED\n");
+	return 0;
+}
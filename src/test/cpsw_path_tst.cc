@@ -204,6 +204,52 @@ static void test_dotdot_across_root_f8560f57884( Hub r )
 	r->findByName("outer/../outer/inner");
 }
 
+// names resolved from the (cached) prefixes must yield the same paths
+static void test_path_index( Hub r )
+{
+static const char *names[][2] = {
+	{ "outer/inner/leaf1",             "/outer[0-1]/inner[0-3]/leaf1[0-3]" },
+	{ "outer[1]/inner[2-3]/leaf1[1]",  "/outer[1]/inner[2-3]/leaf1[1]"     },
+	{ "outer/inner/leaf1[2]",          "/outer[0-1]/inner[0-3]/leaf1[2]"   },
+	{ "outer/inner/",                  "/outer[0-1]/inner[0-3]"            },
+	{ "/outer//inner/leaf",            "/outer[0-1]/inner[0-3]/leaf"       },
+	{ "outer/../outer/inner/leaf",     "/outer[0-1]/inner[0-3]/leaf"       },
+	{ "outer/inner/leaf1/../leaf",     "/outer[0-1]/inner[0-3]/leaf"       },
+	{ "outer[0]/inner/leaf1",          "/outer[0]/inner[0-3]/leaf1[0-3]"   },
+};
+const unsigned           n = sizeof(names)/sizeof(names[0]);
+std::vector<std::string> v;
+std::vector<Path>        pv;
+unsigned                 i, pass;
+
+	for ( pass = 0; pass < 2; pass++ ) {
+		for ( i = 0; i < n; i++ ) {
+			std::string s = r->findByName( names[i][0] )->toString();
+			if ( s != names[i][1] ) {
+				fprintf(stderr, "findByName(\"%s\") (pass %u) -- got %s, expected %s\n", names[i][0], pass, s.c_str(), names[i][1]);
+				throw TestFailed();
+			}
+			v.push_back( names[i][0] );
+		}
+		try {
+			r->findByName( "outer/inner/nonexistent" );
+			throw TestFailed();
+		} catch ( NotFoundError &e ) {
+		}
+	}
+
+	pv = r->findByNames( v );
+	if ( pv.size() != v.size() ) {
+		throw TestFailed();
+	}
+	for ( i = 0; i < pv.size(); i++ ) {
+		if ( pv[i]->toString() != names[i % n][1] ) {
+			fprintf(stderr, "findByNames(\"%s\") -- got %s\n", v[i].c_str(), pv[i]->toString().c_str());
+			throw TestFailed();
+		}
+	}
+}
+
 using std::cout;
 
 class DumpNameVisitor : public IPathVisitor {
@@ -541,6 +587,8 @@ Hub     r  = use_yaml ? build_yaml() : build();
 
 	test_dotdot_across_root_f8560f57884( build_yaml() );
 
+	test_path_index( use_yaml ? build_yaml() : build() );
+
 	printf("leaving\n");
 } catch (CPSWError &e ) {
 	fprintf(stderr, "CPSW Error: %s\n", e.getInfo().c_str());
@@ -0,0 +1,147 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <stdio.h>
+#include <string.h>
+#include <cpsw_api_user.h>
+#include <cpsw_error.h>
+
+#include <cpsw_shadow_cache.h>
+
+#include <string>
+
+using std::string;
+
+class TestFailed {
+public:
+	string e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+static void
+checkHit(CShadowCache *c, uint64_t off, const uint8_t *exp, unsigned n, const char *ctxt)
+{
+uint8_t buf[256];
+	if ( ! c->read( off, buf, n ) ) {
+		fprintf(stderr, "%s: ", ctxt);
+		throw TestFailed("expected cache hit");
+	}
+	if ( memcmp( buf, exp, n ) ) {
+		fprintf(stderr, "%s: ", ctxt);
+		throw TestFailed("cached data mismatch");
+	}
+}
+
+static void
+checkMiss(CShadowCache *c, uint64_t off, unsigned n, const char *ctxt)
+{
+uint8_t buf[256];
+	if ( c->read( off, buf, n ) ) {
+		fprintf(stderr, "%s: ", ctxt);
+		throw TestFailed("expected cache miss");
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+uint8_t      a[16], b[16], m[16];
+unsigned     i;
+CShadowCache off;
+CShadowCache c( 8 );
+
+try {
+
+	for ( i=0; i<sizeof(a); i++ ) {
+		a[i] = i;
+		b[i] = 0x80 + i;
+	}
+
+	if ( off.isEnabled() || off.covers( 1 ) )
+		throw TestFailed("default cache should be disabled");
+
+	if ( ! c.covers( 8 ) || c.covers( 9 ) || c.covers( 0 ) )
+		throw TestFailed("'covers' FAILED");
+
+	checkMiss( &c, 0, 4, "empty cache" );
+
+	c.update( 0x100, a, 4 );
+	checkHit ( &c, 0x100, a,     4, "simple"       );
+	checkHit ( &c, 0x101, a + 1, 2, "sub-range"    );
+	checkMiss( &c, 0x0ff,        2, "below extent" );
+	checkMiss( &c, 0x103,        2, "above extent" );
+
+	// adjacent extents must coalesce
+	c.update( 0x104, a + 4, 4 );
+	c.update( 0x0fc, b,     4 );
+	memcpy( m,     b, 4 );
+	memcpy( m + 4, a, 8 );
+	checkHit ( &c, 0x0fc, m, 12, "coalesced" );
+
+	// overwrite the middle of an extent
+	c.update( 0x102, b + 8, 2 );
+	memcpy( m + 6, b + 8, 2 );
+	checkHit ( &c, 0x0fc, m, 12, "overwrite middle" );
+
+	// punch a hole
+	c.invalidate( 0x101, 2 );
+	checkHit ( &c, 0x0fc, m,      5, "head after hole" );
+	checkHit ( &c, 0x103, m + 7,  5, "tail after hole" );
+	checkMiss( &c, 0x100,         2, "hole"            );
+
+	// refill the hole
+	c.update( 0x101, m + 5, 2 );
+	checkHit ( &c, 0x0fc, m, 12, "hole refilled" );
+
+	// bit-merge with known original bytes: msk bits are preserved
+	c.update( 0x0fc, a + 8, 4, 0xf0, 0x0f );
+	m[0] = (m[0] & 0xf0) | (a[8]  & 0x0f);
+	m[1] = a[9];
+	m[2] = a[10];
+	m[3] = (m[3] & 0x0f) | (a[11] & 0xf0);
+	checkHit ( &c, 0x0fc, m, 12, "bit merge" );
+
+	// bit-merge with unknown original bytes invalidates those bytes
+	c.update( 0x1ff, a, 3, 0x01, 0x80 );
+	checkMiss( &c, 0x1ff,        1, "unknown first byte" );
+	checkMiss( &c, 0x201,        1, "unknown last byte"  );
+	checkHit ( &c, 0x200, a + 1, 1, "merged middle"      );
+
+	// invalidation spanning several extents
+	c.invalidate( 0, 0x1000 );
+	if ( c.getNumBytes() != 0 )
+		throw TestFailed("cache not empty after invalidation");
+
+	c.update( 0x10, a, 8 );
+	c.clear();
+	checkMiss( &c, 0x10, 1, "after clear" );
+
+	// a read completing after a write must not overwrite newer data
+	{
+	uint64_t gen = c.getGeneration();
+		c.update( 0x20, b, 4 );
+		if ( c.fill( 0x20, a, 4, gen ) )
+			throw TestFailed("stale fill was recorded");
+		checkHit ( &c, 0x20, b, 4, "write after stale fill" );
+		gen = c.getGeneration();
+		if ( ! c.fill( 0x30, a, 4, gen ) )
+			throw TestFailed("current fill was dropped");
+		checkHit ( &c, 0x30, a, 4, "fill" );
+	}
+
+} catch ( CPSWError &e ) {
+	fprintf(stderr,"ERROR: %s\n", e.getInfo().c_str());
+	throw;
+} catch ( TestFailed &e) {
+	fprintf(stderr,"TEST FAILED: %s\n", e.e_.c_str());
+	throw;
+}
+	printf("CPSW Shadow Cache test PASSED\n");
+	return 0;
+}
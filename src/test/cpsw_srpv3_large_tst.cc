@@ -52,7 +52,7 @@ public:
 	}
 };
 
-static void check(ScalVal arr, TYPE patt, bool async)
+static void check(ScalVal arr, TYPE patt, bool async, bool pipelined)
 {
 unsigned    nelms = arr->getNelms();
 TYPE        buf[nelms];
@@ -65,6 +65,11 @@ unsigned    i;
 				buf[i] = i;
 			arr->setVal( buf, nelms );
 		}
+
+		if ( pipelined ) {
+			// wait for write acknowledgments
+			arr->getPath()->flush();
+		}
 		
 		memset(buf, ~patt, nelms*sizeof(buf[0]));
 
@@ -112,22 +117,26 @@ int         depack2 = 0;
 unsigned    vers    = 3;
 unsigned    tdest   = 1000; /* off */
 unsigned    port    = 0;
+unsigned    window  = 1;
+int         pipe    = 0;
 unsigned   *u_p;
 int         opt;
 
 IProtoStackBuilder::SRPProtoVersion pvers;
 
-	while ( (opt = getopt(argc, argv, "V:p:t:2h")) > 0 ) {
+	while ( (opt = getopt(argc, argv, "V:p:t:w:P2h")) > 0 ) {
 		u_p = 0;
 		switch ( opt ) {
 			case 'V': u_p = &vers;  break;
 			case 'p': u_p = &port;  break;
 			case 't': u_p = &tdest; break;
+			case 'w': u_p = &window; break;
 			case '2': depack2 = 1;  break;
+			case 'P': pipe    = 1;  break;
 			case 'h':
 				rval = 0; /* fall thru */
 			default:
-				fprintf(stderr,"usage: %s [-V <srp_version> ] [-p <port> ] [-t <tdest> ] [-2] [-h]\n", argv[0]);
+				fprintf(stderr,"usage: %s [-V <srp_version> ] [-p <port> ] [-t <tdest> ] [-w <read_window>] [-P] [-2] [-h]\n", argv[0]);
 				return rval;
 		}
 		if ( u_p && (1 != sscanf(optarg, "%i", u_p)) ) {
@@ -172,6 +181,10 @@ IProtoStackBuilder::SRPProtoVersion pvers;
 		pbldr->setSRPVersion(                 pvers );
 		pbldr->setUdpPort   (                  port );
 		pbldr->useRssi      (                  true );
+		pbldr->setSRPReadWindow(             window );
+		if ( pipe ) {
+			pbldr->setSRPDefaultWriteMode( PIPELINED );
+		}
 		if ( tdest > 255 ) {
 			pbldr->useTDestMux  (                 false );
 		} else {
@@ -190,10 +203,10 @@ IProtoStackBuilder::SRPProtoVersion pvers;
 			throw TestFailed();
 		}
 
-		check(arr, 0xdead, false);
-		check(arr,      0, false);
-		check(arr, 0xdead, true );
-		check(arr,      0, true );
+		check(arr, 0xdead, false, pipe);
+		check(arr,      0, false, pipe);
+		check(arr, 0xdead, true , pipe);
+		check(arr,      0, true , pipe);
 
 		
 	} catch ( CPSWError &e ) {
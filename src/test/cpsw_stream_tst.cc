@@ -13,6 +13,7 @@
 #include <pthread.h>
 
 #include <stdio.h>
+#include <string.h>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
 
@@ -22,7 +23,7 @@ class TestFailed {};
 
 static void usage(const char *nm)
 {
-	fprintf(stderr,"Usage: %s [-h] [-s <port>] [-q <input_queue_depth>] [-Q <output queue depth>] [-L <log2(frameWinSize)>] [-l <fragWinSize>] [-T <timeout_us>] [-e err_percent] [-n n_frames] [-R] [-y dump-yaml] [-Y load-yaml] [-2]\n", nm);
+	fprintf(stderr,"Usage: %s [-h] [-s <port>] [-q <input_queue_depth>] [-Q <output queue depth>] [-L <log2(frameWinSize)>] [-l <fragWinSize>] [-T <timeout_us>] [-e err_percent] [-n n_frames] [-R] [-y dump-yaml] [-Y load-yaml] [-2] [-F] [-B <udp_batch_size>] [-E <io_engine_threads>] [-M] [-Z]\n", nm);
 }
 
 #define STRT(chnl) (0x01<<(chnl))
@@ -32,8 +33,15 @@ class StrmRxFailed {};
 
 #define NUM_STREAMS 2
 
+#define RX_SLOT_SIZE 2048
+#define RX_NUM_SLOTS  256
+
+// must outlive the protocol stacks
+static uint8_t rxRegion[RX_SLOT_SIZE * RX_NUM_SLOTS];
+
 struct StrmCtxt {
 	int       depack2;
+	int       zeroCopy;
 	int       debug;
 	unsigned  ngood;
 	unsigned  timeoutUs;
@@ -162,7 +170,24 @@ printf("Rcvr startup: %s\n", c->strmPath ? c->strmPath->toString().c_str() : "<N
 			sendMsg( strm, STRT(c->chnl), c->depack2 );
 		}
 
-		got = strm->read( buf, sizeof(buf), CTimeout(c->timeoutUs), 0 );
+		if ( c->zeroCopy ) {
+			StreamFrame frm = strm->readChain( CTimeout(c->timeoutUs) );
+			got = 0;
+			if ( frm ) {
+				const IStreamFrame::Segment *seg = frm->getSegments();
+				// gather the scatter-list
+				for ( unsigned k = 0; k < frm->getNumSegments() && got + seg[k].size <= sizeof(buf); k++ ) {
+					memcpy( buf + got, seg[k].data, seg[k].size );
+					got += seg[k].size;
+				}
+				if ( (uint64_t)got != frm->getSize() ) {
+					fprintf(stderr,"readChain -- scatter-list does not cover frame\n");
+					throw StrmRxFailed();
+				}
+			}
+		} else {
+			got = strm->read( buf, sizeof(buf), CTimeout(c->timeoutUs), 0 );
+		}
 
 		if ( c->debug > 1 )
 			printf("Read %" PRIu64 " octets\n", got);
@@ -251,6 +276,11 @@ unsigned ngood       = NGOOD;
 int      quiet       = 1;
 unsigned nUdpThreads = 4;
 unsigned useRssi     = 0;
+int      lockFree    = 0;
+unsigned udpBatch    = 1;
+unsigned ioEngine    = 0;
+int      useRegion   = 0;
+int      zeroCopy    = 0;
 unsigned tDest       = 0;
 unsigned sport       = 8193;
 const char *dmp_yaml = 0;
@@ -279,7 +309,7 @@ StrmCtxt ctxt[NUM_STREAMS];
 		ctxt[i].tdest   = -1;
 	}
 
-	while ( (opt=getopt(argc, argv, "dl:L:hT:e:n:Rs:t:y:Y:2")) > 0 ) {
+	while ( (opt=getopt(argc, argv, "dl:L:hT:e:n:Rs:t:y:Y:2FB:E:MZ")) > 0 ) {
 		i_p = 0;
 		switch ( opt ) {
 			case 'd': debug++;               break;
@@ -296,6 +326,11 @@ StrmCtxt ctxt[NUM_STREAMS];
 			case 'Y': use_yaml    = optarg;  break;
 			case 'y': dmp_yaml    = optarg;  break;
 			case '2': depack2 = 1;           break;
+			case 'F': lockFree = 1;          break;
+			case 'B': i_p = &udpBatch;       break;
+			case 'E': i_p = &ioEngine;       break;
+			case 'M': useRegion = 1;         break;
+			case 'Z': zeroCopy  = 1;         break;
 			default:
 			case 'h': usage(argv[0]); return 1;
 		}
@@ -346,6 +381,9 @@ try {
 		bldr->setUdpPort             (                            sport );
 		bldr->setUdpOutQueueDepth    (                          iQDepth );
 		bldr->setUdpNumRxThreads     (                      nUdpThreads );
+		bldr->setUdpRxBatchSize      (                         udpBatch );
+		bldr->setUdpTxBatchSize      (                         udpBatch );
+		bldr->setUdpIoEngineThreads  (                         ioEngine );
 	if ( depack2 ) {
 		bldr->setDepackVersion       ( IProtoStackBuilder::DEPACKETIZER_V2 );
 	}
@@ -353,6 +391,10 @@ try {
 		bldr->setDepackLdFrameWinSize(                   ldFrameWinSize );
 		bldr->setDepackLdFragWinSize (                    ldFragWinSize );
 		bldr->useRssi                (                          useRssi );
+		bldr->useLockFreeQueues      (                         lockFree );
+	if ( useRegion ) {
+		bldr->setRxMemRegion( rxRegion, sizeof(rxRegion), RX_SLOT_SIZE );
+	}
 		if ( depack2 && tDest > 254 ) {
 			tDest = 0;
 		}
@@ -374,6 +416,7 @@ try {
 
 	for ( i=0; i<NUM_STREAMS; i++ ) {
 		ctxt[i].depack2       = depack2;
+		ctxt[i].zeroCopy      = zeroCopy;
 		ctxt[i].debug         = debug;
 		ctxt[i].ngood         = ngood;
 		ctxt[i].timeoutUs     = timeoutUs;
@@ -0,0 +1,379 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+#include <cpsw_sval_conv.h>
+#include <cpsw_api_builder.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define MAXN 200
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+static void usage(const char *nm)
+{
+	fprintf(stderr,"Usage: %s [-h] [-b <Melems>]\n", nm);
+	fprintf(stderr,"       -h          : this message\n");
+	fprintf(stderr,"       -b <Melems> : benchmark some common conversions\n");
+}
+
+static bool hostLE;
+
+static uint64_t
+ldo(const uint8_t *p, unsigned n, bool le)
+{
+uint64_t v = 0;
+unsigned i;
+	for ( i = 0; i < n; i++ ) {
+		v |= ((uint64_t)p[i]) << (8 * ( le ? i : n - 1 - i ));
+	}
+	return v;
+}
+
+static void
+sto(uint8_t *p, unsigned n, bool le, uint64_t v)
+{
+unsigned i;
+	for ( i = 0; i < n; i++ ) {
+		p[i] = v >> (8 * ( le ? i : n - 1 - i ));
+	}
+}
+
+static uint64_t
+sext(uint64_t v, unsigned bits)
+{
+	if ( bits < 64 && ( v & (((uint64_t)1) << (bits - 1)) ) ) {
+		v |= ~((((uint64_t)1) << bits) - 1);
+	}
+	return v;
+}
+
+static void
+refGet(uint8_t *dst, const uint8_t *src, unsigned n, unsigned s, unsigned d, unsigned bits, unsigned lsb, bool sgnd, bool swap)
+{
+unsigned i;
+uint64_t v;
+	for ( i = 0; i < n; i++ ) {
+		v = ldo( src + i*s, s, hostLE != swap ) >> lsb;
+		if ( bits < 64 ) {
+			v &= (((uint64_t)1) << bits) - 1;
+		}
+		if ( sgnd ) {
+			v = sext( v, bits );
+		}
+		sto( dst + i*d, d, hostLE, v );
+	}
+}
+
+static void
+refSet(uint8_t *dst, const uint8_t *src, unsigned n, unsigned s, unsigned d, unsigned lsb, bool sgnd, bool swap)
+{
+unsigned i;
+uint64_t v;
+	for ( i = 0; i < n; i++ ) {
+		v = ldo( src + i*s, s, hostLE );
+		if ( sgnd ) {
+			v = sext( v, 8*s );
+		}
+		sto( dst + i*d, d, hostLE != swap, v << lsb );
+	}
+}
+
+static void
+fill(uint8_t *b, unsigned n)
+{
+	while ( n-- > 0 )
+		*b++ = random();
+}
+
+static void
+testGet(unsigned s, unsigned d, unsigned bits, unsigned lsb, bool sgnd, bool swap)
+{
+uint8_t  src[8*MAXN], buf[8*MAXN + 64], ref[8*MAXN];
+uint8_t *ip;
+unsigned n = random() % MAXN;
+CIntConv conv;
+int      layout;
+char     msg[200];
+
+	if ( ! conv.initGet( s, d, bits, lsb, sgnd, swap ) ) {
+		throw TestFailed("initGet unexpectedly failed");
+	}
+
+	fill( src, s*n );
+	refGet( ref, src, n, s, d, bits, lsb, sgnd, swap );
+
+	// disjoint buffers, in-place and 'big-endian host' layout
+	for ( layout = 0; layout < 3; layout++ ) {
+		fill( buf, sizeof(buf) );
+		switch ( layout ) {
+			case 0:  ip = src;                 break;
+			case 1:  ip = buf;                 break;
+			default: ip = buf + (d > s ? (d - s)*n : 0); break;
+		}
+		if ( ip != src ) {
+			memmove( ip, src, s*n );
+		}
+		conv( buf, ip, n );
+		if ( memcmp( buf, ref, d*n ) ) {
+			snprintf(msg, sizeof(msg), "get mismatch (%s; s %u, d %u, bits %u, lsb %u, signed %d, swap %d, layout %d, n %u)",
+				conv.getKernelName(), s, d, bits, lsb, sgnd, swap, layout, n);
+			fprintf(stderr, "%s\n", msg);
+			throw TestFailed("get kernel mismatch");
+		}
+	}
+}
+
+static void
+testSet(unsigned s, unsigned d, unsigned lsb, bool sgnd, bool swap)
+{
+uint8_t  src[8*MAXN], buf[8*MAXN], ref[8*MAXN];
+unsigned n = random() % MAXN;
+CIntConv conv;
+
+	if ( ! conv.initSet( s, d, lsb, sgnd, swap ) ) {
+		throw TestFailed("initSet unexpectedly failed");
+	}
+
+	fill( src, s*n );
+	refSet( ref, src, n, s, d, lsb, sgnd, swap );
+	conv( buf, src, n );
+	if ( memcmp( buf, ref, d*n ) ) {
+		fprintf(stderr, "set mismatch (%s; s %u, d %u, lsb %u, signed %d, swap %d, n %u)\n",
+			conv.getKernelName(), s, d, lsb, sgnd, swap, n);
+		throw TestFailed("set kernel mismatch");
+	}
+}
+
+static void
+testAll()
+{
+static const unsigned usz[] = { 1, 2, 4, 8 };
+unsigned s, d, lsb, bits, i, sgnd, swap;
+
+	for ( s = 1; s <= 8; s++ ) {
+		for ( i = 0; i < sizeof(usz)/sizeof(usz[0]); i++ ) {
+			d = usz[i];
+			for ( lsb = 0; lsb < 8; lsb++ ) {
+				for ( sgnd = 0; sgnd < 2; sgnd++ ) {
+					for ( swap = 0; swap < 2; swap++ ) {
+						// get: 's' includes the lsb shift
+						if ( 8*s > lsb ) {
+							bits = 8*s - lsb;
+							testGet( s, d, bits, lsb, sgnd, swap );
+							if ( bits > 1 ) {
+								testGet( s, d, 1 + random() % (bits - 1), lsb, sgnd, swap );
+							}
+						}
+						// set: user size 'd', device size 's'
+						testSet( d, s, lsb, sgnd, swap );
+					}
+				}
+			}
+		}
+	}
+}
+
+template <typename T>
+static void
+testDbl(CDblConv &conv)
+{
+uint8_t  src[sizeof(T)*MAXN];
+double   buf[MAXN], ref[MAXN];
+unsigned n = random() % MAXN;
+unsigned i;
+uint8_t *ip;
+T        v;
+int      layout;
+
+	fill( src, sizeof(src) );
+	// extreme values
+	if ( n > 2 ) {
+		memset( src,             0xff, sizeof(T) );
+		memset( src + sizeof(T), 0x00, sizeof(T) );
+		src[2*sizeof(T) - 1] = 0x80;
+	}
+	for ( i = 0; i < n; i++ ) {
+		memcpy( &v, src + i*sizeof(T), sizeof(v) );
+		ref[i] = (double)v;
+	}
+
+	// disjoint buffers and source in the tail of the destination;
+	// results are compared bytewise (random floats include NaNs)
+	for ( layout = 0; layout < 2; layout++ ) {
+		fill( (uint8_t*)buf, sizeof(buf) );
+		if ( 0 == layout ) {
+			ip = src;
+		} else {
+			ip = (uint8_t*)buf + n*(sizeof(double) - sizeof(T));
+			memmove( ip, src, n*sizeof(T) );
+		}
+		conv( buf, ip, n );
+		if ( memcmp( buf, ref, n*sizeof(double) ) ) {
+			fprintf(stderr, "double mismatch (%s; size %u, layout %d, n %u)\n",
+				conv.getKernelName(), (unsigned)sizeof(T), layout, n);
+			throw TestFailed("double kernel mismatch");
+		}
+	}
+}
+
+template <typename T>
+static void
+testDblInt(bool sgnd)
+{
+CDblConv conv;
+unsigned i;
+	if ( ! conv.initInt( sizeof(T), sgnd ) ) {
+		throw TestFailed("CDblConv::initInt unexpectedly failed");
+	}
+	for ( i = 0; i < 50; i++ ) {
+		testDbl<T>( conv );
+	}
+}
+
+static void
+testDblAll()
+{
+CDblConv conv;
+unsigned i;
+
+	testDblInt<uint8_t> ( false );
+	testDblInt<int8_t>  ( true  );
+	testDblInt<uint16_t>( false );
+	testDblInt<int16_t> ( true  );
+	testDblInt<uint32_t>( false );
+	testDblInt<int32_t> ( true  );
+	testDblInt<uint64_t>( false );
+	testDblInt<int64_t> ( true  );
+
+	conv.initFloat();
+	for ( i = 0; i < 50; i++ ) {
+		testDbl<float>( conv );
+	}
+
+	if ( conv.initInt( 3, false ) ) {
+		throw TestFailed("CDblConv::initInt accepted unsupported size");
+	}
+}
+
+static double
+benchDbl(unsigned s, bool sgnd, unsigned melems)
+{
+const unsigned   N = 65536;
+uint8_t         *src = (uint8_t*)malloc( N*s );
+double          *dst = (double*)malloc( N*sizeof(double) );
+unsigned         i, nit = ( melems * 1000000ULL ) / N;
+CDblConv         conv;
+struct timespec  then, now;
+
+	fill( src, N*s );
+	conv.initInt( s, sgnd );
+	clock_gettime( CLOCK_MONOTONIC, &then );
+	for ( i = 0; i < nit; i++ ) {
+		conv( dst, src, N );
+	}
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	free( src );
+	free( dst );
+	return (double)nit*(double)N/( (double)(now.tv_sec - then.tv_sec) + 1.0E-9*(double)(now.tv_nsec - then.tv_nsec) )/1.0E6;
+}
+
+static double
+bench(unsigned s, unsigned d, unsigned bits, unsigned lsb, bool sgnd, bool swap, unsigned melems)
+{
+const unsigned   N = 65536;
+uint8_t         *src = (uint8_t*)malloc( N*s );
+uint8_t         *dst = (uint8_t*)malloc( N*d );
+unsigned         i, nit = ( melems * 1000000ULL ) / N;
+CIntConv         conv;
+struct timespec  then, now;
+
+	fill( src, N*s );
+	conv.initGet( s, d, bits, lsb, sgnd, swap );
+	clock_gettime( CLOCK_MONOTONIC, &then );
+	for ( i = 0; i < nit; i++ ) {
+		conv( dst, src, N );
+	}
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	free( src );
+	free( dst );
+	return (double)nit*(double)N/( (double)(now.tv_sec - then.tv_sec) + 1.0E-9*(double)(now.tv_nsec - then.tv_nsec) )/1.0E6;
+}
+
+int
+main(int argc, char **argv)
+{
+int       opt;
+unsigned  melems = 0;
+unsigned *u_p;
+int       vec;
+
+	while ( (opt = getopt(argc, argv, "hb:")) > 0 ) {
+		u_p = 0;
+		switch ( opt ) {
+			case 'h': usage( argv[0] );  return 0;
+			case 'b': u_p = &melems;     break;
+			default:
+				fprintf(stderr,"Unknown option '%c'\n", opt);
+				usage( argv[0] );
+				return 1;
+		}
+		if ( u_p && 1 != sscanf(optarg, "%i", u_p) ) {
+			fprintf(stderr,"Unable to scan argument to option '-%c'\n", opt);
+			return 1;
+		}
+	}
+
+	hostLE = LE == hostByteOrder();
+
+	try {
+		for ( vec = 1; vec >= 0; vec-- ) {
+			CIntConv::setVectorEnabled( vec );
+			testAll();
+			testDblAll();
+		}
+	} catch ( TestFailed &e ) {
+		fprintf(stderr, "TEST FAILED: %s\n", e.e_);
+		return 1;
+	}
+
+	if ( melems ) {
+		printf("%-36s %14s %14s\n", "Conversion (get)", "scalar Mel/s", "vector Mel/s");
+		CIntConv::setVectorEnabled( false );
+		double s0 = bench( 2, 2, 12, 0, true,  true,  melems );
+		double s1 = bench( 2, 8, 16, 0, true,  true,  melems );
+		double s2 = bench( 4, 4, 28, 4, false, true,  melems );
+		double s3 = bench( 3, 4, 24, 0, true,  false, melems );
+		CIntConv::setVectorEnabled( true );
+		printf("%-36s %14.1f %14.1f\n", "16-bit swapped, 12-bit signed -> 16", s0, bench( 2, 2, 12, 0, true,  true,  melems ));
+		printf("%-36s %14.1f %14.1f\n", "16-bit swapped, signed -> 64",        s1, bench( 2, 8, 16, 0, true,  true,  melems ));
+		printf("%-36s %14.1f %14.1f\n", "32-bit swapped, shifted -> 32",       s2, bench( 4, 4, 28, 4, false, true,  melems ));
+		printf("%-36s %14.1f %14.1f\n", "24-bit signed -> 32",                 s3, bench( 3, 4, 24, 0, true,  false, melems ));
+		printf("%-36s %14s %14s\n", "Conversion (double)", "scalar Mel/s", "vector Mel/s");
+		CIntConv::setVectorEnabled( false );
+		s0 = benchDbl( 2, true,  melems );
+		s1 = benchDbl( 4, false, melems );
+		s2 = benchDbl( 8, true,  melems );
+		CIntConv::setVectorEnabled( true );
+		printf("%-36s %14.1f %14.1f\n", "int16 -> double",                     s0, benchDbl( 2, true,  melems ));
+		printf("%-36s %14.1f %14.1f\n", "uint32 -> double",                    s1, benchDbl( 4, false, melems ));
+		printf("%-36s %14.1f %14.1f\n", "int64 -> double",                     s2, benchDbl( 8, true,  melems ));
+	}
+
+	printf("Integer conversion test PASSED\n");
+	return 0;
+}
@@ -0,0 +1,196 @@
+ //@C Copyright Notice
+ //@C ================
+ //@C This file is part of CPSW. It is subject to the license terms in the LICENSE.txt
+ //@C file found in the top-level directory of this distribution and at
+ //@C https://confluence.slac.stanford.edu/display/ppareg/LICENSE.html.
+ //@C
+ //@C No part of CPSW, including this file, may be copied, modified, propagated, or
+ //@C distributed except according to the terms contained in the LICENSE.txt file.
+
+// A TCP stream serviced by the shared I/O engine must not lose
+// frames when the consumer is slower than the peer: the engine
+// stops reading until the consumer has made room.
+
+#include <cpsw_api_builder.h>
+#include <cpsw_metrics.h>
+
+#include <cpsw_obj_cnt.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+class TestFailed {
+public:
+	const char *e_;
+	TestFailed(const char *e):e_(e) {}
+};
+
+#define NFRAMES  2000
+#define FRAMESZ  1024
+#define QDEPTH   4
+#define NSLOW    20
+
+struct Peer {
+	int sd;
+	int conn;
+};
+
+static void
+sendAll(int sd, const uint8_t *p, size_t len)
+{
+ssize_t put;
+	while ( len > 0 ) {
+		if ( (put = send( sd, p, len, 0 )) <= 0 ) {
+			perror("send");
+			return;
+		}
+		p   += put;
+		len -= put;
+	}
+}
+
+// stream NFRAMES frames (length header + sequence number) to the
+// first client; the connection is left open
+static void *
+peerBody(void *arg)
+{
+Peer    *peer = static_cast<Peer*>( arg );
+uint8_t  frame[sizeof(uint32_t) + FRAMESZ];
+uint32_t v;
+unsigned i;
+
+	if ( (peer->conn = accept( peer->sd, 0, 0 )) < 0 ) {
+		perror("accept");
+		return 0;
+	}
+	memset( frame, 0, sizeof(frame) );
+	v = htonl( FRAMESZ );
+	memcpy( frame, &v, sizeof(v) );
+	for ( i = 0; i < NFRAMES; i++ ) {
+		memcpy( frame + sizeof(v), &i, sizeof(i) );
+		sendAll( peer->conn, frame, sizeof(frame) );
+	}
+	return 0;
+}
+
+static const IMetrics::Sample *
+find(const IMetrics::Snapshot &snap, const char *source, const char *name)
+{
+IMetrics::Snapshot::const_iterator it;
+	for ( it = snap.begin(); it != snap.end(); ++it ) {
+		if ( it->source == source && it->name == name )
+			return &(*it);
+	}
+	fprintf(stderr, "metric %s/%s not found\n", source, name);
+	throw TestFailed("metric missing from snapshot");
+}
+
+int
+main(int argc, char **argv)
+{
+struct sockaddr_in sin;
+socklen_t          sl = sizeof(sin);
+Peer               peer;
+pthread_t          tid;
+bool               started = false;
+uint8_t            buf[2*FRAMESZ];
+uint32_t           seq;
+int64_t            got;
+unsigned           i;
+int                rval = 1;
+
+	peer.conn = -1;
+	memset( &sin, 0, sizeof(sin) );
+	sin.sin_family      = AF_INET;
+	sin.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	sin.sin_port        = 0;
+
+	if (    (peer.sd = socket( AF_INET, SOCK_STREAM, 0 )) < 0
+	     || bind( peer.sd, (struct sockaddr*)&sin, sizeof(sin) )
+	     || listen( peer.sd, 1 )
+	     || getsockname( peer.sd, (struct sockaddr*)&sin, &sl ) ) {
+		perror("unable to create listening socket");
+		return 1;
+	}
+
+	try {
+		{
+		NetIODev root = INetIODev::create("netio", "127.0.0.1");
+		{
+		ProtoStackBuilder bldr( IProtoStackBuilder::create() );
+
+			bldr->setSRPVersion         ( IProtoStackBuilder::SRP_UDP_NONE );
+			bldr->setTcpPort            (             ntohs( sin.sin_port ) );
+			bldr->setTcpOutQueueDepth   (                            QDEPTH );
+			bldr->setTcpIoEngineThreads (                                 1 );
+
+			root->addAtAddress( IField::create("data"), bldr );
+		}
+
+		Stream strm = IStream::create( root->findByName("data") );
+
+			// the stream is open; anything sent now must arrive
+			if ( pthread_create( &tid, 0, peerBody, &peer ) ) {
+				throw TestFailed("unable to create peer thread");
+			}
+			started = true;
+
+			for ( i = 0; i < NFRAMES; i++ ) {
+				if ( i < NSLOW ) {
+					// let the engine run into the full queue
+					usleep( 10000 );
+				}
+				got = strm->read( buf, sizeof(buf), CTimeout( 5000000 ) );
+				if ( got != FRAMESZ ) {
+					fprintf(stderr, "frame %u: got %lld octets\n", i, (long long)got);
+					throw TestFailed( got ? "wrong frame size" : "timeout; frame lost" );
+				}
+				memcpy( &seq, buf, sizeof(seq) );
+				if ( seq != i ) {
+					fprintf(stderr, "expected frame %u, got %u\n", i, seq);
+					throw TestFailed("frame lost or out of order");
+				}
+			}
+
+			IMetrics::Snapshot snap;
+			IMetrics::snapshot( &snap );
+
+			if ( 0 == find( snap, "TCP", "rx_stalls" )->value ) {
+				throw TestFailed("engine never stopped reading; queue was not full");
+			}
+			if ( NFRAMES != find( snap, "TCP", "rx_dgrams" )->value ) {
+				throw TestFailed("TCP RX frame counter wrong");
+			}
+		}
+		rval = 0;
+	} catch ( CPSWError &e ) {
+		fprintf(stderr,"CPSW Error caught: %s\n", e.getInfo().c_str());
+	} catch ( TestFailed &e ) {
+		fprintf(stderr,"TEST FAILED: %s\n", e.e_);
+	}
+
+	if ( started ) {
+		pthread_join( tid, 0 );
+	}
+	if ( peer.conn >= 0 ) {
+		close( peer.conn );
+	}
+	close( peer.sd );
+
+	if ( rval ) {
+		return rval;
+	}
+
+	if ( CpswObjCounter::report(stderr) ) {
+		fprintf(stderr, "Leaked Objects!\n");
+		return 1;
+	}
+	printf("TCP I/O engine test PASSED\n");
+	return 0;
+}
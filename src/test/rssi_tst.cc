@@ -19,9 +19,11 @@ static void sh(int sig)
 
 static void usage(const char *nm)
 {
-	fprintf(stderr,"Usage: %s [-s <sleep_us>] [-n <packets>] [-L <percent dropped packets>] [-G garblDepth] [-h]\n", nm);
+	fprintf(stderr,"Usage: %s [-s <sleep_us>] [-n <packets>] [-L <percent dropped packets>] [-G garblDepth] [-R <reactor threads>] [-E] [-h]\n", nm);
 	fprintf(stderr,"Note: garbled packet depth quickly leads to out-of sequence packets\n");
 	fprintf(stderr,"      probability a packet is delayed more than N cycles is ((Depth-1)/Depth)^N\n");
+	fprintf(stderr,"      with -R both peers are served by a shared reactor pool\n");
+	fprintf(stderr,"      with -E both peers use selective (extended) ACKs\n");
 }
 
 int
@@ -32,17 +34,21 @@ unsigned sleep_us                = 0;
 unsigned dropped_packets_percent = 0;
 unsigned garbl_depth             = 0;
 unsigned n_packets               = 100000;
+unsigned reactor_threads         = 0;
+bool     selective_ack           = false;
 int      opt;
 unsigned *i_p;
 int      rval = 1;
 
-	while ( (opt = getopt(argc, argv, "s:L:G:n:h")) > 0 ) {
+	while ( (opt = getopt(argc, argv, "s:L:G:n:R:Eh")) > 0 ) {
 		i_p = 0;
 		switch (opt) {
 			case 's': i_p = &sleep_us;                break;
 			case 'L': i_p = &dropped_packets_percent; break;
 			case 'G': i_p = &garbl_depth;             break;
 			case 'n': i_p = &n_packets;               break;
+			case 'R': i_p = &reactor_threads;         break;
+			case 'E': selective_ack = true;           continue;
 
 			case 'h': rval = 0;
 			default:
@@ -65,9 +71,13 @@ int      rval = 1;
 		perror("Unable to install signal handler");
 	}
 
+	CRssiConfigParams config;
+	config.reactorThreads_ = reactor_threads;
+	config.selectiveAck_   = selective_ack;
+
 for ( j=0; j<1; j++ ) {
-	RssiPort  server = CRssiPort::create(true);
-	RssiPort  client = CRssiPort::create(false);
+	RssiPort  server = CRssiPort::create(true,  &config);
+	RssiPort  client = CRssiPort::create(false, &config);
 	ProtoPort sSink  = ISink::create("Server Sink");
 	ProtoPort cSink  = ISink::create("Client Sink", sleep_us);
 	unsigned i = 0;